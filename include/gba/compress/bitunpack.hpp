@@ -0,0 +1,183 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_COMPRESS_BITUNPACK_HPP
+#define GBAXX_COMPRESS_BITUNPACK_HPP
+/** @file */
+
+#include <cstddef>
+
+#include <gba/type.hpp>
+
+#include <gba/bios/compress.hpp>
+
+namespace gba::compress {
+
+    namespace detail {
+
+        // Reads ChunkBits of source at a time (LSB first), looking up OutBits of destination for each
+        template <u32 ChunkBits, u32 OutBits>
+        [[gnu::section(".iwram._gba_bitunpack"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void bitunpack(const u8* __restrict__ src, u32* __restrict__ dest, std::size_t words, const u32* __restrict__ table) noexcept {
+            constexpr auto mask = (1u << ChunkBits) - 1;
+
+            u32 bits = 0;
+            u32 avail = 0;
+            while (words--) {
+                u32 word = 0;
+                for (u32 ii = 0; ii < 32 / OutBits; ++ii) {
+                    if (avail < ChunkBits) {
+                        bits = *src++;
+                        avail = 8;
+                    }
+                    word |= table[bits & mask] << (ii * OutBits);
+                    bits >>= ChunkBits;
+                    avail -= ChunkBits;
+                }
+                *dest++ = word;
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * @class bit_unpacker
+     * @brief Table driven replacement for bios::BitUnPack().
+     * @see <a href="https://mgba-emu.github.io/gbatek/#bitunpack---swi-10h-gbands7nds9dsi7dsi9">BitUnPack - SWI 10h (GBA/NDS7/NDS9/DSi7/DSi9)</a>
+     *
+     * Expands the same data as bios::BitUnPack(), with the offset applied as in bios::bit_un_pack: non-zero source
+     * units have the offset added, and zero units only when offset_zero is set (so zero stays transparent otherwise).
+     *
+     * Every possible source byte (or nibble, for 1 to 8 bpp) is expanded once into a table when the offsets are set.
+     * unpack() then runs from IWRAM in ARM state, writing whole 32-bit words, so it can write directly to VRAM.
+     *
+     * @tparam SrcBpp Source bits per unit (1, 2, or 4).
+     * @tparam DstBpp Destination bits per unit (2, 4, or 8), greater than SrcBpp.
+     *
+     * @code{cpp}
+     * // Uploading a 1bpp font as color 15 on transparent
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const gba::u8 font_1bpp[96 * 8];
+     *
+     * static constexpr auto font_unpacker = gba::compress::bit_unpacker<1, 4>(14); // 1 + 14 = 15, 0 stays 0
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     font_unpacker.unpack(font_1bpp, &mmio::CHARBLOCK0_4BPP[0], 96);
+     * }
+     * @endcode
+     *
+     * @note Unlike bios::BitUnPack(), offsets that overflow a destination unit are masked instead of carrying into the
+     *       next unit.
+     *
+     * @sa bios::BitUnPack()
+     * @sa bios::bit_un_pack
+     */
+    template <u32 SrcBpp, u32 DstBpp>
+        requires ((SrcBpp == 1 || SrcBpp == 2 || SrcBpp == 4) && (DstBpp == 2 || DstBpp == 4 || DstBpp == 8) && SrcBpp < DstBpp)
+    class bit_unpacker {
+    public:
+        // Source bits per table entry, limited so an entry is at most 32 bits
+        static constexpr u32 chunk_bits = 32 * SrcBpp / DstBpp < 8 ? 32 * SrcBpp / DstBpp : 8;
+        static constexpr u32 out_bits = chunk_bits * DstBpp / SrcBpp;
+        static constexpr std::size_t table_size = std::size_t{1} << chunk_bits;
+
+        /**
+         * @param offset Value added to the source units.
+         * @param offset_zero Also add the offset to source units of zero.
+         */
+        constexpr explicit bit_unpacker(u32 offset = 0, bool offset_zero = false) noexcept {
+            set_offset(offset, offset_zero);
+        }
+
+        /**
+         * @param params Unpack parameters, as used by bios::BitUnPack(). The bits per unit must match SrcBpp and
+         *               DstBpp, and src_len is ignored.
+         */
+        constexpr explicit bit_unpacker(const bios::bit_un_pack& params) noexcept : bit_unpacker(params.dst_ofs, params.offset_zero) {}
+
+        /**
+         * @brief Rebuilds the table with new offsets.
+         *
+         * @param offset Value added to the source units.
+         * @param offset_zero Also add the offset to source units of zero.
+         */
+        constexpr void set_offset(u32 offset, bool offset_zero = false) noexcept {
+            constexpr auto src_mask = (1u << SrcBpp) - 1;
+            constexpr auto dst_mask = (1u << DstBpp) - 1;
+
+            for (u32 value = 0; value < table_size; ++value) {
+                u32 out = 0;
+                for (u32 ii = 0; ii < chunk_bits / SrcBpp; ++ii) {
+                    auto unit = (value >> (ii * SrcBpp)) & src_mask;
+                    if (unit || offset_zero) {
+                        unit += offset;
+                    }
+                    out |= (unit & dst_mask) << (ii * DstBpp);
+                }
+                m_table[value] = out;
+            }
+        }
+
+        /**
+         * @brief Expanded units of one table entry.
+         *
+         * @param chunk chunk_bits of packed source units.
+         * @return out_bits of destination units.
+         */
+        [[nodiscard]]
+        constexpr u32 operator[](std::size_t chunk) const noexcept {
+            return m_table[chunk];
+        }
+
+        /**
+         * @brief Expands packed units.
+         *
+         * @param src Packed source units.
+         * @param dest Destination, 4-byte aligned.
+         * @param src_len Source length in bytes. The destination length (src_len * DstBpp / SrcBpp) must be a
+         *                multiple of 4.
+         */
+        void unpack(const void* src, void* dest, std::size_t src_len) const noexcept {
+            detail::bitunpack<chunk_bits, out_bits>(static_cast<const u8*>(src), static_cast<u32*>(dest),
+                                                    src_len * DstBpp / SrcBpp / 4, m_table);
+        }
+
+        /**
+         * @brief Expands packed units directly into 4bpp tiles.
+         *
+         * @param src Packed source, SrcBpp * 8 bytes per tile.
+         * @param dest Destination tiles, such as mmio::CHARBLOCK0_4BPP.
+         * @param count Number of tiles.
+         */
+        void unpack(const void* src, volatile tile4bpp* dest, std::size_t count) const noexcept requires (DstBpp == 4) {
+            unpack(src, static_cast<void*>(const_cast<tile4bpp*>(dest)), count * SrcBpp * 8);
+        }
+
+        /**
+         * @brief Expands packed units directly into 8bpp tiles.
+         *
+         * @param src Packed source, SrcBpp * 8 bytes per tile.
+         * @param dest Destination tiles, such as mmio::CHARBLOCK0_8BPP.
+         * @param count Number of tiles.
+         */
+        void unpack(const void* src, volatile tile8bpp* dest, std::size_t count) const noexcept requires (DstBpp == 8) {
+            unpack(src, static_cast<void*>(const_cast<tile8bpp*>(dest)), count * SrcBpp * 8);
+        }
+
+    private:
+        u32 m_table[table_size]{};
+    };
+
+} // namespace gba::compress
+
+#endif // define GBAXX_COMPRESS_BITUNPACK_HPP
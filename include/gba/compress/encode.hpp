@@ -0,0 +1,265 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_COMPRESS_ENCODE_HPP
+#define GBAXX_COMPRESS_ENCODE_HPP
+/** @file */
+
+#include <array>
+#include <cstddef>
+
+#include <gba/type.hpp>
+
+#include <gba/compress/output.hpp>
+
+namespace gba::compress {
+
+    /**
+     * @struct compressed_array
+     * @brief Compressed data generated at compile time, word aligned as the BIOS functions require.
+     *
+     * @tparam N Size in bytes, including the BIOS header and padding to a multiple of 4.
+     *
+     * @sa lz77_compress()
+     * @sa rle_compress()
+     */
+    template <std::size_t N>
+    struct alignas(4) compressed_array : std::array<u8, N> {};
+
+    namespace detail {
+
+        template <typename T>
+        consteval auto object_bytes(const T& data) {
+            return __builtin_bit_cast(std::array<u8, sizeof(T)>, data);
+        }
+
+        template <std::size_t N>
+        struct encoded_bytes {
+            std::array<u8, N> bytes{};
+            std::size_t size{};
+
+            constexpr void put(u8 value) noexcept {
+                bytes[size++] = value;
+            }
+
+            constexpr void put_header(u8 type, std::size_t length) noexcept {
+                put(type);
+                put(u8(length));
+                put(u8(length >> 8));
+                put(u8(length >> 16));
+            }
+        };
+
+        // Greedy longest match, found through hash chains of three byte prefixes. Each chain walk is capped, and a
+        // candidate is only compared in full if it matches the byte that would make it longer than the best so far.
+        // The arrays are accessed through pointers, as every operator[] call counts against the constexpr limit.
+        template <std::size_t N>
+        consteval auto lz77_encode(const std::array<u8, N>& in, std::size_t min_distance) {
+            constexpr std::size_t window = 0x1000;
+            constexpr std::size_t min_length = 3;
+            constexpr std::size_t max_length = 18;
+            constexpr std::size_t chain_limit = 32;
+
+            // Every literal costs 9 bits at worst
+            auto out = encoded_bytes<4 + N + (N + 7) / 8>{};
+            out.put_header(0x10, N);
+
+            auto head_storage = std::array<int, 0x1000>{};
+            head_storage.fill(-1);
+            auto prev_storage = std::array<int, N>{};
+
+            const u8* const data = in.data();
+            int* const head = head_storage.data();
+            int* const prev = prev_storage.data();
+
+            const auto hash = [data](std::size_t pos) {
+                return ((data[pos] * 0x3bu + data[pos + 1]) * 0x3bu + data[pos + 2]) & 0xfffu;
+            };
+            const auto insert = [&](std::size_t pos) {
+                if (pos + 2 < N) {
+                    const auto h = hash(pos);
+                    prev[pos] = head[h];
+                    head[h] = int(pos);
+                }
+            };
+
+            std::size_t pos = 0;
+            std::size_t flags = 0;
+            unsigned items = 8;
+            while (pos < N) {
+                if (items == 8) {
+                    flags = out.size;
+                    out.put(0);
+                    items = 0;
+                }
+
+                std::size_t best_length = 0;
+                std::size_t best_distance = 0;
+                if (pos + min_length <= N) {
+                    const auto limit = N - pos < max_length ? N - pos : max_length;
+                    const auto* const current = data + pos;
+                    auto candidate = head[hash(pos)];
+                    for (std::size_t chain = 0; candidate >= 0 && chain < chain_limit; candidate = prev[candidate], ++chain) {
+                        const auto distance = pos - std::size_t(candidate);
+                        if (distance > window) {
+                            break;
+                        }
+                        const auto* const match = data + candidate;
+                        if (distance < min_distance || match[best_length] != current[best_length]) {
+                            continue;
+                        }
+
+                        std::size_t length = 0;
+                        while (length < limit && match[length] == current[length]) {
+                            ++length;
+                        }
+                        if (length > best_length) {
+                            best_length = length;
+                            best_distance = distance;
+                            if (length == limit) {
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                if (best_length >= min_length) {
+                    const auto displacement = best_distance - 1;
+                    out.bytes[flags] |= u8(0x80 >> items);
+                    out.put(u8(((best_length - min_length) << 4) | (displacement >> 8)));
+                    out.put(u8(displacement));
+                    for (auto end = pos + best_length; pos < end; ++pos) {
+                        insert(pos);
+                    }
+                } else {
+                    out.put(data[pos]);
+                    insert(pos++);
+                }
+                ++items;
+            }
+            return out;
+        }
+
+        template <std::size_t N>
+        consteval auto rle_encode(const std::array<u8, N>& in) {
+            constexpr std::size_t min_run = 3;
+            constexpr std::size_t max_run = 130;
+            constexpr std::size_t max_literals = 128;
+
+            // Each run saves at least the flag byte of the literals it splits
+            auto out = encoded_bytes<4 + N + (N + max_literals - 1) / max_literals>{};
+            out.put_header(0x30, N);
+
+            std::size_t literals = 0;
+            const auto flush = [&](std::size_t end) {
+                while (literals < end) {
+                    const auto count = end - literals < max_literals ? end - literals : max_literals;
+                    out.put(u8(count - 1));
+                    for (std::size_t ii = 0; ii < count; ++ii) {
+                        out.put(in[literals++]);
+                    }
+                }
+            };
+
+            std::size_t pos = 0;
+            while (pos < N) {
+                std::size_t run = 1;
+                while (pos + run < N && run < max_run && in[pos + run] == in[pos]) {
+                    ++run;
+                }
+                if (run >= min_run) {
+                    flush(pos);
+                    out.put(u8(0x80 | (run - min_run)));
+                    out.put(in[pos]);
+                    literals = pos + run;
+                }
+                pos += run;
+            }
+            flush(N);
+            return out;
+        }
+
+        template <auto Encoded>
+        consteval auto to_compressed_array() {
+            auto result = compressed_array<(Encoded.size + 3) & ~std::size_t{3}>{};
+            for (std::size_t ii = 0; ii < Encoded.size; ++ii) {
+                result[ii] = Encoded.bytes[ii];
+            }
+            return result;
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Compresses data into the BIOS LZ77 format at compile time.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#lz77uncompreadnormalwrite8bit-wram---swi-11h-gbands7nds9dsi7dsi9">LZ77UnCompReadNormalWrite8bit (Wram) - SWI 11h (GBA/NDS7/NDS9/DSi7/DSi9)</a>
+     *
+     * Generated tables and tilemaps can then be stored compressed in ROM without an external tool, and loaded with
+     * lz77_decompress(), lz77_decoder, or the BIOS.
+     *
+     * @tparam Data Array (or any trivially copyable value) to compress, stored as its bytes.
+     * @tparam Target With target::vram, no back-reference copies from the byte just before it, which
+     *                bios::LZ77UnCompVram() cannot decode. The result then suits either target.
+     * @return compressed_array holding the header and the compressed stream.
+     *
+     * @code{cpp}
+     * // Storing a generated checkerboard tilemap compressed in ROM
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static constexpr auto checker = gba::lut::make<1024>([](std::size_t i) {
+     *     return gba::u16(((i / 32) ^ i) & 1);
+     * });
+     * static constexpr auto checker_lz = gba::compress::lz77_compress<checker>(); // 2048 bytes to 256
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     compress::lz77_decompress<compress::target::vram>(checker_lz.data(), &mmio::TEXT_SCREENBLOCKS[31]);
+     * }
+     * @endcode
+     *
+     * @note Compression runs in the compiler, within its limit on constant evaluation. With GCC's default
+     *       `-fconstexpr-ops-limit`, inputs of up to 32KB always compile, and typical assets up to about 64KB. Larger
+     *       inputs fail to compile unless the limit is raised (`-fconstexpr-ops-limit=` for GCC,
+     *       `-fconstexpr-steps=` for Clang).
+     *
+     * @sa lz77_decompress()
+     * @sa rle_compress()
+     */
+    template <auto Data, target Target = target::vram>
+    consteval auto lz77_compress() {
+        static_assert(sizeof(Data) < (1u << 24), "BIOS headers hold a 24-bit size");
+        constexpr auto bytes = detail::object_bytes(Data);
+        return detail::to_compressed_array<detail::lz77_encode(bytes, Target == target::vram ? 2 : 1)>();
+    }
+
+    /**
+     * @brief Compresses data into the BIOS run-length format at compile time.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#rluncompreadnormalwrite8bit-wram---swi-14h-gbands7nds9dsi7dsi9">RLUnCompReadNormalWrite8bit (Wram) - SWI 14h (GBA/NDS7/NDS9/DSi7/DSi9)</a>
+     *
+     * Cheaper to decode than LZ77, and suited to data with long runs of the same byte, such as sparse tilemaps.
+     *
+     * @tparam Data Array (or any trivially copyable value) to compress, stored as its bytes.
+     * @return compressed_array holding the header and the compressed stream.
+     *
+     * @sa rle_decoder
+     * @sa bios::RLUnCompWram()
+     * @sa lz77_compress()
+     */
+    template <auto Data>
+    consteval auto rle_compress() {
+        static_assert(sizeof(Data) < (1u << 24), "BIOS headers hold a 24-bit size");
+        constexpr auto bytes = detail::object_bytes(Data);
+        return detail::to_compressed_array<detail::rle_encode(bytes)>();
+    }
+
+} // namespace gba::compress
+
+#endif // define GBAXX_COMPRESS_ENCODE_HPP
@@ -0,0 +1,141 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_COMPRESS_HUFFMAN_HPP
+#define GBAXX_COMPRESS_HUFFMAN_HPP
+/** @file */
+
+#include <cstddef>
+
+#include <gba/type.hpp>
+
+#include <gba/compress/output.hpp>
+
+namespace gba::compress {
+
+    /**
+     * @class huffman_decoder
+     * @brief Resumable decoder for the BIOS Huffman format.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#huffuncompreadnormal---swi-13h-gba">HuffUnCompReadNormal - SWI 13h (GBA)</a>
+     *
+     * Decompresses the same data as bios::HuffUnComp(), a limited number of bytes at a time.
+     *
+     * Output is written in whole 32-bit words, so the same decoder is safe for both work RAM and video RAM.
+     *
+     * @note An input that is not Huffman compressed has a size() of zero.
+     * @note Both the source and the destination must be 4-byte aligned.
+     * @note The number of bytes decoded is rounded up to a multiple of 4.
+     *
+     * @sa lz77_decoder
+     * @sa bios::HuffUnComp()
+     */
+    class huffman_decoder {
+    public:
+        /**
+         * @param src Compressed data, starting with the BIOS header.
+         * @param dest Destination of the decompressed data.
+         */
+        huffman_decoder(const void* src, void* dest) noexcept : m_tree{static_cast<const u8*>(src)}, m_dest{static_cast<volatile u32*>(dest)} {
+            const auto header = detail::read_header(m_tree);
+            if ((header & 0xf0) == 0x20) {
+                m_size = header >> 8;
+                m_symbol_bits = u8(header & 0xf);
+                m_stream = reinterpret_cast<const u32*>(m_tree + 4 + (m_tree[4] + 1) * 2);
+            }
+        }
+
+        /**
+         * @brief Decompresses the next bytes.
+         *
+         * @param max Maximum number of bytes to write, rounded up to a multiple of 4.
+         * @return Number of bytes written.
+         */
+        std::size_t decode(std::size_t max) noexcept {
+            const auto start = m_position;
+            const auto count = max < remaining() ? max : remaining();
+            const auto end = start + ((count + 3) & ~std::size_t{3});
+
+            const auto symbol_mask = (1u << m_symbol_bits) - 1;
+            while (m_position < end) {
+                // Walk from the root until a data node is reached
+                std::size_t index = 5;
+                auto node = m_tree[index];
+                while (true) {
+                    if (!m_bit_count) {
+                        m_bits = *m_stream++;
+                        m_bit_count = 32;
+                    }
+                    const auto bit = m_bits >> 31;
+                    m_bits <<= 1;
+                    --m_bit_count;
+
+                    const auto data = node & (bit ? 0x40 : 0x80);
+                    index = (index & ~std::size_t{1}) + (node & 0x3fu) * 2 + 2 + bit;
+                    node = m_tree[index];
+                    if (data) {
+                        break;
+                    }
+                }
+
+                m_word |= (node & symbol_mask) << m_word_bits;
+                m_word_bits += m_symbol_bits;
+                if (m_word_bits == 32) {
+                    m_dest[m_position >> 2] = m_word;
+                    m_position += 4;
+                    m_word = 0;
+                    m_word_bits = 0;
+                }
+            }
+
+            return m_position - start;
+        }
+
+        /**
+         * @brief Decompresses everything that remains.
+         */
+        void decode_all() noexcept {
+            decode(remaining());
+        }
+
+        /**
+         * @brief Total decompressed size from the header.
+         *
+         * @return Size in bytes.
+         */
+        [[nodiscard]]
+        std::size_t size() const noexcept {
+            return m_size;
+        }
+
+        [[nodiscard]]
+        std::size_t remaining() const noexcept {
+            return m_position < m_size ? m_size - m_position : 0;
+        }
+
+        [[nodiscard]]
+        bool done() const noexcept {
+            return m_position >= m_size;
+        }
+
+    private:
+        const u8* m_tree;
+        const u32* m_stream{};
+        volatile u32* m_dest;
+        std::size_t m_size{};
+        std::size_t m_position{};
+        u32 m_bits{};
+        u32 m_word{};
+        u8 m_bit_count{};
+        u8 m_word_bits{};
+        u8 m_symbol_bits{8};
+    };
+
+} // namespace gba::compress
+
+#endif // define GBAXX_COMPRESS_HUFFMAN_HPP
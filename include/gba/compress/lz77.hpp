@@ -0,0 +1,298 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_COMPRESS_LZ77_HPP
+#define GBAXX_COMPRESS_LZ77_HPP
+/** @file */
+
+#include <cstddef>
+
+#include <gba/type.hpp>
+
+#include <gba/compress/output.hpp>
+
+namespace gba::compress {
+
+    namespace detail {
+
+        [[gnu::section(".iwram._gba_lz77_wram"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void lz77_decompress_wram(const u8* __restrict__ src, u8* __restrict__ dest) noexcept {
+            const auto header = read_header(src);
+            if ((header & 0xf0) != 0x10) {
+                return;
+            }
+            src += 4;
+
+            auto* const end = dest + (header >> 8);
+            while (dest < end) {
+                auto flags = static_cast<unsigned int>(*src++);
+
+                // Eight literals in a row, the common case for incompressible runs
+                if (!flags && end - dest >= 8) {
+                    dest[0] = src[0]; dest[1] = src[1]; dest[2] = src[2]; dest[3] = src[3];
+                    dest[4] = src[4]; dest[5] = src[5]; dest[6] = src[6]; dest[7] = src[7];
+                    dest += 8;
+                    src += 8;
+                    continue;
+                }
+
+                for (auto block = 8; block && dest < end; --block, flags <<= 1) {
+                    if (!(flags & 0x80)) {
+                        *dest++ = *src++;
+                        continue;
+                    }
+
+                    const unsigned int hi = src[0];
+                    const unsigned int lo = src[1];
+                    src += 2;
+
+                    const u8* from = dest - (((hi & 0xfu) << 8) | lo) - 1;
+                    auto length = static_cast<std::ptrdiff_t>((hi >> 4) + 3);
+                    if (length > end - dest) {
+                        length = end - dest;
+                    }
+                    do {
+                        *dest++ = *from++;
+                    } while (--length);
+                }
+            }
+        }
+
+        [[gnu::section(".iwram._gba_lz77_vram"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void lz77_decompress_vram(const u8* __restrict__ src, void* __restrict__ dest) noexcept {
+            const auto header = read_header(src);
+            if ((header & 0xf0) != 0x10) {
+                return;
+            }
+            src += 4;
+
+            // Byte reads from VRAM are fine, only byte writes are not
+            const auto* const read = static_cast<const volatile u8*>(dest);
+            auto* const write = static_cast<volatile u16*>(dest);
+
+            // The low byte of each halfword is held in a register until the high byte completes it
+            const auto size = header >> 8;
+            std::size_t position = 0;
+            unsigned int pending = 0;
+            const auto put = [&](unsigned int value) {
+                if (position & 1) {
+                    write[position >> 1] = u16(pending | (value << 8));
+                } else {
+                    pending = value;
+                }
+                ++position;
+            };
+
+            while (position < size) {
+                auto flags = static_cast<unsigned int>(*src++);
+                for (auto block = 8; block && position < size; --block, flags <<= 1) {
+                    if (!(flags & 0x80)) {
+                        put(*src++);
+                        continue;
+                    }
+
+                    const unsigned int hi = src[0];
+                    const unsigned int lo = src[1];
+                    src += 2;
+
+                    const auto displacement = (((hi & 0xfu) << 8) | lo) + 1;
+                    auto length = (hi >> 4) + 3;
+                    if (length > size - position) {
+                        length = size - position;
+                    }
+                    do {
+                        const auto from = position - displacement;
+                        put((position & 1) && displacement == 1 ? pending : read[from]);
+                    } while (--length);
+                }
+            }
+
+            // A trailing odd byte preserves the byte after it
+            if (position & 1) {
+                const auto index = position >> 1;
+                write[index] = u16((write[index] & 0xff00) | pending);
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * @class lz77_decoder
+     * @brief Resumable decoder for the BIOS LZ77 format.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#lz77uncompreadnormalwrite8bit-wram---swi-11h-gbands7nds9dsi7dsi9">LZ77UnCompReadNormalWrite8bit (Wram) - SWI 11h (GBA/NDS7/NDS9/DSi7/DSi9)</a>
+     *
+     * Decompresses the same data as bios::LZ77UnCompWram() and bios::LZ77UnCompVram(), but a limited number of bytes
+     * at a time, so a large asset can be spread across several frames without blocking interrupts.
+     *
+     * The destination must be the whole output buffer, as back-references read from previously decoded data.
+     *
+     * @code{cpp}
+     * // Streaming tiles into VRAM over several frames
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const unsigned char level_tiles_lz[];
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     auto decoder = compress::lz77_decoder<compress::target::vram>{level_tiles_lz, &mmio::CHARBLOCK0_4BPP};
+     *     while (!decoder.done()) {
+     *         decoder.decode(2048);
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @tparam Target Type of memory written to.
+     *
+     * @note An input that is not LZ77 has a size() of zero.
+     *
+     * @sa lz77_decompress()
+     * @sa bios::LZ77UnCompWram()
+     * @sa bios::LZ77UnCompVram()
+     */
+    template <target Target = target::wram>
+    class lz77_decoder {
+    public:
+        /**
+         * @param src Compressed data, starting with the BIOS header.
+         * @param dest Destination of the complete decompressed data.
+         */
+        lz77_decoder(const void* src, void* dest) noexcept : m_src{static_cast<const u8*>(src) + 4}, m_out{dest} {
+            const auto header = detail::read_header(static_cast<const u8*>(src));
+            m_size = (header & 0xf0) == 0x10 ? header >> 8 : 0;
+        }
+
+        /**
+         * @brief Decompresses the next bytes.
+         *
+         * @param max Maximum number of bytes to write.
+         * @return Number of bytes written.
+         */
+        std::size_t decode(std::size_t max) noexcept {
+            const auto start = m_out.position();
+            const auto end = start + (max < m_size - start ? max : m_size - start);
+
+            while (m_out.position() < end) {
+                if (m_copy) {
+                    m_out.put(m_out.at(m_out.position() - m_displacement));
+                    --m_copy;
+                    continue;
+                }
+
+                if (!m_flag_bits) {
+                    m_flags = *m_src++;
+                    m_flag_bits = 8;
+                }
+                --m_flag_bits;
+                const auto reference = m_flags & 0x80;
+                m_flags = u8(m_flags << 1);
+
+                if (!reference) {
+                    m_out.put(*m_src++);
+                } else {
+                    const auto hi = m_src[0];
+                    const auto lo = m_src[1];
+                    m_src += 2;
+                    m_copy = (hi >> 4) + 3u;
+                    m_displacement = (((hi & 0xfu) << 8) | lo) + 1u;
+                }
+            }
+
+            if (m_out.position() == m_size) {
+                m_out.finish();
+            }
+            return m_out.position() - start;
+        }
+
+        /**
+         * @brief Decompresses everything that remains.
+         */
+        void decode_all() noexcept {
+            decode(remaining());
+        }
+
+        /**
+         * @brief Total decompressed size from the header.
+         *
+         * @return Size in bytes.
+         */
+        [[nodiscard]]
+        std::size_t size() const noexcept {
+            return m_size;
+        }
+
+        [[nodiscard]]
+        std::size_t remaining() const noexcept {
+            return m_size - m_out.position();
+        }
+
+        [[nodiscard]]
+        bool done() const noexcept {
+            return m_out.position() == m_size;
+        }
+
+    private:
+        const u8* m_src;
+        detail::byte_output<Target> m_out;
+        std::size_t m_size{};
+        unsigned int m_copy{};
+        unsigned int m_displacement{};
+        u8 m_flags{};
+        u8 m_flag_bits{};
+    };
+
+    /**
+     * @brief Decompresses LZ77 compressed data with an ARM decoder in IWRAM.
+     *
+     * Reads the same data as bios::LZ77UnCompWram() and bios::LZ77UnCompVram(), but runs from IWRAM in ARM state, so
+     * it is considerably faster than the BIOS (which decodes a byte at a time from BIOS ROM). With target::vram the
+     * incomplete halfword is held in a register, avoiding the read-modify-write of the BIOS Vram variant.
+     *
+     * @code{cpp}
+     * // Loading screen tiles
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const unsigned char level_tiles_lz[];
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     compress::lz77_decompress<compress::target::vram>(level_tiles_lz, &mmio::CHARBLOCK0_4BPP);
+     * }
+     * @endcode
+     *
+     * @tparam Target Type of memory written to.
+     * @param src Pointer to the compressed source data.
+     * @param dest Pointer to the destination buffer where the uncompressed data will be written to.
+     *
+     * @note Nothing is written if the source is not LZ77.
+     * @note VRAM destinations must be half-word aligned.
+     *
+     * @warning The function assumes that the dest buffer has sufficient space to store the decompressed data.
+     *
+     * @sa lz77_decoder
+     * @sa bios::LZ77UnCompWram()
+     * @sa bios::LZ77UnCompVram()
+     */
+    template <target Target = target::wram>
+    [[gnu::nonnull(1, 2)]]
+    void lz77_decompress(const void* __restrict__ src, void* __restrict__ dest) noexcept {
+        if constexpr (Target == target::vram) {
+            detail::lz77_decompress_vram(static_cast<const u8*>(src), dest);
+        } else {
+            detail::lz77_decompress_wram(static_cast<const u8*>(src), static_cast<u8*>(dest));
+        }
+    }
+
+} // namespace gba::compress
+
+#endif // define GBAXX_COMPRESS_LZ77_HPP
@@ -0,0 +1,118 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_COMPRESS_OUTPUT_HPP
+#define GBAXX_COMPRESS_OUTPUT_HPP
+/** @file */
+
+#include <cstddef>
+
+#include <gba/type.hpp>
+
+namespace gba::compress {
+
+    /**
+     * @enum target
+     * @brief Memory that decompressed data is written to.
+     *
+     * Matches the Wram and Vram variants of the BIOS decompression functions.
+     */
+    enum class target {
+        wram, /**< Byte writes, for work RAM. */
+        vram, /**< 16-bit writes only, for video RAM and palette RAM (which ignore byte writes). */
+    };
+
+    namespace detail {
+
+        template <target Target>
+        class byte_output;
+
+        template <>
+        class byte_output<target::wram> {
+        public:
+            constexpr explicit byte_output(void* dest) noexcept : m_dest{static_cast<u8*>(dest)} {}
+
+            [[gnu::always_inline]]
+            void put(u8 value) noexcept {
+                m_dest[m_position++] = value;
+            }
+
+            [[nodiscard, gnu::always_inline]]
+            u8 at(std::size_t position) const noexcept {
+                return m_dest[position];
+            }
+
+            void finish() noexcept {}
+
+            [[nodiscard]]
+            std::size_t position() const noexcept {
+                return m_position;
+            }
+
+        private:
+            u8* m_dest;
+            std::size_t m_position{};
+        };
+
+        template <>
+        class byte_output<target::vram> {
+        public:
+            constexpr explicit byte_output(void* dest) noexcept : m_dest{static_cast<volatile u16*>(dest)} {}
+
+            [[gnu::always_inline]]
+            void put(u8 value) noexcept {
+                if (m_position & 1) {
+                    m_dest[m_position >> 1] = u16(m_pending | (value << 8));
+                } else {
+                    m_pending = value;
+                }
+                ++m_position;
+            }
+
+            [[nodiscard, gnu::always_inline]]
+            u8 at(std::size_t position) const noexcept {
+                // The low byte of an incomplete halfword has not been written yet
+                if ((m_position & 1) && position == m_position - 1) {
+                    return m_pending;
+                }
+                const auto half = m_dest[position >> 1];
+                return u8(position & 1 ? half >> 8 : half);
+            }
+
+            /**
+             * Writes a trailing odd byte, preserving the byte after it.
+             */
+            void finish() noexcept {
+                if (m_position & 1) {
+                    const auto index = m_position >> 1;
+                    m_dest[index] = u16((m_dest[index] & 0xff00) | m_pending);
+                }
+            }
+
+            [[nodiscard]]
+            std::size_t position() const noexcept {
+                return m_position;
+            }
+
+        private:
+            volatile u16* m_dest;
+            std::size_t m_position{};
+            u8 m_pending{};
+        };
+
+        [[nodiscard]]
+        inline u32 read_header(const u8* src) noexcept {
+            return u32(src[0]) | (u32(src[1]) << 8) | (u32(src[2]) << 16) | (u32(src[3]) << 24);
+        }
+
+    } // namespace detail
+
+} // namespace gba::compress
+
+#endif // define GBAXX_COMPRESS_OUTPUT_HPP
@@ -0,0 +1,128 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_COMPRESS_RLE_HPP
+#define GBAXX_COMPRESS_RLE_HPP
+/** @file */
+
+#include <cstddef>
+
+#include <gba/type.hpp>
+
+#include <gba/compress/output.hpp>
+
+namespace gba::compress {
+
+    /**
+     * @class rle_decoder
+     * @brief Resumable decoder for the BIOS run-length format.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#rluncompreadnormalwrite8bit-wram---swi-14h-gbands7nds9dsi7dsi9">RLUnCompReadNormalWrite8bit (Wram) - SWI 14h (GBA/NDS7/NDS9/DSi7/DSi9)</a>
+     *
+     * Decompresses the same data as bios::RLUnCompWram() and bios::RLUnCompVram(), a limited number of bytes at a
+     * time.
+     *
+     * @tparam Target Type of memory written to.
+     *
+     * @note An input that is not run-length encoded has a size() of zero.
+     *
+     * @sa lz77_decoder
+     * @sa bios::RLUnCompWram()
+     * @sa bios::RLUnCompVram()
+     */
+    template <target Target = target::wram>
+    class rle_decoder {
+    public:
+        /**
+         * @param src Compressed data, starting with the BIOS header.
+         * @param dest Destination of the decompressed data.
+         */
+        rle_decoder(const void* src, void* dest) noexcept : m_src{static_cast<const u8*>(src) + 4}, m_out{dest} {
+            const auto header = detail::read_header(static_cast<const u8*>(src));
+            m_size = (header & 0xf0) == 0x30 ? header >> 8 : 0;
+        }
+
+        /**
+         * @brief Decompresses the next bytes.
+         *
+         * @param max Maximum number of bytes to write.
+         * @return Number of bytes written.
+         */
+        std::size_t decode(std::size_t max) noexcept {
+            const auto start = m_out.position();
+            const auto end = start + (max < m_size - start ? max : m_size - start);
+
+            while (m_out.position() < end) {
+                if (!m_run) {
+                    const auto flag = *m_src++;
+                    m_repeat = flag & 0x80;
+                    m_run = m_repeat ? (flag & 0x7fu) + 3 : (flag & 0x7fu) + 1;
+                    if (m_repeat) {
+                        m_value = *m_src++;
+                    }
+                }
+
+                auto count = end - m_out.position();
+                count = count < m_run ? count : m_run;
+                m_run -= unsigned(count);
+                if (m_repeat) {
+                    while (count--) {
+                        m_out.put(m_value);
+                    }
+                } else {
+                    while (count--) {
+                        m_out.put(*m_src++);
+                    }
+                }
+            }
+
+            if (m_out.position() == m_size) {
+                m_out.finish();
+            }
+            return m_out.position() - start;
+        }
+
+        /**
+         * @brief Decompresses everything that remains.
+         */
+        void decode_all() noexcept {
+            decode(remaining());
+        }
+
+        /**
+         * @brief Total decompressed size from the header.
+         *
+         * @return Size in bytes.
+         */
+        [[nodiscard]]
+        std::size_t size() const noexcept {
+            return m_size;
+        }
+
+        [[nodiscard]]
+        std::size_t remaining() const noexcept {
+            return m_size - m_out.position();
+        }
+
+        [[nodiscard]]
+        bool done() const noexcept {
+            return m_out.position() == m_size;
+        }
+
+    private:
+        const u8* m_src;
+        detail::byte_output<Target> m_out;
+        std::size_t m_size{};
+        unsigned int m_run{};
+        bool m_repeat{};
+        u8 m_value{};
+    };
+
+} // namespace gba::compress
+
+#endif // define GBAXX_COMPRESS_RLE_HPP
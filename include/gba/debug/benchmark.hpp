@@ -0,0 +1,250 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_DEBUG_BENCHMARK_HPP
+#define GBAXX_DEBUG_BENCHMARK_HPP
+/** @file */
+
+#include <cstddef>
+
+#if defined(GBAXX_HOST)
+#include <chrono>
+#include <ratio>
+#endif
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+#include <gba/debug/profile.hpp>
+#include <gba/ext/mgba/log.hpp>
+
+namespace gba::benchmark {
+
+    /**
+     * @brief Prevents the compiler from optimizing away the computation of a value.
+     *
+     * @param value Result of the code being measured.
+     */
+    template <typename T>
+    [[gnu::always_inline]]
+    inline void do_not_optimize(const T& value) noexcept {
+        asm volatile ("" :: "m"(value) : "memory");
+    }
+
+    /**
+     * @brief Prevents the compiler from assuming memory is unchanged, or from removing stores.
+     */
+    [[gnu::always_inline]]
+    inline void clobber() noexcept {
+        asm volatile ("" ::: "memory");
+    }
+
+#if defined(GBAXX_HOST)
+    /**
+     * @brief Calls timed together for each sample of a host build.
+     *
+     * Host kernels often take less than a nanosecond, so each sample times a batch of calls and divides.
+     */
+    inline constexpr u32 host_batch = 256;
+#endif
+
+    /**
+     * @struct result
+     * @brief Cycle measurements of one benchmark.
+     *
+     * The cost of calling an empty kernel is subtracted from every measurement.
+     *
+     * @note In a host build there is no model of the ARM7TDMI, so the measurements are host time instead: picoseconds
+     *       per call, each sample averaged over host_batch calls.
+     */
+    struct result {
+        const char* name; /**< Name of the benchmark. */
+        u32 iterations; /**< Number of measured calls (samples of host_batch calls in a host build). */
+        u32 min; /**< Fewest cycles of a single call. */
+        u32 avg; /**< Average cycles of a call. */
+        u32 max; /**< Most cycles of a single call. */
+    };
+
+    namespace detail {
+
+        [[gnu::noinline]]
+        inline void empty_kernel() noexcept {
+            asm volatile ("");
+        }
+
+#if defined(GBAXX_HOST)
+        // Picoseconds per call, over a batch of calls timed at nanosecond resolution
+        [[gnu::noinline]]
+        inline u32 host_sample(void(*kernel)()) noexcept {
+            const auto begin = std::chrono::steady_clock::now();
+            for (u32 ii = 0; ii < host_batch; ++ii) {
+                kernel();
+            }
+            const auto time = std::chrono::steady_clock::now() - begin;
+            return u32(std::chrono::duration_cast<std::chrono::duration<unsigned long long, std::pico>>(time).count() / host_batch);
+        }
+#endif
+
+        [[gnu::noinline]]
+        inline result measure(const char* name, void(*kernel)(), u32 iterations, u32 overhead) noexcept {
+            auto r = result{name, iterations, ~u32{}, 0, 0};
+            unsigned long long total = 0;
+            for (u32 ii = 0; ii < iterations; ++ii) {
+#if defined(GBAXX_HOST)
+                const auto elapsed = host_sample(kernel);
+#else
+                const auto begin = profile::cycles();
+                kernel();
+                const auto end = profile::cycles();
+
+                const auto elapsed = end - begin;
+#endif
+                const auto c = elapsed > overhead ? elapsed - overhead : 0;
+                total += c;
+                r.min = c < r.min ? c : r.min;
+                r.max = c > r.max ? c : r.max;
+            }
+            r.avg = iterations ? u32(total / iterations) : 0;
+            return r;
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Measures a kernel with interrupts disabled.
+     *
+     * The kernel is called once to warm up, then `iterations` times with each call timed individually by the profile
+     * cycle counter. In a host build, each iteration instead times a batch of host_batch calls with the host clock.
+     *
+     * @param name Name of the benchmark.
+     * @param kernel Function to measure. Captureless lambdas convert implicitly.
+     * @param iterations Number of measured calls.
+     * @return Cycle measurements.
+     *
+     * @warning This takes ownership of TIMER2 and TIMER3, see profile::start().
+     */
+    inline result run(const char* name, void(*kernel)(), u32 iterations = 64) noexcept {
+        const auto ime = *mmio::IME;
+        mmio::IME = false;
+        profile::start();
+
+        const auto overhead = detail::measure(nullptr, detail::empty_kernel, 16, 0).min;
+        kernel();
+        const auto r = detail::measure(name, kernel, iterations, overhead);
+
+        profile::stop();
+        mmio::IME = ime;
+        return r;
+    }
+
+    /**
+     * @brief Prints a result to the mGBA logger.
+     *
+     * @param r Result to print.
+     * @param level Log level of the output.
+     * @param ops Number of operations one call performs, used to print cycles per operation.
+     *
+     * @note mGBA must be present, see mgba::open().
+     */
+    inline void report(const result& r, mgba::log level = mgba::log::info, u32 ops = 1) noexcept {
+#if defined(GBAXX_HOST)
+        const auto per_op = unsigned(r.avg / (ops ? ops : 1));
+        mgba::printf(level, "%s: min=%u.%03u avg=%u.%03u max=%u.%03u ns host time (%u.%03u ns/op over %u batches of %u)",
+                     r.name, unsigned(r.min / 1000), unsigned(r.min % 1000), unsigned(r.avg / 1000), unsigned(r.avg % 1000),
+                     unsigned(r.max / 1000), unsigned(r.max % 1000), per_op / 1000, per_op % 1000, unsigned(r.iterations),
+                     unsigned(host_batch));
+#else
+        const auto per_op_hundredths = unsigned((unsigned long long) r.avg * 100 / (ops ? ops : 1));
+        mgba::printf(level, "%s: min=%u avg=%u max=%u cycles (%u.%02u cycles/op over %u runs)", r.name, unsigned(r.min),
+                     unsigned(r.avg), unsigned(r.max), per_op_hundredths / 100, per_op_hundredths % 100, unsigned(r.iterations));
+#endif
+    }
+
+    /**
+     * @class suite
+     * @brief Fixed capacity list of registered benchmarks.
+     *
+     * @code{cpp}
+     * // Comparing two division paths
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static volatile int numerator = 1000000, denominator = 7;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mgba::open();
+     *
+     *     benchmark::suite<8> benches;
+     *     benches.add("bios::Div", [] {
+     *         benchmark::do_not_optimize(bios::Div(numerator, denominator));
+     *     });
+     *     benches.add("operator/", [] {
+     *         benchmark::do_not_optimize(numerator / denominator);
+     *     });
+     *     benches.run(256);
+     * }
+     * @endcode
+     *
+     * @tparam N Maximum number of benchmarks.
+     */
+    template <std::size_t N>
+    class suite {
+    public:
+        static constexpr auto capacity = N;
+
+        /**
+         * @brief Registers a benchmark.
+         *
+         * @param name Name of the benchmark.
+         * @param kernel Function to measure.
+         * @param ops Number of operations one call performs.
+         * @return `false` if the suite is full.
+         */
+        bool add(const char* name, void(*kernel)(), u32 ops = 1) noexcept {
+            if (m_size == N) {
+                return false;
+            }
+            m_entries[m_size++] = {name, kernel, ops};
+            return true;
+        }
+
+        /**
+         * @brief Runs and reports every registered benchmark in order.
+         *
+         * @param iterations Number of measured calls per benchmark.
+         * @param level Log level of the output.
+         */
+        void run(u32 iterations = 64, mgba::log level = mgba::log::info) const noexcept {
+            for (std::size_t ii = 0; ii < m_size; ++ii) {
+                const auto& e = m_entries[ii];
+                report(benchmark::run(e.name, e.kernel, iterations), level, e.ops);
+            }
+        }
+
+        [[nodiscard]]
+        std::size_t size() const noexcept {
+            return m_size;
+        }
+
+    private:
+        struct entry {
+            const char* name;
+            void(*kernel)();
+            u32 ops;
+        };
+
+        entry m_entries[N]{};
+        std::size_t m_size{};
+    };
+
+} // namespace gba::benchmark
+
+#endif // define GBAXX_DEBUG_BENCHMARK_HPP
@@ -0,0 +1,298 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_DEBUG_PROFILE_HPP
+#define GBAXX_DEBUG_PROFILE_HPP
+/** @file */
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(GBAXX_HOST)
+#include <chrono>
+#endif
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+#include <gba/ext/mgba/log.hpp>
+
+namespace gba::profile {
+
+    /**
+     * @brief Number of CPU cycles in one frame (228 lines of 1232 cycles).
+     */
+    inline constexpr u32 frame_cycles = 280896;
+
+#if defined(GBAXX_HOST)
+    namespace detail {
+
+        // Host builds count host time in units of GBA cycles (2^24 per second), there are no timers to count with
+        struct host_counter {
+            std::chrono::steady_clock::time_point started;
+            u32 stopped;
+            bool running;
+
+            [[nodiscard]]
+            u32 elapsed() const noexcept {
+                const auto time = std::chrono::steady_clock::now() - started;
+                return u32(std::chrono::duration_cast<std::chrono::duration<std::uint64_t, std::ratio<1, 1 << 24>>>(time).count());
+            }
+        };
+
+        inline constinit host_counter counter{};
+
+    } // namespace detail
+#endif
+
+    /**
+     * @brief Starts the 32-bit cycle counter from zero.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#gba-timers">GBA Timers</a>
+     *
+     * TIMER2 counts every CPU cycle and cascades into TIMER3, which counts the overflows.
+     *
+     * @warning The profiler takes ownership of TIMER2 and TIMER3.
+     *
+     * @sa cycles()
+     * @sa stop()
+     */
+    inline void start() noexcept {
+#if defined(GBAXX_HOST)
+        detail::counter = {std::chrono::steady_clock::now(), 0, true};
+#else
+        mmio::TIMER2_CONTROL.reset();
+        mmio::TIMER3_CONTROL.reset();
+        mmio::TIMER2_RELOAD = 0;
+        mmio::TIMER3_RELOAD = 0;
+        mmio::TIMER3_CONTROL = tmcnt_h{.cascade = true, .enabled = true};
+        mmio::TIMER2_CONTROL = tmcnt_h{.enabled = true};
+#endif
+    }
+
+    /**
+     * @brief Stops the cycle counter.
+     *
+     * @sa start()
+     */
+    inline void stop() noexcept {
+#if defined(GBAXX_HOST)
+        if (detail::counter.running) {
+            detail::counter = {{}, detail::counter.elapsed(), false};
+        }
+#else
+        mmio::TIMER2_CONTROL.reset();
+        mmio::TIMER3_CONTROL.reset();
+#endif
+    }
+
+    /**
+     * @brief Reads the cycle counter.
+     *
+     * The high half is read on both sides of the low half, so a carry between the two timers never produces a value
+     * that is off by 65536.
+     *
+     * @return Cycles since start(), wrapping after about 256 seconds.
+     */
+    [[gnu::always_inline]]
+    inline u32 cycles() noexcept {
+#if defined(GBAXX_HOST)
+        return detail::counter.running ? detail::counter.elapsed() : detail::counter.stopped;
+#else
+        auto high = *mmio::TIMER3_COUNT;
+        auto low = *mmio::TIMER2_COUNT;
+        if (const auto again = *mmio::TIMER3_COUNT; again != high) {
+            high = again;
+            low = *mmio::TIMER2_COUNT;
+        }
+        return (u32(high) << 16) | low;
+#endif
+    }
+
+    /**
+     * @struct record
+     * @brief One timed execution of a named scope.
+     */
+    struct record {
+        const char* name; /**< Name of the scope. */
+        u32 cycles; /**< Cycles spent within the scope. */
+    };
+
+    /**
+     * @class history
+     * @brief Ring of the most recent scope records.
+     *
+     * Once full, each new record replaces the oldest.
+     *
+     * @tparam N Number of records kept.
+     *
+     * @sa scope
+     * @sa report()
+     */
+    template <std::size_t N>
+    class history {
+    public:
+        static constexpr auto capacity = N;
+
+        constexpr history() noexcept = default;
+
+        void push(const char* name, u32 cycles) noexcept {
+            m_records[m_next] = {name, cycles};
+            m_next = m_next + 1 < N ? m_next + 1 : 0;
+            if (m_size < N) {
+                ++m_size;
+            }
+        }
+
+        void clear() noexcept {
+            m_next = 0;
+            m_size = 0;
+        }
+
+        [[nodiscard]]
+        std::size_t size() const noexcept {
+            return m_size;
+        }
+
+        [[nodiscard]]
+        const record& operator[](std::size_t i) const noexcept {
+            return m_records[i];
+        }
+
+        /**
+         * @brief Prints the count, minimum, average and maximum cycles of each scope to the mGBA logger.
+         *
+         * Records are grouped by name. The average is also shown as a percentage of a frame.
+         *
+         * @param level Log level of the output.
+         *
+         * @note mGBA must be present, see mgba::open().
+         */
+        void report(mgba::log level = mgba::log::info) const noexcept {
+            for (std::size_t ii = 0; ii < m_size; ++ii) {
+                const auto* name = m_records[ii].name;
+                if (seen_before(ii)) {
+                    continue;
+                }
+
+                unsigned int count = 0;
+                u32 least = ~u32{};
+                u32 most = 0;
+                unsigned long long total = 0;
+                for (std::size_t jj = ii; jj < m_size; ++jj) {
+                    if (!same_name(m_records[jj].name, name)) {
+                        continue;
+                    }
+                    const auto c = m_records[jj].cycles;
+                    ++count;
+                    total += c;
+                    least = c < least ? c : least;
+                    most = c > most ? c : most;
+                }
+
+                const auto average = unsigned(total / count);
+                const auto hundredths = unsigned((total * 10000) / (count * (unsigned long long) frame_cycles));
+                mgba::printf(level, "%s: n=%u min=%u avg=%u max=%u (%u.%02u%% frame)", name, count, unsigned(least),
+                             average, unsigned(most), hundredths / 100, hundredths % 100);
+            }
+        }
+
+    private:
+        static bool same_name(const char* a, const char* b) noexcept {
+            return a == b || std::strcmp(a, b) == 0;
+        }
+
+        bool seen_before(std::size_t index) const noexcept {
+            for (std::size_t ii = 0; ii < index; ++ii) {
+                if (same_name(m_records[ii].name, m_records[index].name)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        record m_records[N]{};
+        std::size_t m_next{};
+        std::size_t m_size{};
+    };
+
+    /**
+     * @brief Default history of 256 records, placed in EWRAM.
+     */
+    [[gnu::section(".ewram._gba_profile")]]
+    inline constinit history<256> samples{};
+
+    /**
+     * @class scope
+     * @brief Records the cycles spent between its construction and destruction.
+     *
+     * @code{cpp}
+     * // Attributing the frame budget
+     *
+     * #include <gba/gba.hpp>
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mgba::open();
+     *     profile::start();
+     *
+     *     for (int frame = 0; ; ++frame) {
+     *         {
+     *             profile::scope s{"physics"};
+     *             // ...
+     *         }
+     *         {
+     *             profile::scope s{"render"};
+     *             // ...
+     *         }
+     *
+     *         if (frame % 60 == 59) {
+     *             profile::samples.report();
+     *             profile::samples.clear();
+     *         }
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note Reading the counter costs a few cycles, which is included in each record.
+     *
+     * @sa start()
+     * @sa history::report()
+     */
+    template <std::size_t N = 256>
+    class scope {
+    public:
+        /**
+         * @param name Name of the scope. The string must outlive the history, a string literal is ideal.
+         * @param h History receiving the record.
+         */
+        [[gnu::always_inline]]
+        explicit scope(const char* name, history<N>& h = samples) noexcept : m_history{h}, m_name{name}, m_start{cycles()} {}
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+        [[gnu::always_inline]]
+        ~scope() noexcept {
+            const auto end = cycles();
+            m_history.push(m_name, end - m_start);
+        }
+
+    private:
+        history<N>& m_history;
+        const char* m_name;
+        u32 m_start;
+    };
+
+    scope(const char*) -> scope<256>;
+
+} // namespace gba::profile
+
+#endif // define GBAXX_DEBUG_PROFILE_HPP
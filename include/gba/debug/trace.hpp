@@ -0,0 +1,218 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_DEBUG_TRACE_HPP
+#define GBAXX_DEBUG_TRACE_HPP
+/** @file */
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include <gba/type.hpp>
+
+#include <gba/debug/profile.hpp>
+#include <gba/ext/mgba/log.hpp>
+#include <gba/interrupt/guard.hpp>
+
+namespace gba::trace {
+
+    /**
+     * @struct entry
+     * @brief One recorded event.
+     */
+    struct entry {
+        u32 time; /**< profile::cycles() when the event was recorded. */
+        u16 id; /**< Event identifier, chosen by the game. */
+        u16 payload; /**< Event value, such as mmio::VCOUNT or an object index. */
+    };
+
+    namespace detail {
+
+        // Each line is a marker followed by 11 characters per entry, with 6 bits per character from '0' to 'o'
+        inline constexpr std::size_t chars_per_entry = 11;
+        inline constexpr std::size_t entries_per_line = 22;
+
+        inline volatile char* encode(volatile char* out, std::uint64_t value, std::size_t chars) noexcept {
+            for (std::size_t ii = 0; ii < chars; ++ii) {
+                *out++ = char('0' + (value & 0x3f));
+                value >>= 6;
+            }
+            return out;
+        }
+
+        inline void send_line(volatile char* end, mgba::log level) noexcept {
+            *end = '\0';
+            mgba::detail::send(level);
+        }
+
+    } // namespace detail
+
+    /**
+     * @class ring
+     * @brief Ring of recorded events, cheap enough to fill from interrupt handlers and streamed out at idle time.
+     *
+     * record() reads the profile cycle counter and stores an 8 byte entry with interrupts masked for a few
+     * instructions. flush() later sends the entries to the mGBA logger in bulk, 22 entries per log message, in an
+     * encoding that tools/trace_decode.py turns back into a timeline of frames and scanlines.
+     *
+     * Once full, each new entry replaces the oldest one that has not been flushed, and the next flush() reports how
+     * many were lost.
+     *
+     * @tparam N Number of entries kept, a power of two.
+     *
+     * @code{cpp}
+     * // Catching HBlank handlers that run late
+     *
+     * #include <gba/gba.hpp>
+     *
+     * enum event : gba::u16 { hblank_enter, vblank_enter };
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mgba::open();
+     *     profile::start();
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.hblank) {
+     *             trace::record(hblank_enter, *mmio::VCOUNT);
+     *         }
+     *         if (flags.vblank) {
+     *             trace::record(vblank_enter);
+     *         }
+     *     });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true, .irq_hblank = true};
+     *     mmio::IE = {.vblank = true, .hblank = true};
+     *     mmio::IME = true;
+     *
+     *     while (true) {
+     *         bios::VBlankIntrWait();
+     *         trace::flush(); // Time left at the end of the frame
+     *     }
+     * }
+     * @endcode
+     *
+     * @note mGBA must be present, see mgba::open().
+     * @warning The timestamps take ownership of TIMER2 and TIMER3, see profile::start().
+     *
+     * @sa events
+     * @sa profile::cycles()
+     */
+    template <std::size_t N> requires (std::has_single_bit(N))
+    class ring {
+    public:
+        static constexpr auto capacity = N;
+
+        constexpr ring() noexcept = default;
+
+        ring(const ring&) = delete;
+        ring& operator=(const ring&) = delete;
+
+        /**
+         * @brief Records an event. Safe to call from interrupt handlers.
+         *
+         * @param id Event identifier.
+         * @param payload Event value.
+         */
+        [[gnu::always_inline]]
+        void record(u16 id, u16 payload = 0) noexcept {
+            irq_guard guard;
+            m_entries[m_head % N] = {profile::cycles(), id, payload};
+            m_head = m_head + 1;
+        }
+
+        /**
+         * @brief Number of entries recorded but not yet flushed, including any that were lost.
+         */
+        [[nodiscard]]
+        u32 pending() const noexcept {
+            return m_head - m_tail;
+        }
+
+        /**
+         * @brief Discards every recorded entry.
+         */
+        void clear() noexcept {
+            m_tail = m_head;
+        }
+
+        /**
+         * @brief Sends recorded entries to the mGBA logger.
+         *
+         * Lines start with `~T` followed by the encoded entries, or with `~L` followed by the number of entries lost
+         * since the previous flush.
+         *
+         * @param max_entries Maximum number of entries to send, to bound the time spent.
+         * @param level Log level of the output.
+         * @return Number of entries sent.
+         */
+        std::size_t flush(std::size_t max_entries = N, mgba::log level = mgba::log::debug) noexcept {
+            const u32 head = m_head;
+            if (const auto pending = head - m_tail; pending > N) {
+                volatile char* out = &mgba::mmio::DEBUG_STRING;
+                *out++ = '~';
+                *out++ = 'L';
+                detail::send_line(detail::encode(out, pending - N, 6), level);
+                m_tail = head - N;
+            }
+
+            std::size_t sent = 0;
+            while (m_tail != head && sent < max_entries) {
+                volatile char* out = &mgba::mmio::DEBUG_STRING;
+                *out++ = '~';
+                *out++ = 'T';
+                for (std::size_t ii = 0; ii < detail::entries_per_line && m_tail != head && sent < max_entries; ++ii, ++sent) {
+                    const auto& e = m_entries[m_tail % N];
+                    out = detail::encode(out, e.time | (std::uint64_t(e.id) << 32) | (std::uint64_t(e.payload) << 48), detail::chars_per_entry);
+                    m_tail = m_tail + 1;
+                }
+                detail::send_line(out, level);
+            }
+            return sent;
+        }
+
+    private:
+        entry m_entries[N]{};
+        volatile u32 m_head{};
+        u32 m_tail{};
+    };
+
+    /**
+     * @brief Default ring of 1024 events (8 KiB), placed in EWRAM.
+     */
+    [[gnu::section(".ewram._gba_trace")]]
+    inline constinit ring<1024> events{};
+
+    /**
+     * @brief Records an event into the default ring. Safe to call from interrupt handlers.
+     *
+     * @param id Event identifier.
+     * @param payload Event value.
+     *
+     * @sa ring::record()
+     */
+    [[gnu::always_inline]]
+    inline void record(u16 id, u16 payload = 0) noexcept {
+        events.record(id, payload);
+    }
+
+    /**
+     * @brief Sends the entries of the default ring to the mGBA logger.
+     *
+     * @sa ring::flush()
+     */
+    inline std::size_t flush(std::size_t max_entries = decltype(events)::capacity, mgba::log level = mgba::log::debug) noexcept {
+        return events.flush(max_entries, level);
+    }
+
+} // namespace gba::trace
+
+#endif // define GBAXX_DEBUG_TRACE_HPP
@@ -22,8 +22,10 @@
 #include <gba/ext/agbabi/irq.hpp>
 #include <gba/ext/agbabi/math.hpp>
 #include <gba/ext/agbabi/overclock.hpp>
+#include <gba/ext/agbabi/pipeline.hpp>
 #include <gba/ext/agbabi/pull_coroutine.hpp>
 #include <gba/ext/agbabi/push_coroutine.hpp>
+#include <gba/ext/agbabi/scheduler.hpp>
 #include <gba/ext/agbabi/string.hpp>
 
 #endif
@@ -0,0 +1,520 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_EXT_AGBABI_PIPELINE_HPP
+#define GBAXX_EXT_AGBABI_PIPELINE_HPP
+/** @file */
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include <gba/type.hpp>
+
+#include <gba/compress/bitunpack.hpp>
+#include <gba/ext/agbabi/pull_coroutine.hpp>
+#include <gba/hardware/dmahelper.hpp>
+
+/**
+ * @namespace gba::agbabi::pipeline
+ * @brief Stages that stream data through small buffers, pulling one value at a time from the stage before.
+ *
+ * A source is anything called to produce its next value and tested with `operator bool` afterwards, which is false
+ * once the call found nothing more to produce. agbabi::pull_coroutine is a source, so any generator written as a
+ * coroutine can start or join a pipeline. The stages here follow the same protocol, without needing a stack of their
+ * own, and hold a reference to the stage before them.
+ *
+ * Data flows as pipeline::bytes chunks. Each chunk stays valid until the next value is pulled from the same stage, so
+ * only one chunk per stage is ever held in memory.
+ *
+ * @code{cpp}
+ * // ROM -> LZ77 decode -> 1bpp to 4bpp -> VRAM, 4 chunks per frame
+ *
+ * #include <gba/gba.hpp>
+ *
+ * extern const gba::u8 font_1bpp_lz[];
+ *
+ * static constexpr auto expand = gba::compress::bit_unpacker<1, 4>(14);
+ *
+ * int main() {
+ *     using namespace gba;
+ *     using namespace gba::agbabi;
+ *
+ *     static pipeline::lz77_stage<256> decoded{font_1bpp_lz}; // 4KB window, in IWRAM
+ *     auto tiles = pipeline::unpack(decoded, expand);
+ *     auto sink = pipeline::dma_sink{tiles, &mmio::CHARBLOCK0_4BPP};
+ *
+ *     while (!sink.done()) {
+ *         sink.run(4);
+ *         bios::VBlankIntrWait();
+ *     }
+ * }
+ * @endcode
+ *
+ * @code{cpp}
+ * // A coroutine stage, and the stackless adaptors
+ *
+ * #include <gba/gba.hpp>
+ *
+ * extern const gba::u8 level_data[];
+ *
+ * int main() {
+ *     using namespace gba;
+ *     using namespace gba::agbabi;
+ *
+ *     static std::array<gba::u32, 256> stack;
+ *     pull_coroutine<int> rows{stack, [](auto& yield) {
+ *         for (int row = 0; row < 32; ++row) {
+ *             yield(row);
+ *         }
+ *     }};
+ *
+ *     auto odd = pipeline::filter(rows, [](int row) { return row % 2; });
+ *     auto offsets = pipeline::map(odd, [](int row) { return row * 64; });
+ *     auto first = pipeline::take(offsets, 4);
+ *     while (true) {
+ *         const auto offset = first();
+ *         if (!first) {
+ *             break;
+ *         }
+ *         // 64, 192, 320, 448...
+ *     }
+ * }
+ * @endcode
+ */
+namespace gba::agbabi::pipeline {
+
+    /**
+     * @brief Chunk of bytes passed between stages.
+     */
+    using bytes = std::span<const u8>;
+
+    /**
+     * @brief Concept of a pipeline source.
+     */
+    template <typename Src>
+    concept Source = requires(Src& src) {
+        src();
+        static_cast<bool>(src);
+    };
+
+    template <Source Src>
+    using value_t = std::remove_cvref_t<decltype(std::declval<Src&>()())>;
+
+    /**
+     * @brief Pulls the next value from a source.
+     *
+     * @param src Source.
+     * @param value Receives the value.
+     * @return False once the source is exhausted, in which case value is not meaningful.
+     */
+    template <Source Src>
+    bool next(Src& src, value_t<Src>& value) noexcept {
+        value = src();
+        return static_cast<bool>(src);
+    }
+
+    namespace detail {
+
+        class stage_base {
+        public:
+            [[nodiscard]]
+            explicit operator bool() const noexcept {
+                return !m_done;
+            }
+
+        protected:
+            template <typename T>
+            T finish() noexcept {
+                m_done = true;
+                return T{};
+            }
+
+            bool m_done{};
+        };
+
+    } // namespace detail
+
+    /**
+     * @class map_stage
+     * @brief Applies a function to every value.
+     *
+     * @sa map()
+     */
+    template <Source Src, typename Fn>
+    class map_stage : public detail::stage_base {
+    public:
+        using value_type = std::remove_cvref_t<std::invoke_result_t<Fn&, value_t<Src>&>>;
+
+        map_stage(Src& src, Fn fn) noexcept : m_src{src}, m_fn{std::move(fn)} {}
+
+        value_type operator()() noexcept {
+            value_t<Src> value;
+            if (!next(m_src, value)) {
+                return finish<value_type>();
+            }
+            return m_fn(value);
+        }
+
+    private:
+        Src& m_src;
+        Fn m_fn;
+    };
+
+    /**
+     * @class filter_stage
+     * @brief Passes on only the values matching a predicate.
+     *
+     * @sa filter()
+     */
+    template <Source Src, typename Pred>
+    class filter_stage : public detail::stage_base {
+    public:
+        using value_type = value_t<Src>;
+
+        filter_stage(Src& src, Pred pred) noexcept : m_src{src}, m_pred{std::move(pred)} {}
+
+        value_type operator()() noexcept {
+            value_type value;
+            while (next(m_src, value)) {
+                if (m_pred(value)) {
+                    return value;
+                }
+            }
+            return finish<value_type>();
+        }
+
+    private:
+        Src& m_src;
+        Pred m_pred;
+    };
+
+    /**
+     * @class take_stage
+     * @brief Passes on a limited number of values, without pulling any more from the source.
+     *
+     * @sa take()
+     */
+    template <Source Src>
+    class take_stage : public detail::stage_base {
+    public:
+        using value_type = value_t<Src>;
+
+        take_stage(Src& src, std::size_t count) noexcept : m_src{src}, m_remaining{count} {}
+
+        value_type operator()() noexcept {
+            value_type value;
+            if (!m_remaining || !next(m_src, value)) {
+                return finish<value_type>();
+            }
+            --m_remaining;
+            return value;
+        }
+
+    private:
+        Src& m_src;
+        std::size_t m_remaining;
+    };
+
+    /**
+     * @class chunk_stage
+     * @brief Regroups byte chunks of any size into chunks of Size bytes (the last may be shorter), in an aligned buffer.
+     *
+     * @sa chunk()
+     */
+    template <Source Src, std::size_t Size> requires (Size > 0)
+    class chunk_stage : public detail::stage_base {
+    public:
+        using value_type = bytes;
+
+        explicit chunk_stage(Src& src) noexcept : m_src{src} {}
+
+        bytes operator()() noexcept {
+            std::size_t filled = 0;
+            while (filled < Size) {
+                if (m_rest.empty()) {
+                    value_t<Src> value;
+                    if (!next(m_src, value)) {
+                        break;
+                    }
+                    m_rest = bytes{value};
+                    continue;
+                }
+                const auto count = std::min(Size - filled, m_rest.size());
+                std::copy_n(m_rest.data(), count, m_buffer + filled);
+                m_rest = m_rest.subspan(count);
+                filled += count;
+            }
+            if (!filled) {
+                return finish<bytes>();
+            }
+            return {m_buffer, filled};
+        }
+
+    private:
+        Src& m_src;
+        bytes m_rest{};
+        alignas(4) u8 m_buffer[Size]{};
+    };
+
+    /**
+     * @class lz77_stage
+     * @brief Source of the data decompressed from BIOS LZ77 data, in chunks of Size bytes.
+     *
+     * The decoder keeps a 4KB sliding window (the furthest a back-reference reaches) instead of the whole output, and
+     * yields each chunk of it when complete.
+     *
+     * @tparam Size Bytes per chunk, a multiple of 4 that divides 4096.
+     *
+     * @note The chunk points into the window, and is valid until the next chunk is pulled.
+     *
+     * @sa compress::lz77_decoder
+     */
+    template <std::size_t Size> requires (Size % 4 == 0 && 4096 % Size == 0)
+    class lz77_stage : public detail::stage_base {
+    public:
+        using value_type = bytes;
+
+        /**
+         * @param src Compressed data, starting with the BIOS header.
+         */
+        explicit lz77_stage(const void* src) noexcept : m_src{static_cast<const u8*>(src) + 4} {
+            const auto* header = static_cast<const u8*>(src);
+            m_size = (header[0] & 0xf0) == 0x10 ? u32(header[1] | (header[2] << 8) | (header[3] << 16)) : 0;
+        }
+
+        bytes operator()() noexcept {
+            if (m_position == m_size) {
+                return finish<bytes>();
+            }
+
+            const auto start = m_position;
+            const auto end = std::min<u32>(start + Size, m_size);
+            while (m_position < end) {
+                if (m_copy) {
+                    put(m_window[(m_position - m_displacement) & mask]);
+                    --m_copy;
+                    continue;
+                }
+
+                if (!m_flag_bits) {
+                    m_flags = *m_src++;
+                    m_flag_bits = 8;
+                }
+                --m_flag_bits;
+                const auto reference = m_flags & 0x80;
+                m_flags = u8(m_flags << 1);
+
+                if (!reference) {
+                    put(*m_src++);
+                } else {
+                    const u32 hi = m_src[0];
+                    const u32 lo = m_src[1];
+                    m_src += 2;
+                    m_displacement = (((hi & 0xfu) << 8) | lo) + 1;
+                    m_copy = (hi >> 4) + 3;
+                }
+            }
+            return {m_window + (start & mask), end - start};
+        }
+
+        /**
+         * @brief Total size of the decompressed data.
+         */
+        [[nodiscard]]
+        u32 size() const noexcept {
+            return m_size;
+        }
+
+    private:
+        static constexpr u32 mask = 4096 - 1;
+
+        [[gnu::always_inline]]
+        void put(u8 value) noexcept {
+            m_window[m_position++ & mask] = value;
+        }
+
+        const u8* m_src;
+        u32 m_size{};
+        u32 m_position{};
+        u32 m_displacement{};
+        u32 m_copy{};
+        u8 m_flags{};
+        u8 m_flag_bits{};
+        alignas(4) u8 m_window[4096]{};
+    };
+
+    /**
+     * @class unpack_stage
+     * @brief Expands each chunk with a bit_unpacker, such as 1bpp to 4bpp.
+     *
+     * Chunks larger than Size are expanded Size bytes at a time.
+     *
+     * @tparam Size Largest source chunk expanded at once.
+     *
+     * @note Every expanded chunk must be a multiple of 4 bytes.
+     *
+     * @sa unpack()
+     * @sa compress::bit_unpacker
+     */
+    template <Source Src, u32 SrcBpp, u32 DstBpp, std::size_t Size>
+    class unpack_stage : public detail::stage_base {
+    public:
+        using value_type = bytes;
+        using unpacker_type = compress::bit_unpacker<SrcBpp, DstBpp>;
+
+        unpack_stage(Src& src, const unpacker_type& unpacker) noexcept : m_src{src}, m_unpacker{unpacker} {}
+
+        bytes operator()() noexcept {
+            if (m_rest.empty()) {
+                value_t<Src> value;
+                if (!next(m_src, value)) {
+                    return finish<bytes>();
+                }
+                m_rest = bytes{value};
+            }
+            const auto count = std::min(Size, m_rest.size());
+            m_unpacker.unpack(m_rest.data(), m_buffer, count);
+            m_rest = m_rest.subspan(count);
+            return {m_buffer, count * DstBpp / SrcBpp};
+        }
+
+    private:
+        Src& m_src;
+        const unpacker_type& m_unpacker;
+        bytes m_rest{};
+        alignas(4) u8 m_buffer[Size * DstBpp / SrcBpp]{};
+    };
+
+    /**
+     * @class dma_sink
+     * @brief Copies every chunk of a source to consecutive memory with DMA 3, a limited number of chunks at a time.
+     *
+     * @note Chunks must be word aligned, and a multiple of 2 bytes (4 for full speed).
+     */
+    template <Source Src>
+    class dma_sink {
+    public:
+        /**
+         * @param src Source of byte chunks.
+         * @param dest Destination, such as VRAM.
+         */
+        dma_sink(Src& src, volatile void* dest) noexcept : m_src{src}, m_dest{static_cast<volatile u8*>(dest)} {}
+
+        /**
+         * @brief Pulls and copies chunks.
+         *
+         * @param chunks Maximum number of chunks to copy.
+         * @return Bytes copied.
+         */
+        std::size_t run(std::size_t chunks = ~std::size_t{}) noexcept {
+            std::size_t copied = 0;
+            for (; chunks && !m_done; --chunks) {
+                value_t<Src> value;
+                if (!next(m_src, value)) {
+                    m_done = true;
+                    break;
+                }
+                const auto chunk = bytes{value};
+                auto* dest = m_dest + m_written;
+                if (chunk.size() % 4 == 0) {
+                    dma<3>::copy(reinterpret_cast<const u32*>(chunk.data()), reinterpret_cast<volatile u32*>(dest), chunk.size() / 4);
+                } else {
+                    dma<3>::copy(reinterpret_cast<const u16*>(chunk.data()), reinterpret_cast<volatile u16*>(dest), chunk.size() / 2);
+                }
+                m_written += chunk.size();
+                copied += chunk.size();
+            }
+            return copied;
+        }
+
+        [[nodiscard]]
+        bool done() const noexcept {
+            return m_done;
+        }
+
+        /**
+         * @brief Total bytes copied.
+         */
+        [[nodiscard]]
+        std::size_t written() const noexcept {
+            return m_written;
+        }
+
+    private:
+        Src& m_src;
+        volatile u8* m_dest;
+        std::size_t m_written{};
+        bool m_done{};
+    };
+
+    template <Source Src>
+    dma_sink(Src&, volatile void*) -> dma_sink<Src>;
+
+    /**
+     * @brief Stage applying a function to every value.
+     *
+     * @param src Source.
+     * @param fn Function of one value.
+     */
+    template <Source Src, typename Fn>
+    auto map(Src& src, Fn fn) noexcept {
+        return map_stage<Src, Fn>{src, std::move(fn)};
+    }
+
+    /**
+     * @brief Stage passing on only the values matching a predicate.
+     *
+     * @param src Source.
+     * @param pred Predicate of one value.
+     */
+    template <Source Src, typename Pred>
+    auto filter(Src& src, Pred pred) noexcept {
+        return filter_stage<Src, Pred>{src, std::move(pred)};
+    }
+
+    /**
+     * @brief Stage passing on the first values of a source.
+     *
+     * @param src Source.
+     * @param count Number of values.
+     */
+    template <Source Src>
+    auto take(Src& src, std::size_t count) noexcept {
+        return take_stage<Src>{src, count};
+    }
+
+    /**
+     * @brief Stage regrouping byte chunks into Size byte chunks.
+     *
+     * @tparam Size Bytes per chunk.
+     * @param src Source of byte chunks.
+     */
+    template <std::size_t Size, Source Src>
+    auto chunk(Src& src) noexcept {
+        return chunk_stage<Src, Size>{src};
+    }
+
+    /**
+     * @brief Stage expanding each chunk with a bit_unpacker.
+     *
+     * @tparam Size Largest source chunk expanded at once.
+     * @param src Source of byte chunks.
+     * @param unpacker Unpacker, which must outlive the stage.
+     */
+    template <std::size_t Size = 256, Source Src, u32 SrcBpp, u32 DstBpp>
+    auto unpack(Src& src, const compress::bit_unpacker<SrcBpp, DstBpp>& unpacker) noexcept {
+        return unpack_stage<Src, SrcBpp, DstBpp, Size>{src, unpacker};
+    }
+
+} // namespace gba::agbabi::pipeline
+
+#endif // define GBAXX_EXT_AGBABI_PIPELINE_HPP
@@ -0,0 +1,317 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_EXT_AGBABI_SCHEDULER_HPP
+#define GBAXX_EXT_AGBABI_SCHEDULER_HPP
+/** @file */
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+#include <agbabi.h>
+
+#include <gba/bios/halt.hpp>
+#include <gba/interrupt/irq.hpp>
+#include <gba/mmio.hpp>
+
+#include <gba/ext/agbabi/fiber.hpp>
+
+namespace gba::agbabi {
+
+    /**
+     * @class scheduler
+     * @brief Cooperative scheduler of fibers that wake on VBlank and IRQs.
+     *
+     * Each task is a fiber with a fixed stack owned by the scheduler. Tasks give up the CPU with yield(),
+     * sleep_frames(), or wait_irq(). The ready task with the highest priority runs next, and tasks of equal priority
+     * take turns.
+     *
+     * When every task is blocked, run() halts the CPU with bios::IntrWait() until an IRQ that a task waits for is
+     * raised.
+     *
+     * on_irq() must be called from the IRQ handler with the raised flags. Sleeping uses the VBlank IRQ, so it must be
+     * enabled.
+     *
+     * @code{cpp}
+     * // Streaming assets while animating
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static gba::agbabi::scheduler<4> tasks;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         tasks.on_irq(flags);
+     *     });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true};
+     *     mmio::IME = true;
+     *
+     *     tasks.spawn([](auto& sched) {
+     *         while (true) {
+     *             // Animate once per frame
+     *             sched.sleep_frames(1);
+     *         }
+     *     }, 1);
+     *
+     *     tasks.spawn([](auto& sched) {
+     *         for (int chunk = 0; chunk < 64; ++chunk) {
+     *             // Decompress one chunk of a level
+     *             sched.yield();
+     *         }
+     *     });
+     *
+     *     tasks.run();
+     * }
+     * @endcode
+     *
+     * @tparam MaxTasks Maximum number of tasks alive at once.
+     * @tparam StackSize Size in bytes of each task's stack.
+     *
+     * @note The scheduler's own bookkeeping (including the wrapped task function) is placed at the top of each stack.
+     * @warning yield(), sleep_frames() and wait_irq() must only be called from within a task.
+     *
+     * @sa fiber
+     */
+    template <std::size_t MaxTasks, std::size_t StackSize = 0x400> requires (MaxTasks > 0 && StackSize % 8 == 0)
+    class scheduler {
+    public:
+        static constexpr auto max_tasks = MaxTasks;
+        static constexpr auto stack_size = StackSize;
+
+        scheduler() noexcept = default;
+
+        scheduler(const scheduler&) = delete;
+        scheduler& operator=(const scheduler&) = delete;
+
+        /**
+         * @brief Adds a task.
+         *
+         * @param fn Function called with a reference to this scheduler.
+         * @param priority Tasks with higher priority run first.
+         * @return Index of the new task, or -1 if all task slots are in use.
+         */
+        template <typename Fn>
+        int spawn(Fn&& fn, int priority = 0) noexcept {
+            for (std::size_t ii = 0; ii < MaxTasks; ++ii) {
+                auto& t = m_tasks[ii];
+                if (t.status != state::free) {
+                    continue;
+                }
+
+                t.priority = priority;
+                t.status = state::ready;
+                t.context.emplace(t.stack, [this, &t, fn = std::forward<Fn>(fn)](fiber& self) mutable {
+                    t.self = &self;
+                    fn(*this);
+                });
+                ++m_count;
+                return int(ii);
+            }
+            return -1;
+        }
+
+        /**
+         * @brief Lets other ready tasks run.
+         */
+        void yield() noexcept {
+            suspend();
+        }
+
+        /**
+         * @brief Blocks the current task for a number of VBlanks.
+         *
+         * @param frames Number of VBlank IRQs to wait for. 0 is the same as yield().
+         */
+        void sleep_frames(unsigned int frames) noexcept {
+            if (frames) {
+                m_current->wake_frame = m_frame + frames;
+                m_current->status = state::sleeping;
+            }
+            suspend();
+        }
+
+        /**
+         * @brief Blocks the current task until one of the IRQs is raised.
+         *
+         * Only IRQs raised after this call wake the task.
+         *
+         * @param mask IRQs to wait for.
+         * @return The IRQs in `mask` that woke the task.
+         */
+        irq wait_irq(irq mask) noexcept {
+            wake(); // Consume IRQs that were raised before the wait
+            m_current->wait_mask = bits(mask);
+            m_current->status = state::waiting;
+            suspend();
+            return std::bit_cast<irq>(m_current->woken_by);
+        }
+
+        /**
+         * @brief Records raised IRQs. Call this from the IRQ handler.
+         *
+         * @param flags The raised IRQs.
+         */
+        void on_irq(irq flags) noexcept {
+            m_raised = m_raised | bits(flags);
+            if (flags.vblank) {
+                m_frame = m_frame + 1;
+            }
+        }
+
+        /**
+         * @brief Runs the next ready task until it gives up the CPU.
+         *
+         * @return `false` if no task was ready.
+         */
+        bool run_once() noexcept {
+            wake();
+
+            auto* next = pick();
+            if (!next) {
+                return false;
+            }
+
+            m_current = next;
+            (*next->context)();
+            m_current = nullptr;
+
+            if (!*next->context) {
+                next->context.reset();
+                next->status = state::free;
+                --m_count;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Runs tasks until they have all returned, halting the CPU while every task is blocked.
+         */
+        void run() noexcept {
+            while (m_count) {
+                if (!run_once()) {
+                    idle();
+                }
+            }
+        }
+
+        /**
+         * @brief Number of tasks that have not returned.
+         *
+         * @return Task count.
+         */
+        [[nodiscard]]
+        std::size_t size() const noexcept {
+            return m_count;
+        }
+
+        /**
+         * @brief Number of VBlanks passed to on_irq().
+         *
+         * @return Frame count.
+         */
+        [[nodiscard]]
+        unsigned int frame() const noexcept {
+            return m_frame;
+        }
+
+    private:
+        enum class state : unsigned char {
+            free,
+            ready,
+            sleeping,
+            waiting,
+        };
+
+        struct task {
+            alignas(8) std::array<std::byte, StackSize> stack;
+            std::optional<fiber> context;
+            fiber* self{};
+            int priority{};
+            unsigned int wake_frame{};
+            unsigned short wait_mask{};
+            unsigned short woken_by{};
+            state status{};
+        };
+
+        static unsigned short bits(irq flags) noexcept {
+            return std::bit_cast<unsigned short>(flags);
+        }
+
+        void suspend() noexcept {
+            (*m_current->self)();
+        }
+
+        void wake() noexcept {
+            const auto ime = *mmio::IME;
+            mmio::IME = false;
+            const auto raised = m_raised;
+            const auto frame = m_frame;
+            m_raised = 0;
+            mmio::IME = ime;
+
+            for (auto& t : m_tasks) {
+                if (t.status == state::sleeping && int(frame - t.wake_frame) >= 0) {
+                    t.status = state::ready;
+                } else if (t.status == state::waiting && (raised & t.wait_mask)) {
+                    t.woken_by = raised & t.wait_mask;
+                    t.status = state::ready;
+                }
+            }
+        }
+
+        task* pick() noexcept {
+            task* best = nullptr;
+            auto index = m_last;
+            for (std::size_t ii = 0; ii < MaxTasks; ++ii) {
+                index = index + 1 < MaxTasks ? index + 1 : 0;
+                auto& t = m_tasks[index];
+                if (t.status == state::ready && (!best || t.priority > best->priority)) {
+                    best = &t;
+                    m_last = index;
+                }
+            }
+            return best;
+        }
+
+        void idle() noexcept {
+            unsigned short mask = 0;
+            for (const auto& t : m_tasks) {
+                if (t.status == state::sleeping) {
+                    mask |= bits({.vblank = true});
+                } else if (t.status == state::waiting) {
+                    mask |= t.wait_mask;
+                }
+            }
+
+            // IRQs raised since wake() are still set in the BIOS flags, so IntrWait returns at once instead of missing them
+            if (mask) {
+                bios::IntrWait(false, std::bit_cast<irq>(mask));
+            } else {
+                bios::Halt();
+            }
+        }
+
+        task m_tasks[MaxTasks]{};
+        task* m_current{};
+        std::size_t m_last{MaxTasks - 1};
+        std::size_t m_count{};
+        volatile unsigned int m_frame{};
+        volatile unsigned short m_raised{};
+    };
+
+} // namespace gba::agbabi
+
+#endif // define GBAXX_EXT_AGBABI_SCHEDULER_HPP
@@ -12,6 +12,7 @@
 /** @file */
 
 #include <cstdarg>
+#include <cstdio>
 #include <cstring>
 #include <type_traits>
 
@@ -95,6 +96,20 @@ namespace gba::mgba {
 
     }
 
+    namespace detail {
+
+        // Sends DEBUG_STRING to the logger, which host builds print to the standard error stream
+        inline void send(log level) noexcept {
+#if defined(GBAXX_HOST)
+            static constexpr const char* names[] = {"FATAL", "ERROR", "WARN", "INFO", "DEBUG"};
+            std::fprintf(stderr, "[%s] GBA Debug: %.256s\n", names[static_cast<int>(level) % 5], const_cast<const char*>(&mmio::DEBUG_STRING));
+#else
+            mmio::DEBUG_FLAGS.emplace(static_cast<std::underlying_type_t<log>>(level) | 0x100);
+#endif
+        }
+
+    } // namespace detail
+
     /**
      * @brief Enables mGBA debug features.
      *
@@ -119,7 +134,11 @@ namespace gba::mgba {
      * @sa close()
      */
     inline bool open() noexcept {
+#if defined(GBAXX_HOST)
+        mmio::DEBUG_ENABLE = 0x1DEA; // The host logger is always present
+#else
         mmio::DEBUG_ENABLE = 0xC0DE;
+#endif
         return *mmio::DEBUG_ENABLE == 0x1DEA;
     }
 
@@ -148,7 +167,7 @@ namespace gba::mgba {
      */
     inline void puts(log level, const char* str) noexcept {
         std::strncpy(&mmio::DEBUG_STRING, str, 256);
-        mmio::DEBUG_FLAGS.emplace(static_cast<std::underlying_type_t<log>>(level) | 0x100);
+        detail::send(level);
     }
 
     /**
@@ -172,7 +191,7 @@ namespace gba::mgba {
         va_start(args, str);
         std::vsnprintf(&mmio::DEBUG_STRING, 256, str, args);
         va_end(args);
-        mmio::DEBUG_FLAGS.emplace(static_cast<std::underlying_type_t<log>>(level) | 0x100);
+        detail::send(level);
     }
 
 #ifdef _PSPRINTF_HEADER_
@@ -197,7 +216,7 @@ namespace gba::mgba {
     [[gnu::always_inline]]
     inline void posprintf(log level, const char* str, ...) noexcept {
         ::posprintf(&mmio::DEBUG_STRING, str, __builtin_va_arg_pack());
-        mmio::DEBUG_FLAGS.emplace(static_cast<std::underlying_type_t<log>>(level) | 0x100);
+        detail::send(level);
     }
 #endif
 
@@ -0,0 +1,323 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_EXT_MGBA_PRINT_HPP
+#define GBAXX_EXT_MGBA_PRINT_HPP
+/** @file */
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include <gba/type.hpp>
+
+#include <gba/ext/mgba/log.hpp>
+
+namespace gba::mgba {
+
+    namespace detail {
+
+        template <std::size_t N>
+        struct format_string {
+            consteval format_string(const char (&str)[N]) noexcept {
+                for (std::size_t ii = 0; ii < N; ++ii) {
+                    data[ii] = str[ii];
+                }
+            }
+
+            char data[N]{};
+        };
+
+        enum class format_spec : char {
+            none,
+            hex,
+        };
+
+        // Literal text (with escapes resolved) split around each placeholder
+        template <std::size_t N>
+        struct parsed_format {
+            char text[N]{};
+            std::size_t begin[N]{};
+            std::size_t length[N]{};
+            format_spec specs[N]{};
+            std::size_t placeholders{};
+        };
+
+        template <format_string Fmt>
+        consteval auto parse_format() {
+            constexpr auto N = sizeof(Fmt.data);
+            auto result = parsed_format<N>{};
+
+            std::size_t out = 0;
+            std::size_t ii = 0;
+            while (ii < N - 1) {
+                const auto c = Fmt.data[ii];
+                if (c == '{' && Fmt.data[ii + 1] == '{') {
+                    result.text[out++] = '{';
+                    ii += 2;
+                } else if (c == '}' && Fmt.data[ii + 1] == '}') {
+                    result.text[out++] = '}';
+                    ii += 2;
+                } else if (c == '{') {
+                    auto spec = format_spec::none;
+                    if (Fmt.data[ii + 1] == ':' && Fmt.data[ii + 2] == 'x' && Fmt.data[ii + 3] == '}') {
+                        spec = format_spec::hex;
+                        ii += 4;
+                    } else if (Fmt.data[ii + 1] == '}') {
+                        ii += 2;
+                    } else {
+                        throw "Unsupported format placeholder, use {} or {:x}";
+                    }
+
+                    const auto p = result.placeholders++;
+                    result.length[p] = out - result.begin[p];
+                    result.specs[p] = spec;
+                    result.begin[p + 1] = out;
+                } else if (c == '}') {
+                    throw "Unmatched } in format string, use }} for a literal brace";
+                } else {
+                    result.text[out++] = c;
+                    ++ii;
+                }
+            }
+            result.length[result.placeholders] = out - result.begin[result.placeholders];
+            return result;
+        }
+
+        class debug_writer {
+        public:
+            debug_writer() noexcept : m_out{&mmio::DEBUG_STRING[0]} {}
+
+            [[gnu::always_inline]]
+            void put(char c) noexcept {
+                if (m_remaining) {
+                    *m_out++ = c;
+                    --m_remaining;
+                }
+            }
+
+            void write(const char* str, std::size_t length) noexcept {
+                while (length--) {
+                    put(*str++);
+                }
+            }
+
+            void write(const char* str) noexcept {
+                while (*str) {
+                    put(*str++);
+                }
+            }
+
+            void finish() noexcept {
+                *m_out = '\0';
+            }
+
+        private:
+            volatile char* m_out;
+            std::size_t m_remaining{255};
+        };
+
+        template <std::unsigned_integral T>
+        void write_unsigned(debug_writer& out, T value, format_spec spec) noexcept {
+            char digits[sizeof(T) * 3];
+            std::size_t n = 0;
+            if (spec == format_spec::hex) {
+                do {
+                    digits[n++] = "0123456789abcdef"[value & 0xf];
+                    value >>= 4;
+                } while (value);
+            } else {
+                // Constant division compiles to a multiply, 32-bit values avoid the 64-bit helpers
+                using work_type = std::conditional_t<sizeof(T) <= 4, std::uint32_t, std::uint64_t>;
+                auto v = work_type(value);
+                do {
+                    digits[n++] = char('0' + v % 10);
+                    v /= 10;
+                } while (v);
+            }
+            while (n) {
+                out.put(digits[--n]);
+            }
+        }
+
+        template <std::integral T>
+        void write_integer(debug_writer& out, T value, format_spec spec) noexcept {
+            using unsigned_type = std::make_unsigned_t<T>;
+            if constexpr (std::is_signed_v<T>) {
+                if (value < 0 && spec != format_spec::hex) {
+                    out.put('-');
+                    write_unsigned(out, unsigned_type(-unsigned_type(value)), spec);
+                    return;
+                }
+            }
+            write_unsigned(out, unsigned_type(value), spec);
+        }
+
+        template <std::size_t FractionalBits, std::integral T>
+        void write_fixed(debug_writer& out, T raw, format_spec spec) noexcept {
+            if (spec == format_spec::hex) {
+                write_unsigned(out, std::make_unsigned_t<T>(raw), spec);
+                return;
+            }
+
+            using magnitude_type = std::conditional_t<sizeof(T) <= 4 && FractionalBits < 28, std::uint32_t, std::uint64_t>;
+            auto magnitude = magnitude_type(std::make_unsigned_t<T>(raw));
+            if constexpr (std::is_signed_v<T>) {
+                if (raw < 0) {
+                    out.put('-');
+                    magnitude = magnitude_type(std::make_unsigned_t<T>(-std::make_unsigned_t<T>(raw)));
+                }
+            }
+
+            write_unsigned(out, magnitude >> FractionalBits, format_spec::none);
+            if constexpr (FractionalBits > 0) {
+                // Enough decimal digits to distinguish every fractional step (log10(2) ~= 0.301)
+                constexpr auto max_digits = (FractionalBits * 301 + 999) / 1000;
+                constexpr auto mask = (magnitude_type{1} << FractionalBits) - 1;
+
+                char digits[max_digits];
+                auto fraction = magnitude & mask;
+                std::size_t n = 0;
+                std::size_t last = 0;
+                while (n < max_digits) {
+                    fraction *= 10;
+                    digits[n++] = char('0' + (fraction >> FractionalBits));
+                    fraction &= mask;
+                    if (digits[n - 1] != '0') {
+                        last = n;
+                    }
+                }
+
+                out.put('.');
+                out.write(digits, last ? last : 1);
+            }
+        }
+
+        template <Vector T>
+        void write_vector(debug_writer& out, const T& value, auto&& element) noexcept {
+            out.put('(');
+            for (std::size_t ii = 0; ii < vector_traits<T>::size; ++ii) {
+                if (ii) {
+                    out.write(", ", 2);
+                }
+                element(value[ii]);
+            }
+            out.put(')');
+        }
+
+        template <typename T>
+        void write_value(debug_writer& out, const T& value, format_spec spec) noexcept {
+            if constexpr (std::same_as<T, bool>) {
+                out.write(value ? "true" : "false");
+            } else if constexpr (std::same_as<T, char>) {
+                out.put(value);
+            } else if constexpr (std::integral<T>) {
+                write_integer(out, value, spec);
+            } else if constexpr (std::is_enum_v<T>) {
+                write_integer(out, std::underlying_type_t<T>(value), spec);
+            } else if constexpr (std::same_as<std::decay_t<T>, const char*> || std::same_as<std::decay_t<T>, char*>) {
+                const char* str = value;
+                out.write(str ? str : "(null)");
+            } else if constexpr (Fixed<T>) {
+                constexpr auto bits = T::fractional_bits;
+                if constexpr (Vector<typename T::data_type>) {
+                    write_vector(out, value.data(), [&](auto element) {
+                        write_fixed<bits>(out, element, spec);
+                    });
+                } else {
+                    write_fixed<bits>(out, value.data(), spec);
+                }
+            } else if constexpr (Angle<T>) {
+                if (spec == format_spec::hex) {
+                    write_integer(out, value.data(), spec);
+                } else {
+                    // Hundredths of a degree, rounded
+                    constexpr auto turn = std::uint64_t{1} << T::bits;
+                    const auto raw = std::uint64_t(value.data()) & (turn - 1);
+                    const auto hundredths = std::uint32_t((raw * 36000 + turn / 2) >> T::bits);
+                    write_unsigned(out, hundredths / 100, format_spec::none);
+                    out.put('.');
+                    out.put(char('0' + (hundredths / 10) % 10));
+                    out.put(char('0' + hundredths % 10));
+                }
+            } else if constexpr (Vector<T>) {
+                write_vector(out, value, [&](auto element) {
+                    write_integer(out, element, spec);
+                });
+            } else if constexpr (std::is_pointer_v<T>) {
+                out.write("0x", 2);
+                write_unsigned(out, std::uintptr_t(value), format_spec::hex);
+            } else {
+                static_assert(!sizeof(T), "Type cannot be formatted by mgba::print");
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Formats directly into the mGBA debug string, with the format string parsed at compile time.
+     *
+     * Each `{}` in the format is replaced by the next argument. `{:x}` prints integers (and raw fixed-point or angle
+     * data) in hexadecimal, `{{` and `}}` print literal braces.
+     *
+     * Supported arguments are integers, `bool`, `char`, strings, enums, pointers, fixed-point values (printed as
+     * decimals), binary angles (printed as degrees with two decimal places), and GNU vectors of these.
+     *
+     * Unlike printf(), there are no C varargs, no libc calls, and no intermediate buffer. The number of arguments is
+     * checked at compile time.
+     *
+     * @tparam Fmt Format string.
+     * @param level The log level to determine the type of message to output.
+     * @param args Values to format.
+     *
+     * @code{cpp}
+     * // Logging game state every frame
+     *
+     * #include <gba/gba.hpp>
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mgba::open();
+     *
+     *     fixed<int, 8> x = 12.5;
+     *     angle<u16> heading = 0x4000;
+     *     mgba::print<"x={} heading={} flags={:x}">(mgba::log::info, x, heading, 0xbeef);
+     *     // x=12.5 heading=90.00 flags=beef
+     * }
+     * @endcode
+     *
+     * @note A maximum of 255 characters will be printed, longer output is truncated.
+     * @note Fractional digits are truncated rather than rounded, with trailing zeros removed.
+     * @note mGBA must be present for this function to work.
+     *
+     * @sa printf()
+     * @sa open()
+     */
+    template <detail::format_string Fmt, typename... Args>
+    void print(log level, const Args&... args) noexcept {
+        static constexpr auto format = detail::parse_format<Fmt>();
+        static_assert(format.placeholders == sizeof...(Args), "Number of arguments must match the number of placeholders");
+
+        auto out = detail::debug_writer{};
+        [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+            ((out.write(format.text + format.begin[Is], format.length[Is]), detail::write_value(out, args, format.specs[Is])), ...);
+        }(std::index_sequence_for<Args...>{});
+        out.write(format.text + format.begin[sizeof...(Args)], format.length[sizeof...(Args)]);
+        out.finish();
+
+        detail::send(level);
+    }
+
+} // namespace gba::mgba
+
+#endif // define GBAXX_EXT_MGBA_PRINT_HPP
@@ -20,11 +20,75 @@
 #include <gba/bios/misc.hpp>
 #include <gba/bios/sound.hpp>
 
+#include <gba/compress/bitunpack.hpp>
+#include <gba/compress/encode.hpp>
+#include <gba/compress/huffman.hpp>
+#include <gba/compress/lz77.hpp>
+#include <gba/compress/output.hpp>
+#include <gba/compress/rle.hpp>
+
+#include <gba/debug/benchmark.hpp>
+#include <gba/debug/profile.hpp>
+#include <gba/debug/trace.hpp>
+
 #include <gba/ext/agbabi/agbabi.hpp>
 #include <gba/ext/mgba/log.hpp>
+#include <gba/ext/mgba/print.hpp>
 
+#include <gba/hardware/dmahelper.hpp>
+#include <gba/hardware/dmaqueue.hpp>
+#include <gba/hardware/multiboot.hpp>
+#include <gba/hardware/multiplayer.hpp>
+#include <gba/hardware/rtc.hpp>
+#include <gba/hardware/rumble.hpp>
+#include <gba/hardware/save.hpp>
+#include <gba/hardware/save_journal.hpp>
+#include <gba/hardware/waitstate.hpp>
+
+#include <gba/input/key_sampler.hpp>
 #include <gba/input/keyhelper.hpp>
 
+#include <gba/interrupt/atomic.hpp>
+#include <gba/interrupt/dispatcher.hpp>
+#include <gba/interrupt/guard.hpp>
+
+#include <gba/math/collision_grid.hpp>
+#include <gba/math/divide.hpp>
+#include <gba/math/matrix.hpp>
+#include <gba/math/reciprocal.hpp>
+#include <gba/math/sqrt.hpp>
+#include <gba/math/trig.hpp>
+#include <gba/math/vec2.hpp>
+
+#include <gba/memory/arena.hpp>
+#include <gba/memory/entity_table.hpp>
+#include <gba/memory/pool.hpp>
+#include <gba/memory/ring_buffer.hpp>
+#include <gba/memory/section.hpp>
+#include <gba/memory/stack_pool.hpp>
+
+#include <gba/sound/adpcm.hpp>
+#include <gba/sound/mixer.hpp>
+#include <gba/sound/tracker.hpp>
+#include <gba/sound/wave_stream.hpp>
+
+#include <gba/video/affine_pool.hpp>
+#include <gba/video/bitmap.hpp>
+#include <gba/video/bg_streamer.hpp>
+#include <gba/video/frame_pacer.hpp>
+#include <gba/video/metatile.hpp>
+#include <gba/video/mode7.hpp>
+#include <gba/video/obj_vram.hpp>
+#include <gba/video/palette.hpp>
+#include <gba/video/raster3d.hpp>
+#include <gba/video/scanline.hpp>
+#include <gba/video/shadow_io.hpp>
+#include <gba/video/shadow_oam.hpp>
+#include <gba/video/sprite_sort.hpp>
+#include <gba/video/text.hpp>
+#include <gba/video/tilemap_builder.hpp>
+#include <gba/video/transition.hpp>
+
 namespace gba {
 
     /**
@@ -58,11 +58,37 @@ namespace gba {
      * @var waitcnt_default
      * @brief The default waitcnt configuration.
      *
+     * 3/1 cycle Wait State 0 with prefetch, the timings used by retail cartridges.
+     *
      * @sa waitcnt
      * @sa mmio::WAITCNT
      */
     inline constexpr auto waitcnt_default = waitcnt{.sram = 3, .ws0_first = 1, .ws0_second = 1, .ws2_first = 3, .prefetch = true};
 
+    /**
+     * @var waitcnt_reset
+     * @brief The waitcnt configuration at power on (4/2 cycle ROM access, no prefetch).
+     *
+     * Every cartridge and flashcart works with these timings.
+     *
+     * @sa waitcnt
+     * @sa mmio::WAITCNT
+     */
+    inline constexpr auto waitcnt_reset = waitcnt{};
+
+    /**
+     * @var waitcnt_fast
+     * @brief Fastest ROM access (2/1 cycle Wait State 0, with prefetch).
+     *
+     * Faster than the 3/1 timings that retail cartridges are rated for. Most flashcarts and many retail ROM chips
+     * handle it, but some do not, so it should only be used after checking with waitstate::tune().
+     *
+     * @sa waitcnt
+     * @sa waitstate::tune()
+     * @sa mmio::WAITCNT
+     */
+    inline constexpr auto waitcnt_fast = waitcnt{.sram = 3, .ws0_first = 2, .ws0_second = 1, .ws2_first = 3, .prefetch = true};
+
     /**
      * @struct cartdirection
      * @brief Bitmask represents the control of GPIO data direction.
@@ -0,0 +1,277 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_HARDWARE_DMAHELPER_HPP
+#define GBAXX_HARDWARE_DMAHELPER_HPP
+/** @file */
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <gba/mmio.hpp>
+
+#include <gba/hardware/dma.hpp>
+
+namespace gba {
+
+    /**
+     * @brief Concept for a type that can be moved by the DMA hardware.
+     *
+     * The DMA units transfer either 16-bit or 32-bit units, so the type must be trivially copyable and a multiple of
+     * 2 bytes in size and alignment.
+     *
+     * @tparam T Type to be tested.
+     */
+    template <typename T>
+    concept DmaTransferable = std::is_trivially_copyable_v<std::remove_cv_t<T>> &&
+            sizeof(T) % 2 == 0 && alignof(T) % 2 == 0;
+
+    /**
+     * @brief Selects if a type will be transferred with 32-bit DMA units.
+     *
+     * A type is transferred with 32-bit units when both its size and alignment are multiples of 4 bytes, otherwise
+     * 16-bit units are used.
+     *
+     * @tparam T Element type of the transfer.
+     *
+     * @sa dmacnt_h::transfer_32bit
+     */
+    template <DmaTransferable T>
+    inline constexpr bool dma_transfer_32bit_v = sizeof(T) % 4 == 0 && alignof(T) % 4 == 0;
+
+    /**
+     * @struct dma
+     * @brief Typed interface for a DMA channel.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#gba-dma-transfers">GBA DMA Transfers</a>
+     *
+     * Every transfer writes the source, destination, count, and control registers of the channel with a single `stm`
+     * instruction. The transfer unit size is selected at compile time from the element type.
+     *
+     * <table><thead><tr><th>Channel</th><th>Source</th><th>Destination</th><th>Max units</th></tr></thead><tbody><tr><td>0</td><td>Internal memory</td><td>Internal memory</td><td>0x4000</td></tr><tr><td>1</td><td>Any memory</td><td>Internal memory</td><td>0x4000</td></tr><tr><td>2</td><td>Any memory</td><td>Internal memory</td><td>0x4000</td></tr><tr><td>3</td><td>Any memory</td><td>Any memory</td><td>0x10000</td></tr></tbody></table>
+     *
+     * @tparam Channel DMA channel number (0, 1, 2, or 3).
+     *
+     * @code{cpp}
+     * // Uploading a palette and clearing a charblock with DMA3
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const gba::u16 my_palette[256];
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     dma<3>::copy(my_palette, &mmio::BG_PALETTE, 256); // 256 16-bit units
+     *
+     *     const auto empty = tile4bpp{};
+     *     dma<3>::fill(empty, &mmio::CHARBLOCK0_4BPP, 512); // 512 tiles, one 8-unit DMA per tile
+     * }
+     * @endcode
+     *
+     * @sa dmacnt_h
+     * @sa mmio::DMA_SRC
+     * @sa mmio::DMA_DEST
+     * @sa mmio::DMA_COUNT
+     * @sa mmio::DMA_CONTROL
+     */
+    template <std::size_t Channel> requires (Channel < 4)
+    struct dma {
+        static constexpr auto channel = Channel;
+
+        /**
+         * @brief Maximum number of units the channel can move in a single transfer.
+         *
+         * @note A count of 0 transfers this many units.
+         */
+        static constexpr std::size_t max_units = Channel == 3 ? 0x10000 : 0x4000;
+
+        /**
+         * @brief Writes a complete transfer descriptor to the channel registers.
+         *
+         * The source, destination, and the combined count & control words are stored with one `stmia`, so the
+         * transfer begins with the final store.
+         *
+         * @param src Source address.
+         * @param dest Destination address.
+         * @param units Number of units to transfer.
+         * @param control Control parameters for the transfer.
+         *
+         * @note If `control.enabled` is false the registers are loaded but the transfer is not started.
+         *
+         * @sa copy()
+         * @sa fill()
+         */
+        [[gnu::always_inline]]
+        static void transfer(const volatile void* src, volatile void* dest, std::size_t units, dmacnt_h control) noexcept {
+#if defined(GBAXX_HOST)
+            // Only immediate transfers run, straight away, as there is no display or sound to start the others
+            if (control.enabled && control.start_time == start::immediate) {
+                const std::ptrdiff_t size = control.transfer_32bit ? 4 : 2;
+                const auto src_step = control.src_control == src_addr::increment ? size : control.src_control == src_addr::decrement ? -size : 0;
+                const auto dest_step = control.dest_control == dest_addr::decrement ? -size : control.dest_control == dest_addr::fixed ? 0 : size;
+
+                const auto max_units = std::size_t(Channel == 3 ? 0x10000 : 0x4000);
+                auto count = units & (max_units - 1);
+                if (count == 0) {
+                    count = max_units;
+                }
+
+                auto* s = static_cast<const volatile std::byte*>(src);
+                auto* d = static_cast<volatile std::byte*>(dest);
+                for (; count; --count, s += src_step, d += dest_step) {
+                    detail::host_copy(d, s, std::size_t(size));
+                }
+                control.enabled = false;
+            }
+            volatile_store(reinterpret_cast<volatile u32*>(register_block() + 8), u32(units & 0xffff) | (u32(__builtin_bit_cast(u16, control)) << 16));
+#else
+            register auto* r0 asm("r0") = src;
+            register auto* r1 asm("r1") = dest;
+            register auto r2 asm("r2") = u32(units & 0xffff) | (u32(__builtin_bit_cast(u16, control)) << 16);
+            register auto r3 asm("r3") = register_block();
+            asm volatile (
+                "stmia %[reg]!, {%[src], %[dest], %[cnt]}"
+                : [reg]"+l"(r3) : [src]"l"(r0), [dest]"l"(r1), [cnt]"l"(r2) : "memory"
+            );
+#endif
+        }
+
+        /**
+         * @brief Copies `count` elements from `src` to `dest`.
+         *
+         * @tparam T Source element type.
+         * @tparam U Destination element type.
+         * @param src Pointer to the first source element.
+         * @param dest Pointer to the first destination element.
+         * @param count Number of elements to copy.
+         * @param start_time When the transfer should begin.
+         *
+         * @note Immediate transfers halt the CPU until completed.
+         * @warning The total number of units must not exceed max_units.
+         *
+         * @sa fill()
+         * @sa dma_transfer_32bit_v
+         */
+        template <DmaTransferable T, DmaTransferable U> requires std::same_as<std::remove_cv_t<T>, std::remove_cv_t<U>>
+        [[gnu::always_inline, gnu::nonnull(1, 2)]]
+        static void copy(const T* src, U* dest, std::size_t count, start start_time = start::immediate) noexcept {
+            transfer(src, dest, units_of<T>(count), control_for<T>(src_addr::increment, dest_addr::increment, start_time));
+        }
+
+        /**
+         * @brief Fills `count` elements of `dest` with a value.
+         *
+         * The transfer keeps the source address fixed, so the value is read from memory for every unit.
+         *
+         * @tparam T Source value type.
+         * @tparam U Destination element type.
+         * @param value Value to fill the destination with.
+         * @param dest Pointer to the first destination element.
+         * @param count Number of elements to fill.
+         *
+         * @note The fill is immediate, so `value` may live on the stack.
+         * @warning The total number of units must not exceed max_units.
+         *
+         * @sa copy()
+         */
+        template <DmaTransferable T, DmaTransferable U> requires std::same_as<std::remove_cv_t<T>, std::remove_cv_t<U>> && (sizeof(T) <= 4)
+        [[gnu::always_inline, gnu::nonnull(2)]]
+        static void fill(const T& value, U* dest, std::size_t count) noexcept {
+            transfer(&value, dest, units_of<T>(count), control_for<T>(src_addr::fixed, dest_addr::increment, start::immediate));
+        }
+
+        /**
+         * @brief Fills `count` elements of `dest` with a value wider than a single DMA unit.
+         *
+         * Each element is transferred as its own immediate DMA, as the hardware can only repeat a single unit.
+         *
+         * @tparam T Source value type.
+         * @tparam U Destination element type.
+         * @param value Value to fill the destination with.
+         * @param dest Pointer to the first destination element.
+         * @param count Number of elements to fill.
+         *
+         * @sa copy()
+         */
+        template <DmaTransferable T, DmaTransferable U> requires std::same_as<std::remove_cv_t<T>, std::remove_cv_t<U>> && (sizeof(T) > 4)
+        [[gnu::nonnull(2)]]
+        static void fill(const T& value, U* dest, std::size_t count) noexcept {
+            for (std::size_t ii = 0; ii < count; ++ii) {
+                copy(&value, dest + ii, 1);
+            }
+        }
+
+        /**
+         * @brief Stops the channel, cancelling any pending repeat or timed transfer.
+         */
+        [[gnu::always_inline]]
+        static void stop() noexcept {
+            mmio::DMA_CONTROL.reset(Channel);
+        }
+
+        /**
+         * @brief Tests if the channel is still enabled.
+         *
+         * @return True if the channel is enabled (transfer pending, in progress, or repeating).
+         */
+        [[nodiscard, gnu::always_inline]]
+        static bool busy() noexcept {
+            return mmio::DMA_CONTROL.get(Channel).enabled;
+        }
+
+        /**
+         * @brief Number of DMA units needed to transfer `count` elements of T.
+         *
+         * @tparam T Element type.
+         * @param count Number of elements.
+         * @return Number of 16-bit or 32-bit units.
+         */
+        template <DmaTransferable T>
+        static constexpr std::size_t units_of(std::size_t count) noexcept {
+            return count * (sizeof(T) / (dma_transfer_32bit_v<T> ? 4 : 2));
+        }
+
+        /**
+         * @brief Builds control parameters suitable for transferring elements of T.
+         *
+         * @tparam T Element type.
+         * @param src Source address control.
+         * @param dest Destination address control.
+         * @param start_time When the transfer should begin.
+         * @param repeat Repeat the transfer for HBlank, VBlank, or special timed transfers.
+         * @return Enabled dmacnt_h with the unit size selected for T.
+         */
+        template <DmaTransferable T>
+        static constexpr dmacnt_h control_for(src_addr src, dest_addr dest, start start_time, bool repeat = false) noexcept {
+            return dmacnt_h{
+                .dest_control = dest,
+                .src_control = src,
+                .repeat = repeat,
+                .transfer_32bit = dma_transfer_32bit_v<T>,
+                .start_time = start_time,
+                .enabled = true
+            };
+        }
+
+        /**
+         * @brief Address of the channel's source, destination, count, and control register block.
+         *
+         * @return Address of the channel's source register.
+         */
+        [[nodiscard, gnu::always_inline]]
+        static std::uintptr_t register_block() noexcept {
+            return reinterpret_cast<std::uintptr_t>(&mmio::DMA_SRC) + Channel * mmio::DMA_SRC.stride;
+        }
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_HARDWARE_DMAHELPER_HPP
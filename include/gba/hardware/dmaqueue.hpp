@@ -0,0 +1,236 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_HARDWARE_DMAQUEUE_HPP
+#define GBAXX_HARDWARE_DMAQUEUE_HPP
+/** @file */
+
+#include <atomic>
+#include <concepts>
+#include <type_traits>
+
+#include <gba/hardware/dmahelper.hpp>
+
+namespace gba {
+
+    /**
+     * @class dma_queue
+     * @brief Fixed capacity queue of DMA copies, deferred until flushed from an interrupt handler.
+     *
+     * Game logic pushes copies (typically to VRAM, OAM, or palette RAM) during the frame, and the VBlank interrupt
+     * handler calls flush() to submit them back-to-back at the very start of VBlank.
+     *
+     * The queue is safe for a single producer (the main loop) and a single consumer (the interrupt handler) without
+     * disabling interrupts. Each command is submitted to the channel with one `ldmia`/`stmia` pair, and as `stmia`
+     * cannot be interrupted part-way the main loop may also use the same channel with dma::copy().
+     *
+     * @tparam Capacity Maximum number of pending commands. Must be a power of 2.
+     * @tparam Channel DMA channel used for the transfers.
+     *
+     * @code{cpp}
+     * // Deferring uploads to the start of VBlank
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static gba::dma_queue<32> uploads;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.vblank) {
+     *             uploads.flush();
+     *         }
+     *     });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true};
+     *     mmio::IME = true;
+     *
+     *     static u16 palette[256]{};
+     *
+     *     while (true) {
+     *         // Update palette...
+     *         uploads.push(palette, &mmio::BG_PALETTE, 256);
+     *
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note Source data must remain valid and unchanged until the queue has been flushed.
+     *
+     * @sa dma
+     */
+    template <std::size_t Capacity, std::size_t Channel = 3> requires (Capacity > 0 && (Capacity & (Capacity - 1)) == 0)
+    class dma_queue {
+    public:
+        /**
+         * @struct command
+         * @brief A single queued transfer, laid out exactly as the channel's register block.
+         */
+        struct command {
+            const volatile void* src; /**< Source address. */
+            volatile void* dest; /**< Destination address. */
+            u32 count_control; /**< Unit count in the low 16 bits, dmacnt_h in the high 16 bits. */
+        };
+
+        static constexpr auto capacity = Capacity;
+
+        constexpr dma_queue() noexcept = default;
+
+        dma_queue(const dma_queue&) = delete;
+        dma_queue& operator=(const dma_queue&) = delete;
+
+        /**
+         * @brief Queues a copy of `count` elements from `src` to `dest`.
+         *
+         * @tparam T Source element type.
+         * @tparam U Destination element type.
+         * @param src Pointer to the first source element.
+         * @param dest Pointer to the first destination element.
+         * @param count Number of elements to copy.
+         * @return False if the queue is full and the copy was not queued.
+         *
+         * @sa dma::copy()
+         */
+        template <DmaTransferable T, DmaTransferable U> requires std::same_as<std::remove_cv_t<T>, std::remove_cv_t<U>>
+        [[gnu::always_inline, gnu::nonnull(2, 3)]]
+        bool push(const T* src, U* dest, std::size_t count) noexcept {
+            using channel = dma<Channel>;
+            return push(command{src, dest, make_count_control(channel::template units_of<T>(count),
+                    channel::template control_for<T>(src_addr::increment, dest_addr::increment, start::immediate))});
+        }
+
+        /**
+         * @brief Queues a fill of `count` elements of `dest` with the value pointed to by `value`.
+         *
+         * @tparam T Source value type.
+         * @tparam U Destination element type.
+         * @param value Pointer to the value to fill the destination with.
+         * @param dest Pointer to the first destination element.
+         * @param count Number of elements to fill.
+         * @return False if the queue is full and the fill was not queued.
+         *
+         * @warning `value` is read when the queue is flushed, so it must not point to a temporary.
+         *
+         * @sa dma::fill()
+         */
+        template <DmaTransferable T, DmaTransferable U> requires std::same_as<std::remove_cv_t<T>, std::remove_cv_t<U>> && (sizeof(T) <= 4)
+        [[gnu::always_inline, gnu::nonnull(2, 3)]]
+        bool push_fill(const T* value, U* dest, std::size_t count) noexcept {
+            using channel = dma<Channel>;
+            return push(command{value, dest, make_count_control(channel::template units_of<T>(count),
+                    channel::template control_for<T>(src_addr::fixed, dest_addr::increment, start::immediate))});
+        }
+
+        /**
+         * @brief Queues a raw command.
+         *
+         * @param cmd Command to queue.
+         * @return False if the queue is full and the command was not queued.
+         */
+        bool push(const command& cmd) noexcept {
+            const auto tail = m_tail;
+            if (tail - m_head == Capacity) {
+                return false;
+            }
+
+            m_commands[tail & mask] = cmd;
+            std::atomic_signal_fence(std::memory_order_release);
+            m_tail = tail + 1;
+            return true;
+        }
+
+        /**
+         * @brief Submits all queued commands to the DMA channel.
+         *
+         * Intended to be called from the VBlank interrupt handler.
+         *
+         * @return Number of commands submitted.
+         */
+        std::size_t flush() noexcept {
+            auto head = m_head;
+            const auto tail = m_tail;
+            std::atomic_signal_fence(std::memory_order_acquire);
+
+            const auto count = tail - head;
+            while (head != tail) {
+                submit(m_commands[head++ & mask]);
+            }
+
+            std::atomic_signal_fence(std::memory_order_release);
+            m_head = head;
+            return count;
+        }
+
+        /**
+         * @brief Discards all queued commands.
+         *
+         * @note Like flush(), this must not race with another consumer.
+         */
+        void clear() noexcept {
+            m_head = m_tail;
+        }
+
+        [[nodiscard]]
+        std::size_t size() const noexcept {
+            return m_tail - m_head;
+        }
+
+        [[nodiscard]]
+        bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        [[nodiscard]]
+        bool full() const noexcept {
+            return size() == Capacity;
+        }
+
+        /**
+         * @brief Packs a unit count and control parameters into a command count_control word.
+         *
+         * @param units Number of units to transfer.
+         * @param control Control parameters for the transfer.
+         * @return Combined count & control word.
+         */
+        static u32 make_count_control(std::size_t units, dmacnt_h control) noexcept {
+            return u32(units & 0xffff) | (u32(__builtin_bit_cast(u16, control)) << 16);
+        }
+
+    private:
+        static constexpr std::size_t mask = Capacity - 1;
+
+        [[gnu::always_inline]]
+        static void submit(const command& cmd) noexcept {
+#if defined(GBAXX_HOST)
+            dma<Channel>::transfer(cmd.src, cmd.dest, cmd.count_control & 0xffff, __builtin_bit_cast(dmacnt_h, u16(cmd.count_control >> 16)));
+#else
+            register u32 r0 asm("r0");
+            register u32 r1 asm("r1");
+            register u32 r2 asm("r2");
+            auto reg = dma<Channel>::register_block();
+            asm volatile (
+                "ldmia %[cmd], {%[src], %[dest], %[cnt]}\n\t"
+                "stmia %[reg]!, {%[src], %[dest], %[cnt]}"
+                : [src]"=&l"(r0), [dest]"=&l"(r1), [cnt]"=&l"(r2), [reg]"+l"(reg)
+                : [cmd]"l"(&cmd) : "memory"
+            );
+#endif
+        }
+
+        command m_commands[Capacity]{};
+        volatile std::size_t m_head{};
+        volatile std::size_t m_tail{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_HARDWARE_DMAQUEUE_HPP
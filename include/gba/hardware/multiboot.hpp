@@ -0,0 +1,479 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_HARDWARE_MULTIBOOT_HPP
+#define GBAXX_HARDWARE_MULTIBOOT_HPP
+/** @file */
+
+#include <cstddef>
+#include <cstdint>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+#include <gba/bios/misc.hpp>
+#include <gba/hardware/dmahelper.hpp>
+
+namespace gba::multiboot {
+
+    /**
+     * @enum status
+     * @brief Result of a multiboot transfer.
+     *
+     * @sa host
+     * @sa client
+     */
+    enum class status : u8 {
+        ok,
+        bad_image, /**< Image is too small or too large, or not aligned. */
+        no_clients, /**< No client answered. */
+        handshake_failed, /**< A client stopped answering the BIOS handshake. */
+        bios_failed, /**< bios::MultiBoot() failed. */
+        transfer_failed /**< The fast transfer timed out, or failed its checksum. */
+    };
+
+    namespace detail {
+
+        // Fast protocol words
+        inline constexpr u16 sync = 0x4658;
+        inline constexpr u16 sync_ack = 0x5846;
+        inline constexpr u16 start = 0x5354;
+        inline constexpr u16 result_ok = 0x4F4B;
+        inline constexpr u16 result_bad = 0x4E47;
+
+        inline constexpr u32 timeout = 0x40000;
+
+        inline void delay(u32 reads) noexcept {
+            while (reads--) {
+                static_cast<void>(*mmio::VCOUNT);
+            }
+        }
+
+        inline void wait_frames(u32 frames) noexcept {
+            while (frames--) {
+                while (*mmio::VCOUNT >= 160) {}
+                while (*mmio::VCOUNT < 160) {}
+            }
+        }
+
+        // Clients poll IF, which is raised for the serial interrupt even while it is disabled in IE
+        inline bool wait_serial(u32 limit) noexcept {
+            while (!(*mmio::IF).serial) {
+                if (!limit--) {
+                    return false;
+                }
+            }
+            mmio::IF = {.serial = true};
+            return true;
+        }
+
+        constexpr bool is_multi(multi_boot_mode mode) noexcept {
+            return mode == multi_boot_mode::multi_play_115KHz_16bit;
+        }
+
+    } // namespace detail
+
+    /**
+     * @class host
+     * @brief Sends a program to up to 3 GBAs without a cartridge, then streams more data to them at high speed.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#multiboot-transfer-protocol">Multiboot Transfer Protocol</a>
+     *
+     * boot() runs the BIOS handshake (detecting the clients, sending the 0xC0 byte header, and exchanging the palette
+     * and handshake bytes) itself, then hands over to bios::MultiBoot() for the encrypted main transfer.
+     *
+     * The BIOS transfer is slow, so the booted program should be a small bootstrap that calls client::receive(). The
+     * host then sends the rest of the game with stream(), which uses a simpler protocol without the BIOS delays. In
+     * normal mode (one client) stream() clocks 32-bit transfers at 2MHz, waiting for the client to signal ready on SI
+     * before each one. In multi-player mode (up to 3 clients) it broadcasts 16-bit transfers back to back. The data is
+     * copied from ROM into a RAM buffer with DMA 3 ahead of being sent.
+     *
+     * @code{cpp}
+     * // Booting the clients with a bootstrap, then sending the game
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const gba::u8 bootstrap_mb[], bootstrap_mb_end[];
+     * extern const gba::u32 game_mb[], game_mb_end[];
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     multiboot::host sender{multi_boot_mode::multi_play_115KHz_16bit};
+     *
+     *     if (sender.boot(bootstrap_mb, std::size_t(bootstrap_mb_end - bootstrap_mb)) == multiboot::status::ok) {
+     *         sender.stream(game_mb, std::size_t(game_mb_end - game_mb) * 4);
+     *     }
+     * }
+     * @endcode
+     *
+     * @note Interrupts should be disabled while booting, as the transfers are timed by polling.
+     *
+     * @sa client
+     * @sa bios::MultiBoot()
+     */
+    class host {
+    public:
+        static constexpr std::size_t min_size = 0x100 + 0xC0;
+        static constexpr std::size_t max_size = 0x40000;
+
+        constexpr explicit host(multi_boot_mode mode = multi_boot_mode::multi_play_115KHz_16bit) noexcept : m_mode{mode} {}
+
+        host(const host&) = delete;
+        host& operator=(const host&) = delete;
+
+        /**
+         * @brief Sends a multiboot image with the BIOS protocol, which the clients then run.
+         *
+         * @param image Multiboot image, including its 0xC0 byte header.
+         * @param size Bytes in the image, from min_size to max_size.
+         * @param palette Palette byte for the client boot logo.
+         * @param attempts Frames to wait for clients to appear.
+         * @return status::ok once the clients are running the image.
+         */
+        status boot(const void* image, std::size_t size, u8 palette = 0xC1, u32 attempts = 60) noexcept {
+            if (size < min_size || size > max_size) {
+                return status::bad_image;
+            }
+            const auto* bytes = static_cast<const u8*>(image);
+            setup(false);
+
+            u16 replies[3];
+            m_clients = 0;
+            for (u32 ii = 0; ii < attempts && !m_clients; ++ii) {
+                exchange(0x6200, replies);
+                m_clients = clients_replying(replies, 0x7200);
+                if (!m_clients) {
+                    detail::wait_frames(1);
+                }
+            }
+            if (!m_clients) {
+                return status::no_clients;
+            }
+
+            exchange(u16(0x6100 | m_clients), replies);
+            if (clients_replying(replies, 0x7200) != m_clients) {
+                return status::handshake_failed;
+            }
+
+            for (u32 ii = 0; ii < 0x60; ++ii) {
+                exchange(u16(bytes[ii * 2] | (bytes[ii * 2 + 1] << 8)), replies);
+                if (clients_replying(replies, 0, 0x00F0) != m_clients) { // NN0x, with NN counting down
+                    return status::handshake_failed;
+                }
+            }
+
+            exchange(0x6200, replies);
+            exchange(u16(0x6200 | m_clients), replies);
+            if (clients_replying(replies, 0x7200) != m_clients) {
+                return status::handshake_failed;
+            }
+
+            multi_boot_param param{};
+            bool ready = false;
+            for (u32 ii = 0; ii < attempts && !ready; ++ii) {
+                exchange(u16(0x6300 | palette), replies);
+                ready = true;
+                for (u32 jj = 0; jj < 3; ++jj) {
+                    if (m_clients & (2u << jj)) {
+                        ready &= (replies[jj] >> 8) == 0x73;
+                    }
+                }
+            }
+            if (!ready) {
+                return status::handshake_failed;
+            }
+
+            u8 handshake = 0x11;
+            for (u32 jj = 0; jj < 3; ++jj) {
+                param.client_data[jj] = (m_clients & (2u << jj)) ? u8(replies[jj]) : 0xFF;
+                handshake = u8(handshake + param.client_data[jj]);
+            }
+
+            exchange(u16(0x6400 | handshake), replies);
+            detail::wait_frames(4); // 1/16th of a second
+
+            param.handshake_data = handshake;
+            param.palette_data = palette;
+            param.client_bit = m_clients;
+            param.boot_srcp = const_cast<u8*>(bytes + 0xC0);
+            param.boot_endp = const_cast<u8*>(bytes + ((size + 0xF) & ~std::size_t{0xF}));
+            return bios::MultiBoot(&param, m_mode) == 0 ? status::ok : status::bios_failed;
+        }
+
+        /**
+         * @brief Streams data to clients running client::receive().
+         *
+         * @param data Data to send, word aligned.
+         * @param size Bytes to send (rounded up to a multiple of 4).
+         * @param attempts Frames to wait for the clients to start receiving.
+         * @return status::ok once every client received the data and verified its checksum.
+         */
+        status stream(const void* data, std::size_t size, u32 attempts = 120) noexcept {
+            if (reinterpret_cast<std::uintptr_t>(data) & 3) {
+                return status::bad_image;
+            }
+            if (!m_clients) {
+                m_clients = detail::is_multi(m_mode) ? 0b1110 : 0b0010; // Not booted by boot(), so expect every client
+            }
+            setup(true);
+
+            u16 replies[3];
+            bool synced = false;
+            for (u32 ii = 0; ii < attempts && !synced; ++ii) {
+                synced = fast_exchange(detail::sync, replies) && clients_replying(replies, detail::sync_ack, 0xFFFF) == m_clients;
+                if (!synced) {
+                    detail::wait_frames(1);
+                }
+            }
+            if (!synced) {
+                return status::no_clients;
+            }
+
+            const auto words = (size + 3) / 4;
+            auto ok = fast_exchange(detail::start, replies) &&
+                      send_word(u32(words * 4), replies);
+
+            u32 checksum = 0;
+            const auto* src = static_cast<const u32*>(data);
+            for (std::size_t done = 0; ok && done < words; done += buffer_words) {
+                const auto count = words - done < buffer_words ? words - done : buffer_words;
+                dma<3>::copy(src + done, m_buffer, count);
+                for (std::size_t ii = 0; ok && ii < count; ++ii) {
+                    checksum += m_buffer[ii];
+                    ok = send_word(m_buffer[ii], replies);
+                }
+            }
+
+            ok = ok && send_word(checksum, replies) && fast_exchange(0, replies);
+            if (!ok || clients_replying(replies, detail::result_ok, 0xFFFF) != m_clients) {
+                return status::transfer_failed;
+            }
+            return status::ok;
+        }
+
+        /**
+         * @brief Bitmask of the connected clients, as sent to the BIOS (bit 1 for client 1, up to bit 3).
+         */
+        [[nodiscard]]
+        u8 clients() const noexcept {
+            return m_clients;
+        }
+
+    private:
+        static constexpr std::size_t buffer_words = 64;
+
+        void setup(bool fast) noexcept {
+            mmio::RCNT = 0;
+            if (detail::is_multi(m_mode)) {
+                mmio::SIOCNT_MULTI = siocnt_multi{.baud = bps::_115200};
+            } else {
+                const bool fast_clock = fast || m_mode == multi_boot_mode::normal_2MHz_32bit;
+                mmio::SIOCNT_NORMAL = siocnt_normal{.use_clock = true, .clock_2MHz = fast_clock, .transfer_32bit = true};
+            }
+        }
+
+        [[nodiscard]]
+        u8 clients_replying(const u16 (&replies)[3], u16 value, u16 mask = 0xFFF0) const noexcept {
+            u8 bits = 0;
+            for (u32 ii = 0; ii < 3; ++ii) {
+                const auto bit = u16(2u << ii);
+                if (mask == 0xFFFF ? replies[ii] == value : (replies[ii] & mask) == value && (replies[ii] & 0xF) == bit) {
+                    bits |= bit;
+                }
+            }
+            return detail::is_multi(m_mode) ? bits : u8(bits & 0b0010);
+        }
+
+        // One BIOS protocol transfer, giving the clients time to answer from their interrupt handler
+        void exchange(u16 value, u16 (&replies)[3]) noexcept {
+            detail::delay(0x100);
+            if (detail::is_multi(m_mode)) {
+                mmio::SIOMLT_SEND = value;
+                auto cnt = *mmio::SIOCNT_MULTI;
+                cnt.enabled = true;
+                mmio::SIOCNT_MULTI = cnt;
+                for (u32 limit = detail::timeout; (*mmio::SIOCNT_MULTI).enabled && limit; --limit) {}
+                for (u32 ii = 0; ii < 3; ++ii) {
+                    replies[ii] = mmio::SIOMULTI.get(ii + 1);
+                }
+            } else {
+                mmio::SIODATA32 = value;
+                auto cnt = *mmio::SIOCNT_NORMAL;
+                cnt.enabled = true;
+                mmio::SIOCNT_NORMAL = cnt;
+                for (u32 limit = detail::timeout; (*mmio::SIOCNT_NORMAL).enabled && limit; --limit) {}
+                replies[0] = u16(*mmio::SIODATA32 >> 16);
+                replies[1] = replies[2] = 0xFFFF;
+            }
+        }
+
+        // One fast protocol transfer: a halfword in multi-player mode, or a word in normal mode
+        bool fast_exchange(u32 value, u16 (&replies)[3]) noexcept {
+            if (detail::is_multi(m_mode)) {
+                detail::delay(0x20); // Time for the clients to store the previous halfword
+                mmio::SIOMLT_SEND = u16(value);
+                auto cnt = *mmio::SIOCNT_MULTI;
+                if (!cnt.is_ready || cnt.error) {
+                    return false;
+                }
+                cnt.enabled = true;
+                mmio::SIOCNT_MULTI = cnt;
+                u32 limit = detail::timeout;
+                while ((*mmio::SIOCNT_MULTI).enabled) {
+                    if (!limit--) {
+                        return false;
+                    }
+                }
+                for (u32 ii = 0; ii < 3; ++ii) {
+                    replies[ii] = mmio::SIOMULTI.get(ii + 1);
+                }
+                return true;
+            }
+
+            // The client holds SO (our SI) low once it is ready for the next word
+            u32 limit = detail::timeout;
+            while ((*mmio::SIOCNT_NORMAL).input) {
+                if (!limit--) {
+                    return false;
+                }
+            }
+            mmio::SIODATA32 = value;
+            auto cnt = *mmio::SIOCNT_NORMAL;
+            cnt.enabled = true;
+            mmio::SIOCNT_NORMAL = cnt;
+            while ((*mmio::SIOCNT_NORMAL).enabled) {}
+            replies[0] = u16(*mmio::SIODATA32);
+            replies[1] = replies[2] = 0xFFFF;
+            return true;
+        }
+
+        bool send_word(u32 value, u16 (&replies)[3]) noexcept {
+            if (detail::is_multi(m_mode)) {
+                return fast_exchange(value & 0xFFFF, replies) && fast_exchange(value >> 16, replies);
+            }
+            return fast_exchange(value, replies);
+        }
+
+        multi_boot_mode m_mode;
+        u8 m_clients{};
+        u32 m_buffer[buffer_words]{};
+    };
+
+    /**
+     * @struct client
+     * @brief Receiving side of host::stream(), for the bootstrap program sent by host::boot().
+     *
+     * @code{cpp}
+     * // Bootstrap, built as a small multiboot image
+     *
+     * #include <gba/gba.hpp>
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     auto* const game = reinterpret_cast<u32*>(0x2010000); // Past the bootstrap, in EWRAM
+     *     const auto size = multiboot::client::receive(game, 0x30000, multi_boot_mode::multi_play_115KHz_16bit);
+     *     if (size) {
+     *         reinterpret_cast<void(*)()>(game)();
+     *     }
+     *     bios::HardReset();
+     * }
+     * @endcode
+     *
+     * @sa host
+     */
+    struct client {
+        /**
+         * @brief Receives data sent by host::stream().
+         *
+         * Waits indefinitely for the host to start, then with a timeout for each transfer.
+         *
+         * @param dest Destination, word aligned.
+         * @param capacity Bytes available at dest.
+         * @param mode Serial mode the host uses (the same mode given to the host).
+         * @return Bytes received, or 0 if the transfer failed.
+         */
+        static std::size_t receive(u32* dest, std::size_t capacity, multi_boot_mode mode) noexcept {
+            const bool multi = detail::is_multi(mode);
+            mmio::RCNT = 0;
+            if (multi) {
+                mmio::SIOCNT_MULTI = siocnt_multi{.baud = bps::_115200, .irq_after = true};
+            }
+            mmio::IF = {.serial = true};
+
+            u32 value{};
+            const auto next_unit = [multi, &value](u16 reply, u32 limit) noexcept {
+                if (multi) {
+                    mmio::SIOMLT_SEND = reply;
+                } else {
+                    // SO carries bit 31 (low, so ready) until the transfer, then the output bit (high, so busy) after it
+                    mmio::SIODATA32 = reply;
+                    mmio::SIOCNT_NORMAL = siocnt_normal{.output = true, .enabled = true, .transfer_32bit = true, .irq_after = true};
+                }
+                if (!detail::wait_serial(limit)) {
+                    return false;
+                }
+                value = multi ? mmio::SIOMULTI.get(0) : *mmio::SIODATA32;
+                return true;
+            };
+            const auto next_word = [&](u16 reply, u32& word) noexcept {
+                if (!next_unit(reply, detail::timeout)) {
+                    return false;
+                }
+                word = value;
+                if (multi) {
+                    if (!next_unit(reply, detail::timeout)) {
+                        return false;
+                    }
+                    word = (word & 0xFFFF) | (value << 16);
+                }
+                return true;
+            };
+
+            // Wait for the host's sync, and answer it until it sends the start word
+            do {
+                next_unit(0, ~u32{});
+            } while (value != detail::sync);
+            do {
+                if (!next_unit(detail::sync_ack, detail::timeout)) {
+                    return 0;
+                }
+            } while (value == detail::sync);
+            if (value != detail::start) {
+                return 0;
+            }
+
+            u32 size;
+            if (!next_word(0, size) || size > capacity) {
+                return 0;
+            }
+
+            u32 checksum = 0;
+            for (u32 ii = 0; ii < size / 4; ++ii) {
+                if (!next_word(0, dest[ii])) {
+                    return 0;
+                }
+                checksum += dest[ii];
+            }
+
+            u32 expected;
+            if (!next_word(0, expected)) {
+                return 0;
+            }
+            const bool good = expected == checksum;
+            if (!next_unit(good ? detail::result_ok : detail::result_bad, detail::timeout)) {
+                return 0;
+            }
+            return good ? size : 0;
+        }
+    };
+
+} // namespace gba::multiboot
+
+#endif // define GBAXX_HARDWARE_MULTIBOOT_HPP
@@ -0,0 +1,331 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_HARDWARE_MULTIPLAYER_HPP
+#define GBAXX_HARDWARE_MULTIPLAYER_HPP
+/** @file */
+
+#include <array>
+#include <cstddef>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+#include <gba/memory/ring_buffer.hpp>
+
+namespace gba {
+
+    /**
+     * @class multiplayer
+     * @brief Packet transport over the link cable in Multi-Player mode, driven entirely from interrupts.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#sio-multi-player-mode">SIO Multi-Player Mode</a>
+     *
+     * Every transfer exchanges one halfword between all (up to 4) players at 115200 bps. The parent starts a transfer
+     * from a timer interrupt at a fixed cadence, and every player's serial interrupt collects the received halfwords
+     * and loads the next one to send, so the main loop never polls mmio::SIOCNT_MULTI.
+     *
+     * Transfers are grouped into slots of Words halfwords: a header holding a sequence number, followed by one packet
+     * of payload. A player with nothing queued sends an idle header instead. Children align their slots to the header
+     * sent by the parent, so a child that joins late or loses a transfer re-synchronizes at the next slot.
+     *
+     * Received packets go into one lock-free ring_buffer per player, and packets to send into another. Gaps in a
+     * player's sequence numbers, and packets dropped because a queue was full, are counted by lost().
+     *
+     * @tparam Words Halfwords per slot, including the header.
+     * @tparam Depth Packets in each queue, a power of 2.
+     * @tparam Timer Timer starting the transfers on the parent.
+     *
+     * @code{cpp}
+     * // Sharing each player's input every frame
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static gba::multiplayer<4> session;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     interrupt::install();
+     *     interrupt::set_handler({.timer3 = true}, [] { session.on_timer(); });
+     *     interrupt::set_handler({.serial = true}, [] { session.on_serial(); });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true, .timer3 = true, .serial = true};
+     *     mmio::IME = true;
+     *
+     *     session.start();
+     *
+     *     while (true) {
+     *         session.send({std::bit_cast<u16>(*mmio::KEYINPUT), 0, 0});
+     *
+     *         for (std::size_t player = 0; player < 4; ++player) {
+     *             decltype(session)::packet packet;
+     *             while (session.receive(player, packet)) {
+     *                 // Apply packet[0] as the input of player...
+     *             }
+     *         }
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note The payload should avoid the header values (0xA500 to 0xA5FF, and 0x5A00) in its first halfword where
+     *       possible, as a child searching for the parent's header may otherwise align to it for one slot.
+     * @note The timer period must leave time for the transfer itself (about 0.7ms with 4 players), the default is
+     *       about 1ms.
+     *
+     * @sa siocnt_multi
+     * @sa mmio::SIOMULTI
+     * @sa ring_buffer
+     */
+    template <std::size_t Words = 8, std::size_t Depth = 8, u32 Timer = 3> requires (Words >= 2 && Words <= 257 && Timer < 4)
+    class multiplayer {
+    public:
+        using packet = std::array<u16, Words - 1>;
+
+        static constexpr std::size_t players = 4;
+        static constexpr u16 default_period = 256; /**< Timer ticks of 64 cycles, about 1ms. */
+
+        constexpr multiplayer() noexcept = default;
+
+        multiplayer(const multiplayer&) = delete;
+        multiplayer& operator=(const multiplayer&) = delete;
+
+        /**
+         * @brief Switches the serial port to Multi-Player mode, and starts the parent's transfer timer.
+         *
+         * Every player calls start(). Only the player that turns out to be the parent starts transfers.
+         *
+         * @param period Time between transfers, in ticks of 64 cycles.
+         */
+        void start(u16 period = default_period) noexcept {
+            stop();
+            m_position = Words - 1;
+            m_tx_active = false;
+            m_aligned = false;
+            for (auto& rx : m_rx) {
+                rx.active = false;
+                rx.seen = false;
+            }
+
+            mmio::RCNT = 0;
+            mmio::SIOCNT_MULTI = siocnt_multi{.baud = bps::_115200, .irq_after = true};
+            load_next();
+
+            volatile_store(&mmio::TIMER_RELOAD[Timer], u16(-period));
+            volatile_store(&mmio::TIMER_CONTROL[Timer], tmcnt_h{.scale = timer_scale::_64, .overflow_irq = true, .enabled = true});
+        }
+
+        /**
+         * @brief Stops the transfer timer and the serial port. Queued packets are kept.
+         */
+        void stop() noexcept {
+            volatile_store(&mmio::TIMER_CONTROL[Timer], tmcnt_h{});
+            mmio::SIOCNT_MULTI = siocnt_multi{};
+        }
+
+        /**
+         * @brief Call from the interrupt handler of the timer. Starts a transfer on the parent when the link is idle.
+         */
+        void on_timer() const noexcept {
+            const auto cnt = *mmio::SIOCNT_MULTI;
+            if (cnt.is_child || !cnt.is_ready || cnt.enabled) {
+                return;
+            }
+            mmio::SIOCNT_MULTI = siocnt_multi{.baud = bps::_115200, .enabled = true, .irq_after = true};
+        }
+
+        /**
+         * @brief Call from the serial interrupt handler. Collects the halfwords of the transfer and loads the next one.
+         */
+        void on_serial() noexcept {
+            const auto cnt = *mmio::SIOCNT_MULTI;
+            if (cnt.error) {
+                m_aligned = false;
+                m_position = Words - 1;
+                load_next();
+                return;
+            }
+
+            const auto position = m_position + 1 == Words ? std::size_t{} : m_position + 1;
+            u16 received[players];
+            for (std::size_t ii = 0; ii < players; ++ii) {
+                received[ii] = mmio::SIOMULTI.get(ii);
+            }
+
+            // Children wait at the start of a slot until the parent sends a header
+            if (position == 0 && cnt.is_child && !is_header(received[0])) {
+                m_aligned = false;
+                return;
+            }
+            m_aligned = true;
+            m_position = position;
+
+            for (std::size_t player = 0; player < players; ++player) {
+                if (player != cnt.id) {
+                    collect(player, position, received[player]);
+                }
+            }
+            load_next();
+        }
+
+        /**
+         * @brief Queues a packet to send to every other player.
+         *
+         * @param value Packet to send.
+         * @return False if the send queue is full.
+         */
+        bool send(const packet& value) noexcept {
+            return m_send.push(value);
+        }
+
+        /**
+         * @brief Takes the oldest packet received from a player.
+         *
+         * @param player Player ID (0 is the parent).
+         * @param value Receives the packet.
+         * @return False if no packet is waiting.
+         */
+        bool receive(std::size_t player, packet& value) noexcept {
+            return m_receive[player].pop(value);
+        }
+
+        /**
+         * @brief Number of packets waiting from a player.
+         *
+         * @param player Player ID.
+         */
+        [[nodiscard]]
+        std::size_t pending(std::size_t player) const noexcept {
+            return m_receive[player].size();
+        }
+
+        /**
+         * @brief Number of packets queued to send.
+         */
+        [[nodiscard]]
+        std::size_t queued() const noexcept {
+            return m_send.size();
+        }
+
+        /**
+         * @brief Packets from a player that were missed (sequence gaps) or dropped (full receive queue).
+         *
+         * @param player Player ID.
+         */
+        [[nodiscard]]
+        u32 lost(std::size_t player) const noexcept {
+            return volatile_load(&m_rx[player].lost);
+        }
+
+        /**
+         * @brief This player's ID, valid once connected().
+         */
+        [[nodiscard]]
+        static std::size_t id() noexcept {
+            const auto cnt = *mmio::SIOCNT_MULTI;
+            return cnt.id;
+        }
+
+        /**
+         * @brief True when all connected devices are ready, without errors.
+         */
+        [[nodiscard]]
+        static bool connected() noexcept {
+            const auto cnt = *mmio::SIOCNT_MULTI;
+            return cnt.is_ready && !cnt.error;
+        }
+
+        /**
+         * @brief True when this player is in step with the parent's slots.
+         */
+        [[nodiscard]]
+        bool synchronized() const noexcept {
+            return volatile_load(&m_aligned);
+        }
+
+    private:
+        static constexpr u16 header_data = 0xA500;
+        static constexpr u16 header_idle = 0x5A00;
+
+        struct receiver {
+            packet data;
+            u32 lost;
+            u8 expected;
+            bool active;
+            bool seen;
+        };
+
+        static constexpr bool is_header(u16 value) noexcept {
+            return (value & 0xff00) == header_data || value == header_idle;
+        }
+
+        void collect(std::size_t player, std::size_t position, u16 value) noexcept {
+            auto& rx = m_rx[player];
+            if (position == 0) {
+                rx.active = (value & 0xff00) == header_data;
+                if (rx.active) {
+                    const auto seq = u8(value);
+                    if (rx.seen) {
+                        rx.lost += u8(seq - rx.expected);
+                    }
+                    rx.expected = u8(seq + 1);
+                    rx.seen = true;
+                }
+                return;
+            }
+            if (!rx.active) {
+                return;
+            }
+
+            rx.data[position - 1] = value;
+            if (position == Words - 1) {
+                rx.active = false;
+                if (!m_receive[player].push(rx.data)) {
+                    ++rx.lost;
+                }
+            }
+        }
+
+        // Loads the halfword for the transfer after m_position
+        void load_next() noexcept {
+            const auto next = m_position + 1 == Words ? std::size_t{} : m_position + 1;
+
+            u16 value;
+            if (next == 0) {
+                // A packet stays current until its whole slot has gone out, so re-sending a header keeps its sequence
+                if (!m_tx_active) {
+                    m_tx_active = m_send.pop(m_tx);
+                }
+                value = m_tx_active ? u16(header_data | m_tx_seq) : header_idle;
+            } else {
+                value = m_tx_active ? m_tx[next - 1] : u16{};
+                if (m_tx_active && next == Words - 1) {
+                    m_tx_active = false;
+                    ++m_tx_seq;
+                }
+            }
+            mmio::SIOMLT_SEND = value;
+        }
+
+        ring_buffer<packet, Depth> m_send{};
+        ring_buffer<packet, Depth> m_receive[players]{};
+
+        // Owned by the serial interrupt
+        receiver m_rx[players]{};
+        packet m_tx{};
+        std::size_t m_position{Words - 1};
+        u8 m_tx_seq{};
+        bool m_tx_active{};
+        bool m_aligned{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_HARDWARE_MULTIPLAYER_HPP
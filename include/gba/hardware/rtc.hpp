@@ -0,0 +1,304 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_HARDWARE_RTC_HPP
+#define GBAXX_HARDWARE_RTC_HPP
+/** @file */
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+#include <gba/interrupt/guard.hpp>
+
+namespace gba {
+
+    /**
+     * @struct rtc_datetime
+     * @brief Date and time of the cartridge real time clock, in binary (not BCD).
+     *
+     * @sa rtc
+     */
+    struct rtc_datetime {
+        u8 year; /**< 0 to 99 (2000 to 2099). */
+        u8 month; /**< 1 to 12. */
+        u8 day; /**< 1 to 31. */
+        u8 weekday; /**< 0 to 6. */
+        u8 hour; /**< 0 to 23. */
+        u8 minute; /**< 0 to 59. */
+        u8 second; /**< 0 to 59. */
+    };
+
+    namespace detail {
+
+        // GPIO pins of the S-3511
+        inline constexpr u16 rtc_sck = 1;
+        inline constexpr u16 rtc_sio = 2;
+        inline constexpr u16 rtc_cs = 4;
+
+        // Command bytes (sent MSB first), with bit 0 set to read
+        inline constexpr u8 rtc_reset = 0x60;
+        inline constexpr u8 rtc_status = 0x62;
+        inline constexpr u8 rtc_date_time = 0x64;
+        inline constexpr u8 rtc_read = 0x01;
+
+        inline constexpr u8 rtc_status_24h = 0x40;
+        inline constexpr u8 rtc_status_power = 0x80;
+
+        inline void rtc_begin(u8 command) noexcept {
+            mmio::IO_PORT_DATA = rtc_sck;
+            mmio::IO_PORT_DATA = rtc_sck | rtc_cs;
+            mmio::IO_PORT_DIRECTION = {.direction = rtc_sck | rtc_sio | rtc_cs};
+
+            for (auto ii = 8; ii--;) {
+                const auto bit = u16(((command >> ii) & 1) << 1);
+                // Written repeatedly to hold SCK low for the chip's setup time
+                mmio::IO_PORT_DATA = bit | rtc_cs;
+                mmio::IO_PORT_DATA = bit | rtc_cs;
+                mmio::IO_PORT_DATA = bit | rtc_cs;
+                mmio::IO_PORT_DATA = bit | rtc_sck | rtc_cs;
+            }
+        }
+
+        inline void rtc_end() noexcept {
+            mmio::IO_PORT_DATA = rtc_sck;
+            mmio::IO_PORT_DATA = rtc_sck;
+        }
+
+        // Data bytes are LSB first
+        inline void rtc_write_byte(u8 value) noexcept {
+            for (auto ii = 0; ii < 8; ++ii) {
+                const auto bit = u16(((value >> ii) & 1) << 1);
+                mmio::IO_PORT_DATA = bit | rtc_cs;
+                mmio::IO_PORT_DATA = bit | rtc_cs;
+                mmio::IO_PORT_DATA = bit | rtc_cs;
+                mmio::IO_PORT_DATA = bit | rtc_sck | rtc_cs;
+            }
+        }
+
+        inline u8 rtc_read_byte() noexcept {
+            u8 value = 0;
+            for (auto ii = 0; ii < 8; ++ii) {
+                mmio::IO_PORT_DATA = rtc_cs;
+                mmio::IO_PORT_DATA = rtc_cs;
+                mmio::IO_PORT_DATA = rtc_cs;
+                mmio::IO_PORT_DATA = rtc_cs;
+                mmio::IO_PORT_DATA = rtc_cs;
+                mmio::IO_PORT_DATA = rtc_sck | rtc_cs;
+                value = u8((value >> 1) | (((*mmio::IO_PORT_DATA & rtc_sio) >> 1) << 7));
+            }
+            return value;
+        }
+
+        constexpr bool rtc_from_bcd(u8 bcd, u8 max, u8& value) noexcept {
+            if ((bcd & 0xF) > 9 || (bcd >> 4) > 9) {
+                return false;
+            }
+            value = u8((bcd >> 4) * 10 + (bcd & 0xF));
+            return value <= max;
+        }
+
+        constexpr u8 rtc_to_bcd(u8 value) noexcept {
+            return u8(((value / 10) << 4) | (value % 10));
+        }
+
+    } // namespace detail
+
+    /**
+     * @class rtc
+     * @brief Driver for the Seiko S-3511 real time clock on the cartridge GPIO port, with a cached date and time.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#gba-cart-real-time-clock-rtc">GBA Cart Real-Time Clock (RTC)</a>
+     *
+     * Reading the clock means bit-banging 64 bits through mmio::IO_PORT_DATA, which costs thousands of cycles. rtc reads
+     * it once per second from a timer interrupt (see start()), and get() returns the cached copy, so the game can ask
+     * for the time every frame for free.
+     *
+     * @tparam Timer Timer used by start().
+     *
+     * @code{cpp}
+     * #include <gba/gba.hpp>
+     *
+     * static gba::rtc<> rtc_clock;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     interrupt::install();
+     *     interrupt::set_handler({.timer1 = true}, [] { rtc_clock.on_timer(); });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true, .timer1 = true};
+     *     mmio::IME = true;
+     *
+     *     if (rtc_clock.init()) {
+     *         rtc_clock.start();
+     *     }
+     *
+     *     while (true) {
+     *         const auto now = rtc_clock.get();
+     *         // Draw now.hour, now.minute...
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note The RTC uses GPIO pins 0 to 2, and leaves pin 3 as an input.
+     *
+     * @sa rtc_datetime
+     * @sa mmio::IO_PORT_DATA
+     */
+    template <u32 Timer = 1> requires (Timer < 4)
+    class rtc {
+    public:
+        constexpr rtc() noexcept = default;
+
+        rtc(const rtc&) = delete;
+        rtc& operator=(const rtc&) = delete;
+
+        /**
+         * @brief Enables the GPIO port, resets the clock if it lost power, selects 24 hour mode, and reads the time.
+         *
+         * @return False if no working RTC responded.
+         */
+        bool init() noexcept {
+            mmio::IO_PORT_CONTROL = {.enabled = true};
+
+            auto status = read_status();
+            if (status & detail::rtc_status_power) {
+                detail::rtc_begin(detail::rtc_reset);
+                detail::rtc_end();
+                status = read_status();
+            }
+            if (!(status & detail::rtc_status_24h)) {
+                write_status(u8(status | detail::rtc_status_24h));
+            }
+
+            m_present = sync();
+            return m_present;
+        }
+
+        /**
+         * @brief Tests if init() found a working RTC.
+         */
+        [[nodiscard]]
+        bool present() const noexcept {
+            return m_present;
+        }
+
+        /**
+         * @brief Starts a 1Hz timer for on_timer().
+         */
+        void start() noexcept {
+            volatile_store(&mmio::TIMER_CONTROL[Timer], tmcnt_h{});
+            volatile_store(&mmio::TIMER_RELOAD[Timer], u16(-16384)); // 16.78MHz / 1024
+            volatile_store(&mmio::TIMER_CONTROL[Timer], tmcnt_h{.scale = timer_scale::_1024, .overflow_irq = true, .enabled = true});
+        }
+
+        /**
+         * @brief Stops the timer started by start().
+         */
+        void stop() noexcept {
+            volatile_store(&mmio::TIMER_CONTROL[Timer], tmcnt_h{});
+        }
+
+        /**
+         * @brief Call from the interrupt handler of the timer.
+         */
+        void on_timer() noexcept {
+            sync();
+        }
+
+        /**
+         * @brief Reads the clock into the cache.
+         *
+         * @return False if the clock returned an invalid date or time, in which case the cache is unchanged.
+         */
+        bool sync() noexcept {
+            u8 bcd[7];
+            {
+                irq_guard guard;
+                detail::rtc_begin(detail::rtc_date_time | detail::rtc_read);
+                mmio::IO_PORT_DIRECTION = {.direction = detail::rtc_sck | detail::rtc_cs};
+                for (auto& byte : bcd) {
+                    byte = detail::rtc_read_byte();
+                }
+                detail::rtc_end();
+            }
+            bcd[4] &= 0x3F; // Clear the PM flag
+
+            rtc_datetime time;
+            if (!detail::rtc_from_bcd(bcd[0], 99, time.year) ||
+                !detail::rtc_from_bcd(bcd[1], 12, time.month) ||
+                !detail::rtc_from_bcd(bcd[2], 31, time.day) ||
+                !detail::rtc_from_bcd(bcd[3], 6, time.weekday) ||
+                !detail::rtc_from_bcd(bcd[4], 23, time.hour) ||
+                !detail::rtc_from_bcd(bcd[5], 59, time.minute) ||
+                !detail::rtc_from_bcd(bcd[6], 59, time.second) ||
+                !time.month || !time.day) {
+                return false;
+            }
+
+            irq_guard guard;
+            m_time = time;
+            return true;
+        }
+
+        /**
+         * @brief The date and time of the last sync().
+         */
+        [[nodiscard]]
+        rtc_datetime get() const noexcept {
+            irq_guard guard;
+            return m_time;
+        }
+
+        /**
+         * @brief Sets the clock, and the cache.
+         *
+         * @param time New date and time.
+         */
+        void set(const rtc_datetime& time) noexcept {
+            const u8 bcd[7] = {
+                detail::rtc_to_bcd(time.year), detail::rtc_to_bcd(time.month), detail::rtc_to_bcd(time.day),
+                detail::rtc_to_bcd(time.weekday), detail::rtc_to_bcd(time.hour), detail::rtc_to_bcd(time.minute),
+                detail::rtc_to_bcd(time.second)
+            };
+
+            irq_guard guard;
+            detail::rtc_begin(detail::rtc_date_time);
+            for (const auto byte : bcd) {
+                detail::rtc_write_byte(byte);
+            }
+            detail::rtc_end();
+            m_time = time;
+        }
+
+    private:
+        static u8 read_status() noexcept {
+            irq_guard guard;
+            detail::rtc_begin(detail::rtc_status | detail::rtc_read);
+            mmio::IO_PORT_DIRECTION = {.direction = detail::rtc_sck | detail::rtc_cs};
+            const auto status = detail::rtc_read_byte();
+            detail::rtc_end();
+            return status;
+        }
+
+        static void write_status(u8 status) noexcept {
+            irq_guard guard;
+            detail::rtc_begin(detail::rtc_status);
+            detail::rtc_write_byte(status);
+            detail::rtc_end();
+        }
+
+        rtc_datetime m_time{};
+        bool m_present{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_HARDWARE_RTC_HPP
@@ -0,0 +1,136 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_HARDWARE_RUMBLE_HPP
+#define GBAXX_HARDWARE_RUMBLE_HPP
+/** @file */
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+namespace gba {
+
+    /**
+     * @class rumble
+     * @brief Driver for a rumble motor on cartridge GPIO pin 3.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#gba-cart-rumble">GBA Cart Rumble</a>
+     *
+     * The motor is either on or off, so weaker levels are made by switching it on for some frames of every 4. update()
+     * is called once per frame, and only writes mmio::IO_PORT_DATA when the motor actually changes state.
+     *
+     * @code{cpp}
+     * #include <gba/gba.hpp>
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true};
+     *     mmio::IME = true;
+     *
+     *     rumble motor;
+     *     motor.init();
+     *
+     *     keystate keys{};
+     *     while (true) {
+     *         keys = *mmio::KEYINPUT;
+     *         if (keys.pressed(key::a)) {
+     *             motor.pulse(30, 2); // Half strength for half a second
+     *         }
+     *         motor.update();
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @sa mmio::IO_PORT_DATA
+     */
+    class rumble {
+    public:
+        static constexpr u8 max_level = 4;
+
+        constexpr rumble() noexcept = default;
+
+        /**
+         * @brief Enables the GPIO port, and sets pin 3 as an output with the motor off.
+         */
+        void init() noexcept {
+            mmio::IO_PORT_CONTROL = {.enabled = true};
+            mmio::IO_PORT_DIRECTION = {.direction = pin};
+            m_on = false;
+            mmio::IO_PORT_DATA = 0;
+        }
+
+        /**
+         * @brief Sets the strength until changed.
+         *
+         * @param level 0 (off) to max_level (always on).
+         */
+        void set(u8 level) noexcept {
+            m_level = level > max_level ? max_level : level;
+            m_frames = 0;
+        }
+
+        /**
+         * @brief Sets the strength for a number of frames, then switches off.
+         *
+         * @param frames Duration in calls to update().
+         * @param level 1 to max_level.
+         */
+        void pulse(u16 frames, u8 level = max_level) noexcept {
+            set(level);
+            m_frames = frames;
+        }
+
+        /**
+         * @brief Switches the motor off.
+         */
+        void stop() noexcept {
+            set(0);
+            write(false);
+        }
+
+        /**
+         * @brief Call once per frame.
+         */
+        void update() noexcept {
+            if (m_frames && !--m_frames) {
+                m_level = 0;
+            }
+            m_phase = u8((m_phase + 1) % max_level);
+            write(m_phase < m_level);
+        }
+
+        /**
+         * @brief Tests if the motor is currently switched on.
+         */
+        [[nodiscard]]
+        bool active() const noexcept {
+            return m_on;
+        }
+
+    private:
+        static constexpr u16 pin = 8;
+
+        void write(bool on) noexcept {
+            if (on != m_on) {
+                m_on = on;
+                mmio::IO_PORT_DATA = on ? pin : 0;
+            }
+        }
+
+        u16 m_frames{};
+        u8 m_level{};
+        u8 m_phase{};
+        bool m_on{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_HARDWARE_RUMBLE_HPP
@@ -0,0 +1,391 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_HARDWARE_SAVE_HPP
+#define GBAXX_HARDWARE_SAVE_HPP
+/** @file */
+
+#include <cstddef>
+
+#include <gba/type.hpp>
+
+#include <gba/hardware/dmahelper.hpp>
+#include <gba/interrupt/guard.hpp>
+
+namespace gba::save {
+
+    /**
+     * @enum chip
+     * @brief Type of save memory on the game pak.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#gba-cart-backup-ids">GBA Cart Backup IDs</a>
+     *
+     * @sa detect()
+     * @sa device
+     */
+    enum class chip : u8 {
+        none,
+        sram_32k, /**< 32KB battery backed SRAM (or FRAM). */
+        flash_64k, /**< 64KB Flash with 4KB sectors. */
+        flash_64k_atmel, /**< 64KB Atmel Flash, written in 128 byte pages without erasing. */
+        flash_128k, /**< 128KB Flash in two 64KB banks. */
+        eeprom_512, /**< 512 byte EEPROM. */
+        eeprom_8k /**< 8KB EEPROM. */
+    };
+
+    namespace detail {
+
+        inline auto* const sram = reinterpret_cast<volatile u8*>(gba::detail::mapped_address(0xE000000));
+        inline auto* const eeprom = reinterpret_cast<volatile u16*>(gba::detail::mapped_address(0xDFFFF00)); // Valid for every ROM size
+
+        [[gnu::always_inline]]
+        inline void flash_command(u8 command) noexcept {
+            sram[0x5555] = 0xAA;
+            sram[0x2AAA] = 0x55;
+            sram[0x5555] = command;
+        }
+
+        // Runs from IWRAM, as the game pak bus returns the ID instead of data until ID mode is left
+        [[gnu::section(".iwram._gba_save_flash_id"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline u16 flash_id() noexcept {
+            flash_command(0x90);
+            for (int ii = 0; ii < 0x100; ++ii) {
+                static_cast<void>(sram[0]); // Some chips take a moment to enter ID mode
+            }
+            const auto id = u16(sram[0] | (sram[1] << 8));
+            flash_command(0xF0);
+            sram[0x5555] = 0xF0;
+            return id;
+        }
+
+        inline chip flash_chip(u16 id) noexcept {
+            switch (id) {
+                case 0xD4BF: // SST
+                case 0x1CC2: // Macronix
+                case 0x1B32: // Panasonic
+                    return chip::flash_64k;
+                case 0x3D1F: // Atmel
+                    return chip::flash_64k_atmel;
+                case 0x1362: // Sanyo
+                case 0x09C2: // Macronix
+                    return chip::flash_128k;
+                default:
+                    return chip::none;
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Size of a save chip in bytes.
+     *
+     * @param type Save chip.
+     */
+    constexpr std::size_t capacity(chip type) noexcept {
+        switch (type) {
+            case chip::sram_32k: return 0x8000;
+            case chip::flash_64k: return 0x10000;
+            case chip::flash_64k_atmel: return 0x10000;
+            case chip::flash_128k: return 0x20000;
+            case chip::eeprom_512: return 0x200;
+            case chip::eeprom_8k: return 0x2000;
+            default: return 0;
+        }
+    }
+
+    /**
+     * @brief Probes the game pak for Flash or SRAM.
+     *
+     * Flash is identified by its manufacturer and device ID, and SRAM by writing (and restoring) its first byte.
+     *
+     * The Flash ID command writes to bytes 0x5555 and 0x2AAA, so on SRAM both are read beforehand and restored when
+     * no Flash ID is returned. Save data is left unchanged either way.
+     *
+     * @return Detected save chip, or chip::none.
+     *
+     * @note EEPROM cannot be probed without risking its contents, so it is never reported. Games using EEPROM pass
+     *       chip::eeprom_512 or chip::eeprom_8k to device directly.
+     * @note Save memory access requires mmio::WAITCNT::sram to be 3 (8 cycles), which is the reset value.
+     */
+    inline chip detect() noexcept {
+        irq_guard guard;
+
+        // SRAM takes the Flash command bytes as data
+        const u8 command_high = detail::sram[0x5555];
+        const u8 command_low = detail::sram[0x2AAA];
+
+        if (const auto type = detail::flash_chip(detail::flash_id()); type != chip::none) {
+            return type;
+        }
+
+        detail::sram[0x5555] = command_high;
+        detail::sram[0x2AAA] = command_low;
+
+        const u8 original = detail::sram[0];
+        detail::sram[0] = u8(~original);
+        const bool writable = detail::sram[0] == u8(~original);
+        detail::sram[0] = original;
+        return writable ? chip::sram_32k : chip::none;
+    }
+
+    /**
+     * @class device
+     * @brief Non-blocking access to a save chip.
+     *
+     * Reads are immediate. Erases and writes are started by start_erase() and start_write(), and complete in the
+     * background while busy() is true, so they can be spread over many frames by a state machine (see journal).
+     *
+     * <table><thead><tr><th>Chip</th><th>Erase unit</th><th>Write unit</th><th>Write time</th></tr></thead><tbody>
+     * <tr><td>SRAM</td><td>None</td><td>64 bytes</td><td>Immediate</td></tr>
+     * <tr><td>Flash</td><td>4KB sector</td><td>1 byte</td><td>~20us (erase ~20ms to 500ms)</td></tr>
+     * <tr><td>Atmel Flash</td><td>None</td><td>128 byte page</td><td>~10ms</td></tr>
+     * <tr><td>EEPROM</td><td>None</td><td>8 bytes</td><td>~7ms</td></tr>
+     * </tbody></table>
+     *
+     * @note EEPROM transfers use DMA 3, which must not be busy with a queued (non-immediate) transfer at the time.
+     *
+     * @sa detect()
+     * @sa journal
+     */
+    class device {
+    public:
+        constexpr device() noexcept = default;
+        constexpr explicit device(chip type) noexcept : m_type{type} {}
+
+        [[nodiscard]]
+        constexpr chip type() const noexcept {
+            return m_type;
+        }
+
+        [[nodiscard]]
+        constexpr std::size_t size() const noexcept {
+            return capacity(m_type);
+        }
+
+        /**
+         * @brief Bytes cleared by start_erase(), or 0 if the chip is written without erasing.
+         */
+        [[nodiscard]]
+        constexpr std::size_t erase_size() const noexcept {
+            return m_type == chip::flash_64k || m_type == chip::flash_128k ? 0x1000 : 0;
+        }
+
+        /**
+         * @brief Bytes written by each start_write().
+         */
+        [[nodiscard]]
+        constexpr std::size_t write_size() const noexcept {
+            switch (m_type) {
+                case chip::sram_32k: return 64;
+                case chip::flash_64k_atmel: return 128;
+                case chip::eeprom_512:
+                case chip::eeprom_8k: return 8;
+                default: return 1;
+            }
+        }
+
+        /**
+         * @brief True for the chips whose writes finish within microseconds, so busy() may be polled in a loop.
+         */
+        [[nodiscard]]
+        constexpr bool fast_writes() const noexcept {
+            return m_type == chip::sram_32k || m_type == chip::flash_64k || m_type == chip::flash_128k;
+        }
+
+        /**
+         * @brief Reads save memory.
+         *
+         * @param offset First byte to read. EEPROM offsets must be multiples of 8.
+         * @param dest Destination.
+         * @param length Bytes to read. EEPROM lengths must be multiples of 8.
+         */
+        void read(std::size_t offset, void* dest, std::size_t length) noexcept {
+            auto* out = static_cast<u8*>(dest);
+            if (is_eeprom()) {
+                for (std::size_t ii = 0; ii < length; ii += 8) {
+                    eeprom_read(u32((offset + ii) / 8), out + ii);
+                }
+                return;
+            }
+            for (std::size_t ii = 0; ii < length; ++ii) {
+                out[ii] = detail::sram[bank_offset(offset + ii)];
+            }
+        }
+
+        /**
+         * @brief Starts erasing the Flash sector at an offset.
+         *
+         * @param offset Offset of the sector, a multiple of erase_size().
+         */
+        void start_erase(std::size_t offset) noexcept {
+            if (!erase_size()) {
+                return;
+            }
+            irq_guard guard;
+            const auto address = bank_offset(offset);
+            detail::flash_command(0x80);
+            detail::sram[0x5555] = 0xAA;
+            detail::sram[0x2AAA] = 0x55;
+            detail::sram[address] = 0x30;
+            m_pending = address;
+            m_expected = 0xFF;
+        }
+
+        /**
+         * @brief Starts writing one write_size() unit.
+         *
+         * @param offset Offset of the unit, a multiple of write_size().
+         * @param src Data of the unit.
+         */
+        void start_write(std::size_t offset, const u8* src) noexcept {
+            switch (m_type) {
+                case chip::sram_32k:
+                    for (std::size_t ii = 0; ii < 64; ++ii) {
+                        detail::sram[offset + ii] = src[ii];
+                    }
+                    break;
+                case chip::flash_64k:
+                case chip::flash_128k: {
+                    irq_guard guard;
+                    const auto address = bank_offset(offset);
+                    detail::flash_command(0xA0);
+                    detail::sram[address] = src[0];
+                    m_pending = address;
+                    m_expected = src[0];
+                    break;
+                }
+                case chip::flash_64k_atmel: {
+                    irq_guard guard;
+                    detail::flash_command(0xA0);
+                    for (std::size_t ii = 0; ii < 128; ++ii) {
+                        detail::sram[offset + ii] = src[ii];
+                    }
+                    m_pending = offset + 127;
+                    m_expected = src[127];
+                    break;
+                }
+                case chip::eeprom_512:
+                case chip::eeprom_8k:
+                    eeprom_write(u32(offset / 8), src);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        /**
+         * @brief Tests if the last erase or write is still in progress.
+         */
+        [[nodiscard]]
+        bool busy() noexcept {
+            if (is_eeprom()) {
+                if (!m_eeprom_busy) {
+                    return false;
+                }
+                m_eeprom_busy = (*detail::eeprom & 1) == 0;
+                return m_eeprom_busy;
+            }
+            if (m_pending == no_pending) {
+                return false;
+            }
+            if (detail::sram[m_pending] != m_expected) {
+                return true;
+            }
+            m_pending = no_pending;
+            return false;
+        }
+
+        /**
+         * @brief Polls busy() up to a number of times.
+         *
+         * @param polls Maximum number of polls.
+         * @return True if the chip is ready.
+         */
+        bool wait(u32 polls) noexcept {
+            while (busy()) {
+                if (!polls--) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        static constexpr std::size_t no_pending = ~std::size_t{};
+
+        [[nodiscard]]
+        constexpr bool is_eeprom() const noexcept {
+            return m_type == chip::eeprom_512 || m_type == chip::eeprom_8k;
+        }
+
+        // Selects the 64KB bank of 128KB Flash, returning the offset within it
+        std::size_t bank_offset(std::size_t offset) noexcept {
+            if (m_type == chip::flash_128k) {
+                const auto bank = u8(offset >> 16);
+                if (bank != m_bank) {
+                    irq_guard guard;
+                    detail::flash_command(0xB0);
+                    detail::sram[0] = bank;
+                    m_bank = bank;
+                }
+            }
+            return offset & 0xFFFF;
+        }
+
+        // Request bits: 2 command bits, the address MSB first (6 or 14 bits), then a stop bit
+        std::size_t eeprom_request(u16* bits, u32 command, u32 block) const noexcept {
+            const auto address_bits = m_type == chip::eeprom_8k ? 14u : 6u;
+            std::size_t n = 0;
+            bits[n++] = u16(command >> 1);
+            bits[n++] = u16(command & 1);
+            for (auto ii = address_bits; ii--;) {
+                bits[n++] = u16((block >> ii) & 1);
+            }
+            return n;
+        }
+
+        void eeprom_read(u32 block, u8* dest) noexcept {
+            u16 bits[68];
+            auto n = eeprom_request(bits, 0b11, block);
+            bits[n++] = 0;
+            dma<3>::copy(static_cast<const u16*>(bits), detail::eeprom, n);
+            dma<3>::copy(static_cast<const volatile u16*>(detail::eeprom), bits, 68);
+
+            // 4 ignored bits, then 64 data bits MSB first
+            for (std::size_t ii = 0; ii < 8; ++ii) {
+                u8 value = 0;
+                for (std::size_t jj = 0; jj < 8; ++jj) {
+                    value = u8((value << 1) | (bits[4 + ii * 8 + jj] & 1));
+                }
+                dest[ii] = value;
+            }
+        }
+
+        void eeprom_write(u32 block, const u8* src) noexcept {
+            u16 bits[81];
+            auto n = eeprom_request(bits, 0b10, block);
+            for (std::size_t ii = 0; ii < 8; ++ii) {
+                for (auto jj = 8u; jj--;) {
+                    bits[n++] = u16((src[ii] >> jj) & 1);
+                }
+            }
+            bits[n++] = 0;
+            dma<3>::copy(static_cast<const u16*>(bits), detail::eeprom, n);
+            m_eeprom_busy = true;
+        }
+
+        chip m_type{};
+        u8 m_bank{};
+        u8 m_expected{};
+        bool m_eeprom_busy{};
+        std::size_t m_pending{no_pending};
+    };
+
+} // namespace gba::save
+
+#endif // define GBAXX_HARDWARE_SAVE_HPP
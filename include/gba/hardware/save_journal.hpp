@@ -0,0 +1,512 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_HARDWARE_SAVE_JOURNAL_HPP
+#define GBAXX_HARDWARE_SAVE_JOURNAL_HPP
+/** @file */
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include <gba/type.hpp>
+
+#include <gba/hardware/save.hpp>
+
+namespace gba::save {
+
+    /**
+     * @class journal
+     * @brief RAM image of a save file, written back to save memory one dirty block at a time in the background.
+     *
+     * The save chip is divided into physical blocks (a 4KB sector for Flash, 256 bytes of SRAM, or 64 bytes of EEPROM)
+     * which hold one logical block of the image each, followed by a footer with the logical block number, a sequence
+     * number, and a checksum. There is always at least one more physical block than logical blocks.
+     *
+     * Game code changes the image with write() (or edits data() and calls mark()), which only marks the affected logical
+     * blocks dirty. step() then advances a small state machine by a bounded amount of work: it snapshots a dirty block,
+     * erases a free physical block, programs it a few bytes at a time, verifies it, and only then retires the physical
+     * block that held the previous copy. Each call returns quickly, even while a Flash sector erase is in progress, so
+     * step() can be called every frame or from a timer interrupt without ever stalling the game.
+     *
+     * A reset or power loss mid-write loses at most the block being written, as its previous copy is still intact;
+     * mount() keeps the newest valid copy of each logical block.
+     *
+     * The writer is a state machine rather than an agbabi::fiber: its whole state is a few words of the journal, where
+     * a fiber would need a stack of its own, and it may be stepped from an interrupt handler without switching stacks.
+     *
+     * @tparam Size Bytes in the save image.
+     * @tparam Budget Bytes programmed or verified by each step().
+     *
+     * @code{cpp}
+     * // Saving settings without a "Saving..." screen
+     *
+     * #include <gba/gba.hpp>
+     *
+     * struct settings {
+     *     int volume;
+     *     int brightness;
+     * };
+     *
+     * GBAXX_EWRAM_DATA
+     * static gba::save::journal<0x400> save_file;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     save_file.mount(save::detect());
+     *
+     *     settings current;
+     *     save_file.read(0, &current, sizeof(current));
+     *
+     *     while (true) {
+     *         // Change current from the menu...
+     *
+     *         save_file.write(0, &current, sizeof(current)); // Only marks blocks that actually changed
+     *         save_file.step();
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note A journal needs Size bytes for the image plus 4KB for the block being written, so is best placed in EWRAM.
+     * @note step() must not interrupt itself, but may interrupt write() and mark(). A block changed while it is being
+     *       written is marked dirty again, and written again.
+     *
+     * @sa device
+     */
+    template <std::size_t Size, std::size_t Budget = 64> requires (Size > 0 && Budget > 0)
+    class journal {
+    public:
+        static constexpr std::size_t footer_size = 8;
+        static constexpr std::size_t max_block_size = 0x1000;
+        static constexpr std::size_t max_blocks = std::min<std::size_t>((Size + 55) / 56, 127); // Limited by 128 physical blocks
+
+        constexpr journal() noexcept = default;
+
+        journal(const journal&) = delete;
+        journal& operator=(const journal&) = delete;
+
+        /**
+         * @brief Size of the physical blocks used on a save chip.
+         *
+         * @param type Save chip.
+         */
+        static constexpr std::size_t block_size(chip type) noexcept {
+            switch (type) {
+                case chip::sram_32k: return 0x100;
+                case chip::flash_64k:
+                case chip::flash_64k_atmel:
+                case chip::flash_128k: return 0x1000;
+                case chip::eeprom_512:
+                case chip::eeprom_8k: return 0x40;
+                default: return 0;
+            }
+        }
+
+        /**
+         * @brief Largest save image a save chip can journal.
+         *
+         * @param type Save chip.
+         */
+        static constexpr std::size_t max_size(chip type) noexcept {
+            const auto block = block_size(type);
+            if (!block) {
+                return 0;
+            }
+            return (capacity(type) / block - 1) * (block - footer_size);
+        }
+
+        /**
+         * @brief Loads the newest valid copy of every block from a save chip.
+         *
+         * Blocks with no valid copy (such as on a blank chip) read as 0xFF.
+         *
+         * @param type Save chip.
+         * @return False if the image does not fit on the chip.
+         */
+        bool mount(chip type) noexcept {
+            m_state = state::idle;
+            m_failed = false;
+            std::fill(std::begin(m_dirty), std::end(m_dirty), 0u);
+            std::fill(std::begin(m_image), std::end(m_image), u8(0xFF));
+
+            if (Size > max_size(type)) {
+                m_device = device{};
+                m_logical = 0;
+                return false;
+            }
+
+            m_device = device{type};
+            m_block_size = u16(block_size(type));
+            m_physical = u8(m_device.size() / m_block_size);
+            m_logical = u8((Size + payload() - 1) / payload());
+            m_next = 0;
+            std::fill(std::begin(m_map), std::end(m_map), no_block);
+            std::fill(std::begin(m_used), std::end(m_used), 0u);
+
+            for (u32 physical = 0; physical < m_physical; ++physical) {
+                m_device.read(physical * m_block_size, m_block, m_block_size);
+
+                const auto logical = footer_logical();
+                if (logical >= m_logical || footer_checksum() != checksum()) {
+                    continue;
+                }
+
+                const auto sequence = footer_sequence();
+                if (m_map[logical] != no_block) {
+                    if (std::int16_t(sequence - m_sequence[logical]) <= 0) {
+                        continue;
+                    }
+                    release(m_map[logical]);
+                }
+
+                m_map[logical] = u8(physical);
+                m_sequence[logical] = sequence;
+                claim(physical);
+                std::copy_n(m_block, block_bytes(logical), m_image + logical * payload());
+            }
+            return true;
+        }
+
+        /**
+         * @brief The save image.
+         *
+         * @note Call mark() after changing the image directly.
+         */
+        [[nodiscard]]
+        constexpr u8* data() noexcept {
+            return m_image;
+        }
+
+        [[nodiscard]]
+        constexpr const u8* data() const noexcept {
+            return m_image;
+        }
+
+        [[nodiscard]]
+        static constexpr std::size_t size() noexcept {
+            return Size;
+        }
+
+        /**
+         * @brief Copies bytes out of the save image.
+         *
+         * @param offset First byte to read.
+         * @param dest Destination.
+         * @param length Bytes to read.
+         * @return False if the range is outside of the image.
+         */
+        bool read(std::size_t offset, void* dest, std::size_t length) const noexcept {
+            if (offset > Size || length > Size - offset) {
+                return false;
+            }
+            std::copy_n(m_image + offset, length, static_cast<u8*>(dest));
+            return true;
+        }
+
+        /**
+         * @brief Copies bytes into the save image, and marks the changed blocks dirty.
+         *
+         * Unchanged bytes are skipped, so rewriting identical data does not wear the chip.
+         *
+         * @param offset First byte to write.
+         * @param src Source.
+         * @param length Bytes to write.
+         * @return False if the range is outside of the image.
+         */
+        bool write(std::size_t offset, const void* src, std::size_t length) noexcept {
+            if (offset > Size || length > Size - offset) {
+                return false;
+            }
+            const auto* in = static_cast<const u8*>(src);
+            for (std::size_t ii = 0; ii < length; ++ii) {
+                if (m_image[offset + ii] != in[ii]) {
+                    m_image[offset + ii] = in[ii];
+                    mark(offset + ii, 1);
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Marks a range of the save image dirty, to be written by step().
+         *
+         * @param offset First changed byte.
+         * @param length Number of changed bytes.
+         */
+        void mark(std::size_t offset, std::size_t length) noexcept {
+            if (!m_logical || !length || offset >= Size) {
+                return;
+            }
+            const auto first = offset / payload();
+            const auto last = std::min(offset + length - 1, Size - 1) / payload();
+            std::atomic_signal_fence(std::memory_order_release);
+            for (auto ii = first; ii <= last; ++ii) {
+                m_dirty[ii / 32] = m_dirty[ii / 32] | (1u << (ii % 32));
+            }
+        }
+
+        /**
+         * @brief Advances the background write.
+         *
+         * @return True while there is more work to do.
+         */
+        bool step() noexcept {
+            if (m_failed || !m_logical) {
+                return false;
+            }
+
+            switch (m_state) {
+                case state::idle:
+                    return begin();
+                case state::erase:
+                    if (!m_device.wait(0)) {
+                        return true;
+                    }
+                    m_state = state::program;
+                    m_cursor = 0;
+                    [[fallthrough]];
+                case state::program:
+                    return program();
+                case state::verify:
+                    return verify();
+            }
+            return false;
+        }
+
+        /**
+         * @brief Writes every dirty block, blocking until done.
+         *
+         * @return False if a block failed to write.
+         */
+        bool flush() noexcept {
+            while (step()) {}
+            return !m_failed;
+        }
+
+        /**
+         * @brief Tests if a block is being written, or waiting to be written.
+         */
+        [[nodiscard]]
+        bool busy() const noexcept {
+            if (m_failed) {
+                return false;
+            }
+            if (m_state != state::idle) {
+                return true;
+            }
+            return std::any_of(std::begin(m_dirty), std::end(m_dirty), [](const volatile u32& word) { return word != 0; });
+        }
+
+        /**
+         * @brief Tests if writing stopped because a block failed to verify repeatedly.
+         *
+         * The image is kept, and mount() retries.
+         */
+        [[nodiscard]]
+        bool failed() const noexcept {
+            return m_failed;
+        }
+
+    private:
+        enum class state : u8 {
+            idle,
+            erase,
+            program,
+            verify
+        };
+
+        static constexpr u8 no_block = 0xFF;
+        static constexpr u32 max_retries = 3;
+        static constexpr u32 fast_polls = 1000; // Flash byte programs take ~20us
+
+        [[nodiscard]]
+        std::size_t payload() const noexcept {
+            return m_block_size - footer_size;
+        }
+
+        [[nodiscard]]
+        std::size_t block_bytes(std::size_t logical) const noexcept {
+            return std::min(payload(), Size - logical * payload());
+        }
+
+        void claim(u32 physical) noexcept {
+            m_used[physical / 32] |= 1u << (physical % 32);
+        }
+
+        void release(u32 physical) noexcept {
+            m_used[physical / 32] &= ~(1u << (physical % 32));
+        }
+
+        // Round-robin, so every free block is reused in turn
+        [[nodiscard]]
+        u32 next_free() noexcept {
+            for (u32 ii = 0; ii < m_physical; ++ii) {
+                const auto physical = (m_next + ii) % m_physical;
+                if (!(m_used[physical / 32] & (1u << (physical % 32)))) {
+                    m_next = u8((physical + 1) % m_physical);
+                    return physical;
+                }
+            }
+            return no_block; // Unreachable, as there is always a spare block
+        }
+
+        // Footer: u16 logical, u16 sequence, u32 checksum
+        [[nodiscard]]
+        u16 footer_logical() const noexcept {
+            return u16(m_block[payload()] | (m_block[payload() + 1] << 8));
+        }
+
+        [[nodiscard]]
+        u16 footer_sequence() const noexcept {
+            return u16(m_block[payload() + 2] | (m_block[payload() + 3] << 8));
+        }
+
+        [[nodiscard]]
+        u32 footer_checksum() const noexcept {
+            const auto* footer = m_block + payload() + 4;
+            return u32(footer[0] | (footer[1] << 8) | (footer[2] << 16) | (footer[3] << 24));
+        }
+
+        // FNV-1a of the payload, logical block, and sequence
+        [[nodiscard]]
+        u32 checksum() const noexcept {
+            u32 hash = 0x811c9dc5;
+            for (std::size_t ii = 0; ii < payload() + 4; ++ii) {
+                hash = (hash ^ m_block[ii]) * 0x01000193;
+            }
+            return hash;
+        }
+
+        bool begin() noexcept {
+            u32 logical = 0;
+            for (auto& word : m_dirty) {
+                if (const auto bits = word; bits) {
+                    logical += u32(std::countr_zero(bits));
+                    break;
+                }
+                logical += 32;
+            }
+            if (logical >= m_logical) {
+                return false;
+            }
+
+            // Cleared before the snapshot, so a change made during the write marks the block again
+            m_dirty[logical / 32] = m_dirty[logical / 32] & ~(1u << (logical % 32));
+            std::atomic_signal_fence(std::memory_order_acquire);
+
+            const auto bytes = block_bytes(logical);
+            std::copy_n(m_image + logical * payload(), bytes, m_block);
+            std::fill(m_block + bytes, m_block + payload(), u8(0xFF));
+
+            const auto sequence = u16(m_sequence[logical] + 1);
+            m_block[payload()] = u8(logical);
+            m_block[payload() + 1] = 0;
+            m_block[payload() + 2] = u8(sequence);
+            m_block[payload() + 3] = u8(sequence >> 8);
+            const auto hash = checksum();
+            for (std::size_t ii = 0; ii < 4; ++ii) {
+                m_block[payload() + 4 + ii] = u8(hash >> (ii * 8));
+            }
+
+            m_current = u8(logical);
+            m_target = u8(next_free());
+            m_retries = 0;
+            start();
+            return true;
+        }
+
+        void start() noexcept {
+            m_cursor = 0;
+            if (m_device.erase_size()) {
+                m_device.start_erase(m_target * m_block_size);
+                m_state = state::erase;
+            } else {
+                m_state = state::program;
+            }
+        }
+
+        bool program() noexcept {
+            const auto unit = m_device.write_size();
+            const auto polls = m_device.fast_writes() ? fast_polls : 0;
+            for (std::size_t done = 0; done < Budget && m_cursor < m_block_size; done += unit) {
+                if (!m_device.wait(polls)) {
+                    return true;
+                }
+                m_device.start_write(m_target * m_block_size + m_cursor, m_block + m_cursor);
+                m_cursor += unit;
+            }
+            if (m_cursor == m_block_size) {
+                m_state = state::verify;
+                m_cursor = 0;
+            }
+            return true;
+        }
+
+        bool verify() noexcept {
+            if (!m_device.wait(m_device.fast_writes() ? fast_polls : 0)) {
+                return true;
+            }
+
+            // EEPROM reads are in whole 8 byte units
+            const auto length = std::min<std::size_t>((Budget + 7) & ~std::size_t{7}, m_block_size - m_cursor);
+            u8 readback[(Budget + 7) & ~std::size_t{7}];
+            m_device.read(m_target * m_block_size + m_cursor, readback, length);
+            if (!std::equal(readback, readback + length, m_block + m_cursor)) {
+                if (++m_retries > max_retries) {
+                    m_failed = true;
+                    m_state = state::idle;
+                    mark(m_current * payload(), 1);
+                    return false;
+                }
+                start();
+                return true;
+            }
+
+            m_cursor += u16(length);
+            if (m_cursor < m_block_size) {
+                return true;
+            }
+
+            // The new copy is complete, so the previous copy can be retired
+            if (m_map[m_current] != no_block) {
+                release(m_map[m_current]);
+            }
+            claim(m_target);
+            m_map[m_current] = m_target;
+            ++m_sequence[m_current];
+            m_state = state::idle;
+            return busy();
+        }
+
+        device m_device{};
+        u16 m_block_size{};
+        u16 m_cursor{};
+        u8 m_physical{};
+        u8 m_logical{};
+        u8 m_next{};
+        u8 m_current{};
+        u8 m_target{};
+        u8 m_retries{};
+        state m_state{};
+        bool m_failed{};
+        u8 m_map[max_blocks]{};
+        u16 m_sequence[max_blocks]{};
+        u32 m_used[4]{};
+        volatile u32 m_dirty[(max_blocks + 31) / 32]{};
+        alignas(4) u8 m_block[max_block_size]{};
+        alignas(4) u8 m_image[Size]{};
+    };
+
+} // namespace gba::save
+
+#endif // define GBAXX_HARDWARE_SAVE_JOURNAL_HPP
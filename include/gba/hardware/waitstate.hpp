@@ -0,0 +1,153 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_HARDWARE_WAITSTATE_HPP
+#define GBAXX_HARDWARE_WAITSTATE_HPP
+/** @file */
+
+#include <cstddef>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+namespace gba::waitstate {
+
+    /**
+     * @brief Start of Wait State 0 (game pak ROM).
+     */
+    inline const auto* const rom_start = reinterpret_cast<const u32*>(gba::detail::mapped_address(0x8000000));
+
+    /**
+     * @brief Default number of bytes checksummed by tune() and stable().
+     */
+    inline constexpr std::size_t default_size = 0x4000;
+
+    /**
+     * @brief Candidates tried by tune(), fastest first.
+     */
+    inline constexpr waitcnt candidates[] = {waitcnt_fast, waitcnt_default};
+
+    namespace detail {
+
+        // Zero initialized .bss is waitcnt_reset
+        inline constinit waitcnt selected{};
+
+        // Runs entirely from IWRAM with IRQs disabled, so no code is fetched from ROM while the candidate timings are
+        // applied. Reads 4 words at a time so the sequential access timings are exercised along with the first access
+        [[gnu::section(".iwram._gba_waitstate_checksum"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline u32 checksum(const volatile u32* src, std::size_t words, u32 passes, waitcnt candidate, waitcnt restore) noexcept {
+            const auto ime = *mmio::IME;
+            mmio::IME = false;
+            mmio::WAITCNT = candidate;
+
+            u32 sum = 0;
+            while (passes--) {
+                const auto* p = src;
+                for (auto n = words / 4; n; --n) {
+                    const auto a = p[0];
+                    const auto b = p[1];
+                    const auto c = p[2];
+                    const auto d = p[3];
+                    p += 4;
+                    sum = ((sum << 5) | (sum >> 27)) ^ a;
+                    sum = ((sum << 5) | (sum >> 27)) ^ b;
+                    sum = ((sum << 5) | (sum >> 27)) ^ c;
+                    sum = ((sum << 5) | (sum >> 27)) ^ d;
+                }
+            }
+
+            mmio::WAITCNT = restore;
+            mmio::IME = ime;
+            return sum;
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Tests if the cartridge reads correctly with the given timings.
+     *
+     * The region is checksummed under waitcnt_reset timings, then again under the candidate timings. The current
+     * mmio::WAITCNT is restored before returning.
+     *
+     * @param candidate Timings to test.
+     * @param region Start of the ROM region to read, 16-byte aligned.
+     * @param size Bytes to read, a multiple of 16.
+     * @param passes Number of times the region is read under the candidate timings.
+     * @return True if every pass matched the reference checksum.
+     *
+     * @sa tune()
+     */
+    inline bool stable(waitcnt candidate, const u32* region = rom_start, std::size_t size = default_size, u32 passes = 4) noexcept {
+        const auto current = *mmio::WAITCNT;
+        const auto words = size / 4;
+        const auto reference = detail::checksum(region, words, passes, waitcnt_reset, current);
+        return detail::checksum(region, words, passes, candidate, current) == reference;
+    }
+
+    /**
+     * @brief Applies the fastest ROM timings that the cartridge reads correctly.
+     *
+     * Each of the candidates is tried in turn (2/1 cycle Wait State 0 first, then the retail 3/1), falling back to
+     * waitcnt_reset if neither is stable. The chosen timings are written to mmio::WAITCNT and recorded for selected().
+     *
+     * @code{cpp}
+     * #include <gba/gba.hpp>
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     const auto timings = waitstate::tune();
+     *     if (timings.ws0_first == waitcnt_fast.ws0_first) {
+     *         // Running with the fastest ROM access...
+     *     }
+     * }
+     * @endcode
+     *
+     * @param region Start of the ROM region to read, 16-byte aligned.
+     * @param size Bytes to read, a multiple of 16.
+     * @param passes Number of times the region is read under each candidate.
+     * @return The applied timings.
+     *
+     * @note Call once at startup, before any timing sensitive code. Wait State 1, Wait State 2, and SRAM timings are
+     *       taken from the candidates (the same as waitcnt_default).
+     *
+     * @sa stable()
+     * @sa waitcnt_fast
+     * @sa waitcnt_default
+     */
+    inline waitcnt tune(const u32* region = rom_start, std::size_t size = default_size, u32 passes = 4) noexcept {
+        const auto words = size / 4;
+        const auto reference = detail::checksum(region, words, passes, waitcnt_reset, waitcnt_reset);
+
+        auto result = waitcnt_reset;
+        for (const auto& candidate : candidates) {
+            if (detail::checksum(region, words, passes, candidate, waitcnt_reset) == reference) {
+                result = candidate;
+                break;
+            }
+        }
+
+        mmio::WAITCNT = result;
+        detail::selected = result;
+        return result;
+    }
+
+    /**
+     * @brief Timings chosen by the most recent tune().
+     *
+     * @return The applied timings, or waitcnt_reset if tune() has not been called.
+     */
+    [[nodiscard]]
+    inline waitcnt selected() noexcept {
+        return detail::selected;
+    }
+
+} // namespace gba::waitstate
+
+#endif // define GBAXX_HARDWARE_WAITSTATE_HPP
@@ -0,0 +1,141 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_HOST_HPP
+#define GBAXX_HOST_HPP
+/** @file */
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @def GBAXX_HOST
+ * @brief Builds for the host machine instead of the GBA, with the GBA memory map simulated in RAM.
+ *
+ * Defined by the `GBAXX_HOST` CMake option (or the `host` meson option). Code that only computes, such as fixed,
+ * angle, the lookup tables, vectors, and the software decompressors, then compiles natively and runs on a PC, for
+ * quick iteration and for testing and benchmarking in CI.
+ *
+ * In a host build:
+ * - Addresses of registers and video memory are mapped into host::memory, see host::simulated_memory.
+ * - The ARM inline assembly of volatile_store() and friends is replaced by portable stores.
+ * - Immediate DMA transfers are copied straight away. VBlank, HBlank, and special transfers never start.
+ * - profile::cycles() counts host time, in units of GBA cycles (2^24 per second). It is not a model of the ARM7TDMI.
+ * - benchmark results are host time in picoseconds per call, timed over batches of benchmark::host_batch calls, and
+ *   are reported in nanoseconds rather than cycles.
+ * - mGBA log messages are printed to the standard error stream.
+ * - BIOS calls and agbabi are not available.
+ *
+ * @note Sections such as `.iwram` are kept, so the host must use ELF object files (Linux and the BSDs).
+ */
+
+/**
+ * @def GBAXX_TARGET_ARM
+ * @brief Attribute that compiles a function as ARM code, or nothing in a host build.
+ *
+ * Used within an attribute list, such as `[[gnu::section(".iwram.x"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL]]`.
+ *
+ * @sa GBAXX_IWRAM_ARM
+ */
+
+/**
+ * @def GBAXX_LONG_CALL
+ * @brief Attribute that calls a function through a register, for calls between ROM and RAM, or nothing in a host
+ *        build.
+ *
+ * @sa GBAXX_TARGET_ARM
+ */
+#if defined(GBAXX_HOST)
+#define GBAXX_TARGET_ARM
+#define GBAXX_LONG_CALL
+#else
+#define GBAXX_TARGET_ARM gnu::target("arm")
+#define GBAXX_LONG_CALL gnu::long_call
+#endif
+
+#if defined(GBAXX_HOST)
+
+namespace gba::host {
+
+    /**
+     * @struct simulated_memory
+     * @brief Host RAM standing in for the GBA memory regions in a host build.
+     *
+     * Regions are mirrored like the hardware: addresses beyond the size of a region wrap around within it (the upper
+     * 32KiB of VRAM mirror the object tiles). Space that is not listed reads and writes the cartridge region.
+     *
+     * @sa memory
+     */
+    struct simulated_memory {
+        alignas(8) std::byte ewram[0x40000]; /**< 0x2000000 */
+        alignas(8) std::byte iwram[0x8000]; /**< 0x3000000 */
+        alignas(8) std::byte io[0x400]; /**< 0x4000000 */
+        alignas(8) std::byte debug[0x200]; /**< 0x4FFF600, the mGBA debug registers */
+        alignas(8) std::byte palette[0x400]; /**< 0x5000000 */
+        alignas(8) std::byte vram[0x18000]; /**< 0x6000000 */
+        alignas(8) std::byte oam[0x400]; /**< 0x7000000 */
+        alignas(8) std::byte cartridge[0x10000]; /**< 0x8000000 to 0xDFFFFFF */
+        alignas(8) std::byte sram[0x10000]; /**< 0xE000000 */
+    };
+
+    /**
+     * @brief The simulated GBA memory of a host build, which tests may read and write directly.
+     */
+    inline constinit simulated_memory memory{};
+
+} // namespace gba::host
+
+#endif
+
+namespace gba::detail {
+
+#if defined(GBAXX_HOST)
+    inline std::uintptr_t mapped_address(std::uintptr_t address) noexcept {
+        auto& m = host::memory;
+        const auto offset = address & 0xffffff;
+
+        const auto in = [](std::byte* region, std::size_t size, std::size_t at) {
+            return reinterpret_cast<std::uintptr_t>(region + (at & (size - 1)));
+        };
+
+        switch (address >> 24) {
+        case 0x2:
+            return in(m.ewram, sizeof(m.ewram), offset);
+        case 0x3:
+            return in(m.iwram, sizeof(m.iwram), offset);
+        case 0x4:
+            if (offset >= 0xfff600 && offset < 0xfff800) {
+                return in(m.debug, sizeof(m.debug), offset - 0xfff600);
+            }
+            return in(m.io, sizeof(m.io), offset);
+        case 0x5:
+            return in(m.palette, sizeof(m.palette), offset);
+        case 0x6: {
+            const auto vram = offset & 0x1ffff;
+            return reinterpret_cast<std::uintptr_t>(m.vram + (vram < 0x18000 ? vram : vram - 0x8000));
+        }
+        case 0x7:
+            return in(m.oam, sizeof(m.oam), offset);
+        case 0xe:
+        case 0xf:
+            return in(m.sram, sizeof(m.sram), offset);
+        default:
+            return in(m.cartridge, sizeof(m.cartridge), offset);
+        }
+    }
+#else
+    // The address of a memory mapped register or memory region, as seen by the code
+    constexpr std::uintptr_t mapped_address(std::uintptr_t address) noexcept {
+        return address;
+    }
+#endif
+
+} // namespace gba::detail
+
+#endif // define GBAXX_HOST_HPP
@@ -0,0 +1,253 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_INPUT_KEY_SAMPLER_HPP
+#define GBAXX_INPUT_KEY_SAMPLER_HPP
+/** @file */
+
+#include <bit>
+#include <cstddef>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+#include <gba/input/keyhelper.hpp>
+#include <gba/memory/ring_buffer.hpp>
+
+namespace gba {
+
+    /**
+     * @struct key_event
+     * @brief State of the keypad at the moment it changed.
+     *
+     * @sa key_sampler
+     */
+    struct key_event {
+        keyinput keys; /**< Keypad state after the change. */
+        u16 line; /**< mmio::VCOUNT when the change was sampled. */
+        u32 time; /**< Time of the sample, in the units given to key_sampler::sample() (64 cycle ticks for on_timer() and on_keypad()). */
+    };
+
+    /**
+     * @class key_sampler
+     * @brief Samples the keypad from interrupts, queueing a timestamped event for every change.
+     *
+     * Polling mmio::KEYINPUT once per frame misses taps shorter than a frame, and delays every press by up to a frame.
+     * key_sampler instead reads the keypad from a timer interrupt (or from any other interrupt through sample()), and
+     * pushes an event into a ring_buffer whenever the state changes. The main loop replays the events through a
+     * keystate with poll(), so keystate::pressed() and keystate::released() see every edge in order.
+     *
+     * A keypad interrupt can also be armed with wake_on(), which samples a press the moment it happens instead of at
+     * the next timer tick (it also wakes the CPU from bios::Stop()). The interrupt is disarmed once it fires, as the
+     * hardware keeps raising it while the keys remain held, and re-armed once the keys are released.
+     *
+     * @tparam Capacity Events held in the queue, a power of 2.
+     * @tparam Timer Timer used by start().
+     *
+     * @code{cpp}
+     * // Sampling the keypad at 1kHz for a rhythm game
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static gba::key_sampler<> sampler;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     interrupt::install();
+     *     interrupt::set_handler({.timer2 = true}, [] { sampler.on_timer(); });
+     *     interrupt::set_handler({.keypad = true}, [] { sampler.on_keypad(); });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true, .timer2 = true, .keypad = true};
+     *     mmio::IME = true;
+     *
+     *     sampler.start(1000);
+     *     sampler.wake_on(key::a | key::b);
+     *
+     *     keystate keys{};
+     *     key_event event;
+     *     while (true) {
+     *         while (sampler.poll(keys, event)) {
+     *             if (keys.pressed(key::a)) {
+     *                 // Judge the hit against event.time...
+     *             }
+     *         }
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note The interrupt handlers calling sample() must not interrupt each other (the default when not nesting).
+     *
+     * @sa keystate
+     * @sa ring_buffer
+     */
+    template <std::size_t Capacity = 32, u32 Timer = 2> requires (Timer < 4)
+    class key_sampler {
+    public:
+        static constexpr u32 ticks_per_second = 262144; /**< Rate of the timer ticks, the system clock divided by 64. */
+
+        constexpr key_sampler() noexcept = default;
+
+        key_sampler(const key_sampler&) = delete;
+        key_sampler& operator=(const key_sampler&) = delete;
+
+        /**
+         * @brief Starts the sampling timer.
+         *
+         * @param rate Samples per second, from 5 to 262144.
+         */
+        void start(u32 rate) noexcept {
+            stop();
+            m_period = u16(ticks_per_second / rate);
+            volatile_store(&mmio::TIMER_RELOAD[Timer], u16(-m_period));
+            volatile_store(&mmio::TIMER_CONTROL[Timer], tmcnt_h{.scale = timer_scale::_64, .overflow_irq = true, .enabled = true});
+        }
+
+        /**
+         * @brief Stops the sampling timer, and disarms the keypad interrupt.
+         */
+        void stop() noexcept {
+            volatile_store(&mmio::TIMER_CONTROL[Timer], tmcnt_h{});
+            wake_on(key::constant{});
+        }
+
+        /**
+         * @brief Arms the keypad interrupt for a set of keys.
+         *
+         * @param keys Keys that raise the interrupt when pressed, or none to disable it.
+         * @param all True to raise the interrupt only once all of the keys are pressed.
+         */
+        void wake_on(key::constant keys, bool all = false) noexcept {
+            m_wake = u16(keys.mask);
+            m_wake_all = all;
+            arm(m_wake != 0);
+        }
+
+        /**
+         * @brief Call from the interrupt handler of the timer.
+         */
+        void on_timer() noexcept {
+            m_clock += m_period;
+            sample(m_clock);
+        }
+
+        /**
+         * @brief Call from the keypad interrupt handler.
+         */
+        void on_keypad() noexcept {
+            arm(false);
+            sample(now());
+        }
+
+        /**
+         * @brief Reads the keypad, queueing an event if it changed since the last sample.
+         *
+         * Called by on_timer() and on_keypad(), or directly from another interrupt (such as HBlank) with a timestamp of
+         * its own.
+         *
+         * @param time Timestamp of the event.
+         */
+        void sample(u32 time) noexcept {
+            const auto keys = *mmio::KEYINPUT;
+            const auto state = std::bit_cast<u16>(keys);
+            if (state == m_state) {
+                return;
+            }
+            m_state = state;
+
+            if (!m_events.push(key_event{keys, *mmio::VCOUNT, time})) {
+                ++m_lost;
+            }
+
+            // Re-arm once every wake key is released (keys are active low)
+            if (m_wake && !m_armed && (state & m_wake) == m_wake) {
+                arm(true);
+            }
+        }
+
+        /**
+         * @brief Current time of the sampling timer, in 64 cycle ticks.
+         *
+         * @note Only counts while the timer is running.
+         */
+        [[nodiscard]]
+        u32 now() const noexcept {
+            return m_clock + u16(mmio::TIMER_COUNT[Timer] + m_period);
+        }
+
+        /**
+         * @brief Replays the oldest event into a keystate.
+         *
+         * @param keys Key state, updated as if it had been assigned mmio::KEYINPUT at the time of the event.
+         * @return False if no event is waiting.
+         */
+        bool poll(keystate& keys) noexcept {
+            key_event event;
+            return poll(keys, event);
+        }
+
+        /**
+         * @brief Replays the oldest event into a keystate.
+         *
+         * @param keys Key state, updated as if it had been assigned mmio::KEYINPUT at the time of the event.
+         * @param event Receives the event, with its timestamp.
+         * @return False if no event is waiting.
+         */
+        bool poll(keystate& keys, key_event& event) noexcept {
+            if (!m_events.pop(event)) {
+                return false;
+            }
+            keys = event.keys;
+            return true;
+        }
+
+        /**
+         * @brief Number of events waiting.
+         */
+        [[nodiscard]]
+        std::size_t pending() const noexcept {
+            return m_events.size();
+        }
+
+        /**
+         * @brief Number of events dropped because the queue was full.
+         */
+        [[nodiscard]]
+        u32 lost() const noexcept {
+            return volatile_load(&m_lost);
+        }
+
+        /**
+         * @brief Discards every waiting event.
+         */
+        void clear() noexcept {
+            m_events.clear();
+        }
+
+    private:
+        void arm(bool enabled) noexcept {
+            m_armed = enabled;
+            mmio::KEYCNT = std::bit_cast<keycnt>(u16(m_wake | (enabled ? 0x4000 : 0) | (m_wake_all ? 0x8000 : 0)));
+        }
+
+        ring_buffer<key_event, Capacity> m_events{};
+        u32 m_clock{};
+        u32 m_lost{};
+        u16 m_period{};
+        u16 m_state{0x03ff}; // All released
+        u16 m_wake{};
+        bool m_wake_all{};
+        bool m_armed{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_INPUT_KEY_SAMPLER_HPP
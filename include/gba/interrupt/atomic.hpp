@@ -0,0 +1,288 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_INTERRUPT_ATOMIC_HPP
+#define GBAXX_INTERRUPT_ATOMIC_HPP
+/** @file */
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+
+#include <gba/type.hpp>
+
+#include <gba/interrupt/guard.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        // swp and swpb are ARM only, so these run from IWRAM and are reached with a long call from Thumb
+        [[gnu::section(".iwram._gba_atomic_swap"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline u32 atomic_swap(volatile u32* word, u32 value) noexcept {
+#if defined(GBAXX_HOST)
+            return __atomic_exchange_n(const_cast<u32*>(word), value, __ATOMIC_SEQ_CST);
+#else
+            u32 old;
+            asm volatile ("swp %[old], %[value], [%[word]]" : [old]"=&r"(old) : [value]"r"(value), [word]"r"(word) : "memory");
+            return old;
+#endif
+        }
+
+        [[gnu::section(".iwram._gba_atomic_swap_byte"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline u8 atomic_swap_byte(volatile u8* byte, u8 value) noexcept {
+#if defined(GBAXX_HOST)
+            return __atomic_exchange_n(const_cast<u8*>(byte), value, __ATOMIC_SEQ_CST);
+#else
+            u32 old;
+            asm volatile ("swpb %[old], %[value], [%[byte]]" : [old]"=&r"(old) : [value]"r"(value), [byte]"r"(byte) : "memory");
+            return u8(old);
+#endif
+        }
+
+        template <std::size_t Size>
+        struct atomic_storage;
+
+        template <>
+        struct atomic_storage<1> {
+            using type = u8;
+        };
+
+        template <>
+        struct atomic_storage<2> {
+            using type = u16;
+        };
+
+        template <>
+        struct atomic_storage<4> {
+            using type = u32;
+        };
+
+    } // namespace detail
+
+    /**
+     * @class atomic
+     * @brief Minimal std::atomic replacement for values shared between IRQ handlers and the main loop.
+     *
+     * The GBA has a single core, so atomicity only has to hold against interrupts:
+     * * load() and store() are single volatile accesses.
+     * * exchange() of 1 and 4 byte values is a single `swpb` or `swp` instruction.
+     * * Every other read-modify-write operation runs inside an irq_guard, which costs three halfword accesses to
+     *   mmio::IME.
+     *
+     * Memory orders are accepted for compatibility with std::atomic, and only act as compiler barriers.
+     *
+     * @tparam T Trivially copyable type of 1, 2, or 4 bytes.
+     *
+     * @code{cpp}
+     * #include <gba/gba.hpp>
+     *
+     * static gba::atomic<int> frames;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.vblank) {
+     *             frames.fetch_add(1, std::memory_order_relaxed);
+     *         }
+     *     });
+     *
+     *     while (true) {
+     *         const auto elapsed = frames.exchange(0); // Frames since the last update, none are lost
+     *         // Step the game elapsed times...
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @sa irq_guard
+     */
+    template <typename T> requires (std::is_trivially_copyable_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4))
+    class atomic {
+        using storage_type = typename detail::atomic_storage<sizeof(T)>::type;
+
+    public:
+        using value_type = T;
+
+        /** Nothing here waits on a lock: operations are either single instructions or masked from interrupts. */
+        static constexpr bool is_always_lock_free = true;
+
+        constexpr atomic() noexcept = default;
+        constexpr atomic(T desired) noexcept : m_value{std::bit_cast<storage_type>(desired)} {}
+
+        atomic(const atomic&) = delete;
+        atomic& operator=(const atomic&) = delete;
+
+        [[nodiscard]]
+        bool is_lock_free() const noexcept {
+            return is_always_lock_free;
+        }
+
+        [[nodiscard]]
+        T load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+            const auto value = m_value;
+            std::atomic_signal_fence(order);
+            return std::bit_cast<T>(value);
+        }
+
+        void store(T desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            std::atomic_signal_fence(order);
+            m_value = std::bit_cast<storage_type>(desired);
+        }
+
+        /**
+         * @brief Replaces the value.
+         *
+         * @param desired New value.
+         * @return Previous value.
+         */
+        T exchange(T desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            std::atomic_signal_fence(order);
+            const auto value = std::bit_cast<storage_type>(desired);
+            storage_type old;
+            if constexpr (sizeof(T) == 4) {
+                old = detail::atomic_swap(&m_value, value);
+            } else if constexpr (sizeof(T) == 1) {
+                old = detail::atomic_swap_byte(&m_value, value);
+            } else {
+                irq_guard guard;
+                old = m_value;
+                m_value = value;
+            }
+            std::atomic_signal_fence(order);
+            return std::bit_cast<T>(old);
+        }
+
+        /**
+         * @brief Replaces the value if it has the bit pattern of expected.
+         *
+         * @param expected Value to compare with, updated to the current value on failure.
+         * @param desired New value.
+         * @return True if the value was replaced.
+         */
+        bool compare_exchange_strong(T& expected, T desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            const auto want = std::bit_cast<storage_type>(expected);
+            storage_type old;
+            {
+                irq_guard guard;
+                old = m_value;
+                if (old == want) {
+                    m_value = std::bit_cast<storage_type>(desired);
+                }
+            }
+            std::atomic_signal_fence(order);
+            if (old == want) {
+                return true;
+            }
+            expected = std::bit_cast<T>(old);
+            return false;
+        }
+
+        bool compare_exchange_strong(T& expected, T desired, std::memory_order success, std::memory_order) noexcept {
+            return compare_exchange_strong(expected, desired, success);
+        }
+
+        /**
+         * @brief Same as compare_exchange_strong(), which never fails spuriously here.
+         */
+        bool compare_exchange_weak(T& expected, T desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return compare_exchange_strong(expected, desired, order);
+        }
+
+        bool compare_exchange_weak(T& expected, T desired, std::memory_order success, std::memory_order) noexcept {
+            return compare_exchange_strong(expected, desired, success);
+        }
+
+        T fetch_add(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept requires std::is_integral_v<T> {
+            return modify(order, [arg](T value) { return T(value + arg); });
+        }
+
+        T fetch_sub(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept requires std::is_integral_v<T> {
+            return modify(order, [arg](T value) { return T(value - arg); });
+        }
+
+        T fetch_and(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept requires std::is_integral_v<T> {
+            return modify(order, [arg](T value) { return T(value & arg); });
+        }
+
+        T fetch_or(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept requires std::is_integral_v<T> {
+            return modify(order, [arg](T value) { return T(value | arg); });
+        }
+
+        T fetch_xor(T arg, std::memory_order order = std::memory_order_seq_cst) noexcept requires std::is_integral_v<T> {
+            return modify(order, [arg](T value) { return T(value ^ arg); });
+        }
+
+        operator T() const noexcept {
+            return load();
+        }
+
+        T operator=(T desired) noexcept {
+            store(desired);
+            return desired;
+        }
+
+        T operator++() noexcept requires std::is_integral_v<T> {
+            return T(fetch_add(1) + 1);
+        }
+
+        T operator++(int) noexcept requires std::is_integral_v<T> {
+            return fetch_add(1);
+        }
+
+        T operator--() noexcept requires std::is_integral_v<T> {
+            return T(fetch_sub(1) - 1);
+        }
+
+        T operator--(int) noexcept requires std::is_integral_v<T> {
+            return fetch_sub(1);
+        }
+
+        T operator+=(T arg) noexcept requires std::is_integral_v<T> {
+            return T(fetch_add(arg) + arg);
+        }
+
+        T operator-=(T arg) noexcept requires std::is_integral_v<T> {
+            return T(fetch_sub(arg) - arg);
+        }
+
+        T operator&=(T arg) noexcept requires std::is_integral_v<T> {
+            return T(fetch_and(arg) & arg);
+        }
+
+        T operator|=(T arg) noexcept requires std::is_integral_v<T> {
+            return T(fetch_or(arg) | arg);
+        }
+
+        T operator^=(T arg) noexcept requires std::is_integral_v<T> {
+            return T(fetch_xor(arg) ^ arg);
+        }
+
+    private:
+        template <typename Op>
+        [[gnu::always_inline]]
+        T modify(std::memory_order order, Op op) noexcept {
+            T old;
+            {
+                irq_guard guard;
+                old = std::bit_cast<T>(storage_type(m_value));
+                m_value = std::bit_cast<storage_type>(op(old));
+            }
+            std::atomic_signal_fence(order);
+            return old;
+        }
+
+        alignas(sizeof(T)) volatile storage_type m_value{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_INTERRUPT_ATOMIC_HPP
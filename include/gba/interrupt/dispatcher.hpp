@@ -0,0 +1,180 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_INTERRUPT_DISPATCHER_HPP
+#define GBAXX_INTERRUPT_DISPATCHER_HPP
+/** @file */
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+namespace gba::interrupt {
+
+    /**
+     * @brief Function called for one interrupt source.
+     */
+    using handler = void(*)();
+
+    /**
+     * @brief Number of interrupt sources.
+     */
+    inline constexpr std::size_t sources = 14;
+
+    namespace detail {
+
+        struct entry {
+            handler func;
+            u16 nest; // IE bits that may interrupt this handler, zero to run with IRQs disabled
+        };
+
+        // Zero initialized .bss, which is in IWRAM
+        inline constinit entry table[sources]{};
+
+        // Calls a handler in system mode with IRQs enabled, preserving the IRQ mode state a nested interrupt would
+        // overwrite (SPSR_irq and LR_irq) and the interrupted code's LR_sys
+        [[gnu::always_inline]]
+        inline void call_nested(handler func) noexcept {
+#if defined(GBAXX_HOST)
+            func();
+#else
+            asm volatile (
+                "mrs r2, spsr\n\t"
+                "stmfd sp!, {r2, lr}\n\t"
+                "msr cpsr_c, #0x1f\n\t"
+                "stmfd sp!, {r2, lr}\n\t"
+                "mov lr, pc\n\t"
+                "bx %[func]\n\t"
+                "ldmfd sp!, {r2, lr}\n\t"
+                "msr cpsr_c, #0x92\n\t"
+                "ldmfd sp!, {r2, lr}\n\t"
+                "msr spsr_cf, r2"
+                :: [func]"r"(func) : "r0", "r1", "r2", "r3", "r12", "lr", "memory", "cc"
+            );
+#endif
+        }
+
+        [[gnu::section(".iwram._gba_interrupt_dispatch"), GBAXX_TARGET_ARM, gnu::noinline]]
+        inline void dispatch() noexcept {
+            const auto raised = u16(std::bit_cast<u16>(*mmio::IE) & std::bit_cast<u16>(*mmio::IF));
+
+            // Acknowledge everything up front, so a source raised again while its handler runs is not lost
+            mmio::IF = std::bit_cast<irq>(raised);
+            mmio::INTRWAIT_FLAGS = std::bit_cast<irq>(u16(std::bit_cast<u16>(*mmio::INTRWAIT_FLAGS) | raised));
+
+            // Lower bits first, so table order is priority order (VBlank, HBlank, VCount, timers, ...)
+            auto pending = unsigned(raised);
+            while (pending) {
+                const auto& e = table[std::countr_zero(pending)];
+                pending &= pending - 1;
+                if (!e.func) {
+                    continue;
+                }
+                if (!e.nest) {
+                    e.func();
+                    continue;
+                }
+
+                const auto enabled = *mmio::IE;
+                mmio::IE = std::bit_cast<irq>(u16(std::bit_cast<u16>(enabled) & e.nest));
+                call_nested(e.func);
+                mmio::IE = enabled;
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Installs the table-driven dispatcher as the IRQ handler.
+     *
+     * The dispatcher runs in ARM from IWRAM. It acknowledges the raised sources in mmio::IF and
+     * mmio::INTRWAIT_FLAGS (so the BIOS wait functions keep working), then calls the handler of each raised source
+     * through a table of plain function pointers, lowest bit (VBlank) first.
+     *
+     * A handler registered with a nesting mask runs in system mode with IRQs enabled, and mmio::IE temporarily reduced
+     * to that mask, so only the chosen (higher priority) sources may interrupt it.
+     *
+     * @code{cpp}
+     * // A long VBlank handler that must not delay HBlank effects
+     *
+     * #include <gba/gba.hpp>
+     *
+     * void on_hblank();
+     * void on_vblank();
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     interrupt::install();
+     *     interrupt::set_handler({.hblank = true}, on_hblank);
+     *     interrupt::set_handler({.vblank = true}, on_vblank, {.hblank = true}); // HBlank may interrupt VBlank
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true, .irq_hblank = true};
+     *     mmio::IE = {.vblank = true, .hblank = true};
+     *     mmio::IME = true;
+     *
+     *     while (true) {
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note Handlers for sources that are not in mmio::IE are never called, enabling sources is left to the caller.
+     *
+     * @sa set_handler()
+     * @sa mmio::IRQ_HANDLER
+     */
+    inline void install() noexcept {
+        mmio::IRQ_HANDLER = detail::dispatch;
+    }
+
+    /**
+     * @brief Sets the handler of one or more interrupt sources.
+     *
+     * @param which Sources that call the handler.
+     * @param func Handler function, or nullptr to ignore the sources.
+     * @param nest Sources that may interrupt the handler. Empty runs the handler with IRQs disabled.
+     *
+     * @note Handlers may be Thumb or ARM, and in ROM or IWRAM. Keep latency critical handlers in IWRAM.
+     *
+     * @sa install()
+     * @sa clear_handler()
+     */
+    inline void set_handler(irq which, handler func, irq nest = {}) noexcept {
+        auto bits = unsigned(std::bit_cast<u16>(which));
+        const auto mask = std::bit_cast<u16>(nest);
+        while (bits) {
+            auto& e = detail::table[std::countr_zero(bits)];
+            bits &= bits - 1;
+            // Written with the handler cleared, so the dispatcher never sees a half written entry
+            e.func = nullptr;
+            std::atomic_signal_fence(std::memory_order_release);
+            e.nest = mask;
+            std::atomic_signal_fence(std::memory_order_release);
+            e.func = func;
+        }
+    }
+
+    /**
+     * @brief Removes the handler of one or more interrupt sources.
+     *
+     * @param which Sources to ignore.
+     *
+     * @sa set_handler()
+     */
+    inline void clear_handler(irq which) noexcept {
+        set_handler(which, nullptr);
+    }
+
+} // namespace gba::interrupt
+
+#endif // define GBAXX_INTERRUPT_DISPATCHER_HPP
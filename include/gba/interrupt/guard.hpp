@@ -0,0 +1,127 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_INTERRUPT_GUARD_HPP
+#define GBAXX_INTERRUPT_GUARD_HPP
+/** @file */
+
+#include <atomic>
+#include <bit>
+
+#include <gba/type.hpp>
+
+#include <gba/interrupt/irq.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        // Plain volatile halfword accesses (a single ldrh or strh each), the fences keep the guarded code inside
+        inline auto* const guard_ime = reinterpret_cast<volatile u16*>(detail::mapped_address(0x4000208));
+        inline auto* const guard_ie = reinterpret_cast<volatile u16*>(detail::mapped_address(0x4000200));
+
+    } // namespace detail
+
+    /**
+     * @class irq_guard
+     * @brief Disables interrupts for the lifetime of the guard, restoring the previous state of mmio::IME.
+     *
+     * Guards nest: an inner guard restores a disabled IME, so only the outermost guard enables interrupts again.
+     * Entering costs a load and a store of IME, and leaving a single store.
+     *
+     * @code{cpp}
+     * #include <gba/gba.hpp>
+     *
+     * static int shared_counter;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     {
+     *         irq_guard guard;
+     *         shared_counter += 2; // Not interrupted
+     *     }
+     * }
+     * @endcode
+     *
+     * @sa ie_guard
+     * @sa mmio::IME
+     */
+    class irq_guard {
+    public:
+        [[gnu::always_inline]]
+        irq_guard() noexcept : m_ime{*detail::guard_ime} {
+            *detail::guard_ime = 0;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        }
+
+        [[gnu::always_inline]]
+        ~irq_guard() noexcept {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            *detail::guard_ime = m_ime;
+        }
+
+        irq_guard(const irq_guard&) = delete;
+        irq_guard& operator=(const irq_guard&) = delete;
+
+    private:
+        u16 m_ime;
+    };
+
+    /**
+     * @class ie_guard
+     * @brief Disables selected interrupt sources for the lifetime of the guard, restoring mmio::IE afterwards.
+     *
+     * Unlike irq_guard, sources outside of the mask (such as HBlank effects) keep running.
+     *
+     * @code{cpp}
+     * #include <gba/gba.hpp>
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     {
+     *         ie_guard guard{{.vblank = true}};
+     *         // Update state read by the VBlank handler...
+     *     }
+     * }
+     * @endcode
+     *
+     * @note A handler that runs while the guard is alive must not change mmio::IE, as the guard restores its old value.
+     *
+     * @sa irq_guard
+     * @sa mmio::IE
+     */
+    class ie_guard {
+    public:
+        /**
+         * @param mask Sources to disable.
+         */
+        [[gnu::always_inline]]
+        explicit ie_guard(irq mask) noexcept : m_ie{*detail::guard_ie} {
+            *detail::guard_ie = u16(m_ie & ~std::bit_cast<u16>(mask));
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        }
+
+        [[gnu::always_inline]]
+        ~ie_guard() noexcept {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            *detail::guard_ie = m_ie;
+        }
+
+        ie_guard(const ie_guard&) = delete;
+        ie_guard& operator=(const ie_guard&) = delete;
+
+    private:
+        u16 m_ie;
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_INTERRUPT_GUARD_HPP
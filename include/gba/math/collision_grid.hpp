@@ -0,0 +1,274 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MATH_COLLISION_GRID_HPP
+#define GBAXX_MATH_COLLISION_GRID_HPP
+/** @file */
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+
+#include <gba/type.hpp>
+
+namespace gba {
+
+    /**
+     * @struct aabb
+     * @brief Axis-aligned bounding box, with the right and bottom edges exclusive.
+     *
+     * @sa collision_grid
+     */
+    struct aabb {
+        fixed<int, 8> left;
+        fixed<int, 8> top;
+        fixed<int, 8> right;
+        fixed<int, 8> bottom;
+
+        /**
+         * @brief Tests if two boxes intersect. Boxes that only touch do not intersect.
+         */
+        [[nodiscard]]
+        constexpr bool overlaps(const aabb& other) const noexcept {
+            return left.data() < other.right.data() && other.left.data() < right.data() &&
+                   top.data() < other.bottom.data() && other.top.data() < bottom.data();
+        }
+    };
+
+    /**
+     * @class collision_grid
+     * @brief Uniform grid for finding the overlapping pairs of a set of boxes in near-linear time.
+     *
+     * Each box is linked into the cell holding its top-left corner. As no box is larger than a cell, two boxes can only
+     * overlap when their cells are neighbours, so for_each_pair() tests each box against its own cell and four of its
+     * neighbours instead of against every other box. Boxes outside of the grid are clamped into the edge cells.
+     *
+     * The grid stores only the cell links, indexed like the boxes. The boxes themselves are passed in as a span, such
+     * as an entity_table column. update() relinks the boxes that changed cell, and erase() follows the swap-remove of
+     * entity_table::erase().
+     *
+     * @tparam Columns Number of cells across.
+     * @tparam Rows Number of cells down.
+     * @tparam CellShift Cell size as a power of two, in pixels. Boxes must be no larger than a cell.
+     * @tparam Capacity Maximum number of boxes, up to 254, as 255 marks an empty cell.
+     *
+     * @code{cpp}
+     * // Colliding actors stored in an entity table
+     *
+     * #include <gba/gba.hpp>
+     *
+     * enum { bounds, velocity };
+     *
+     * static gba::entity_table<128, gba::aabb, gba::fixed_vec2<8>> actors;
+     * static gba::collision_grid<16, 16, 5, 128> grid; // 512x512 pixel world of 32x32 cells
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     while (true) {
+     *         // ... move actors
+     *         grid.update(actors.column<bounds>());
+     *         grid.for_each_pair(actors.column<bounds>(), [](std::size_t a, std::size_t b) {
+     *             // ... resolve collision between actor a and actor b
+     *         });
+     *
+     *         if (!actors.empty() && actors.get<bounds>(0).top > 512) {
+     *             grid.erase(0, actors.erase(0)); // Both swap-remove
+     *         }
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note A static collision_grid is in .bss, which is IWRAM.
+     *
+     * @sa aabb
+     * @sa entity_table
+     */
+    template <std::size_t Columns, std::size_t Rows, unsigned CellShift = 5, std::size_t Capacity = 128>
+        requires (Columns > 0 && Rows > 0 && Columns * Rows <= 0x10000 && Capacity > 0 && Capacity < 255)
+    class collision_grid {
+    public:
+        static constexpr std::size_t columns = Columns;
+        static constexpr std::size_t rows = Rows;
+        static constexpr std::size_t cell_size = std::size_t{1} << CellShift;
+        static constexpr std::size_t capacity = Capacity;
+
+        constexpr collision_grid() noexcept {
+            std::fill(std::begin(m_head), std::end(m_head), none);
+        }
+
+        collision_grid(const collision_grid&) = delete;
+        collision_grid& operator=(const collision_grid&) = delete;
+
+        /**
+         * @brief Relinks the boxes that moved to a different cell, and links boxes added since the last update.
+         *
+         * @param boxes Every box, at least as many as size(), at most capacity.
+         */
+        void update(std::span<const aabb> boxes) noexcept {
+            for (std::size_t id = 0; id < m_count; ++id) {
+                const auto cell = cell_of(boxes[id]);
+                if (cell != m_cell[id]) {
+                    unlink(id);
+                    link(id, cell);
+                }
+            }
+            for (auto id = m_count; id < boxes.size(); ++id) {
+                link(id, cell_of(boxes[id]));
+            }
+            m_count = boxes.size();
+        }
+
+        /**
+         * @brief Removes a box by moving the last box into its place, matching entity_table::erase().
+         *
+         * @param id Index of the box to remove.
+         * @param last Index of the last box, which is renumbered to id.
+         */
+        void erase(std::size_t id, std::size_t last) noexcept {
+            unlink(id);
+            if (last != id) {
+                const auto cell = m_cell[last];
+                unlink(last);
+                link(id, cell);
+            }
+            m_count = last;
+        }
+
+        /**
+         * @brief Calls a function once for each pair of overlapping boxes.
+         *
+         * @param boxes Boxes as of the last update().
+         * @param fn Function of the two indices.
+         */
+        template <typename Fn>
+        void for_each_pair(std::span<const aabb> boxes, Fn&& fn) const noexcept {
+            for (std::size_t id = 0; id < m_count; ++id) {
+                const auto& box = boxes[id];
+                const auto x = m_cell[id] % Columns;
+                const auto y = m_cell[id] / Columns;
+
+                const auto test = [&](std::size_t other) {
+                    for (; other != none; other = m_next[other]) {
+                        if (box.overlaps(boxes[other])) {
+                            fn(id, other);
+                        }
+                    }
+                };
+
+                // Boxes later in the same cell, then the neighbouring cells that have not tested against this one
+                test(m_next[id]);
+                if (x + 1 < Columns) {
+                    test(m_head[m_cell[id] + 1]);
+                }
+                if (y + 1 < Rows) {
+                    const auto below = m_cell[id] + Columns;
+                    if (x > 0) {
+                        test(m_head[below - 1]);
+                    }
+                    test(m_head[below]);
+                    if (x + 1 < Columns) {
+                        test(m_head[below + 1]);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Calls a function for each box overlapping an area. The area may be any size.
+         *
+         * @param boxes Boxes as of the last update().
+         * @param area Area to test.
+         * @param fn Function of the index of the box.
+         */
+        template <typename Fn>
+        void query(std::span<const aabb> boxes, const aabb& area, Fn&& fn) const noexcept {
+            // Boxes linked into the cells above or to the left can reach one cell in
+            const auto x0 = std::max(column_of(area.left) - 1, 0);
+            const auto y0 = std::max(row_of(area.top) - 1, 0);
+            const auto x1 = column_of(area.right);
+            const auto y1 = row_of(area.bottom);
+
+            for (auto y = y0; y <= y1; ++y) {
+                for (auto x = x0; x <= x1; ++x) {
+                    for (auto id = m_head[y * Columns + x]; id != none; id = m_next[id]) {
+                        if (area.overlaps(boxes[id])) {
+                            fn(std::size_t{id});
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Removes every box.
+         */
+        void clear() noexcept {
+            std::fill(std::begin(m_head), std::end(m_head), none);
+            m_count = 0;
+        }
+
+        [[nodiscard]]
+        constexpr std::size_t size() const noexcept {
+            return m_count;
+        }
+
+    private:
+        static constexpr u8 none = 0xff;
+
+        [[nodiscard]]
+        static constexpr int column_of(fixed<int, 8> x) noexcept {
+            return std::clamp(x.data() >> (8 + CellShift), 0, int(Columns) - 1);
+        }
+
+        [[nodiscard]]
+        static constexpr int row_of(fixed<int, 8> y) noexcept {
+            return std::clamp(y.data() >> (8 + CellShift), 0, int(Rows) - 1);
+        }
+
+        [[nodiscard]]
+        static constexpr u16 cell_of(const aabb& box) noexcept {
+            return u16(row_of(box.top) * Columns + column_of(box.left));
+        }
+
+        void link(std::size_t id, u16 cell) noexcept {
+            const auto head = m_head[cell];
+            m_cell[id] = cell;
+            m_prev[id] = none;
+            m_next[id] = head;
+            if (head != none) {
+                m_prev[head] = u8(id);
+            }
+            m_head[cell] = u8(id);
+        }
+
+        void unlink(std::size_t id) noexcept {
+            const auto prev = m_prev[id];
+            const auto next = m_next[id];
+            if (prev != none) {
+                m_next[prev] = next;
+            } else {
+                m_head[m_cell[id]] = next;
+            }
+            if (next != none) {
+                m_prev[next] = prev;
+            }
+        }
+
+        u8 m_head[Columns * Rows]{};
+        u8 m_next[Capacity]{};
+        u8 m_prev[Capacity]{};
+        u16 m_cell[Capacity]{};
+        std::size_t m_count{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_MATH_COLLISION_GRID_HPP
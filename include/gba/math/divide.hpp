@@ -0,0 +1,214 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MATH_DIVIDE_HPP
+#define GBAXX_MATH_DIVIDE_HPP
+/** @file */
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include <gba/type/fixed.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        struct divide_magic {
+            std::uint64_t multiplier;
+            unsigned shift;
+        };
+
+        // Smallest multiplier and shift where floor(n * multiplier / 2^shift) == floor(n / d) for every n of T
+        // (with one added for negative n). A multiplier that fits a signed word is preferred, as that is one smull.
+        template <std::integral T>
+        consteval divide_magic find_divide_magic(std::uint64_t d) {
+            constexpr auto bits = unsigned(std::numeric_limits<T>::digits + std::is_signed_v<T>);
+            constexpr auto positive_max = std::uint64_t(std::numeric_limits<T>::max());
+            constexpr auto preferred_max = std::is_signed_v<T> ? std::uint64_t{1} << (bits - 1) : std::uint64_t{1} << bits;
+
+            divide_magic fallback{};
+            for (auto shift = bits; shift < 64; ++shift) {
+                const auto power = std::uint64_t{1} << shift;
+                const auto multiplier = (power + d - 1) / d;
+                const auto error = multiplier * d - power;
+
+                // n = q * d + r is exact while the rounding error times n stays below one step of the shift
+                auto exact = positive_max * error < power;
+                if constexpr (std::is_signed_v<T>) {
+                    // The most negative value has no positive counterpart, so is checked directly
+                    const auto part = shift - bits + 1;
+                    const auto quotient = (multiplier + (std::uint64_t{1} << part) - 1) >> part;
+                    exact = exact && quotient - 1 == (positive_max + 1) / d;
+                }
+                if (!exact) {
+                    continue;
+                }
+                if (multiplier < preferred_max) {
+                    return {multiplier, shift};
+                }
+                if (!fallback.shift) {
+                    fallback = {multiplier, shift};
+                }
+            }
+            return fallback;
+        }
+
+        template <std::integral T, std::intmax_t D>
+        struct constant_divide {
+            using unsigned_type = std::make_unsigned_t<T>;
+
+            static constexpr auto bits = unsigned(std::numeric_limits<T>::digits + std::is_signed_v<T>);
+            static constexpr auto magnitude = std::uint64_t(D < 0 ? -D : D);
+            static constexpr bool power_of_two = (magnitude & (magnitude - 1)) == 0;
+            static constexpr auto log2 = unsigned(std::bit_width(magnitude) - 1);
+            // The quotient is 0 or 1, and such divisors may have no exact multiplier with a shift below 64
+            static constexpr bool large = magnitude > std::uint64_t(std::numeric_limits<T>::max()) / 2;
+            static constexpr auto magic = power_of_two || large ? divide_magic{} : find_divide_magic<T>(magnitude);
+
+            [[nodiscard, gnu::always_inline]]
+            static constexpr T divide_magnitude(T n) noexcept {
+                if constexpr (magnitude == 1) {
+                    return n;
+                } else if constexpr (power_of_two) {
+                    if constexpr (std::is_signed_v<T>) {
+                        // Round towards zero, as the division operator does
+                        const auto bias = T((n >> (bits - 1)) & T(magnitude - 1));
+                        return T((n + bias) >> log2);
+                    } else {
+                        return T(n >> log2);
+                    }
+                } else if constexpr (large) {
+                    if constexpr (std::is_signed_v<T>) {
+                        return T(T(n >= T(magnitude)) - T(n <= -T(magnitude)));
+                    } else {
+                        return T(n >= T(magnitude));
+                    }
+                } else if constexpr (std::is_signed_v<T>) {
+                    const auto floor = std::int64_t(n) * std::int64_t(magic.multiplier) >> magic.shift;
+                    return T(floor + (n < 0));
+                } else if constexpr (magic.multiplier <= std::numeric_limits<std::uint32_t>::max()) {
+                    return T(std::uint64_t(n) * magic.multiplier >> magic.shift);
+                } else {
+                    // 33-bit multiplier: multiply by the low word, and add the missing n back without overflowing
+                    const auto low = std::uint32_t(std::uint64_t(n) * (magic.multiplier - (std::uint64_t{1} << bits)) >> bits);
+                    return T((low + ((std::uint32_t(n) - low) >> 1)) >> (magic.shift - bits - 1));
+                }
+            }
+
+            [[nodiscard, gnu::always_inline]]
+            static constexpr T divide(T n) noexcept {
+                if constexpr (D < 0) {
+                    return T(-divide_magnitude(n));
+                } else {
+                    return divide_magnitude(n);
+                }
+            }
+
+            static consteval bool verify() {
+                constexpr auto lowest = std::int64_t(std::numeric_limits<T>::lowest());
+                constexpr auto highest = std::int64_t(std::numeric_limits<T>::max());
+                constexpr auto d = std::int64_t(D);
+
+                // Wrapped into T, so unsigned types test their top values too
+                const std::int64_t tests[] = {
+                    0, 1, d - 1, d, d + 1, d * 2 - 1, d * 2, highest, highest - 1, highest - highest % d,
+                    highest - highest % d - 1, lowest + 1, lowest, -1, -d, -d + 1, -d - 1
+                };
+                for (const auto test : tests) {
+                    const auto n = T(test);
+                    if (D == -1 && n == std::numeric_limits<T>::lowest()) {
+                        continue; // Overflows, as with the division operator
+                    }
+                    if (divide(n) != T(n / T(D))) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            static_assert(magnitude <= std::uint64_t(std::numeric_limits<T>::max()), "Divisor is out of range of the type");
+            static_assert(std::is_signed_v<T> || D > 0, "Unsigned values cannot be divided by a negative divisor");
+            static_assert(verify(), "Constant division does not round exactly like the division operator");
+        };
+
+    } // namespace detail
+
+    /**
+     * @struct divisor
+     * @brief Compile-time constant divisor.
+     *
+     * @tparam D Value of the divisor.
+     *
+     * @sa constant
+     */
+    template <std::intmax_t D> requires (D != 0)
+    struct divisor {
+        static constexpr auto value = D;
+    };
+
+    /**
+     * @brief Divisor known at compile time, which turns division into a multiply and a shift.
+     *
+     * The GBA has no divide instruction, so dividing by a variable calls a division routine costing tens of cycles.
+     * Dividing by a constant instead multiplies by a reciprocal found at compile time (a single `smull` for most
+     * divisors of a 32-bit value) and shifts out the fraction, with a correction for negative values. The reciprocal
+     * is the smallest proven to give the exact quotient for every value of the type, and the result rounds towards
+     * zero exactly as the division operator does, which is also checked at compile time. Divisors above half the range
+     * of the type, where the quotient is at most 1, are a comparison instead.
+     *
+     * Works for integers and for fixed-point values (dividing the underlying data, as with an integer divisor).
+     *
+     * @tparam D Value of the divisor.
+     *
+     * @code{cpp}
+     * // Averaging three samples, and converting pixels to 24 pixel cells
+     *
+     * #include <gba/gba.hpp>
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     fixed<int, 8> a = 1, b = 2.5, c = 4;
+     *     const auto average = (a + b + c) / constant<3>;
+     *
+     *     int x = 200;
+     *     const auto cell = x / constant<24>; // 8
+     * }
+     * @endcode
+     *
+     * @sa lut::reciprocal()
+     */
+    template <std::intmax_t D> requires (D != 0)
+    inline constexpr divisor<D> constant{};
+
+    template <std::integral T, std::intmax_t D>
+    [[nodiscard]]
+    constexpr T operator/(T lhs, divisor<D>) noexcept {
+        return detail::constant_divide<T, D>::divide(lhs);
+    }
+
+    template <Fixed Lhs, std::intmax_t D> requires std::integral<typename Lhs::data_type>
+    [[nodiscard]]
+    constexpr Lhs operator/(Lhs lhs, divisor<D>) noexcept {
+        return Lhs::from_data(detail::constant_divide<typename Lhs::data_type, D>::divide(lhs.data()));
+    }
+
+    template <typename Lhs, std::intmax_t D> requires requires (Lhs lhs) { lhs / divisor<D>{}; }
+    constexpr Lhs& operator/=(Lhs& lhs, divisor<D> rhs) noexcept {
+        lhs = lhs / rhs;
+        return lhs;
+    }
+
+} // namespace gba
+
+#endif // define GBAXX_MATH_DIVIDE_HPP
@@ -0,0 +1,299 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MATH_MATRIX_HPP
+#define GBAXX_MATH_MATRIX_HPP
+/** @file */
+
+#include <cstddef>
+#include <cstdint>
+
+#include <gba/type/angle.hpp>
+#include <gba/type/fixed.hpp>
+
+#include <gba/math/trig.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        // Sum of products in 64 bits, shifted down once so that only the result is rounded
+        template <std::size_t Shift>
+        constexpr int dot3(int a0, int b0, int a1, int b1, int a2, int b2) noexcept {
+            const auto sum = std::int64_t(a0) * b0 + std::int64_t(a1) * b1 + std::int64_t(a2) * b2;
+            return int(sum >> Shift);
+        }
+
+    } // namespace detail
+
+    /**
+     * @struct fixed_vec3
+     * @brief Three 32-bit fixed-point values, for 3D positions and directions.
+     *
+     * @tparam FractionalBits The number of fractional bits of each element.
+     *
+     * @sa fixed_mat3
+     * @sa fixed_mat3x4
+     */
+    template <std::size_t FractionalBits = 8> requires (FractionalBits < 31)
+    struct fixed_vec3 {
+        using value_type = fixed<int, FractionalBits>;
+        static constexpr auto fractional_bits = FractionalBits;
+
+        value_type x;
+        value_type y;
+        value_type z;
+
+        constexpr fixed_vec3& operator+=(const fixed_vec3& rhs) noexcept {
+            x += rhs.x;
+            y += rhs.y;
+            z += rhs.z;
+            return *this;
+        }
+
+        constexpr fixed_vec3& operator-=(const fixed_vec3& rhs) noexcept {
+            x -= rhs.x;
+            y -= rhs.y;
+            z -= rhs.z;
+            return *this;
+        }
+
+        [[nodiscard]]
+        friend constexpr fixed_vec3 operator+(fixed_vec3 lhs, const fixed_vec3& rhs) noexcept {
+            return lhs += rhs;
+        }
+
+        [[nodiscard]]
+        friend constexpr fixed_vec3 operator-(fixed_vec3 lhs, const fixed_vec3& rhs) noexcept {
+            return lhs -= rhs;
+        }
+
+        [[nodiscard]]
+        constexpr fixed_vec3 operator-() const noexcept {
+            return {-x, -y, -z};
+        }
+
+        /**
+         * @brief Scales each element by a fixed-point scalar.
+         */
+        [[nodiscard]]
+        friend constexpr fixed_vec3 operator*(const fixed_vec3& lhs, Fixed auto scalar) noexcept requires (decltype(scalar)::size == 1) {
+            constexpr auto shift = decltype(scalar)::fractional_bits;
+            const auto s = std::int64_t(scalar.data());
+            return {
+                value_type::from_data(int((lhs.x.data() * s) >> shift)),
+                value_type::from_data(int((lhs.y.data() * s) >> shift)),
+                value_type::from_data(int((lhs.z.data() * s) >> shift))
+            };
+        }
+
+        [[nodiscard]]
+        friend constexpr bool operator==(const fixed_vec3& lhs, const fixed_vec3& rhs) noexcept {
+            return lhs.x.data() == rhs.x.data() && lhs.y.data() == rhs.y.data() && lhs.z.data() == rhs.z.data();
+        }
+    };
+
+    /**
+     * @brief Dot product, accumulated in 64 bits.
+     */
+    template <std::size_t FractionalBits>
+    [[nodiscard]]
+    constexpr auto dot(const fixed_vec3<FractionalBits>& a, const fixed_vec3<FractionalBits>& b) noexcept {
+        using value_type = typename fixed_vec3<FractionalBits>::value_type;
+        return value_type::from_data(detail::dot3<FractionalBits>(a.x.data(), b.x.data(), a.y.data(), b.y.data(), a.z.data(), b.z.data()));
+    }
+
+    /**
+     * @brief Cross product, accumulated in 64 bits.
+     */
+    template <std::size_t FractionalBits>
+    [[nodiscard]]
+    constexpr auto cross(const fixed_vec3<FractionalBits>& a, const fixed_vec3<FractionalBits>& b) noexcept {
+        using value_type = typename fixed_vec3<FractionalBits>::value_type;
+        return fixed_vec3<FractionalBits>{
+            value_type::from_data(detail::dot3<FractionalBits>(a.y.data(), b.z.data(), -a.z.data(), b.y.data(), 0, 0)),
+            value_type::from_data(detail::dot3<FractionalBits>(a.z.data(), b.x.data(), -a.x.data(), b.z.data(), 0, 0)),
+            value_type::from_data(detail::dot3<FractionalBits>(a.x.data(), b.y.data(), -a.y.data(), b.x.data(), 0, 0))
+        };
+    }
+
+    /**
+     * @struct fixed_mat3
+     * @brief 3x3 fixed-point matrix for rotating and scaling 3D vectors.
+     *
+     * Elements are stored row by row, and transform column vectors: `m * v` applies m to v, and `a * b` applies b then a.
+     * The default 14 fractional bits match lut::sin_lut, which the rotations read.
+     *
+     * @tparam FractionalBits The number of fractional bits of each element.
+     *
+     * @sa fixed_mat3x4
+     */
+    template <std::size_t FractionalBits = 14> requires (FractionalBits < 31)
+    struct fixed_mat3 {
+        using value_type = fixed<int, FractionalBits>;
+        static constexpr auto fractional_bits = FractionalBits;
+
+        value_type m[3][3];
+
+        [[nodiscard]]
+        static constexpr fixed_mat3 identity() noexcept {
+            return scale(value_type(1));
+        }
+
+        /**
+         * @brief Uniform scale.
+         */
+        [[nodiscard]]
+        static constexpr fixed_mat3 scale(value_type s) noexcept {
+            return {{{s, {}, {}}, {{}, s, {}}, {{}, {}, s}}};
+        }
+
+        /**
+         * @brief Rotation about the X axis, turning Y towards Z.
+         */
+        [[nodiscard]]
+        static constexpr fixed_mat3 rotate_x(Angle auto a) noexcept {
+            const value_type s = lut::sin(lut::sin_lut, a);
+            const value_type c = lut::cos(lut::sin_lut, a);
+            return {{{1, {}, {}}, {{}, c, -s}, {{}, s, c}}};
+        }
+
+        /**
+         * @brief Rotation about the Y axis, turning Z towards X.
+         */
+        [[nodiscard]]
+        static constexpr fixed_mat3 rotate_y(Angle auto a) noexcept {
+            const value_type s = lut::sin(lut::sin_lut, a);
+            const value_type c = lut::cos(lut::sin_lut, a);
+            return {{{c, {}, s}, {{}, 1, {}}, {-s, {}, c}}};
+        }
+
+        /**
+         * @brief Rotation about the Z axis, turning X towards Y.
+         */
+        [[nodiscard]]
+        static constexpr fixed_mat3 rotate_z(Angle auto a) noexcept {
+            const value_type s = lut::sin(lut::sin_lut, a);
+            const value_type c = lut::cos(lut::sin_lut, a);
+            return {{{c, -s, {}}, {s, c, {}}, {{}, {}, 1}}};
+        }
+
+        /**
+         * @brief Swaps rows and columns, which inverts a rotation.
+         */
+        [[nodiscard]]
+        constexpr fixed_mat3 transposed() const noexcept {
+            return {{
+                {m[0][0], m[1][0], m[2][0]},
+                {m[0][1], m[1][1], m[2][1]},
+                {m[0][2], m[1][2], m[2][2]}
+            }};
+        }
+
+        [[nodiscard]]
+        friend constexpr fixed_mat3 operator*(const fixed_mat3& a, const fixed_mat3& b) noexcept {
+            fixed_mat3 result{};
+            for (int row = 0; row < 3; ++row) {
+                for (int col = 0; col < 3; ++col) {
+                    result.m[row][col] = value_type::from_data(detail::dot3<FractionalBits>(
+                        a.m[row][0].data(), b.m[0][col].data(),
+                        a.m[row][1].data(), b.m[1][col].data(),
+                        a.m[row][2].data(), b.m[2][col].data()
+                    ));
+                }
+            }
+            return result;
+        }
+
+        template <std::size_t VectorBits>
+        [[nodiscard]]
+        friend constexpr fixed_vec3<VectorBits> operator*(const fixed_mat3& a, const fixed_vec3<VectorBits>& v) noexcept {
+            using vector_value = typename fixed_vec3<VectorBits>::value_type;
+
+            const auto row = [&](int r) {
+                return vector_value::from_data(detail::dot3<FractionalBits>(
+                    a.m[r][0].data(), v.x.data(), a.m[r][1].data(), v.y.data(), a.m[r][2].data(), v.z.data()
+                ));
+            };
+            return {row(0), row(1), row(2)};
+        }
+    };
+
+    /**
+     * @struct fixed_mat3x4
+     * @brief Affine 3D transform: a fixed_mat3 basis followed by a translation.
+     *
+     * Composes like a 4x4 matrix with an implicit bottom row of (0, 0, 0, 1), in the same order as fixed_mat3.
+     *
+     * @tparam MatrixBits The number of fractional bits of the basis.
+     * @tparam VectorBits The number of fractional bits of the translation, and of the vectors transformed.
+     *
+     * @code{cpp}
+     * // Model-view transform of a spinning object in front of the camera
+     *
+     * #include <gba/gba.hpp>
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     using transform = fixed_mat3x4<>;
+     *
+     *     const auto view = transform::translate({0, 0, 8});
+     *     for (u16 frame = 0; ; ++frame) {
+     *         const angle<u16, 8> spin = frame;
+     *         const auto model = transform{fixed_mat3<>::rotate_y(spin) * fixed_mat3<>::rotate_x(spin)};
+     *         const auto model_view = view * model;
+     *         const auto corner = model_view * fixed_vec3<>{1, 1, 1};
+     *     }
+     * }
+     * @endcode
+     *
+     * @sa transform_vertices()
+     */
+    template <std::size_t MatrixBits = 14, std::size_t VectorBits = 8>
+    struct fixed_mat3x4 {
+        using basis_type = fixed_mat3<MatrixBits>;
+        using vector_type = fixed_vec3<VectorBits>;
+
+        basis_type basis = basis_type::identity();
+        vector_type origin{};
+
+        [[nodiscard]]
+        static constexpr fixed_mat3x4 identity() noexcept {
+            return {};
+        }
+
+        [[nodiscard]]
+        static constexpr fixed_mat3x4 translate(const vector_type& offset) noexcept {
+            return {basis_type::identity(), offset};
+        }
+
+        /**
+         * @brief Inverse of a transform whose basis is a rotation, such as a camera placement.
+         */
+        [[nodiscard]]
+        constexpr fixed_mat3x4 rigid_inverse() const noexcept {
+            const auto inverse = basis.transposed();
+            return {inverse, -(inverse * origin)};
+        }
+
+        [[nodiscard]]
+        friend constexpr fixed_mat3x4 operator*(const fixed_mat3x4& a, const fixed_mat3x4& b) noexcept {
+            return {a.basis * b.basis, a.basis * b.origin + a.origin};
+        }
+
+        [[nodiscard]]
+        friend constexpr vector_type operator*(const fixed_mat3x4& a, const vector_type& v) noexcept {
+            return a.basis * v + a.origin;
+        }
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_MATH_MATRIX_HPP
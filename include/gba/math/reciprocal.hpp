@@ -0,0 +1,77 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MATH_RECIPROCAL_HPP
+#define GBAXX_MATH_RECIPROCAL_HPP
+/** @file */
+
+#include <array>
+#include <concepts>
+#include <limits>
+
+#include <gba/type/fixed.hpp>
+
+namespace gba::lut {
+
+    /**
+     * @brief Generates a table of reciprocals.
+     *
+     * Entry `i` holds `1 / i` rounded to the nearest value of `F`. Entry 0 holds the largest value of `F`.
+     *
+     * @tparam N Number of entries.
+     * @tparam F Fixed-point type of the values.
+     * @return Array of reciprocals.
+     *
+     * @code{cpp}
+     * // Dividing by small integers with a multiply
+     *
+     * #include <gba/gba.hpp>
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     fixed<int, 8> distance = 100;
+     *     const auto per_frame = distance * lut::reciprocal(lut::reciprocal_lut, 6);
+     * }
+     * @endcode
+     *
+     * @sa reciprocal()
+     */
+    template <std::size_t N = 256, Fixed F = fixed<unsigned int, 16>>
+    consteval auto make_reciprocal() {
+        using data_type = typename F::data_type;
+
+        auto result = std::array<F, N>{};
+        result[0] = F::from_data(std::numeric_limits<data_type>::max());
+        for (std::size_t ii = 1; ii < N; ++ii) {
+            result[ii] = F::from_data(data_type((std::uint64_t(F::data_unit) + ii / 2) / ii));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Default 256 entry reciprocal table with 16 fractional bits, stored in ROM.
+     */
+    inline constexpr auto reciprocal_lut = make_reciprocal<>();
+
+    /**
+     * @brief Looks up the reciprocal of an integer.
+     *
+     * @param table Table generated by make_reciprocal().
+     * @param x Integer smaller than the table size.
+     * @return Fixed-point `1 / x`.
+     */
+    template <Fixed F, std::size_t N>
+    constexpr F reciprocal(const std::array<F, N>& table, std::integral auto x) noexcept {
+        return table[std::size_t(x)];
+    }
+
+} // namespace gba::lut
+
+#endif // define GBAXX_MATH_RECIPROCAL_HPP
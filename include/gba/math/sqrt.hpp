@@ -0,0 +1,285 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MATH_SQRT_HPP
+#define GBAXX_MATH_SQRT_HPP
+/** @file */
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+
+#include <gba/type/fixed.hpp>
+
+#include <gba/math/vec2.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        consteval double square_root(double x) noexcept {
+            auto r = x > 1 ? x : 1.0;
+            for (int ii = 0; ii < 64; ++ii) {
+                r = (r + x / r) / 2;
+            }
+            return r;
+        }
+
+        // 1 / sqrt(u) for u in [1, 4) in steps of 1/64, sampled at the middle of each step, as unsigned 0.16
+        consteval auto make_rsqrt_seed() {
+            auto result = std::array<std::uint16_t, 192>{};
+            for (std::size_t ii = 0; ii < result.size(); ++ii) {
+                const auto u = (double(ii) + 64.5) / 64.0;
+                result[ii] = std::uint16_t(65536.0 / square_root(u) + 0.5);
+            }
+            return result;
+        }
+
+        // Read for every call, so kept off the cartridge bus
+        [[gnu::section(".iwram._gba_rsqrt_seed")]]
+        inline constinit auto rsqrt_seed = make_rsqrt_seed();
+
+        // Returns 2^31 / sqrt(u) with about 15 bits of precision, where x = u * 2^(30 - shift) for u in [1, 4)
+        [[gnu::always_inline]]
+        inline std::uint32_t rsqrt_estimate(std::uint32_t x, unsigned& shift) noexcept {
+            // Normalize by an even shift, as ARMv4 has no clz
+            shift = 0;
+            if (x < 0x10000) {
+                x <<= 16;
+                shift += 16;
+            }
+            if (x < 0x1000000) {
+                x <<= 8;
+                shift += 8;
+            }
+            if (x < 0x10000000) {
+                x <<= 4;
+                shift += 4;
+            }
+            if (x < 0x40000000) {
+                x <<= 2;
+                shift += 2;
+            }
+
+            // Table seed, then one Newton-Raphson step: y = y * (3 - u * y^2) / 2
+            const auto y = std::uint32_t(rsqrt_seed[(x >> 24) - 64]) << 15; // 1.31
+            const auto y2 = std::uint32_t((std::uint64_t(y) * y) >> 32); // 2.30
+            const auto uy2 = std::uint32_t((std::uint64_t(x) * y2) >> 32); // 4.28
+            const auto refined = std::uint32_t((std::uint64_t(y) * ((3u << 28) - uy2)) >> 29);
+
+            // The step never overshoots, so is nudged up to centre the error
+            return refined + (refined >> 16);
+        }
+
+        // Reduces a sum of squares to 32 bits by an even shift, returning half of the shift
+        [[gnu::always_inline]]
+        inline unsigned reduce_squares(std::uint64_t& sum) noexcept {
+            unsigned half = 0;
+            while (sum >> 32) {
+                sum >>= 2;
+                ++half;
+            }
+            return half;
+        }
+
+        [[gnu::always_inline]]
+        inline std::uint64_t sum_of_squares(std::int32_t x, std::int32_t y) noexcept {
+            return std::uint64_t(std::int64_t(x) * x) + std::uint64_t(std::int64_t(y) * y);
+        }
+
+        // Fixed-point 1 / sqrt(x), saturating
+        [[gnu::section(".iwram._gba_rsqrt"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline std::uint32_t rsqrt(std::uint32_t x, unsigned fractional_bits) noexcept {
+            if (!x) {
+                return std::numeric_limits<std::uint32_t>::max();
+            }
+
+            unsigned shift;
+            std::uint64_t y = rsqrt_estimate(x, shift);
+            if (fractional_bits & 1) {
+                y = (y * 0xb504f334u) >> 31; // sqrt(2) as 1.31
+            }
+
+            // 2^(3 * fractional_bits / 2) / sqrt(x), with y = 2^(46 - shift / 2) / sqrt(x)
+            const auto exponent = int(shift / 2 + (fractional_bits * 3) / 2) - 46;
+            if (exponent < 0) {
+                return std::uint32_t((y + (std::uint64_t{1} << (-exponent - 1))) >> -exponent);
+            }
+            y <<= exponent;
+            return y >> 32 ? std::numeric_limits<std::uint32_t>::max() : std::uint32_t(y);
+        }
+
+        // sqrt(x^2 + y^2), rounded
+        [[gnu::section(".iwram._gba_hypot"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline std::uint32_t hypot(std::int32_t x, std::int32_t y) noexcept {
+            auto sum = sum_of_squares(x, y);
+            if (!sum) {
+                return 0;
+            }
+            const auto half = reduce_squares(sum);
+
+            // sum * (1 / sqrt(sum))
+            unsigned shift;
+            const auto inverse = rsqrt_estimate(std::uint32_t(sum), shift);
+            const auto down = 46 - shift / 2 - half;
+            return std::uint32_t((sum * inverse + (std::uint64_t{1} << (down - 1))) >> down);
+        }
+
+        // Scales (x, y) to a length of 2^fractional_bits, leaving zero as zero
+        [[gnu::section(".iwram._gba_normalize"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void normalize(std::int32_t& x, std::int32_t& y, unsigned fractional_bits) noexcept {
+            auto sum = sum_of_squares(x, y);
+            if (!sum) {
+                return;
+            }
+            const auto half = reduce_squares(sum);
+
+            unsigned shift;
+            const auto inverse = std::int64_t(rsqrt_estimate(std::uint32_t(sum), shift));
+            const auto down = 46 + half - shift / 2 - fractional_bits;
+            const auto round = std::int64_t{1} << (down - 1);
+            x = std::int32_t((x * inverse + round) >> down);
+            y = std::int32_t((y * inverse + round) >> down);
+        }
+
+        template <typename T>
+        [[nodiscard, gnu::always_inline]]
+        inline T saturate(std::uint32_t x) noexcept {
+            constexpr auto max = std::uint32_t(std::numeric_limits<T>::max());
+            return T(x > max ? max : x);
+        }
+
+        template <typename T>
+        concept FixedScalar = Fixed<T> && T::size == 1 && std::integral<typename T::data_type> &&
+                              sizeof(typename T::data_type) <= 4 && T::fractional_bits <= 30;
+
+        template <typename T>
+        concept FixedVector2 = Fixed<T> && T::size == 2 && std::integral<typename T::value_type::data_type> &&
+                               sizeof(typename T::value_type::data_type) <= 4 && T::fractional_bits <= 30;
+
+    } // namespace detail
+
+    /**
+     * @brief Reciprocal square root, using a table seed refined with one Newton-Raphson step in ARM.
+     *
+     * Precise to about 15 bits. Multiplying by the reciprocal square root replaces both the square root and the
+     * division of a normalization.
+     *
+     * @param x Positive fixed-point value.
+     * @return `1 / sqrt(x)` in the type of x, saturating to its largest value (and for zero).
+     *
+     * @sa agbabi::sqrt()
+     * @sa normalize()
+     */
+    template <detail::FixedScalar F>
+    [[nodiscard, gnu::const]]
+    F rsqrt(F x) noexcept {
+        using data_type = typename F::data_type;
+        return F::from_data(detail::saturate<data_type>(detail::rsqrt(std::uint32_t(x.data()), F::fractional_bits)));
+    }
+
+    /**
+     * @brief Length of the vector (x, y), without overflowing in the squares.
+     *
+     * @return `sqrt(x * x + y * y)`, precise to about 15 bits and saturating to the largest value of the type.
+     */
+    template <detail::FixedScalar F>
+    [[nodiscard, gnu::const]]
+    F hypot(F x, F y) noexcept {
+        using data_type = typename F::data_type;
+        return F::from_data(detail::saturate<data_type>(detail::hypot(x.data(), y.data())));
+    }
+
+    /**
+     * @brief Length of a two element fixed-point vector.
+     *
+     * @sa hypot()
+     */
+    template <detail::FixedVector2 F>
+    [[nodiscard, gnu::const]]
+    auto length(F v) noexcept {
+        return hypot(v[0], v[1]);
+    }
+
+    /**
+     * @brief Length of a packed vector.
+     *
+     * @sa hypot()
+     */
+    template <std::size_t FractionalBits>
+    [[nodiscard, gnu::const]]
+    auto length(fixed_vec2<FractionalBits> v) noexcept {
+        return hypot(v.x(), v.y());
+    }
+
+    /**
+     * @brief Scales a two element fixed-point vector to a length of one, with one reciprocal square root.
+     *
+     * @param v Vector to normalize. The fractional bits must leave room for +1 and -1.
+     * @return Unit vector in the direction of v, or zero if v is zero.
+     *
+     * @code{cpp}
+     * // Homing projectiles steering towards a target
+     *
+     * #include <gba/gba.hpp>
+     *
+     * struct projectile {
+     *     gba::fixed_vec2<8> position;
+     *     gba::fixed_vec2<8> velocity;
+     * };
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     static projectile projectiles[64];
+     *     const fixed_vec2<8> target = {120, 80};
+     *
+     *     for (auto& p : projectiles) {
+     *         const auto heading = normalize(target - p.position); // No sqrt, no divide
+     *         p.velocity = lerp(p.velocity, heading * fixed<short, 8>(1.5), fixed<short, 8>(0.125));
+     *         p.position += p.velocity;
+     *     }
+     * }
+     * @endcode
+     *
+     * @sa rsqrt()
+     */
+    template <detail::FixedVector2 F>
+    [[nodiscard, gnu::const]]
+    F normalize(F v) noexcept {
+        using value_type = typename F::value_type;
+        using lane_type = typename value_type::data_type;
+
+        std::int32_t x = v[0].data();
+        std::int32_t y = v[1].data();
+        detail::normalize(x, y, F::fractional_bits);
+        return F{value_type::from_data(lane_type(x)), value_type::from_data(lane_type(y))};
+    }
+
+    /**
+     * @brief Scales a packed vector to a length of one, with one reciprocal square root.
+     *
+     * @param v Vector to normalize. FractionalBits must be less than 15 to hold +1.
+     * @return Unit vector in the direction of v, or zero if v is zero.
+     */
+    template <std::size_t FractionalBits> requires (FractionalBits < 15)
+    [[nodiscard, gnu::const]]
+    fixed_vec2<FractionalBits> normalize(fixed_vec2<FractionalBits> v) noexcept {
+        using value_type = typename fixed_vec2<FractionalBits>::value_type;
+
+        std::int32_t x = v.x().data();
+        std::int32_t y = v.y().data();
+        detail::normalize(x, y, FractionalBits);
+        return {value_type::from_data(short(x)), value_type::from_data(short(y))};
+    }
+
+} // namespace gba
+
+#endif // define GBAXX_MATH_SQRT_HPP
@@ -0,0 +1,326 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MATH_TRIG_HPP
+#define GBAXX_MATH_TRIG_HPP
+/** @file */
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+
+#include <gba/type/angle.hpp>
+#include <gba/type/fixed.hpp>
+#include <gba/type/lut.hpp>
+
+namespace gba::lut {
+
+    namespace detail {
+
+        // Series evaluations usable in constant expressions, where <cmath> is not
+
+        constexpr double sine(double x) noexcept {
+            constexpr auto pi = std::numbers::pi;
+
+            // Fold into [-pi/2, pi/2] where the series converges quickly
+            while (x > pi) {
+                x -= 2 * pi;
+            }
+            while (x < -pi) {
+                x += 2 * pi;
+            }
+            if (x > pi / 2) {
+                x = pi - x;
+            } else if (x < -pi / 2) {
+                x = -pi - x;
+            }
+
+            double term = x;
+            double sum = x;
+            for (int n = 1; n < 12; ++n) {
+                term *= -x * x / ((2 * n) * (2 * n + 1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        constexpr double arctangent(double x) noexcept {
+            if (x < 0) {
+                return -arctangent(-x);
+            }
+            if (x > 1) {
+                return std::numbers::pi / 2 - arctangent(1 / x);
+            }
+            if (x > 0.5) {
+                // atan(x) = pi/4 - atan((1 - x) / (1 + x)), the argument is then at most 1/3
+                return std::numbers::pi / 4 - arctangent((1 - x) / (1 + x));
+            }
+
+            double power = x;
+            double sum = x;
+            for (int n = 1; n < 24; ++n) {
+                power *= -x * x;
+                sum += power / (2 * n + 1);
+            }
+            return sum;
+        }
+
+        template <typename T>
+        constexpr T round_to(double x) noexcept {
+            constexpr auto lowest = double(std::numeric_limits<T>::lowest());
+            constexpr auto highest = double(std::numeric_limits<T>::max());
+
+            x = x < 0 ? x - 0.5 : x + 0.5;
+            if (x <= lowest) {
+                return std::numeric_limits<T>::lowest();
+            }
+            if (x >= highest) {
+                return std::numeric_limits<T>::max();
+            }
+            return T(x);
+        }
+
+        template <Angle T, std::size_t Bits>
+        constexpr auto angle_index(T a) noexcept {
+            return std::size_t(shift_to<T::bits, Bits>(std::uint64_t(a.data()))) & ((std::size_t{1} << Bits) - 1);
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Generates a sine table.
+     *
+     * @tparam A Binary angle type of the index. The table has `1 << A::bits` entries.
+     * @tparam F Fixed-point type of the values.
+     * @return angle_array of sine values.
+     *
+     * @code{cpp}
+     * // Placing a 1024 entry sine table in IWRAM
+     *
+     * #include <gba/gba.hpp>
+     *
+     * [[gnu::section(".iwram.sine")]]
+     * constinit auto iwram_sine = gba::lut::make_sin<gba::angle<gba::u16, 10>>();
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     auto y = lut::sin_lerp(iwram_sine, angle<u16>(0x1234));
+     * }
+     * @endcode
+     *
+     * @sa sin()
+     * @sa sin_lerp()
+     */
+    template <Angle A = angle<u16, 8>, Fixed F = fixed<short, 14>>
+    consteval auto make_sin() {
+        return make<A>([](A a, int size) {
+            const auto turns = double(a.data()) / size;
+            return F::from_data(detail::round_to<typename F::data_type>(detail::sine(turns * 2 * std::numbers::pi) * F::data_unit));
+        });
+    }
+
+    /**
+     * @brief Generates a tangent table.
+     *
+     * Values at the asymptotes are clamped to the limits of `F`.
+     *
+     * @tparam A Binary angle type of the index. The table has `1 << A::bits` entries.
+     * @tparam F Fixed-point type of the values.
+     * @return angle_array of tangent values.
+     *
+     * @sa tan()
+     */
+    template <Angle A = angle<u16, 8>, Fixed F = fixed<int, 16>>
+    consteval auto make_tan() {
+        return make<A>([](A a, int size) {
+            const auto radians = double(a.data()) / size * 2 * std::numbers::pi;
+            const auto cosine = detail::sine(radians + std::numbers::pi / 2);
+            const auto sine = detail::sine(radians);
+
+            using data_type = typename F::data_type;
+            if (cosine > -1e-12 && cosine < 1e-12) {
+                return F::from_data(sine < 0 ? std::numeric_limits<data_type>::lowest() : std::numeric_limits<data_type>::max());
+            }
+            return F::from_data(detail::round_to<data_type>(sine / cosine * F::data_unit));
+        });
+    }
+
+    /**
+     * @brief Generates an arctangent table for ratios between 0 and 1.
+     *
+     * Entry `i` holds `atan(i / N)`, with one extra entry for the ratio 1 so lookups can interpolate.
+     *
+     * @tparam N Number of steps between 0 and 1.
+     * @tparam A Binary angle type of the values.
+     * @return Array of `N + 1` angles, ranging from 0 to one eighth of a turn.
+     *
+     * @sa atan2()
+     */
+    template <std::size_t N = 256, Angle A = angle<u16>>
+    consteval auto make_atan() {
+        auto result = std::array<A, N + 1>{};
+        for (std::size_t ii = 0; ii <= N; ++ii) {
+            const auto turns = detail::arctangent(double(ii) / N) / (2 * std::numbers::pi);
+            result[ii] = A(detail::round_to<typename A::data_type>(turns * double(std::uint64_t{1} << A::bits)));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Default 256 entry sine table with 14 fractional bits, stored in ROM.
+     */
+    inline constexpr auto sin_lut = make_sin<>();
+
+    /**
+     * @brief Default 256 entry tangent table with 16 fractional bits, stored in ROM.
+     */
+    inline constexpr auto tan_lut = make_tan<>();
+
+    /**
+     * @brief Default 257 entry arctangent table producing 16-bit angles, stored in ROM.
+     */
+    inline constexpr auto atan_lut = make_atan<>();
+
+    /**
+     * @brief Sine of a binary angle, using the table entry at or below the angle.
+     *
+     * @param table Table generated by make_sin().
+     * @param a Binary angle of any precision.
+     * @return Fixed-point sine.
+     */
+    template <typename T, Angle U>
+    constexpr T sin(const angle_array<T, U>& table, Angle auto a) noexcept {
+        return table[a];
+    }
+
+    /**
+     * @brief Cosine of a binary angle, using the sine table entry at or below the angle.
+     *
+     * @param table Table generated by make_sin().
+     * @param a Binary angle of any precision.
+     * @return Fixed-point cosine.
+     */
+    template <typename T, Angle U>
+    constexpr T cos(const angle_array<T, U>& table, Angle auto a) noexcept {
+        constexpr auto quarter = std::size_t{1} << (U::bits - 2);
+        constexpr auto mask = (std::size_t{1} << U::bits) - 1;
+        return table.data()[(detail::angle_index<decltype(a), U::bits>(a) + quarter) & mask];
+    }
+
+    /**
+     * @brief Tangent of a binary angle, using the table entry at or below the angle.
+     *
+     * @param table Table generated by make_tan().
+     * @param a Binary angle of any precision.
+     * @return Fixed-point tangent.
+     */
+    template <typename T, Angle U>
+    constexpr T tan(const angle_array<T, U>& table, Angle auto a) noexcept {
+        return table[a];
+    }
+
+    /**
+     * @brief Sine of a binary angle, linearly interpolated between table entries.
+     *
+     * The bits of `a` below the table precision are used as the interpolation factor.
+     *
+     * @param table Table generated by make_sin().
+     * @param a Binary angle, ideally of higher precision than the table.
+     * @return Fixed-point sine.
+     */
+    template <typename T, Angle U>
+    constexpr T sin_lerp(const angle_array<T, U>& table, Angle auto a) noexcept {
+        using angle_type = decltype(a);
+        if constexpr (angle_type::bits <= U::bits) {
+            return table[a];
+        } else {
+            constexpr auto frac_bits = angle_type::bits - U::bits;
+            constexpr auto mask = (std::size_t{1} << U::bits) - 1;
+
+            const auto raw = std::uint64_t(a.data());
+            const auto index = std::size_t(raw >> frac_bits) & mask;
+            const auto frac = std::int64_t(raw & ((std::uint64_t{1} << frac_bits) - 1));
+
+            const auto lo = std::int64_t(table.data()[index].data());
+            const auto hi = std::int64_t(table.data()[(index + 1) & mask].data());
+            return T::from_data(typename T::data_type(lo + (((hi - lo) * frac) >> frac_bits)));
+        }
+    }
+
+    /**
+     * @brief Cosine of a binary angle, linearly interpolated between the entries of a sine table.
+     *
+     * @param table Table generated by make_sin().
+     * @param a Binary angle, ideally of higher precision than the table.
+     * @return Fixed-point cosine.
+     */
+    template <typename T, Angle U>
+    constexpr T cos_lerp(const angle_array<T, U>& table, Angle auto a) noexcept {
+        using angle_type = decltype(a);
+        using data_type = typename angle_type::data_type;
+        return sin_lerp(table, angle_type(data_type(a.data() + (data_type{1} << (angle_type::bits - 2)))));
+    }
+
+    /**
+     * @brief Arctangent of y / x as a binary angle covering the full circle.
+     *
+     * @param table Table generated by make_atan().
+     * @param x X coordinate.
+     * @param y Y coordinate.
+     * @return Binary angle of the point (x, y).
+     *
+     * @note The order of the parameters is (x, y), matching agbabi::atan2().
+     * @note This uses one 32-bit division to find the ratio of the smaller to the larger coordinate, and interpolates
+     *       between table entries.
+     */
+    template <Angle A, std::size_t N> requires (N > 1 && N <= 257)
+    constexpr A atan2(const std::array<A, N>& table, std::integral auto x, std::integral auto y) noexcept {
+        using data_type = typename A::data_type;
+        constexpr auto steps = unsigned(N - 1);
+        constexpr auto eighth = std::uint64_t{1} << (A::bits - 3);
+
+        if (x == 0 && y == 0) {
+            return A{};
+        }
+
+        auto ax = std::uint64_t(x < 0 ? -std::int64_t(x) : std::int64_t(x));
+        auto ay = std::uint64_t(y < 0 ? -std::int64_t(y) : std::int64_t(y));
+
+        // Reduce to the first octant, keeping the ratio within a 32-bit division
+        const auto swap = ay > ax;
+        auto small = swap ? ax : ay;
+        auto large = swap ? ay : ax;
+        while (large >= (1u << 15)) {
+            small >>= 1;
+            large >>= 1;
+        }
+
+        const auto scaled = (unsigned(small) * steps << 8) / unsigned(large);
+        const auto index = scaled >> 8;
+        const auto lo = std::int64_t(table[index].data());
+        const auto hi = std::int64_t(table[index < steps ? index + 1 : steps].data());
+        auto result = std::uint64_t(lo + (((hi - lo) * std::int64_t(scaled & 0xff)) >> 8));
+
+        if (swap) {
+            result = 2 * eighth - result;
+        }
+        if (x < 0) {
+            result = 4 * eighth - result;
+        }
+        if (y < 0) {
+            result = 8 * eighth - result;
+        }
+        return A(data_type(result));
+    }
+
+} // namespace gba::lut
+
+#endif // define GBAXX_MATH_TRIG_HPP
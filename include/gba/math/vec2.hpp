@@ -0,0 +1,219 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MATH_VEC2_HPP
+#define GBAXX_MATH_VEC2_HPP
+/** @file */
+
+#include <cstdint>
+
+#include <gba/type/fixed.hpp>
+#include <gba/type/vector.hpp>
+
+namespace gba {
+
+    /**
+     * @struct fixed_vec2
+     * @brief Two signed 16-bit fixed-point values packed into one 32-bit word.
+     * @see <a href="https://en.wikipedia.org/wiki/SWAR">SWAR - Wikipedia</a>
+     *
+     * Addition and subtraction operate on both lanes at once with SIMD-within-a-register arithmetic, isolating the
+     * carry between the lanes. Scaling uses one `mul` per lane, as ARMv4T has no halfword multiply instructions.
+     *
+     * X is stored in the low halfword and Y in the high halfword, the same layout as
+     * `fixed<make_vector<short, 2>, FractionalBits>`, which it converts to and from.
+     *
+     * Each lane wraps on overflow.
+     *
+     * @tparam FractionalBits The number of fractional bits of each lane.
+     *
+     * @code{cpp}
+     * // Integrating entity positions
+     *
+     * #include <gba/gba.hpp>
+     *
+     * struct entity {
+     *     gba::fixed_vec2<8> position;
+     *     gba::fixed_vec2<8> velocity;
+     * };
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     static entity entities[128];
+     *
+     *     for (auto& e : entities) {
+     *         e.velocity = e.velocity * fixed<short, 8>(0.9375); // Friction
+     *         e.position += e.velocity; // One add, two eor, two and
+     *     }
+     * }
+     * @endcode
+     */
+    template <std::size_t FractionalBits = 8> requires (FractionalBits < 16)
+    struct alignas(4) fixed_vec2 {
+        using value_type = fixed<short, FractionalBits>;
+        using vector_type = fixed<make_vector<short, 2>, FractionalBits>;
+        static constexpr auto fractional_bits = FractionalBits;
+
+        constexpr fixed_vec2() noexcept = default;
+
+        constexpr fixed_vec2(value_type x, value_type y) noexcept : m_data{pack(x.data(), y.data())} {}
+
+        constexpr fixed_vec2(vector_type v) noexcept : m_data{__builtin_bit_cast(std::uint32_t, v)} {}
+
+        constexpr operator vector_type() const noexcept {
+            return __builtin_bit_cast(vector_type, m_data);
+        }
+
+        static constexpr fixed_vec2 from_data(std::uint32_t data) noexcept {
+            fixed_vec2 v;
+            v.m_data = data;
+            return v;
+        }
+
+        [[nodiscard]]
+        constexpr std::uint32_t data() const noexcept {
+            return m_data;
+        }
+
+        [[nodiscard]]
+        constexpr value_type x() const noexcept {
+            return value_type::from_data(low(m_data));
+        }
+
+        [[nodiscard]]
+        constexpr value_type y() const noexcept {
+            return value_type::from_data(high(m_data));
+        }
+
+        constexpr fixed_vec2& set_x(value_type x) noexcept {
+            m_data = (m_data & 0xffff0000) | std::uint16_t(x.data());
+            return *this;
+        }
+
+        constexpr fixed_vec2& set_y(value_type y) noexcept {
+            m_data = (m_data & 0x0000ffff) | (std::uint32_t(std::uint16_t(y.data())) << 16);
+            return *this;
+        }
+
+        constexpr fixed_vec2& operator+=(fixed_vec2 rhs) noexcept {
+            m_data = add(m_data, rhs.m_data);
+            return *this;
+        }
+
+        constexpr fixed_vec2& operator-=(fixed_vec2 rhs) noexcept {
+            m_data = sub(m_data, rhs.m_data);
+            return *this;
+        }
+
+        constexpr fixed_vec2& operator*=(Fixed auto scalar) noexcept requires (decltype(scalar)::size == 1) {
+            return *this = *this * scalar;
+        }
+
+        [[nodiscard]]
+        friend constexpr fixed_vec2 operator+(fixed_vec2 lhs, fixed_vec2 rhs) noexcept {
+            return from_data(add(lhs.m_data, rhs.m_data));
+        }
+
+        [[nodiscard]]
+        friend constexpr fixed_vec2 operator-(fixed_vec2 lhs, fixed_vec2 rhs) noexcept {
+            return from_data(sub(lhs.m_data, rhs.m_data));
+        }
+
+        [[nodiscard]]
+        constexpr fixed_vec2 operator-() const noexcept {
+            return from_data(sub(0, m_data));
+        }
+
+        /**
+         * @brief Scales both lanes by a fixed-point scalar.
+         *
+         * @param scalar Fixed-point scalar of any precision that fits in 16 bits.
+         * @return Scaled vector.
+         */
+        [[nodiscard]]
+        friend constexpr fixed_vec2 operator*(fixed_vec2 lhs, Fixed auto scalar) noexcept requires (decltype(scalar)::size == 1) {
+            constexpr auto shift = decltype(scalar)::fractional_bits;
+            const auto s = int(scalar.data());
+            return from_data(pack((low(lhs.m_data) * s) >> shift, (high(lhs.m_data) * s) >> shift));
+        }
+
+        [[nodiscard]]
+        friend constexpr fixed_vec2 operator*(Fixed auto scalar, fixed_vec2 rhs) noexcept requires (decltype(scalar)::size == 1) {
+            return rhs * scalar;
+        }
+
+        /**
+         * @brief Arithmetic shift of both lanes.
+         *
+         * @param lhs Vector to shift.
+         * @param rhs Number of bits to shift each lane right.
+         * @return Shifted vector.
+         */
+        [[nodiscard]]
+        friend constexpr fixed_vec2 operator>>(fixed_vec2 lhs, unsigned rhs) noexcept {
+            return from_data(pack(low(lhs.m_data) >> rhs, high(lhs.m_data) >> rhs));
+        }
+
+        [[nodiscard]]
+        friend constexpr fixed_vec2 operator<<(fixed_vec2 lhs, unsigned rhs) noexcept {
+            const auto mask = (0xffffu << rhs) & 0xffffu;
+            return from_data((lhs.m_data << rhs) & (mask | (mask << 16)));
+        }
+
+        [[nodiscard]]
+        friend constexpr bool operator==(fixed_vec2 lhs, fixed_vec2 rhs) noexcept {
+            return lhs.m_data == rhs.m_data;
+        }
+
+    private:
+        static constexpr std::uint32_t high_bits = 0x80008000; // Sign bit of each lane
+
+        static constexpr int low(std::uint32_t x) noexcept {
+            return short(x);
+        }
+
+        static constexpr int high(std::uint32_t x) noexcept {
+            return std::int32_t(x) >> 16;
+        }
+
+        static constexpr std::uint32_t pack(int x, int y) noexcept {
+            return std::uint16_t(x) | (std::uint32_t(y) << 16);
+        }
+
+        static constexpr std::uint32_t add(std::uint32_t a, std::uint32_t b) noexcept {
+            // Add without the top bit of each lane so no carry crosses, then xor the top bits back in
+            return ((a & ~high_bits) + (b & ~high_bits)) ^ ((a ^ b) & high_bits);
+        }
+
+        static constexpr std::uint32_t sub(std::uint32_t a, std::uint32_t b) noexcept {
+            // Set the top bit of each lane so no borrow crosses, then correct the top bits
+            return ((a | high_bits) - (b & ~high_bits)) ^ ((a ^ ~b) & high_bits);
+        }
+
+        std::uint32_t m_data{};
+    };
+
+    /**
+     * @brief Linear interpolation between two packed vectors.
+     *
+     * @param a Vector at t = 0.
+     * @param b Vector at t = 1.
+     * @param t Fixed-point interpolation factor, usually between 0 and 1.
+     * @return `a + (b - a) * t`, computed with two multiplies.
+     */
+    template <std::size_t FractionalBits>
+    [[nodiscard]]
+    constexpr fixed_vec2<FractionalBits> lerp(fixed_vec2<FractionalBits> a, fixed_vec2<FractionalBits> b, Fixed auto t) noexcept requires (decltype(t)::size == 1) {
+        return a + (b - a) * t;
+    }
+
+} // namespace gba
+
+#endif // define GBAXX_MATH_VEC2_HPP
@@ -0,0 +1,336 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MEMORY_ARENA_HPP
+#define GBAXX_MEMORY_ARENA_HPP
+/** @file */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace gba {
+
+    /**
+     * @class arena
+     * @brief Bump allocator over a fixed region of memory.
+     *
+     * Allocation advances a pointer through the region, and memory is only released in bulk with rewind() or reset().
+     * There are no headers and no fragmentation, allocating is an align and compare.
+     *
+     * The region may be a static buffer placed in a section, or the space between two linker script symbols.
+     *
+     * @code{cpp}
+     * // Loading a level into an EWRAM arena
+     *
+     * #include <gba/gba.hpp>
+     *
+     * // Symbol names depend on the linker script
+     * extern "C" std::byte __eheap_start[], __eheap_end[];
+     *
+     * struct enemy {
+     *     int x, y;
+     * };
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     static arena level{__eheap_start, __eheap_end};
+     *
+     *     auto* enemies = level.allocate_array<enemy>(64);
+     *     auto* tiles = level.allocate_array<u16>(64 * 64);
+     *
+     *     // Unload the level
+     *     level.reset();
+     * }
+     * @endcode
+     *
+     * @note Allocation failure returns `nullptr`.
+     *
+     * @sa arena_scope
+     * @sa static_arena
+     * @sa arena_resource
+     */
+    class arena {
+    public:
+        /**
+         * @brief Position within an arena, used to release every allocation made after it.
+         */
+        using marker = std::byte*;
+
+        constexpr arena() noexcept = default;
+
+        /**
+         * @param begin Start of the region.
+         * @param end One past the end of the region.
+         */
+        constexpr arena(std::byte* begin, std::byte* end) noexcept : m_begin{begin}, m_current{begin}, m_end{end} {}
+
+        /**
+         * @param begin Start of the region.
+         * @param end One past the end of the region.
+         */
+        arena(void* begin, void* end) noexcept : arena(static_cast<std::byte*>(begin), static_cast<std::byte*>(end)) {}
+
+        /**
+         * @param buffer Region to allocate from.
+         */
+        constexpr explicit arena(std::span<std::byte> buffer) noexcept : arena(buffer.data(), buffer.data() + buffer.size()) {}
+
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+
+        /**
+         * @brief Allocates uninitialized memory.
+         *
+         * @param bytes Size of the allocation.
+         * @param alignment Alignment of the allocation, must be a power of 2.
+         * @return Pointer to the allocation, or `nullptr` if the arena is exhausted.
+         */
+        [[nodiscard, gnu::malloc, gnu::alloc_size(2), gnu::alloc_align(3)]]
+        void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) noexcept {
+            const auto address = (reinterpret_cast<std::uintptr_t>(m_current) + alignment - 1) & ~(alignment - 1);
+            auto* pointer = reinterpret_cast<std::byte*>(address);
+            if (bytes > std::size_t(m_end - pointer) || pointer > m_end) [[unlikely]] {
+                return nullptr;
+            }
+            m_current = pointer + bytes;
+            return pointer;
+        }
+
+        /**
+         * @brief Allocates uninitialized storage for an array.
+         *
+         * @tparam T Element type.
+         * @param count Number of elements.
+         * @return Pointer to the first element, or `nullptr` if the arena is exhausted.
+         */
+        template <typename T>
+        [[nodiscard]]
+        T* allocate_array(std::size_t count) noexcept {
+            if (count > std::size_t(-1) / sizeof(T)) [[unlikely]] {
+                return nullptr;
+            }
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        /**
+         * @brief Allocates and constructs an object.
+         *
+         * @tparam T Type to construct.
+         * @param args Arguments forwarded to the constructor.
+         * @return Pointer to the new object, or `nullptr` if the arena is exhausted.
+         *
+         * @note The destructor is never called by the arena.
+         */
+        template <typename T, typename... Args>
+        [[nodiscard]]
+        T* create(Args&&... args) noexcept {
+            auto* pointer = allocate(sizeof(T), alignof(T));
+            if (!pointer) [[unlikely]] {
+                return nullptr;
+            }
+            return new(pointer) T(std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Current position of the arena.
+         *
+         * @return Marker to pass to rewind().
+         */
+        [[nodiscard]]
+        constexpr marker mark() const noexcept {
+            return m_current;
+        }
+
+        /**
+         * @brief Releases every allocation made since a marker.
+         *
+         * @param position Value previously returned by mark().
+         */
+        constexpr void rewind(marker position) noexcept {
+            m_current = position;
+        }
+
+        /**
+         * @brief Releases every allocation.
+         */
+        constexpr void reset() noexcept {
+            m_current = m_begin;
+        }
+
+        [[nodiscard]]
+        constexpr std::size_t capacity() const noexcept {
+            return std::size_t(m_end - m_begin);
+        }
+
+        [[nodiscard]]
+        constexpr std::size_t used() const noexcept {
+            return std::size_t(m_current - m_begin);
+        }
+
+        [[nodiscard]]
+        constexpr std::size_t remaining() const noexcept {
+            return std::size_t(m_end - m_current);
+        }
+
+        /**
+         * @brief Tests if a pointer is within the arena's region.
+         *
+         * @param pointer Pointer to test.
+         * @return `true` if the pointer belongs to this arena.
+         */
+        [[nodiscard]]
+        bool owns(const void* pointer) const noexcept {
+            const auto address = reinterpret_cast<std::uintptr_t>(pointer);
+            return address >= reinterpret_cast<std::uintptr_t>(m_begin) && address < reinterpret_cast<std::uintptr_t>(m_end);
+        }
+
+    private:
+        std::byte* m_begin{};
+        std::byte* m_current{};
+        std::byte* m_end{};
+    };
+
+    /**
+     * @class static_arena
+     * @brief Arena that owns its storage.
+     *
+     * Placing the object in a section puts the storage there too. Reset once per frame this becomes a scratch allocator
+     * for temporary buffers.
+     *
+     * @code{cpp}
+     * // Per-frame scratch memory in IWRAM
+     *
+     * #include <gba/gba.hpp>
+     *
+     * [[gnu::section(".iwram.scratch")]]
+     * constinit gba::static_arena<0x1000> scratch;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     while (true) {
+     *         scratch.reset();
+     *
+     *         auto* visible = scratch.allocate_array<u8>(128);
+     *         // ...
+     *
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @tparam Size Size of the storage in bytes.
+     */
+    template <std::size_t Size>
+    class static_arena : public arena {
+    public:
+        constexpr static_arena() noexcept : arena(m_buffer, m_buffer + Size) {}
+
+    private:
+        alignas(std::max_align_t) std::byte m_buffer[Size]{};
+    };
+
+    /**
+     * @class arena_scope
+     * @brief Releases everything allocated from an arena during its lifetime.
+     *
+     * @code{cpp}
+     * void draw_frame(gba::arena& scratch) {
+     *     gba::arena_scope scope{scratch};
+     *     auto* sorted = scratch.allocate_array<int>(128);
+     *     // ...
+     * } // sorted is released
+     * @endcode
+     */
+    class arena_scope {
+    public:
+        explicit arena_scope(arena& a) noexcept : m_arena{a}, m_marker{a.mark()} {}
+
+        arena_scope(const arena_scope&) = delete;
+        arena_scope& operator=(const arena_scope&) = delete;
+
+        ~arena_scope() noexcept {
+            m_arena.rewind(m_marker);
+        }
+
+    private:
+        arena& m_arena;
+        arena::marker m_marker;
+    };
+
+    /**
+     * @class arena_resource
+     * @brief `std::pmr::memory_resource` adapter for an arena.
+     *
+     * Deallocation only releases memory when it is the most recent allocation; otherwise it is reclaimed when the
+     * arena is rewound or reset.
+     *
+     * Exhausting the arena forwards the request to the upstream resource, which defaults to
+     * `std::pmr::null_memory_resource()` (throwing `std::bad_alloc`).
+     *
+     * @code{cpp}
+     * // Standard containers without the heap
+     *
+     * #include <gba/gba.hpp>
+     * #include <vector>
+     *
+     * static gba::static_arena<0x4000> level;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     arena_resource resource{level};
+     *     std::pmr::vector<int> values{&resource};
+     *     values.reserve(256);
+     * }
+     * @endcode
+     */
+    class arena_resource : public std::pmr::memory_resource {
+    public:
+        explicit arena_resource(arena& a, std::pmr::memory_resource* upstream = std::pmr::null_memory_resource()) noexcept : m_arena{a}, m_upstream{upstream} {}
+
+        [[nodiscard]]
+        arena& get_arena() const noexcept {
+            return m_arena;
+        }
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            if (auto* pointer = m_arena.allocate(bytes, alignment)) {
+                return pointer;
+            }
+            return m_upstream->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+            if (!m_arena.owns(pointer)) {
+                m_upstream->deallocate(pointer, bytes, alignment);
+            } else if (static_cast<std::byte*>(pointer) + bytes == m_arena.mark()) {
+                m_arena.rewind(static_cast<std::byte*>(pointer));
+            }
+        }
+
+        [[nodiscard]]
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    private:
+        arena& m_arena;
+        std::pmr::memory_resource* m_upstream;
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_MEMORY_ARENA_HPP
@@ -0,0 +1,308 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MEMORY_ENTITY_TABLE_HPP
+#define GBAXX_MEMORY_ENTITY_TABLE_HPP
+/** @file */
+
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <gba/type.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        template <typename T, typename... Ts>
+        inline constexpr std::size_t type_count = (std::size_t{std::is_same_v<T, Ts>} + ... + 0);
+
+        template <typename T, typename... Ts>
+        consteval std::size_t type_index() noexcept {
+            std::size_t index = 0;
+            ((std::is_same_v<T, Ts> ? false : (++index, true)) && ...);
+            return index;
+        }
+
+        // Column padded to a whole number of words, so 16-bit components can be processed in pairs
+        template <typename T, std::size_t Capacity>
+        struct entity_column {
+            static constexpr std::size_t bytes = (Capacity * sizeof(T) + 3) / 4 * 4;
+            static constexpr std::size_t padded = (bytes + sizeof(T) - 1) / sizeof(T);
+
+            alignas(4) T data[padded]{};
+        };
+
+    } // namespace detail
+
+    /**
+     * @class entity_table
+     * @brief Structure-of-arrays container of entities, with one array per component.
+     *
+     * An update that only touches some components (such as adding velocities to positions) only loads the arrays of
+     * those components, instead of dragging whole entity records through memory. Each array is word aligned and a whole
+     * number of words long, so 16-bit components can also be processed two entities at a time through packed().
+     *
+     * Entities are kept dense: erase() moves the last entity into the erased slot, so iteration never skips holes.
+     *
+     * Components are accessed by index, or by type when the type is used by only one component.
+     *
+     * @tparam Capacity Maximum number of entities.
+     * @tparam Components Component types, trivially copyable.
+     *
+     * @code{cpp}
+     * // Moving and culling bullets
+     *
+     * #include <gba/gba.hpp>
+     *
+     * enum { position, velocity, lifetime };
+     *
+     * static gba::entity_table<128, gba::fixed_vec2<8>, gba::fixed_vec2<8>, gba::u16> bullets; // .bss, so IWRAM
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     bullets.insert({fixed<short, 8>(120), fixed<short, 8>(80)}, {fixed<short, 8>(1.5), fixed<short, 8>(0)}, 60);
+     *
+     *     while (true) {
+     *         bullets.for_each<position, velocity>([](auto& p, const auto& v) {
+     *             p += v; // Both lanes in one add
+     *         });
+     *         bullets.erase_if<lifetime>([](u16& frames) {
+     *             return --frames == 0;
+     *         });
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note A static entity_table is in .bss, which is IWRAM. Use an EWRAM section for rarely updated tables.
+     *
+     * @sa fixed_vec2
+     * @sa pool
+     */
+    template <std::size_t Capacity, typename... Components>
+        requires (Capacity > 0 && sizeof...(Components) > 0 && (std::is_trivially_copyable_v<Components> && ...))
+    class entity_table {
+    public:
+        static constexpr std::size_t capacity = Capacity;
+        static constexpr std::size_t npos = ~std::size_t{};
+
+        template <std::size_t Index>
+        using component_type = std::tuple_element_t<Index, std::tuple<Components...>>;
+
+        constexpr entity_table() noexcept = default;
+
+        entity_table(const entity_table&) = delete;
+        entity_table& operator=(const entity_table&) = delete;
+
+        /**
+         * @brief Adds an entity at the end.
+         *
+         * @param values Value of every component.
+         * @return Index of the new entity, or npos if the table is full.
+         */
+        std::size_t insert(const Components&... values) noexcept {
+            if (m_size == Capacity) [[unlikely]] {
+                return npos;
+            }
+            const auto index = m_size++;
+            assign(index, std::index_sequence_for<Components...>{}, values...);
+            return index;
+        }
+
+        /**
+         * @brief Removes an entity by moving the last entity into its place.
+         *
+         * @param index Index of the entity to remove.
+         * @return Previous index of the entity moved into index (equal to index when it was the last entity).
+         */
+        std::size_t erase(std::size_t index) noexcept {
+            const auto last = --m_size;
+            if (index != last) {
+                move(last, index, std::index_sequence_for<Components...>{});
+            }
+            return last;
+        }
+
+        /**
+         * @brief Removes every entity that matches a predicate on some of its components.
+         *
+         * @tparam Indices Components passed to the predicate.
+         * @param pred Predicate of the components, which may modify them.
+         */
+        template <std::size_t... Indices, typename Pred>
+        void erase_if(Pred&& pred) noexcept {
+            for (std::size_t ii = 0; ii < m_size;) {
+                if (pred(column<Indices>()[ii]...)) {
+                    erase(ii);
+                } else {
+                    ++ii;
+                }
+            }
+        }
+
+        /**
+         * @brief Calls a function for every entity, with references to some of its components.
+         *
+         * @tparam Indices Components passed to the function.
+         * @param fn Function of the components.
+         */
+        template <std::size_t... Indices, typename Fn>
+        void for_each(Fn&& fn) noexcept {
+            auto columns = std::make_tuple(std::get<Indices>(m_columns).data...);
+            for (std::size_t ii = 0; ii < m_size; ++ii) {
+                std::apply([&](auto*... data) { fn(data[ii]...); }, columns);
+            }
+        }
+
+        /**
+         * @brief Calls a function for every entity, with references to some of its components.
+         *
+         * @tparam Types Components passed to the function, each used by only one component.
+         * @param fn Function of the components.
+         */
+        template <typename... Types, typename Fn> requires (sizeof...(Types) > 0)
+        void for_each(Fn&& fn) noexcept {
+            for_each<index_of<Types>()...>(std::forward<Fn>(fn));
+        }
+
+        /**
+         * @brief Array of a component, for the entities in the table.
+         *
+         * @tparam Index Component.
+         */
+        template <std::size_t Index>
+        [[nodiscard]]
+        std::span<component_type<Index>> column() noexcept {
+            return {std::get<Index>(m_columns).data, m_size};
+        }
+
+        template <std::size_t Index>
+        [[nodiscard]]
+        std::span<const component_type<Index>> column() const noexcept {
+            return {std::get<Index>(m_columns).data, m_size};
+        }
+
+        /**
+         * @brief Array of a component, for the entities in the table.
+         *
+         * @tparam Type Component, used by only one component.
+         */
+        template <typename Type>
+        [[nodiscard]]
+        std::span<Type> column() noexcept {
+            return column<index_of<Type>()>();
+        }
+
+        template <typename Type>
+        [[nodiscard]]
+        std::span<const Type> column() const noexcept {
+            return column<index_of<Type>()>();
+        }
+
+        /**
+         * @brief Array of a component as words, for processing 16-bit (or 8-bit) components several at a time.
+         *
+         * The last word may include unused slots past size(), which are safe to modify.
+         *
+         * @tparam Index Component.
+         */
+        template <std::size_t Index>
+        [[nodiscard]]
+        std::span<u32> packed() noexcept {
+            auto& data = std::get<Index>(m_columns).data;
+            return {reinterpret_cast<u32*>(data), (m_size * sizeof(component_type<Index>) + 3) / 4};
+        }
+
+        /**
+         * @brief A component of one entity.
+         *
+         * @tparam Index Component.
+         * @param index Index of the entity.
+         */
+        template <std::size_t Index>
+        [[nodiscard]]
+        component_type<Index>& get(std::size_t index) noexcept {
+            return std::get<Index>(m_columns).data[index];
+        }
+
+        template <std::size_t Index>
+        [[nodiscard]]
+        const component_type<Index>& get(std::size_t index) const noexcept {
+            return std::get<Index>(m_columns).data[index];
+        }
+
+        /**
+         * @brief A component of one entity.
+         *
+         * @tparam Type Component, used by only one component.
+         * @param index Index of the entity.
+         */
+        template <typename Type>
+        [[nodiscard]]
+        Type& get(std::size_t index) noexcept {
+            return get<index_of<Type>()>(index);
+        }
+
+        template <typename Type>
+        [[nodiscard]]
+        const Type& get(std::size_t index) const noexcept {
+            return get<index_of<Type>()>(index);
+        }
+
+        [[nodiscard]]
+        constexpr std::size_t size() const noexcept {
+            return m_size;
+        }
+
+        [[nodiscard]]
+        constexpr bool empty() const noexcept {
+            return m_size == 0;
+        }
+
+        [[nodiscard]]
+        constexpr bool full() const noexcept {
+            return m_size == Capacity;
+        }
+
+        /**
+         * @brief Removes every entity.
+         */
+        constexpr void clear() noexcept {
+            m_size = 0;
+        }
+
+    private:
+        template <typename Type>
+        static consteval std::size_t index_of() noexcept {
+            static_assert(detail::type_count<Type, Components...> == 1, "Component type must be used by exactly one component");
+            return detail::type_index<Type, Components...>();
+        }
+
+        template <std::size_t... Indices>
+        void assign(std::size_t index, std::index_sequence<Indices...>, const Components&... values) noexcept {
+            ((std::get<Indices>(m_columns).data[index] = values), ...);
+        }
+
+        template <std::size_t... Indices>
+        void move(std::size_t from, std::size_t to, std::index_sequence<Indices...>) noexcept {
+            ((std::get<Indices>(m_columns).data[to] = std::get<Indices>(m_columns).data[from]), ...);
+        }
+
+        std::tuple<detail::entity_column<Components, Capacity>...> m_columns{};
+        std::size_t m_size{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_MEMORY_ENTITY_TABLE_HPP
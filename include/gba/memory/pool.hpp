@@ -0,0 +1,234 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MEMORY_POOL_HPP
+#define GBAXX_MEMORY_POOL_HPP
+/** @file */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace gba {
+
+    /**
+     * @class pool
+     * @brief Fixed capacity allocator of same-sized objects, backed by a free list.
+     *
+     * Allocation and deallocation are constant time. Slots that have never been used are handed out in order before
+     * the free list is consulted, so a zero-initialized pool needs no setup and lives in BSS (or any section).
+     *
+     * @code{cpp}
+     * // Spawning and destroying bullets without the heap
+     *
+     * #include <gba/gba.hpp>
+     *
+     * struct bullet {
+     *     int x, y, dx, dy;
+     * };
+     *
+     * [[gnu::section(".ewram.bullets")]]
+     * constinit gba::pool<bullet, 256> bullets;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     auto* b = bullets.create(bullet{120, 80, 1, 0});
+     *     // ...
+     *     bullets.destroy(b);
+     * }
+     * @endcode
+     *
+     * @tparam T Type of the objects.
+     * @tparam N Number of slots.
+     *
+     * @note Allocation failure returns `nullptr`.
+     */
+    template <typename T, std::size_t N> requires (N > 0)
+    class pool {
+    public:
+        using value_type = T;
+        static constexpr auto capacity = N;
+
+        constexpr pool() noexcept = default;
+
+        pool(const pool&) = delete;
+        pool& operator=(const pool&) = delete;
+
+        /**
+         * @brief Allocates uninitialized storage for one object.
+         *
+         * @return Pointer to the storage, or `nullptr` if every slot is in use.
+         */
+        [[nodiscard]]
+        T* allocate() noexcept {
+            slot* result;
+            if (m_free) {
+                result = m_free;
+                m_free = result->next;
+            } else if (m_untouched < N) {
+                result = &m_slots[m_untouched++];
+            } else [[unlikely]] {
+                return nullptr;
+            }
+            ++m_size;
+            return reinterpret_cast<T*>(result->storage);
+        }
+
+        /**
+         * @brief Returns storage to the pool without destroying the object.
+         *
+         * @param pointer Pointer previously returned by allocate().
+         */
+        void deallocate(T* pointer) noexcept {
+            auto* s = reinterpret_cast<slot*>(pointer);
+            s->next = m_free;
+            m_free = s;
+            --m_size;
+        }
+
+        /**
+         * @brief Allocates and constructs an object.
+         *
+         * @param args Arguments forwarded to the constructor.
+         * @return Pointer to the new object, or `nullptr` if every slot is in use.
+         */
+        template <typename... Args>
+        [[nodiscard]]
+        T* create(Args&&... args) noexcept {
+            auto* pointer = allocate();
+            if (!pointer) [[unlikely]] {
+                return nullptr;
+            }
+            return new(pointer) T(std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Destroys an object and returns its storage to the pool.
+         *
+         * @param pointer Pointer previously returned by create().
+         */
+        void destroy(T* pointer) noexcept {
+            pointer->~T();
+            deallocate(pointer);
+        }
+
+        /**
+         * @brief Releases every slot without calling any destructors.
+         */
+        constexpr void clear() noexcept {
+            m_free = nullptr;
+            m_untouched = 0;
+            m_size = 0;
+        }
+
+        /**
+         * @brief Tests if a pointer is a slot of this pool.
+         *
+         * @param pointer Pointer to test.
+         * @return `true` if the pointer belongs to this pool.
+         */
+        [[nodiscard]]
+        bool owns(const void* pointer) const noexcept {
+            const auto address = reinterpret_cast<std::uintptr_t>(pointer);
+            const auto begin = reinterpret_cast<std::uintptr_t>(m_slots);
+            return address >= begin && address < begin + sizeof(m_slots);
+        }
+
+        [[nodiscard]]
+        constexpr std::size_t size() const noexcept {
+            return m_size;
+        }
+
+        [[nodiscard]]
+        constexpr bool empty() const noexcept {
+            return m_size == 0;
+        }
+
+        [[nodiscard]]
+        constexpr bool full() const noexcept {
+            return m_size == N;
+        }
+
+    private:
+        union slot {
+            slot* next;
+            alignas(T) std::byte storage[sizeof(T)];
+        };
+
+        slot m_slots[N]{};
+        slot* m_free{};
+        std::size_t m_untouched{};
+        std::size_t m_size{};
+    };
+
+    /**
+     * @class pool_resource
+     * @brief `std::pmr::memory_resource` adapter serving single-slot requests from a pool.
+     *
+     * Requests that do not fit a slot, or arrive when the pool is full, are forwarded to the upstream resource.
+     *
+     * @tparam T Type of the pool's objects.
+     * @tparam N Number of slots in the pool.
+     *
+     * @code{cpp}
+     * // Node-based containers from a pool
+     *
+     * #include <gba/gba.hpp>
+     * #include <list>
+     *
+     * static gba::pool<std::array<int, 8>, 64> nodes;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     pool_resource resource{nodes};
+     *     std::pmr::list<int> values{&resource};
+     *     values.push_back(1);
+     * }
+     * @endcode
+     */
+    template <typename T, std::size_t N>
+    class pool_resource : public std::pmr::memory_resource {
+    public:
+        explicit pool_resource(pool<T, N>& p, std::pmr::memory_resource* upstream = std::pmr::null_memory_resource()) noexcept : m_pool{p}, m_upstream{upstream} {}
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            if (bytes <= sizeof(T) && alignment <= alignof(T)) {
+                if (auto* pointer = m_pool.allocate()) {
+                    return pointer;
+                }
+            }
+            return m_upstream->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+            if (m_pool.owns(pointer)) {
+                m_pool.deallocate(static_cast<T*>(pointer));
+            } else {
+                m_upstream->deallocate(pointer, bytes, alignment);
+            }
+        }
+
+        [[nodiscard]]
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    private:
+        pool<T, N>& m_pool;
+        std::pmr::memory_resource* m_upstream;
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_MEMORY_POOL_HPP
@@ -0,0 +1,209 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MEMORY_RING_BUFFER_HPP
+#define GBAXX_MEMORY_RING_BUFFER_HPP
+/** @file */
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+
+#include <gba/type.hpp>
+
+namespace gba {
+
+    /**
+     * @class ring_buffer
+     * @brief Lock-free single-producer single-consumer queue, for passing data between IRQ handlers and the main loop.
+     *
+     * One side only ever pushes and the other only ever pops. Each side owns one index: the producer writes the
+     * element before publishing its index with volatile_store(), and the consumer reads the element only after seeing
+     * that index with volatile_load(), so neither side needs to disable mmio::IME.
+     *
+     * The indices run freely and are masked on access, so all N slots are usable.
+     *
+     * @tparam T Element type.
+     * @tparam N Capacity, a power of 2.
+     *
+     * @code{cpp}
+     * // Serial bytes received in an IRQ, processed in the main loop
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static gba::ring_buffer<gba::u8, 64> received;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.serial) {
+     *             received.push(u8(*mmio::SIODATA8));
+     *         }
+     *     });
+     *
+     *     while (true) {
+     *         u8 buffer[16];
+     *         const auto count = received.pop(buffer, 16);
+     *         // Handle count bytes...
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note An IRQ handler that pushes should not wait for space: a full buffer drops the element (push() returns
+     *       false).
+     */
+    template <typename T, std::size_t N> requires (N >= 2 && std::has_single_bit(N) && std::is_trivially_copyable_v<T>)
+    class ring_buffer {
+    public:
+        using value_type = T;
+        static constexpr auto capacity = N;
+
+        constexpr ring_buffer() noexcept = default;
+
+        ring_buffer(const ring_buffer&) = delete;
+        ring_buffer& operator=(const ring_buffer&) = delete;
+
+        /**
+         * @brief Adds one element. Producer only.
+         *
+         * @param value Element to add.
+         * @return False if the buffer is full.
+         */
+        bool push(const T& value) noexcept {
+            const auto head = m_head;
+            if (head - observe(&m_tail) >= N) {
+                return false;
+            }
+            m_data[head & mask] = value;
+            publish(&m_head, head + 1);
+            return true;
+        }
+
+        /**
+         * @brief Adds as many elements as fit. Producer only.
+         *
+         * The consumer sees all of the elements at once.
+         *
+         * @param src Elements to add.
+         * @param count Number of elements.
+         * @return Number of elements added.
+         */
+        std::size_t push(const T* src, std::size_t count) noexcept {
+            const auto head = m_head;
+            const auto space = N - (head - observe(&m_tail));
+            count = count < space ? count : space;
+            for (std::size_t ii = 0; ii < count; ++ii) {
+                m_data[(head + ii) & mask] = src[ii];
+            }
+            publish(&m_head, head + u32(count));
+            return count;
+        }
+
+        /**
+         * @brief Removes one element. Consumer only.
+         *
+         * @param value Receives the element.
+         * @return False if the buffer is empty.
+         */
+        bool pop(T& value) noexcept {
+            const auto tail = m_tail;
+            if (observe(&m_head) == tail) {
+                return false;
+            }
+            value = m_data[tail & mask];
+            publish(&m_tail, tail + 1);
+            return true;
+        }
+
+        /**
+         * @brief Removes up to a number of elements. Consumer only.
+         *
+         * @param dest Receives the elements.
+         * @param max Maximum number of elements.
+         * @return Number of elements removed.
+         */
+        std::size_t pop(T* dest, std::size_t max) noexcept {
+            const auto tail = m_tail;
+            const auto available = std::size_t(observe(&m_head) - tail);
+            const auto count = max < available ? max : available;
+            for (std::size_t ii = 0; ii < count; ++ii) {
+                dest[ii] = m_data[(tail + ii) & mask];
+            }
+            publish(&m_tail, tail + u32(count));
+            return count;
+        }
+
+        /**
+         * @brief Reads the oldest element without removing it. Consumer only.
+         *
+         * @return Pointer to the element, or nullptr if the buffer is empty.
+         */
+        [[nodiscard]]
+        const T* peek() const noexcept {
+            const auto tail = m_tail;
+            if (observe(&m_head) == tail) {
+                return nullptr;
+            }
+            return &m_data[tail & mask];
+        }
+
+        /**
+         * @brief Removes every element. Consumer only.
+         */
+        void clear() noexcept {
+            publish(&m_tail, volatile_load(&m_head));
+        }
+
+        /**
+         * @brief Number of elements waiting.
+         *
+         * @note Exact for the consumer, may be an over-estimate for the producer.
+         */
+        [[nodiscard]]
+        std::size_t size() const noexcept {
+            return std::size_t(volatile_load(&m_head) - volatile_load(&m_tail));
+        }
+
+        [[nodiscard]]
+        bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        [[nodiscard]]
+        bool full() const noexcept {
+            return size() >= N;
+        }
+
+    private:
+        static constexpr u32 mask = u32(N - 1);
+
+        // The store is an asm statement with a memory clobber, so element accesses cannot be moved past it
+        static void publish(u32* index, u32 value) noexcept {
+            volatile_store(index, value);
+        }
+
+        // Mirrors publish(), element accesses cannot be hoisted above reading the other side's index
+        [[nodiscard]]
+        static u32 observe(const u32* index) noexcept {
+            const auto value = volatile_load(index);
+            std::atomic_signal_fence(std::memory_order_acquire);
+            return value;
+        }
+
+        T m_data[N]{};
+        u32 m_head{}; // Written by the producer
+        u32 m_tail{}; // Written by the consumer
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_MEMORY_RING_BUFFER_HPP
@@ -0,0 +1,206 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MEMORY_SECTION_HPP
+#define GBAXX_MEMORY_SECTION_HPP
+/** @file */
+
+#include <cstddef>
+#include <utility>
+
+#define GBAXX_DETAIL_STRINGIFY_(x) #x
+#define GBAXX_DETAIL_STRINGIFY(x) GBAXX_DETAIL_STRINGIFY_(x)
+
+// Unique section name per use, so --gc-sections can discard each function on its own
+#define GBAXX_DETAIL_SECTION(prefix) prefix "." GBAXX_DETAIL_STRINGIFY(__COUNTER__)
+
+/**
+ * @def GBAXX_IWRAM_ARM
+ * @brief Places a function in IWRAM, compiled for ARM state.
+ *
+ * IWRAM is on the 32-bit single cycle bus, so ARM code runs at full speed from it (unlike ROM, where every 32-bit
+ * opcode costs two 16-bit fetches). The function is long-called, as IWRAM is out of range of a branch from ROM.
+ *
+ * @code{cpp}
+ * #include <gba/gba.hpp>
+ *
+ * GBAXX_IWRAM_ARM
+ * void mix(int* dest, const signed char* src, int count) {
+ *     while (count--) {
+ *         *dest++ += *src++;
+ *     }
+ * }
+ * @endcode
+ *
+ * @sa GBAXX_IWRAM_THUMB
+ * @sa gba::iwram_fn
+ */
+#define GBAXX_IWRAM_ARM [[gnu::section(GBAXX_DETAIL_SECTION(".iwram._gbaxx_code")), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+
+/**
+ * @def GBAXX_IWRAM_THUMB
+ * @brief Places a function in IWRAM, compiled for Thumb state.
+ *
+ * Smaller than GBAXX_IWRAM_ARM, for code that must not wait on ROM (such as while the cartridge timings are changed)
+ * but is not performance critical.
+ *
+ * @sa GBAXX_IWRAM_ARM
+ */
+#define GBAXX_IWRAM_THUMB [[gnu::section(GBAXX_DETAIL_SECTION(".iwram._gbaxx_code")), GBAXX_LONG_CALL, gnu::noinline]]
+
+/**
+ * @def GBAXX_IWRAM_DATA
+ * @brief Places initialized data in IWRAM.
+ *
+ * @note Zero initialized variables are already in IWRAM (.bss).
+ */
+#define GBAXX_IWRAM_DATA [[gnu::section(".iwram._gbaxx_data")]]
+
+/**
+ * @def GBAXX_EWRAM_DATA
+ * @brief Places data in EWRAM.
+ *
+ * EWRAM is larger (256KiB) but slower (16-bit bus with wait states), so is suited to large buffers that are not
+ * accessed every cycle.
+ *
+ * @code{cpp}
+ * #include <gba/gba.hpp>
+ *
+ * GBAXX_EWRAM_DATA
+ * constinit gba::u8 level_buffer[0x10000]{};
+ * @endcode
+ */
+#define GBAXX_EWRAM_DATA [[gnu::section(".ewram._gbaxx_data")]]
+
+/**
+ * @def GBAXX_EWRAM_CODE
+ * @brief Places a function in EWRAM, compiled for Thumb state.
+ *
+ * EWRAM is faster than ROM for Thumb code on cartridges with slow wait states, and frees IWRAM.
+ */
+#define GBAXX_EWRAM_CODE [[gnu::section(GBAXX_DETAIL_SECTION(".ewram._gbaxx_code")), GBAXX_LONG_CALL, gnu::noinline]]
+
+/**
+ * @def GBAXX_IWRAM_CODE_BUDGET
+ * @brief Bytes of IWRAM code allowed by gba::iwram_budget before warning.
+ *
+ * Defaults to 16KiB, half of IWRAM, leaving the rest for data and the stacks. Define before including to change.
+ */
+#ifndef GBAXX_IWRAM_CODE_BUDGET
+#define GBAXX_IWRAM_CODE_BUDGET 0x4000
+#endif
+
+namespace gba {
+
+    /**
+     * @struct iwram_fn
+     * @brief Thunk that runs an existing function from IWRAM in ARM state.
+     *
+     * The thunk is an IWRAM ARM function that calls Func with every call inlined (gnu::flatten), so the body of Func is
+     * compiled a second time as ARM code in IWRAM. The original function is left as it is, and callers choose which
+     * copy to run.
+     *
+     * @tparam Func Function to run from IWRAM. Its definition must be visible so it can be inlined.
+     * @tparam Bytes Estimated size of the compiled thunk (from the map file), counted by iwram_budget.
+     *
+     * @code{cpp}
+     * #include <gba/gba.hpp>
+     *
+     * static void update_particles(int count) {
+     *     // Hot loop...
+     * }
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     iwram_fn<update_particles>::call(64); // Runs from IWRAM
+     *     update_particles(64); // Runs from ROM
+     * }
+     * @endcode
+     *
+     * @note Recursive calls and calls through function pointers inside Func still go to the original (ROM) version.
+     *
+     * @sa GBAXX_IWRAM_ARM
+     * @sa iwram_budget
+     */
+    template <auto Func, std::size_t Bytes = 0>
+    struct iwram_fn {
+        static constexpr std::size_t size = Bytes;
+
+        // Each instantiation is its own COMDAT group, so unused thunks are still discarded by --gc-sections
+        template <typename... Args>
+        [[gnu::section(".iwram._gbaxx_fn"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline, gnu::flatten]]
+        static decltype(auto) call(Args&&... args) noexcept(noexcept(Func(std::forward<Args>(args)...))) {
+            return Func(std::forward<Args>(args)...);
+        }
+
+        template <typename... Args>
+        decltype(auto) operator()(Args&&... args) const noexcept(noexcept(Func(std::forward<Args>(args)...))) {
+            return call(std::forward<Args>(args)...);
+        }
+    };
+
+    namespace detail {
+
+        template <std::size_t Used, std::size_t Budget>
+        [[deprecated("IWRAM code exceeds its budget")]]
+        constexpr bool iwram_budget_exceeded() noexcept {
+            return false;
+        }
+
+        // Base of iwram_budget, so the check is instantiated with the class rather than when a member is named
+        template <std::size_t Used, std::size_t Budget>
+        struct iwram_budget_check {
+            static constexpr bool within = true;
+        };
+
+        template <std::size_t Used, std::size_t Budget> requires (Used > Budget)
+        struct iwram_budget_check<Used, Budget> {
+            static constexpr decltype(iwram_budget_exceeded<Used, Budget>()) within = false;
+        };
+
+    } // namespace detail
+
+    /**
+     * @struct iwram_budget
+     * @brief Compile time registry of hot IWRAM functions, warning when their total size exceeds a budget.
+     *
+     * The compiler cannot measure code size, so each registered iwram_fn carries an estimate (taken from the map file
+     * after a build). Naming any member of iwram_budget sums the estimates and raises a (deprecation) warning if the
+     * total is above Budget, so an over budget build still links and can be inspected.
+     *
+     * @tparam Budget Maximum bytes of registered code.
+     * @tparam Fns iwram_fn types.
+     *
+     * @code{cpp}
+     * #include <gba/gba.hpp>
+     *
+     * void mix_voices();
+     * void rasterize_spans();
+     *
+     * using hot_code = gba::iwram_budget<GBAXX_IWRAM_CODE_BUDGET,
+     *     gba::iwram_fn<mix_voices, 0x600>,
+     *     gba::iwram_fn<rasterize_spans, 0x400>
+     * >;
+     * static_assert(hot_code::used == 0xa00); // Warns here if 0xa00 is over GBAXX_IWRAM_CODE_BUDGET
+     * @endcode
+     *
+     * @sa iwram_fn
+     * @sa GBAXX_IWRAM_CODE_BUDGET
+     */
+    template <std::size_t Budget, typename... Fns>
+    struct iwram_budget : detail::iwram_budget_check<(Fns::size + ... + 0), Budget> {
+        static constexpr std::size_t budget = Budget;
+        static constexpr std::size_t used = (Fns::size + ... + 0);
+        static constexpr std::size_t remaining = used > Budget ? 0 : Budget - used;
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_MEMORY_SECTION_HPP
@@ -0,0 +1,224 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_MEMORY_STACK_POOL_HPP
+#define GBAXX_MEMORY_STACK_POOL_HPP
+/** @file */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include <gba/type.hpp>
+
+#include <gba/ext/mgba/log.hpp>
+
+namespace gba {
+
+    /**
+     * @class stack_pool
+     * @brief Fixed pool of coroutine and fiber stacks, painted with a pattern to measure how much of each is used.
+     *
+     * acquire() fills a stack with the paint pattern before handing it out. Stack usage never shrinks back over the
+     * paint, so the first overwritten word, searched for from the bottom of the stack, marks the deepest point it ever
+     * reached. This is checked at any time with high_water(), and kept per slot when the stack is released, so the
+     * stack sizes can be trimmed to what is actually used.
+     *
+     * The lowest guard_size bytes of each stack are a guard band. If they were overwritten the stack overflowed (and
+     * whatever memory lies below may be corrupt).
+     *
+     * Each stack is a `std::array<u32, StackSize / 4>`, so it is passed directly to agbabi::fiber,
+     * agbabi::pull_coroutine, and agbabi::push_coroutine, which place their context at the top.
+     *
+     * @tparam StackSize Bytes per stack, a multiple of 8.
+     * @tparam Count Number of stacks, up to 32.
+     *
+     * @code{cpp}
+     * // Measuring the stack of a cutscene script
+     *
+     * #include <gba/gba.hpp>
+     *
+     * GBAXX_EWRAM_DATA
+     * constinit gba::stack_pool<1024, 4> stacks{};
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mgba::open();
+     *
+     *     auto* stack = stacks.acquire();
+     *     {
+     *         agbabi::fiber script{*stack, [](agbabi::fiber& yield) {
+     *             // ...
+     *             yield();
+     *         }};
+     *         while (script) {
+     *             script();
+     *         }
+     *     }
+     *     stacks.release(stack);
+     *     stacks.report(); // slot 0: 312/1024 bytes (30%)...
+     * }
+     * @endcode
+     *
+     * @note Painting costs a word store per 4 bytes of stack on every acquire().
+     *
+     * @sa agbabi::fiber
+     * @sa pool
+     */
+    template <std::size_t StackSize, std::size_t Count> requires (StackSize % 8 == 0 && StackSize >= 64 && Count > 0 && Count <= 32)
+    class stack_pool {
+    public:
+        static constexpr std::size_t words = StackSize / 4;
+        static constexpr std::size_t guard_size = 8;
+        static constexpr u32 paint = 0xC0DEFA11;
+
+        using stack_type = std::array<u32, words>;
+
+        constexpr stack_pool() noexcept = default;
+
+        stack_pool(const stack_pool&) = delete;
+        stack_pool& operator=(const stack_pool&) = delete;
+
+        /**
+         * @brief Paints and hands out a stack.
+         *
+         * @return The stack, or `nullptr` if every stack is in use.
+         */
+        [[nodiscard]]
+        stack_type* acquire() noexcept {
+            const auto free = ~m_used & mask;
+            if (!free) [[unlikely]] {
+                return nullptr;
+            }
+            const auto slot = std::countr_zero(free);
+            m_used |= 1u << slot;
+            m_stacks[slot].fill(paint);
+            return &m_stacks[slot];
+        }
+
+        /**
+         * @brief Returns a stack to the pool, recording its high water mark.
+         *
+         * @param stack Stack returned by acquire().
+         */
+        void release(stack_type* stack) noexcept {
+            const auto slot = index_of(*stack);
+            record(slot);
+            m_used &= ~(1u << slot);
+        }
+
+        /**
+         * @brief Bytes of a stack used so far, measured from the top.
+         *
+         * @param stack Stack returned by acquire().
+         */
+        [[nodiscard]]
+        std::size_t high_water(const stack_type& stack) const noexcept {
+            const auto* untouched = std::find_if(std::begin(stack), std::end(stack), [](u32 word) {
+                return word != paint;
+            });
+            return std::size_t(std::end(stack) - untouched) * 4;
+        }
+
+        /**
+         * @brief Tests if a stack has written into its guard band.
+         *
+         * @param stack Stack returned by acquire().
+         */
+        [[nodiscard]]
+        bool overflowed(const stack_type& stack) const noexcept {
+            return std::any_of(std::begin(stack), std::begin(stack) + guard_size / 4, [](u32 word) {
+                return word != paint;
+            });
+        }
+
+        /**
+         * @brief Deepest usage of any stack in the pool, in bytes, including the stacks still in use.
+         */
+        [[nodiscard]]
+        std::size_t peak() const noexcept {
+            std::size_t result = 0;
+            for (std::size_t slot = 0; slot < Count; ++slot) {
+                result = std::max(result, slot_peak(slot));
+            }
+            return result;
+        }
+
+        /**
+         * @brief Tests if any stack in the pool has overflowed, including the stacks still in use.
+         */
+        [[nodiscard]]
+        bool any_overflowed() const noexcept {
+            for (std::size_t slot = 0; slot < Count; ++slot) {
+                if (slot_peak(slot) > StackSize - guard_size) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Outputs the peak usage of every stack to the mGBA logger.
+         *
+         * @param level Log level of the report.
+         *
+         * @note mGBA must be present, see mgba::open().
+         */
+        void report(mgba::log level = mgba::log::info) const noexcept {
+            for (std::size_t slot = 0; slot < Count; ++slot) {
+                const auto used = slot_peak(slot);
+                const bool overflow = used > StackSize - guard_size;
+                mgba::printf(overflow ? mgba::log::error : level, "slot %u: %u/%u bytes (%u%%)%s%s", unsigned(slot),
+                             unsigned(used), unsigned(StackSize), unsigned(used * 100 / StackSize),
+                             (m_used & (1u << slot)) ? " in use" : "", overflow ? " OVERFLOW" : "");
+            }
+        }
+
+        [[nodiscard]]
+        constexpr std::size_t size() const noexcept {
+            return std::size_t(std::popcount(m_used));
+        }
+
+        [[nodiscard]]
+        static constexpr std::size_t capacity() noexcept {
+            return Count;
+        }
+
+    private:
+        static constexpr u32 mask = Count == 32 ? ~0u : (1u << Count) - 1;
+
+        [[nodiscard]]
+        std::size_t index_of(const stack_type& stack) const noexcept {
+            return std::size_t(&stack - m_stacks);
+        }
+
+        // The paint is only valid while a stack is in use, so released stacks report their recorded peak
+        [[nodiscard]]
+        std::size_t slot_peak(std::size_t slot) const noexcept {
+            if (m_used & (1u << slot)) {
+                return std::max<std::size_t>(m_peak[slot], high_water(m_stacks[slot]));
+            }
+            return m_peak[slot];
+        }
+
+        void record(std::size_t slot) noexcept {
+            m_peak[slot] = u32(std::max<std::size_t>(m_peak[slot], high_water(m_stacks[slot])));
+        }
+
+        alignas(8) stack_type m_stacks[Count]{};
+        u32 m_peak[Count]{};
+        u32 m_used{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_MEMORY_STACK_POOL_HPP
@@ -100,6 +100,20 @@ namespace gba::mmio {
      */
     inline constexpr auto IRQ_HANDLER = registral<const_ptr<void(* volatile)()>(0x03FFFFFC)>{};
 
+    /**
+     * @brief Interrupt flags checked by the BIOS wait functions.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#default-memory-usage-at-03007fxx-and-mirrored-to-03ffffxx">Default memory usage at 03007FXX (and mirrored to 03FFFFXX)</a>
+     *
+     * bios::IntrWait() and bios::VBlankIntrWait() only return once the IRQ handler has set the awaited flags here, in
+     * addition to acknowledging them in mmio::IF.
+     *
+     * @note This "register" is actually located within IWRAM (0x03007FF8).
+     *
+     * @sa IRQ_HANDLER
+     * @sa IF
+     */
+    inline constexpr auto INTRWAIT_FLAGS = registral<const_ptr<volatile irq>(0x03FFFFF8)>{};
+
     // Video
 
     /**
@@ -1029,6 +1043,17 @@ namespace gba::mmio {
      */
     inline constexpr auto SOUNDBIAS = registral<const_ptr<volatile soundbias>(0x4000088)>{};
 
+    /**
+     * @brief Sound wave pattern RAM, holding 32 4-bit samples.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#4000090h---wave_ram0_l---channel-3-wave-pattern-ram-w-r">4000090h - WAVE_RAM0_L - Channel 3 Wave Pattern RAM (W/R)</a>
+     *
+     * Only the bank not selected by sound3cnt_l::bank1 is accessible. Each byte holds two samples, high nibble first.
+     *
+     * @sa WAVE_BANK
+     * @sa wave_stream
+     */
+    inline constexpr auto WAVE_RAM = registral_series<const_ptr<volatile u32[4]>(0x4000090)>{};
+
     /**
      * @brief Sound FIFO buffer A.
      * @see <a href="https://mgba-emu.github.io/gbatek/#40000a0h---fifo_a_l---sound-a-fifo-data-0-and-data-1-w">40000A0h - FIFO_A_L - Sound A FIFO, Data 0 and Data 1 (W)</a>
@@ -0,0 +1,308 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_SOUND_ADPCM_HPP
+#define GBAXX_SOUND_ADPCM_HPP
+/** @file */
+
+#include <cstddef>
+#include <cstdint>
+
+#include <gba/type.hpp>
+
+#include <gba/sound/mixer.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        // Read for every sample, so kept off the cartridge bus
+        [[gnu::section(".iwram._gba_adpcm_step")]]
+        inline constinit u16 adpcm_step[89] = {
+            7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97,
+            107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+            876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428,
+            4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350,
+            22385, 24623, 27086, 29794, 32767
+        };
+
+        [[gnu::section(".iwram._gba_adpcm_step")]]
+        inline constinit std::int8_t adpcm_index[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+        struct adpcm_state {
+            const u8* src;
+            const u8* end;
+            const u8* block_end;
+            std::size_t block_align;
+            int predictor;
+            int index;
+            u8 byte;
+            bool high;
+        };
+
+        // Decodes up to count samples, returning fewer once the data runs out
+        [[gnu::section(".iwram._gba_adpcm_decode"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline std::size_t adpcm_decode(adpcm_state& s, std::int8_t* __restrict__ dest, std::size_t count) noexcept {
+            const auto* src = s.src;
+            const auto* block_end = s.block_end;
+            auto predictor = s.predictor;
+            auto index = s.index;
+            auto byte = s.byte;
+            auto high = s.high;
+
+            std::size_t done = 0;
+            while (done < count) {
+                unsigned nibble;
+                if (high) {
+                    nibble = byte >> 4;
+                    high = false;
+                } else if (src != block_end) {
+                    byte = *src++;
+                    nibble = byte & 0xf;
+                    high = true;
+                } else {
+                    // Each block starts with its first sample and step index, as in WAV (IMA ADPCM)
+                    if (s.end - src < 4) {
+                        break;
+                    }
+                    predictor = std::int16_t(src[0] | src[1] << 8);
+                    index = src[2] > 88 ? 88 : src[2];
+                    src += 4;
+                    block_end = std::size_t(s.end - src) > s.block_align - 4 ? src + (s.block_align - 4) : s.end;
+                    dest[done++] = std::int8_t(predictor >> 8);
+                    continue;
+                }
+
+                const int step = adpcm_step[index];
+                int diff = step >> 3;
+                if (nibble & 1) {
+                    diff += step >> 2;
+                }
+                if (nibble & 2) {
+                    diff += step >> 1;
+                }
+                if (nibble & 4) {
+                    diff += step;
+                }
+                predictor += (nibble & 8) ? -diff : diff;
+                predictor = predictor > 32767 ? 32767 : predictor < -32768 ? -32768 : predictor;
+
+                index += adpcm_index[nibble & 7];
+                index = index < 0 ? 0 : index > 88 ? 88 : index;
+
+                dest[done++] = std::int8_t(predictor >> 8);
+            }
+
+            s.src = src;
+            s.block_end = block_end;
+            s.predictor = predictor;
+            s.index = index;
+            s.byte = byte;
+            s.high = high;
+            return done;
+        }
+
+    } // namespace detail
+
+    /**
+     * @class adpcm_stream
+     * @brief Mixer voice source decoding 4-bit IMA ADPCM, at a quarter of the ROM size and bandwidth of 16-bit PCM.
+     * @see <a href="https://wiki.multimedia.cx/index.php/IMA_ADPCM">IMA ADPCM</a>
+     *
+     * The voice plays a looping ring of decoded 8-bit samples. update() checks how far the mixer has read through the
+     * ring and decodes the next stretch of ADPCM into the part that has been played, so each frame decodes only what
+     * the voice consumes, with the ARM decoder in IWRAM.
+     *
+     * Data is mono IMA ADPCM in WAV layout: blocks of `block_align` bytes that begin with the first sample and the step
+     * index, followed by two samples per byte, low nibble first.
+     *
+     * @tparam RingSize Decoded samples buffered ahead of the mixer. This must be more than a frame of samples at the
+     *                  playback rate (550 at 32768Hz).
+     *
+     * @code{cpp}
+     * // Playing a voice line from ROM
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const gba::u8 line_adpcm[]; // e.g. ffmpeg -i line.wav -ac 1 -ar 16384 -c:a adpcm_ima_wav line.wav
+     * extern const std::size_t line_adpcm_size;
+     *
+     * static gba::mixer<4> audio;
+     * static gba::adpcm_stream<> line;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     // ... interrupts, and audio.start(), as for the mixer
+     *
+     *     line.open(line_adpcm, line_adpcm_size, 512, 16384);
+     *     line.play(audio);
+     *
+     *     while (true) {
+     *         line.update(audio);
+     *         audio.mix();
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note update() must be called every frame before mixer::mix().
+     *
+     * @sa mixer
+     */
+    template <std::size_t RingSize = 1024> requires (RingSize >= 64)
+    class adpcm_stream {
+    public:
+        static constexpr std::size_t ring_size = RingSize;
+
+        constexpr adpcm_stream() noexcept = default;
+
+        adpcm_stream(const adpcm_stream&) = delete;
+        adpcm_stream& operator=(const adpcm_stream&) = delete;
+
+        /**
+         * @brief Sets the data to stream.
+         *
+         * @param data ADPCM blocks, which must remain valid while playing.
+         * @param size Size of the data in bytes.
+         * @param block_align Bytes per block, including the 4 byte header.
+         * @param rate Playback rate in Hz.
+         * @param loop Restart from the beginning at the end of the data.
+         * @return False if block_align is too small.
+         */
+        bool open(const void* data, std::size_t size, std::size_t block_align, u32 rate, bool loop = false) noexcept {
+            if (block_align < 5) {
+                return false;
+            }
+            m_data = static_cast<const u8*>(data);
+            m_size = size;
+            m_block_align = block_align;
+            m_rate = rate;
+            m_loop = loop;
+            m_voice = -1;
+            return true;
+        }
+
+        /**
+         * @brief Fills the ring and starts a mixer voice on it.
+         *
+         * @param mixer Mixer to play on.
+         * @param volume Volume, from 0 to 64.
+         * @param pan Stereo panning, from -64 (left) to 64 (right).
+         * @return Voice index, or -1 if every voice is playing.
+         */
+        template <typename Mixer>
+        int play(Mixer& mixer, int volume = Mixer::max_volume, int pan = 0) noexcept {
+            stop(mixer);
+            rewind();
+            m_remaining = 0;
+            m_write = 0;
+            m_read = 0;
+            fill(RingSize);
+
+            m_voice = mixer.play(sound_sample{m_ring, RingSize, RingSize, m_rate}, volume, pan);
+            return m_voice;
+        }
+
+        /**
+         * @brief Decodes over the samples that the voice has played, stopping it once the data has finished.
+         *
+         * @param mixer Mixer the voice was started on.
+         */
+        template <typename Mixer>
+        void update(Mixer& mixer) noexcept {
+            if (m_voice < 0) {
+                return;
+            }
+            if (!mixer.playing(m_voice)) {
+                m_voice = -1;
+                return;
+            }
+
+            const auto read = mixer.position(m_voice);
+            const auto played = read >= m_read ? read - m_read : read + RingSize - m_read;
+            m_read = read;
+
+            if (played >= m_remaining && !m_data_left) {
+                stop(mixer);
+                return;
+            }
+            m_remaining -= played;
+            fill(played);
+        }
+
+        /**
+         * @brief Stops the voice.
+         */
+        template <typename Mixer>
+        void stop(Mixer& mixer) noexcept {
+            if (m_voice >= 0) {
+                mixer.stop(m_voice);
+                m_voice = -1;
+            }
+        }
+
+        [[nodiscard]]
+        bool playing() const noexcept {
+            return m_voice >= 0;
+        }
+
+        [[nodiscard]]
+        int voice() const noexcept {
+            return m_voice;
+        }
+
+    private:
+        void rewind() noexcept {
+            m_state = {m_data, m_data + m_size, m_data, m_block_align, 0, 0, 0, false};
+            m_data_left = m_size >= 4;
+        }
+
+        // Decodes count samples at the write position, padding with silence after the end
+        void fill(std::size_t count) noexcept {
+            while (count) {
+                const auto span = RingSize - m_write < count ? RingSize - m_write : count;
+                auto done = m_data_left ? detail::adpcm_decode(m_state, m_ring + m_write, span) : 0;
+                if (done < span && m_data_left) {
+                    if (m_loop) {
+                        rewind();
+                    } else {
+                        m_data_left = false;
+                    }
+                }
+                if (!m_data_left) {
+                    for (auto ii = done; ii < span; ++ii) {
+                        m_ring[m_write + ii] = 0;
+                    }
+                }
+                m_remaining += done;
+                // Looping streams keep decoding into the rest of the span
+                const auto advance = m_data_left ? done : span;
+                m_write = (m_write + advance) % RingSize;
+                count -= advance;
+            }
+        }
+
+        detail::adpcm_state m_state{};
+        const u8* m_data{};
+        std::size_t m_size{};
+        std::size_t m_block_align{};
+        std::size_t m_write{};
+        std::size_t m_read{};
+        std::size_t m_remaining{};
+        u32 m_rate{};
+        int m_voice{-1};
+        bool m_loop{};
+        bool m_data_left{};
+        alignas(4) std::int8_t m_ring[RingSize]{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_SOUND_ADPCM_HPP
@@ -0,0 +1,406 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_SOUND_MIXER_HPP
+#define GBAXX_SOUND_MIXER_HPP
+/** @file */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+namespace gba {
+
+    /**
+     * @struct sound_sample
+     * @brief Signed 8-bit PCM sample data for the mixer.
+     *
+     * @sa mixer
+     */
+    struct sound_sample {
+        const std::int8_t* data; /**< PCM data, typically in ROM. */
+        std::size_t length; /**< Number of samples. */
+        std::size_t loop_length; /**< Number of samples at the end that loop, or 0 for a one-shot sound. */
+        u32 rate; /**< Playback rate in Hz at the original pitch. */
+    };
+
+    namespace detail {
+
+        struct mixer_voice {
+            const std::int8_t* data;
+            u32 position; // 20.12 fixed-point sample index
+            u32 step;
+            u32 end;
+            u32 loop;
+            int volume_left;
+            int volume_right;
+            u32 generation; // Counts play() calls, so a stale voice index can be told apart from its reuse
+        };
+
+        // Returns false when a one-shot voice ends
+        [[gnu::always_inline]]
+        inline bool mixer_advance(mixer_voice& v, u32& position) noexcept {
+            while (position >= v.end) {
+                if (!v.loop) {
+                    v.data = nullptr;
+                    return false;
+                }
+                position -= v.loop;
+            }
+            return true;
+        }
+
+        [[gnu::section(".iwram._gba_mixer_mono"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void mixer_mix_mono(mixer_voice& v, int* __restrict__ accum, std::size_t samples) noexcept {
+            const auto* const data = v.data;
+            const auto step = v.step;
+            const auto volume = v.volume_left;
+            auto position = v.position;
+            while (samples--) {
+                if (!mixer_advance(v, position)) {
+                    return;
+                }
+                *accum++ += data[position >> 12] * volume;
+                position += step;
+            }
+            v.position = position;
+        }
+
+        [[gnu::section(".iwram._gba_mixer_stereo"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void mixer_mix_stereo(mixer_voice& v, int* __restrict__ accum, std::size_t samples) noexcept {
+            const auto* const data = v.data;
+            const auto step = v.step;
+            const auto left = v.volume_left;
+            const auto right = v.volume_right;
+            auto position = v.position;
+            while (samples--) {
+                if (!mixer_advance(v, position)) {
+                    return;
+                }
+                const int sample = data[position >> 12];
+                accum[0] += sample * left;
+                accum[1] += sample * right;
+                accum += 2;
+                position += step;
+            }
+            v.position = position;
+        }
+
+        // Clamps the accumulated samples into 8-bit output (de-interleaving stereo), and clears the accumulator
+        [[gnu::section(".iwram._gba_mixer_resolve"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void mixer_resolve(int* __restrict__ accum, std::int8_t* __restrict__ out, std::size_t samples, std::size_t stride, std::ptrdiff_t channel_offset) noexcept {
+            while (samples--) {
+                for (std::size_t ii = 0; ii < stride; ++ii) {
+                    auto value = accum[ii] >> 6;
+                    value = value > 127 ? 127 : value < -128 ? -128 : value;
+                    out[std::ptrdiff_t(ii) * channel_offset] = std::int8_t(value);
+                    accum[ii] = 0;
+                }
+                accum += stride;
+                ++out;
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * @class mixer
+     * @brief Software mixer for DirectSound, mixing PCM voices into DMA fed FIFOs.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#gba-sound-channel-a-and-b---directsound">GBA Sound Channel A and B - DirectSound</a>
+     *
+     * Voices are resampled, scaled by volume, and summed by ARM kernels in IWRAM. Output is double buffered: DMA1
+     * streams one frame's worth of samples into FIFO A (and DMA2 into FIFO B, for stereo) while mix() prepares the
+     * next. Timer 0 runs at exactly SamplesPerFrame samples per frame, so vblank() only has to restart the DMA every
+     * other frame to keep the buffers in step.
+     *
+     * @tparam Voices Maximum number of voices playing at once.
+     * @tparam SamplesPerFrame Output samples per frame. 304 gives ~18157Hz, 608 gives ~36314Hz.
+     * @tparam Stereo Mix separate left (FIFO A) and right (FIFO B) outputs, with panning.
+     *
+     * @code{cpp}
+     * // Playing a sound effect
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const std::int8_t jump_pcm[];
+     * extern const std::size_t jump_pcm_size;
+     *
+     * static gba::mixer<4> audio;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.vblank) {
+     *             audio.vblank();
+     *         }
+     *     });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true};
+     *     mmio::IME = true;
+     *
+     *     bios::VBlankIntrWait();
+     *     audio.start();
+     *
+     *     audio.play(sound_sample{jump_pcm, jump_pcm_size, 0, 16000});
+     *     while (true) {
+     *         audio.mix();
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note mix() must be called once per frame, and complete before the next VBlank.
+     * @note Timer 0 and DMA1 (and DMA2 for stereo) are reserved while the mixer is running.
+     *
+     * @sa sound_sample
+     * @sa mmio::FIFO_A
+     * @sa mmio::FIFO_B
+     */
+    template <std::size_t Voices, std::size_t SamplesPerFrame = 304, bool Stereo = false>
+        requires (Voices > 0 && SamplesPerFrame % 16 == 0 && 280896 % SamplesPerFrame == 0)
+    class mixer {
+    public:
+        static constexpr auto voices = Voices;
+        static constexpr auto samples_per_frame = SamplesPerFrame;
+        static constexpr auto cycles_per_sample = 280896 / SamplesPerFrame;
+        static constexpr u32 sample_rate = (1u << 24) / cycles_per_sample;
+        static constexpr int max_volume = 64;
+
+        constexpr mixer() noexcept = default;
+
+        mixer(const mixer&) = delete;
+        mixer& operator=(const mixer&) = delete;
+
+        /**
+         * @brief Enables sound output, and starts the timer and DMA.
+         *
+         * Intended to be called immediately after a VBlank, so the buffer swaps in vblank() line up with the timer.
+         */
+        void start() noexcept {
+            mmio::SOUND_ENABLED = soundcnt_x{.enabled = true};
+
+            mmio::TIMER0_CONTROL = tmcnt_h{};
+            mmio::TIMER0_RELOAD = short(-cycles_per_sample);
+
+            m_active = 0;
+            restart();
+            mmio::TIMER0_CONTROL = tmcnt_h{.enabled = true};
+        }
+
+        /**
+         * @brief Stops the timer and DMA.
+         */
+        void stop() noexcept {
+            mmio::TIMER0_CONTROL = tmcnt_h{};
+            mmio::DMA1_CONTROL = dmacnt_h{};
+            if constexpr (Stereo) {
+                mmio::DMA2_CONTROL = dmacnt_h{};
+            }
+        }
+
+        /**
+         * @brief Swaps the buffers.
+         *
+         * Must be called at the very start of the VBlank interrupt handler.
+         */
+        void vblank() noexcept {
+            m_active = m_active ^ 1;
+            if (!m_active) {
+                // The DMA has read ahead into the mirror past the end of the second buffer
+                restart();
+            }
+        }
+
+        /**
+         * @brief Mixes every playing voice into the buffer that is not being played.
+         */
+        void mix() noexcept {
+            for (auto& v : m_voices) {
+                if (!v.data) {
+                    continue;
+                }
+                if constexpr (Stereo) {
+                    detail::mixer_mix_stereo(v, m_accum, SamplesPerFrame);
+                } else {
+                    detail::mixer_mix_mono(v, m_accum, SamplesPerFrame);
+                }
+            }
+
+            const auto half = m_active ^ 1;
+            detail::mixer_resolve(m_accum, m_buffers[0] + half * SamplesPerFrame, SamplesPerFrame, channels, buffer_size);
+            if (!half) {
+                // Mirrored past the end of the second half, for the DMA to read ahead into before it is restarted
+                for (auto& buffer : m_buffers) {
+                    std::copy_n(buffer, fifo_prefetch, buffer + SamplesPerFrame * 2);
+                }
+            }
+        }
+
+        /**
+         * @brief Starts a voice.
+         *
+         * @param sample PCM data to play.
+         * @param volume Volume, from 0 to 64.
+         * @param pan Stereo panning, from -64 (left) to 64 (right). Ignored for mono.
+         * @return Voice index, or -1 if every voice is playing.
+         */
+        int play(const sound_sample& sample, int volume = max_volume, int pan = 0) noexcept {
+            for (std::size_t ii = 0; ii < Voices; ++ii) {
+                auto& v = m_voices[ii];
+                if (v.data) {
+                    continue;
+                }
+                v.position = 0;
+                v.end = u32(sample.length) << 12;
+                v.loop = u32(sample.loop_length) << 12;
+                v.step = step_for(sample.rate);
+                set_volume_internal(v, volume, pan);
+                ++v.generation;
+                v.data = sample.data;
+                return int(ii);
+            }
+            return -1;
+        }
+
+        /**
+         * @brief Stops a voice.
+         *
+         * @param voice Voice index returned by play().
+         */
+        void stop(int voice) noexcept {
+            m_voices[voice].data = nullptr;
+        }
+
+        /**
+         * @brief Stops every voice.
+         */
+        void stop_all() noexcept {
+            for (auto& v : m_voices) {
+                v.data = nullptr;
+            }
+        }
+
+        /**
+         * @brief Changes the volume and panning of a voice.
+         *
+         * @param voice Voice index returned by play().
+         * @param volume Volume, from 0 to 64.
+         * @param pan Stereo panning, from -64 (left) to 64 (right). Ignored for mono.
+         */
+        void set_volume(int voice, int volume, int pan = 0) noexcept {
+            set_volume_internal(m_voices[voice], volume, pan);
+        }
+
+        /**
+         * @brief Changes the pitch of a voice.
+         *
+         * @param voice Voice index returned by play().
+         * @param rate Playback rate in Hz.
+         */
+        void set_rate(int voice, u32 rate) noexcept {
+            m_voices[voice].step = step_for(rate);
+        }
+
+        /**
+         * @brief Sample a voice has played up to, as of the last mix().
+         *
+         * @param voice Voice index returned by play().
+         * @return Index into the sample data.
+         */
+        [[nodiscard]]
+        std::size_t position(int voice) const noexcept {
+            return m_voices[voice].position >> 12;
+        }
+
+        /**
+         * @brief Tests if a voice is still playing.
+         *
+         * @param voice Voice index returned by play().
+         * @return True if the voice is playing.
+         */
+        [[nodiscard]]
+        bool playing(int voice) const noexcept {
+            return m_voices[voice].data != nullptr;
+        }
+
+        /**
+         * @brief Number of times a voice has been started by play().
+         *
+         * A voice index is reused by play() once its sound ends, so code that keeps an index can keep the generation
+         * too, and check it is unchanged before modifying the voice.
+         *
+         * @param voice Voice index returned by play().
+         * @return Generation of the voice.
+         */
+        [[nodiscard]]
+        u32 generation(int voice) const noexcept {
+            return m_voices[voice].generation;
+        }
+
+    private:
+        static constexpr std::size_t channels = Stereo ? 2 : 1;
+
+        // Bytes the FIFO DMA may have read beyond what has been played (a full 32 byte FIFO)
+        static constexpr std::size_t fifo_prefetch = 32;
+        static constexpr std::size_t buffer_size = SamplesPerFrame * 2 + fifo_prefetch;
+
+        // Source samples per output sample, in 20.12 fixed-point
+        static constexpr u32 step_for(u32 rate) noexcept {
+            return u32((static_cast<unsigned long long>(rate) * cycles_per_sample) >> 12);
+        }
+
+        static void set_volume_internal(detail::mixer_voice& v, int volume, int pan) noexcept {
+            if constexpr (Stereo) {
+                v.volume_left = volume * (max_volume - (pan > 0 ? pan : 0)) / max_volume;
+                v.volume_right = volume * (max_volume + (pan < 0 ? pan : 0)) / max_volume;
+            } else {
+                v.volume_left = volume;
+            }
+        }
+
+        // The FIFOs are reset, dropping the samples that were read ahead from the mirror, so the restarted DMA
+        // continues with the first sample of the buffer that follows the last one played
+        void restart() noexcept {
+            constexpr auto control = dmacnt_h{.dest_control = dest_addr::fixed, .repeat = true, .transfer_32bit = true,
+                                              .start_time = start::special, .enabled = true};
+            mmio::DMA1_CONTROL = dmacnt_h{};
+            if constexpr (Stereo) {
+                mmio::DMA2_CONTROL = dmacnt_h{};
+                mmio::SOUND_MIX = soundcnt_h{.volume = volume::_100, .sound_a_full = true, .sound_b_full = true,
+                                             .sound_a_left = true, .sound_a_reset = true,
+                                             .sound_b_right = true, .sound_b_reset = true};
+            } else {
+                mmio::SOUND_MIX = soundcnt_h{.volume = volume::_100, .sound_a_full = true,
+                                             .sound_a_right = true, .sound_a_left = true, .sound_a_reset = true};
+            }
+
+            mmio::DMA1_SRC = m_buffers[0];
+            mmio::DMA1_DEST = const_cast<u32*>(&mmio::FIFO_A);
+            mmio::DMA1_CONTROL = control;
+            if constexpr (Stereo) {
+                mmio::DMA2_SRC = m_buffers[1];
+                mmio::DMA2_DEST = const_cast<u32*>(&mmio::FIFO_B);
+                mmio::DMA2_CONTROL = control;
+            }
+        }
+
+        detail::mixer_voice m_voices[Voices]{};
+        int m_accum[SamplesPerFrame * channels]{};
+        alignas(4) std::int8_t m_buffers[channels][buffer_size]{};
+        volatile u32 m_active{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_SOUND_MIXER_HPP
@@ -0,0 +1,669 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_SOUND_TRACKER_HPP
+#define GBAXX_SOUND_TRACKER_HPP
+/** @file */
+
+#include <cstddef>
+#include <cstdint>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+#include <gba/debug/profile.hpp>
+#include <gba/interrupt/guard.hpp>
+#include <gba/math/trig.hpp>
+#include <gba/sound/mixer.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        // Amiga PAL clock in Hz divided by two (the rate of period 1), scaled by 2^(finetune / 96)
+        inline constexpr u32 mod_clock[16] = {
+            3546895, 3572597, 3598486, 3624562, 3650827, 3677282, 3703929, 3730770,
+            3347823, 3372083, 3396518, 3421131, 3445922, 3470892, 3496044, 3521378
+        };
+
+        // Period multipliers of 2^(-semitones / 12), in 16.16 fixed-point
+        inline constexpr u32 mod_semitone[16] = {
+            65536, 61858, 58386, 55109, 52016, 49097, 46341, 43740,
+            41285, 38968, 36781, 34716, 32768, 30929, 29193, 27554
+        };
+
+        inline constexpr u16 mod_period_min = 113;
+        inline constexpr u16 mod_period_max = 856;
+
+        [[nodiscard]]
+        constexpr u32 mod_word(const u8* p) noexcept {
+            return u32(p[0] << 8 | p[1]) * 2; // Big-endian count of 16-bit words
+        }
+
+        struct mod_instrument {
+            const std::int8_t* data;
+            u32 length;
+            u32 loop_length;
+            u32 clock;
+            u8 volume;
+        };
+
+        struct mod_channel {
+            const mod_instrument* instrument;
+            int voice{-1};
+            u32 generation; // Mixer generation of voice, so a voice reused by another sound is left alone
+            u32 start;
+            u16 period;
+            u16 target;
+            u16 output;
+            u16 delay_period;
+            u8 volume;
+            u8 effect;
+            u8 param;
+            u8 porta_speed;
+            u8 vibrato_speed;
+            u8 vibrato_depth;
+            u8 vibrato_position;
+            u8 offset;
+            u8 delay;
+            bool trigger;
+            bool dirty;
+        };
+
+    } // namespace detail
+
+    /**
+     * @class tracker
+     * @brief Music player for ProTracker MOD songs, played through the DirectSound mixer.
+     * @see <a href="https://www.aes.id.au/modformat.html">MOD format</a>
+     *
+     * The song is read in place from ROM. The sequencer ticks from a timer interrupt at the song tempo (BPM * 2 / 5 Hz),
+     * decoding rows and running the effects on the channel state. update() then hands the changes to the mixer voices,
+     * so the voices are never modified while mixer::mix() is resampling them in IWRAM.
+     *
+     * Supported effects are arpeggio (0), portamento (1, 2, 3), vibrato (4) using the sine table, the combined slides
+     * (5, 6), sample offset (9), volume slide (A), position jump (B), volume (C), pattern break (D), speed and tempo (F),
+     * and fine portamento (E1, E2), fine volume slide (EA, EB), note cut (EC), and note delay (ED). Others are ignored.
+     *
+     * With profiling enabled, the cycles spent in the sequencer and update() are added up and recorded as one
+     * "tracker" scope per frame.
+     *
+     * @tparam Mixer Mixer class, with at least as many voices as the song has channels.
+     * @tparam Timer Timer used for the sequencer tick.
+     * @tparam Channels Maximum number of channels. 4, 6, and 8 channel songs are supported.
+     *
+     * @code{cpp}
+     * // Playing a song with its cost reported to mGBA
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const gba::u8 song_mod[];
+     * extern const std::size_t song_mod_size;
+     *
+     * static gba::mixer<4, 304, true> audio;
+     * static gba::tracker<decltype(audio)> music{audio};
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.vblank) {
+     *             audio.vblank();
+     *         }
+     *         if (flags.timer1) {
+     *             music.on_timer();
+     *         }
+     *     });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true, .timer1 = true};
+     *     mmio::IME = true;
+     *
+     *     mgba::open();
+     *     profile::start();
+     *     music.enable_profiling();
+     *
+     *     bios::VBlankIntrWait();
+     *     audio.start();
+     *     music.load(song_mod, song_mod_size);
+     *     music.play();
+     *
+     *     for (int frame = 0; ; ++frame) {
+     *         music.update();
+     *         audio.mix();
+     *         if (frame % 60 == 59) {
+     *             profile::samples.report(); // tracker: n=60 min=... (x.xx% frame)
+     *             profile::samples.clear();
+     *         }
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note Timer 1 is the default. The profiler owns timers 2 and 3, and the mixer owns timer 0.
+     *
+     * @sa mixer
+     * @sa profile::history
+     */
+    template <typename Mixer, std::size_t Timer = 1, std::size_t Channels = 8> requires (Timer < 4 && Channels >= 4)
+    class tracker {
+    public:
+        static constexpr std::size_t max_channels = Channels;
+        static constexpr int max_volume = 64;
+
+        explicit constexpr tracker(Mixer& mixer) noexcept : m_mixer{mixer} {}
+
+        tracker(const tracker&) = delete;
+        tracker& operator=(const tracker&) = delete;
+
+        /**
+         * @brief Reads the header of a MOD file.
+         *
+         * @param data MOD file, which must remain valid while it plays.
+         * @param size Size of the file in bytes.
+         * @return False if the file is not a supported MOD, or is truncated.
+         */
+        bool load(const void* data, std::size_t size) noexcept {
+            stop();
+            m_song = nullptr;
+
+            const auto* mod = static_cast<const u8*>(data);
+            if (size < 1084) {
+                return false;
+            }
+
+            const auto* tag = mod + 1080;
+            const auto is = [tag](const char* str) {
+                return tag[0] == str[0] && tag[1] == str[1] && tag[2] == str[2] && tag[3] == str[3];
+            };
+            if (is("M.K.") || is("M!K!") || is("FLT4") || is("4CHN")) {
+                m_channel_count = 4;
+            } else if (is("6CHN")) {
+                m_channel_count = 6;
+            } else if (is("8CHN")) {
+                m_channel_count = 8;
+            } else {
+                return false;
+            }
+            if (m_channel_count > Channels) {
+                return false;
+            }
+
+            m_length = mod[950];
+            if (m_length == 0 || m_length > 128) {
+                return false;
+            }
+            m_orders = mod + 952;
+
+            std::size_t patterns = 0;
+            for (std::size_t ii = 0; ii < 128; ++ii) {
+                patterns = m_orders[ii] + 1u > patterns ? m_orders[ii] + 1u : patterns;
+            }
+            m_patterns = mod + 1084;
+
+            auto* samples = reinterpret_cast<const std::int8_t*>(m_patterns + patterns * 64 * 4 * m_channel_count);
+            for (std::size_t ii = 0; ii < 31; ++ii) {
+                const auto* header = mod + 20 + ii * 30;
+                auto length = detail::mod_word(header + 22);
+                const auto loop_start = detail::mod_word(header + 26);
+                const auto loop_length = detail::mod_word(header + 28);
+
+                auto& instrument = m_instruments[ii];
+                instrument.data = samples;
+                samples += length;
+
+                if (loop_length > 2 && loop_start + loop_length <= length) {
+                    length = loop_start + loop_length; // Anything after the loop is never heard
+                    instrument.loop_length = loop_length;
+                } else {
+                    instrument.loop_length = 0;
+                }
+                instrument.length = length;
+                instrument.clock = detail::mod_clock[header[24] & 0xf];
+                instrument.volume = header[25] > max_volume ? max_volume : header[25];
+            }
+            if (reinterpret_cast<const u8*>(samples) > mod + size) {
+                return false;
+            }
+
+            m_song = mod;
+            return true;
+        }
+
+        /**
+         * @brief Starts the song and the sequencer timer.
+         *
+         * @param order Position in the order table to start from.
+         */
+        void play(std::size_t order = 0) noexcept {
+            if (!m_song) {
+                return;
+            }
+            stop();
+
+            for (auto& c : m_channels) {
+                c = {};
+            }
+            m_order = order < m_length ? order : 0;
+            m_row = 0;
+            m_tick = 0;
+            m_speed = 6;
+            m_jump = false;
+
+            set_tempo(125);
+            volatile_store(&mmio::TIMER_CONTROL[Timer], tmcnt_h{.scale = timer_scale::_64, .overflow_irq = true, .enabled = true});
+            m_playing = true;
+        }
+
+        /**
+         * @brief Stops the timer and every voice the song was using.
+         */
+        void stop() noexcept {
+            volatile_store(&mmio::TIMER_CONTROL[Timer], tmcnt_h{});
+            m_playing = false;
+            for (auto& c : m_channels) {
+                if (owns_voice(c)) {
+                    m_mixer.stop(c.voice);
+                }
+                c.voice = -1;
+                c.trigger = false;
+            }
+        }
+
+        /**
+         * @brief Sets the master volume of the song.
+         *
+         * @param volume Volume, from 0 to 64.
+         */
+        void set_volume(int volume) noexcept {
+            m_volume = u8(volume);
+            for (auto& c : m_channels) {
+                c.dirty = true;
+            }
+        }
+
+        /**
+         * @brief Records the cycles spent on music each frame into a profiler history.
+         *
+         * @param history History receiving one "tracker" record per update().
+         *
+         * @note profile::start() must have been called.
+         */
+        void enable_profiling(profile::history<256>& history = profile::samples) noexcept {
+            m_history = &history;
+            m_cycles = 0;
+        }
+
+        void disable_profiling() noexcept {
+            m_history = nullptr;
+        }
+
+        /**
+         * @brief Runs one sequencer tick. Call from the interrupt handler of the timer.
+         */
+        void on_timer() noexcept {
+            if (!m_playing) {
+                return;
+            }
+            const auto start = m_history ? profile::cycles() : 0;
+
+            if (m_tick == 0) {
+                row();
+            } else {
+                for (std::size_t ii = 0; ii < m_channel_count; ++ii) {
+                    effect_tick(m_channels[ii]);
+                }
+            }
+
+            if (++m_tick >= m_speed) {
+                m_tick = 0;
+                advance();
+            }
+
+            if (m_history) {
+                m_cycles += profile::cycles() - start;
+            }
+        }
+
+        /**
+         * @brief Applies the changes made by the sequencer to the mixer voices.
+         *
+         * Call once per frame, before mixer::mix().
+         */
+        void update() noexcept {
+            const auto start = m_history ? profile::cycles() : 0;
+
+            irq_guard guard{};
+            for (std::size_t ii = 0; ii < m_channel_count; ++ii) {
+                apply(m_channels[ii], ii);
+            }
+
+            if (m_history) {
+                m_history->push("tracker", m_cycles + (profile::cycles() - start));
+                m_cycles = 0;
+            }
+        }
+
+        [[nodiscard]]
+        bool playing() const noexcept {
+            return m_playing;
+        }
+
+        [[nodiscard]]
+        std::size_t order() const noexcept {
+            return m_order;
+        }
+
+        [[nodiscard]]
+        std::size_t row_index() const noexcept {
+            return m_row;
+        }
+
+    private:
+        static constexpr u16 clamp_period(int period) noexcept {
+            return u16(period < detail::mod_period_min ? detail::mod_period_min : period > detail::mod_period_max ? detail::mod_period_max : period);
+        }
+
+        static constexpr u8 clamp_volume(int volume) noexcept {
+            return u8(volume < 0 ? 0 : volume > max_volume ? max_volume : volume);
+        }
+
+        void set_tempo(unsigned bpm) noexcept {
+            // BPM * 2 / 5 ticks per second, at 2^24 / 64 timer ticks per second
+            volatile_store(&mmio::TIMER_RELOAD[Timer], u16(-int(655360 / bpm)));
+        }
+
+        void advance() noexcept {
+            if (m_jump) {
+                m_jump = false;
+                m_order = m_jump_order;
+                m_row = m_jump_row;
+            } else if (++m_row == 64) {
+                m_row = 0;
+                ++m_order;
+            }
+            if (m_order >= m_length) {
+                m_order = 0;
+            }
+        }
+
+        void row() noexcept {
+            const auto* cell = m_patterns + (std::size_t(m_orders[m_order]) * 64 + m_row) * 4 * m_channel_count;
+            for (std::size_t ii = 0; ii < m_channel_count; ++ii, cell += 4) {
+                auto& c = m_channels[ii];
+                const auto instrument = (cell[0] & 0xf0) | (cell[2] >> 4);
+                const auto period = u16((cell[0] & 0x0f) << 8 | cell[1]);
+                c.effect = cell[2] & 0x0f;
+                c.param = cell[3];
+
+                if (instrument && instrument <= 31) {
+                    c.instrument = &m_instruments[instrument - 1];
+                    c.volume = c.instrument->volume;
+                    c.dirty = true;
+                }
+
+                if (period) {
+                    if (c.effect == 0x3 || c.effect == 0x5) {
+                        c.target = period;
+                    } else if (c.effect == 0xe && (c.param >> 4) == 0xd && (c.param & 0xf)) {
+                        c.delay_period = period;
+                        c.delay = c.param & 0xf;
+                    } else {
+                        trigger(c, period);
+                    }
+                }
+
+                effect_row(c);
+            }
+        }
+
+        void trigger(detail::mod_channel& c, u16 period) noexcept {
+            c.period = period;
+            c.output = period;
+            c.vibrato_position = 0;
+            c.start = 0;
+            if (c.effect == 0x9) {
+                if (c.param) {
+                    c.offset = c.param;
+                }
+                c.start = u32(c.offset) << 8;
+            }
+            c.trigger = true;
+            c.dirty = true;
+        }
+
+        void effect_row(detail::mod_channel& c) noexcept {
+            const auto x = c.param >> 4;
+            const auto y = c.param & 0xf;
+            if (c.output != c.period) {
+                c.output = c.period; // Ends the vibrato or arpeggio of the previous row
+                c.dirty = true;
+            }
+
+            switch (c.effect) {
+            case 0x3:
+                if (c.param) {
+                    c.porta_speed = c.param;
+                }
+                break;
+            case 0x4:
+                if (x) {
+                    c.vibrato_speed = u8(x);
+                }
+                if (y) {
+                    c.vibrato_depth = u8(y);
+                }
+                break;
+            case 0xb:
+                m_jump = true;
+                m_jump_order = c.param;
+                m_jump_row = 0;
+                break;
+            case 0xc:
+                c.volume = clamp_volume(c.param);
+                c.dirty = true;
+                break;
+            case 0xd:
+                if (!m_jump) {
+                    m_jump_order = m_order + 1;
+                }
+                m_jump = true;
+                m_jump_row = u8((x * 10 + y) & 63);
+                break;
+            case 0xe:
+                switch (x) {
+                case 0x1:
+                    c.period = clamp_period(c.period - y);
+                    c.output = c.period;
+                    c.dirty = true;
+                    break;
+                case 0x2:
+                    c.period = clamp_period(c.period + y);
+                    c.output = c.period;
+                    c.dirty = true;
+                    break;
+                case 0xa:
+                    c.volume = clamp_volume(c.volume + y);
+                    c.dirty = true;
+                    break;
+                case 0xb:
+                    c.volume = clamp_volume(c.volume - y);
+                    c.dirty = true;
+                    break;
+                case 0xc:
+                    if (y == 0) {
+                        c.volume = 0;
+                        c.dirty = true;
+                    }
+                    break;
+                default:
+                    break;
+                }
+                break;
+            case 0xf:
+                if (c.param == 0) {
+                    break;
+                }
+                if (c.param < 32) {
+                    m_speed = c.param;
+                } else {
+                    set_tempo(c.param);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        void effect_tick(detail::mod_channel& c) noexcept {
+            const auto x = c.param >> 4;
+            const auto y = c.param & 0xf;
+
+            switch (c.effect) {
+            case 0x0:
+                if (c.param) {
+                    // Arpeggio cycles through the note, x semitones, and y semitones up
+                    const auto step = (m_tick % 3 == 1) ? x : (m_tick % 3 == 2) ? y : 0;
+                    c.output = clamp_period(int((c.period * detail::mod_semitone[step]) >> 16));
+                    c.dirty = true;
+                }
+                break;
+            case 0x1:
+                c.period = clamp_period(c.period - c.param);
+                c.output = c.period;
+                c.dirty = true;
+                break;
+            case 0x2:
+                c.period = clamp_period(c.period + c.param);
+                c.output = c.period;
+                c.dirty = true;
+                break;
+            case 0x3:
+                tone_portamento(c);
+                break;
+            case 0x4:
+                vibrato(c);
+                break;
+            case 0x5:
+                tone_portamento(c);
+                volume_slide(c, x, y);
+                break;
+            case 0x6:
+                vibrato(c);
+                volume_slide(c, x, y);
+                break;
+            case 0xa:
+                volume_slide(c, x, y);
+                break;
+            case 0xe:
+                if (x == 0xc && m_tick == y) {
+                    c.volume = 0;
+                    c.dirty = true;
+                } else if (x == 0xd && m_tick == c.delay && c.delay_period) {
+                    trigger(c, c.delay_period);
+                    c.delay_period = 0;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        static void tone_portamento(detail::mod_channel& c) noexcept {
+            if (!c.target) {
+                return;
+            }
+            if (c.period < c.target) {
+                c.period = c.period + c.porta_speed >= c.target ? c.target : u16(c.period + c.porta_speed);
+            } else if (c.period > c.target) {
+                c.period = c.period - c.porta_speed <= c.target ? c.target : u16(c.period - c.porta_speed);
+            }
+            c.output = c.period;
+            c.dirty = true;
+        }
+
+        static void vibrato(detail::mod_channel& c) noexcept {
+            // 64 steps per cycle, with a peak of depth * 2 periods
+            const auto sine = lut::sin(lut::sin_lut, angle<u8, 6>(c.vibrato_position));
+            const auto delta = ((sine.data() >> 6) * c.vibrato_depth) >> 7;
+            c.output = clamp_period(c.period + delta);
+            c.vibrato_position = u8((c.vibrato_position + c.vibrato_speed) & 63);
+            c.dirty = true;
+        }
+
+        static void volume_slide(detail::mod_channel& c, int up, int down) noexcept {
+            c.volume = clamp_volume(up ? c.volume + up : c.volume - down);
+            c.dirty = true;
+        }
+
+        // The voice may have ended since, and been started again by another play()
+        [[nodiscard]]
+        bool owns_voice(const detail::mod_channel& c) const noexcept {
+            return c.voice >= 0 && m_mixer.playing(c.voice) && m_mixer.generation(c.voice) == c.generation;
+        }
+
+        void apply(detail::mod_channel& c, std::size_t index) noexcept {
+            // Amiga channels are panned left, right, right, left
+            const int pan = ((index + 1) & 2) ? 32 : -32;
+            const auto volume = int(c.volume) * m_volume / max_volume;
+
+            if (c.trigger) {
+                c.trigger = false;
+                if (owns_voice(c)) {
+                    m_mixer.stop(c.voice);
+                }
+                c.voice = -1;
+                const auto* instrument = c.instrument;
+                if (instrument && instrument->length > c.start && c.output) {
+                    const auto length = instrument->length - c.start;
+                    const auto loop = instrument->loop_length < length ? instrument->loop_length : length;
+                    c.voice = m_mixer.play(sound_sample{instrument->data + c.start, length, loop, instrument->clock / c.output}, volume, pan);
+                    if (c.voice >= 0) {
+                        c.generation = m_mixer.generation(c.voice);
+                    }
+                }
+                c.dirty = false;
+                return;
+            }
+
+            if (!owns_voice(c)) {
+                c.voice = -1;
+                return;
+            }
+            if (c.dirty) {
+                c.dirty = false;
+                m_mixer.set_rate(c.voice, c.instrument->clock / c.output);
+                m_mixer.set_volume(c.voice, volume, pan);
+            }
+        }
+
+        Mixer& m_mixer;
+        const u8* m_song{};
+        const u8* m_orders{};
+        const u8* m_patterns{};
+        profile::history<256>* m_history{};
+        u32 m_cycles{};
+        detail::mod_instrument m_instruments[31]{};
+        detail::mod_channel m_channels[Channels]{};
+        std::size_t m_channel_count{};
+        std::size_t m_length{};
+        std::size_t m_order{};
+        std::size_t m_row{};
+        u8 m_tick{};
+        u8 m_speed{6};
+        u8 m_volume{max_volume};
+        u8 m_jump_order{};
+        u8 m_jump_row{};
+        bool m_jump{};
+        bool m_playing{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_SOUND_TRACKER_HPP
@@ -0,0 +1,204 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_SOUND_WAVE_STREAM_HPP
+#define GBAXX_SOUND_WAVE_STREAM_HPP
+/** @file */
+
+#include <cstddef>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+namespace gba {
+
+    /**
+     * @class wave_stream
+     * @brief Streams 4-bit samples through sound channel 3 (Wave channel) by swapping its two wave RAM banks.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#4000070h---sound3cnt_l-nr30---channel-3-stopwave-ram-select-rw">4000070h - SOUND3CNT_L (NR30) - Channel 3 Stop/Wave RAM select (R/W)</a>
+     *
+     * The channel loops over one 32 sample bank while the other, the only one the CPU can access, holds the next block.
+     * A timer overflows exactly once per 32 samples: at the prescaler of 256 a bank lasts `2048 - sample_rate` ticks.
+     * on_timer() then swaps the banks and writes the following block into the bank that just finished, in four word
+     * stores. This gives an extra voice for ambient loops for a few dozen cycles per 32 samples, rather than the
+     * per-sample cost of mixing into DirectSound.
+     *
+     * Samples are unsigned 4-bit, two per byte with the high nibble played first, in blocks of 16 bytes.
+     *
+     * @tparam Timer Timer used to pace the bank swaps.
+     *
+     * @code{cpp}
+     * // Looping wind ambience on the wave channel
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const gba::wave_stream<>::block_type wind[];
+     * extern const std::size_t wind_blocks;
+     *
+     * static gba::wave_stream<2> ambience;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.timer2) {
+     *             ambience.on_timer();
+     *         }
+     *     });
+     *
+     *     mmio::IE = {.timer2 = true};
+     *     mmio::IME = true;
+     *
+     *     mmio::LEFT_RIGHT_VOLUME = soundcnt_l{.right_volume = 7, .left_volume = 7};
+     *     mmio::SOUND_MIX = soundcnt_h{.volume = volume::_100};
+     *
+     *     ambience.play(wind, wind_blocks, 0, wave_stream<>::rate(8192));
+     *
+     *     while (true) {
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note The timer overflow IRQ must be enabled, and on_timer() called from the interrupt handler.
+     *
+     * @sa mmio::WAVE_RAM
+     * @sa mmio::WAVE_BANK
+     * @sa mixer
+     */
+    template <std::size_t Timer = 2> requires (Timer < 4)
+    class wave_stream {
+    public:
+        using block_type = u32[4]; /**< 32 samples. */
+
+        static constexpr std::size_t npos = ~std::size_t{};
+
+        /**
+         * @brief sound3cnt_x::sample_rate value for a playback rate.
+         *
+         * @param hz Samples per second, from 1025 to 2097152.
+         */
+        [[nodiscard]]
+        static constexpr u16 rate(u32 hz) noexcept {
+            return u16(2048 - (2097152 + hz / 2) / hz);
+        }
+
+        constexpr wave_stream() noexcept = default;
+
+        wave_stream(const wave_stream&) = delete;
+        wave_stream& operator=(const wave_stream&) = delete;
+
+        /**
+         * @brief Starts streaming, routing channel 3 to both speakers.
+         *
+         * @param blocks Sample data.
+         * @param count Number of blocks.
+         * @param loop Block to continue from after the last block, or npos to stop at the end.
+         * @param sample_rate Rate for sound3cnt_x::sample_rate. @sa rate()
+         * @param volume Channel volume.
+         */
+        void play(const block_type* blocks, std::size_t count, std::size_t loop, u16 sample_rate, wave_volume volume = wave_volume::_100) noexcept {
+            stop();
+
+            m_blocks = blocks;
+            m_count = count;
+            m_loop = loop;
+            m_next = 0;
+            m_ending = 0;
+
+            mmio::SOUND_ENABLED = soundcnt_x{.enabled = true};
+            auto routing = *mmio::LEFT_RIGHT_VOLUME;
+            routing.wave_right = true;
+            routing.wave_left = true;
+            mmio::LEFT_RIGHT_VOLUME = routing;
+
+            // Fill bank 0 while bank 1 is selected, then bank 1 while bank 0 plays
+            m_bank = true;
+            select();
+            refill();
+            m_bank = false;
+            select();
+            refill();
+
+            mmio::WAVE_LEN_VOLUME = sound3cnt_h{.volume = volume};
+            mmio::WAVE_FREQ = sound3cnt_x{.sample_rate = sample_rate, .enabled = true};
+
+            // Started straight after the channel so the swaps land on bank boundaries
+            volatile_store(&mmio::TIMER_CONTROL[Timer], tmcnt_h{});
+            volatile_store(&mmio::TIMER_RELOAD[Timer], u16(sample_rate - 2048));
+            volatile_store(&mmio::TIMER_CONTROL[Timer], tmcnt_h{.scale = timer_scale::_256, .overflow_irq = true, .enabled = true});
+        }
+
+        /**
+         * @brief Stops the channel and the timer.
+         */
+        void stop() noexcept {
+            volatile_store(&mmio::TIMER_CONTROL[Timer], tmcnt_h{});
+            mmio::WAVE_BANK = sound3cnt_l{};
+            m_blocks = nullptr;
+        }
+
+        /**
+         * @brief Changes the channel volume.
+         */
+        void set_volume(wave_volume volume) noexcept {
+            mmio::WAVE_LEN_VOLUME = sound3cnt_h{.volume = volume};
+        }
+
+        /**
+         * @brief Call from the interrupt handler of the timer.
+         */
+        void on_timer() noexcept {
+            if (!m_blocks) {
+                return;
+            }
+            if (m_ending == 2) {
+                stop();
+                return;
+            }
+            m_bank = !m_bank;
+            select();
+            refill();
+        }
+
+        [[nodiscard]]
+        bool playing() const noexcept {
+            return m_blocks != nullptr;
+        }
+
+    private:
+        void select() const noexcept {
+            mmio::WAVE_BANK = sound3cnt_l{.bank1 = m_bank, .enabled = true};
+        }
+
+        // Writes the next block into the bank that is not playing, or silence past the end
+        void refill() noexcept {
+            if (m_next == m_count) {
+                if (m_loop == npos) {
+                    static constexpr block_type silence = {0x88888888, 0x88888888, 0x88888888, 0x88888888};
+                    mmio::WAVE_RAM.assign(silence);
+                    ++m_ending;
+                    return;
+                }
+                m_next = m_loop;
+            }
+            mmio::WAVE_RAM.assign(m_blocks[m_next++]);
+        }
+
+        const block_type* m_blocks{};
+        std::size_t m_count{};
+        std::size_t m_loop{};
+        std::size_t m_next{};
+        u8 m_ending{};
+        bool m_bank{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_SOUND_WAVE_STREAM_HPP
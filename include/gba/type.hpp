@@ -13,9 +13,11 @@
 
 #include <gba/type/angle.hpp>
 #include <gba/type/fixed.hpp>
+#include <gba/type/fixed_policy.hpp>
 #include <gba/type/int.hpp>
 #include <gba/type/lut.hpp>
 #include <gba/type/memory.hpp>
+#include <gba/type/register_block.hpp>
 #include <gba/type/tile.hpp>
 #include <gba/type/vector.hpp>
 
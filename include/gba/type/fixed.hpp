@@ -12,7 +12,9 @@
 /** @file */
 
 #include <array>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <type_traits>
 
@@ -58,7 +60,41 @@ struct value_traits<T> {
 template <typename T> requires Vector<T>
 struct value_traits<T> : vector_traits<T> {};
 
-template <Fundamental DataType, std::size_t FractionalBits>
+/**
+ * @brief Arithmetic policies for fixed.
+ *
+ * A policy may provide `template <std::int64_t Shift> static T multiply(T, T)` returning `(lhs * rhs) >> Shift`
+ * and `template <std::int64_t Shift> static T divide(T, T)` returning `(lhs << Shift) / rhs` for the fixed data type
+ * T. The operators fall back to the compiler generated arithmetic for anything the policy does not provide, and in
+ * constant evaluation.
+ *
+ * @sa fixed_policy::iwram_arm
+ */
+namespace fixed_policy {
+
+    /**
+     * @struct standard
+     * @brief Compiler generated arithmetic.
+     */
+    struct standard {};
+
+} // namespace fixed_policy
+
+namespace detail {
+
+    template <typename Policy, typename T>
+    concept FixedPolicyMultiply = requires (T x) {
+        { Policy::template multiply<0>(x, x) } -> std::same_as<T>;
+    };
+
+    template <typename Policy, typename T>
+    concept FixedPolicyDivide = requires (T x) {
+        { Policy::template divide<0>(x, x) } -> std::same_as<T>;
+    };
+
+} // namespace detail
+
+template <Fundamental DataType, std::size_t FractionalBits, typename Policy = fixed_policy::standard>
 struct fixed;
 
 /**
@@ -69,7 +105,7 @@ struct fixed;
  * @sa fixed
  */
 template <typename T>
-concept Fixed = std::same_as<T, fixed<typename T::data_type, T::fractional_bits>>;
+concept Fixed = std::same_as<T, fixed<typename T::data_type, T::fractional_bits, typename T::policy_type>>;
 
 /**
  * @struct fixed
@@ -78,10 +114,14 @@ concept Fixed = std::same_as<T, fixed<typename T::data_type, T::fractional_bits>
  *
  * @tparam DataType The underlying data type used to store the fixed-point number.
  * @tparam FractionalBits The number of fractional bits.
+ * @tparam Policy Arithmetic policy used by multiply and divide. Results take the policy of the left-hand operand.
+ *
+ * @sa fixed_policy
  */
-template <Fundamental DataType, std::size_t FractionalBits>
+template <Fundamental DataType, std::size_t FractionalBits, typename Policy>
 struct fixed {
     using data_type = DataType;
+    using policy_type = Policy;
     static constexpr auto fractional_bits = FractionalBits;
 
     constexpr data_type& data() noexcept {
@@ -94,7 +134,7 @@ struct fixed {
 
     // Vector related detail
     using size_type = typename value_traits<data_type>::size_type;
-    using value_type = fixed<typename value_traits<data_type>::value_type, fractional_bits>;
+    using value_type = fixed<typename value_traits<data_type>::value_type, fractional_bits, policy_type>;
     static constexpr auto size = value_traits<data_type>::size;
 
     // Helper details
@@ -454,7 +494,7 @@ struct fixed {
     }
 
     constexpr auto operator-() const noexcept {
-        return fixed<decltype(-m_data), fractional_bits>::from_data(-m_data);
+        return fixed<decltype(-m_data), fractional_bits, policy_type>::from_data(-m_data);
     }
 
     constexpr fixed operator+() const noexcept {
@@ -542,6 +582,13 @@ struct fixed {
     constexpr fixed& operator*=(Fixed auto rhs) noexcept {
         using bigger_type = typename make_bigger<decltype(data_type() * typename decltype(rhs)::data_type())>::type;
 
+        if constexpr (std::same_as<data_type, typename decltype(rhs)::data_type> && detail::FixedPolicyMultiply<policy_type, data_type>) {
+            if (!std::is_constant_evaluated()) {
+                m_data = policy_type::template multiply<decltype(rhs)::fractional_bits>(m_data, rhs.m_data);
+                return *this;
+            }
+        }
+
         if constexpr (Vector<data_type>) {
             const auto data = __builtin_convertvector(m_data, bigger_type) * rhs.m_data;
             m_data = __builtin_convertvector(data >> decltype(rhs)::fractional_bits, data_type);
@@ -557,6 +604,13 @@ struct fixed {
     constexpr fixed& operator/=(Fixed auto rhs) noexcept {
         using bigger_type = typename make_bigger<decltype(data_type() / typename decltype(rhs)::data_type())>::type;
 
+        if constexpr (std::same_as<data_type, typename decltype(rhs)::data_type> && detail::FixedPolicyDivide<policy_type, data_type>) {
+            if (!std::is_constant_evaluated()) {
+                m_data = policy_type::template divide<decltype(rhs)::fractional_bits>(m_data, rhs.m_data);
+                return *this;
+            }
+        }
+
         if constexpr (Vector<data_type>) {
             const auto data = __builtin_convertvector(m_data, bigger_type) << decltype(rhs)::fractional_bits;
             m_data = __builtin_convertvector(data / rhs.m_data, data_type);
@@ -581,7 +635,7 @@ constexpr auto operator+(Lhs lhs, Rhs rhs) noexcept {
     const auto lhsData = shift_to<Lhs::fractional_bits, frac_bits>(lhs.data());
     const auto rhsData = shift_to<Rhs::fractional_bits, frac_bits>(rhs.data());
 
-    return fixed<data_type, frac_bits>::from_data(lhsData + rhsData);
+    return fixed<data_type, frac_bits, typename Lhs::policy_type>::from_data(lhsData + rhsData);
 }
 
 template <Fixed Lhs, Fundamental Rhs>
@@ -592,7 +646,7 @@ constexpr auto operator+(Lhs lhs, Rhs rhs) noexcept {
     const auto lhsData = shift_to<Lhs::fractional_bits, frac_bits>(lhs.data());
     const auto rhsData = shift_to<0, frac_bits>(rhs);
 
-    return fixed<data_type, frac_bits>::from_data(lhsData + rhsData);
+    return fixed<data_type, frac_bits, typename Lhs::policy_type>::from_data(lhsData + rhsData);
 }
 
 template <Fundamental Lhs, Fixed Rhs>
@@ -603,7 +657,7 @@ constexpr auto operator+(Lhs lhs, Rhs rhs) noexcept {
     const auto lhsData = shift_to<0, frac_bits>(lhs);
     const auto rhsData = shift_to<Rhs::fractional_bits, frac_bits>(rhs.data());
 
-    return fixed<data_type, frac_bits>::from_data(lhsData + rhsData);
+    return fixed<data_type, frac_bits, typename Rhs::policy_type>::from_data(lhsData + rhsData);
 }
 
 // operator-
@@ -615,7 +669,7 @@ constexpr auto operator-(Lhs lhs, Rhs rhs) noexcept {
     const auto lhsData = shift_to<Lhs::fractional_bits, frac_bits>(lhs.data());
     const auto rhsData = shift_to<Rhs::fractional_bits, frac_bits>(rhs.data());
 
-    return fixed<data_type, frac_bits>::from_data(lhsData - rhsData);
+    return fixed<data_type, frac_bits, typename Lhs::policy_type>::from_data(lhsData - rhsData);
 }
 
 template <Fixed Lhs, Fundamental Rhs>
@@ -626,7 +680,7 @@ constexpr auto operator-(Lhs lhs, Rhs rhs) noexcept {
     const auto lhsData = shift_to<Lhs::fractional_bits, frac_bits>(lhs.data());
     const auto rhsData = shift_to<0, frac_bits>(rhs);
 
-    return fixed<data_type, frac_bits>::from_data(lhsData - rhsData);
+    return fixed<data_type, frac_bits, typename Lhs::policy_type>::from_data(lhsData - rhsData);
 }
 
 template <Fundamental Lhs, Fixed Rhs>
@@ -637,7 +691,7 @@ constexpr auto operator-(Lhs lhs, Rhs rhs) noexcept {
     const auto lhsData = shift_to<0, frac_bits>(lhs);
     const auto rhsData = shift_to<Rhs::fractional_bits, frac_bits>(rhs.data());
 
-    return fixed<data_type, frac_bits>::from_data(lhsData - rhsData);
+    return fixed<data_type, frac_bits, typename Rhs::policy_type>::from_data(lhsData - rhsData);
 }
 
 // operator*
@@ -646,15 +700,25 @@ constexpr auto operator*(Lhs lhs, Rhs rhs) noexcept {
     using data_type = decltype(typename Lhs::data_type() * typename Rhs::data_type());
     using bigger_type = typename make_bigger<data_type>::type;
 
+    using policy_type = typename Lhs::policy_type;
+
     constexpr auto bits_combined = Lhs::fractional_bits + Rhs::fractional_bits;
     constexpr auto frac_bits = bits_combined / 2;
 
+    using result_type = fixed<data_type, frac_bits, policy_type>;
+
+    if constexpr (detail::FixedPolicyMultiply<policy_type, data_type>) {
+        if (!std::is_constant_evaluated()) {
+            return result_type::from_data(policy_type::template multiply<bits_combined - frac_bits>(data_type(lhs.data()), data_type(rhs.data())));
+        }
+    }
+
     if constexpr (Vector<data_type>) {
         const auto data = __builtin_convertvector(lhs.data(), bigger_type) * vector_cast<bigger_type>(rhs.data());
-        return fixed<data_type, frac_bits>::from_data(__builtin_convertvector(shift_to<bits_combined, frac_bits>(data), data_type));
+        return result_type::from_data(__builtin_convertvector(shift_to<bits_combined, frac_bits>(data), data_type));
     } else {
         const auto data = bigger_type(lhs.data()) * rhs.data();
-        return fixed<data_type, frac_bits>::from_data(static_cast<data_type>(shift_to<bits_combined, frac_bits>(data)));
+        return result_type::from_data(static_cast<data_type>(shift_to<bits_combined, frac_bits>(data)));
     }
 }
 
@@ -672,14 +736,25 @@ constexpr auto operator/(Lhs lhs, Rhs rhs) noexcept {
     using data_type = decltype(typename Lhs::data_type() / typename Rhs::data_type());
     using bigger_type = typename make_bigger<data_type>::type;
 
+    using policy_type = typename Lhs::policy_type;
+
     constexpr auto bits_combined = Lhs::fractional_bits + Rhs::fractional_bits;
     constexpr auto frac_bits = bits_combined / 2;
 
+    using result_type = fixed<data_type, frac_bits, policy_type>;
+
+    if constexpr (detail::FixedPolicyDivide<policy_type, data_type>) {
+        if (!std::is_constant_evaluated()) {
+            constexpr auto shift = std::int64_t(frac_bits + Rhs::fractional_bits) - std::int64_t(Lhs::fractional_bits);
+            return result_type::from_data(policy_type::template divide<shift>(data_type(lhs.data()), data_type(rhs.data())));
+        }
+    }
+
     const auto data = shift_to<Lhs::fractional_bits, frac_bits + Rhs::fractional_bits>(vector_cast<bigger_type>(lhs.data()));
     if constexpr (Vector<data_type>) {
-        return fixed<data_type, frac_bits>::from_data(__builtin_convertvector(data / __builtin_convertvector(rhs.data(), bigger_type), data_type));
+        return result_type::from_data(__builtin_convertvector(data / __builtin_convertvector(rhs.data(), bigger_type), data_type));
     } else {
-        return fixed<data_type, frac_bits>::from_data(static_cast<data_type>(data / rhs.data()));
+        return result_type::from_data(static_cast<data_type>(data / rhs.data()));
     }
 }
 
@@ -0,0 +1,171 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_TYPE_FIXED_POLICY_HPP
+#define GBAXX_TYPE_FIXED_POLICY_HPP
+/** @file */
+
+#include <concepts>
+#include <cstdint>
+
+#include <gba/type/fixed.hpp>
+#include <gba/type/lut.hpp>
+
+namespace gba {
+
+namespace detail {
+
+    // Q15 reciprocals of the normalized divisor, indexed by its top 9 bits (the leading 1 is implied)
+    inline constexpr auto fixed_reciprocal_lut = lut::make<256>([](std::size_t ii) {
+        return static_cast<unsigned short>((1u << 24) / (257 + ii));
+    });
+
+    [[gnu::section(".iwram._gba_fixed_smul"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+    inline int fixed_smul(int lhs, int rhs, unsigned shift) noexcept {
+        const auto product = static_cast<long long>(lhs) * rhs;
+        if (!shift) {
+            return static_cast<int>(product);
+        }
+        return static_cast<int>((product + (1LL << (shift - 1))) >> shift);
+    }
+
+    [[gnu::section(".iwram._gba_fixed_umul"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+    inline unsigned fixed_umul(unsigned lhs, unsigned rhs, unsigned shift) noexcept {
+        const auto product = static_cast<unsigned long long>(lhs) * rhs;
+        if (!shift) {
+            return static_cast<unsigned>(product);
+        }
+        return static_cast<unsigned>((product + (1ULL << (shift - 1))) >> shift);
+    }
+
+    /**
+     * 64 by 32-bit unsigned division using a table reciprocal refined with two Newton-Raphson steps, followed by a
+     * remainder correction. Division by zero, or a quotient that does not fit within 32 bits, saturates to `~0u`.
+     */
+    [[gnu::section(".iwram._gba_fixed_udiv"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+    inline unsigned fixed_udiv(unsigned long long numerator, unsigned divisor) noexcept {
+        if ((numerator >> 32) >= divisor) [[unlikely]] {
+            return ~0u; // Also catches divisor == 0
+        }
+
+        // Normalize so the divisor's top bit is set (ARMv4T has no clz)
+        auto norm = divisor;
+        unsigned shift = 0;
+        if (!(norm & 0xffff0000)) { norm <<= 16; shift += 16; }
+        if (!(norm & 0xff000000)) { norm <<= 8; shift += 8; }
+        if (!(norm & 0xf0000000)) { norm <<= 4; shift += 4; }
+        if (!(norm & 0xc0000000)) { norm <<= 2; shift += 2; }
+        if (!(norm & 0x80000000)) { norm <<= 1; shift += 1; }
+
+        // Q31 reciprocal (2^63 / norm), always an under-estimate
+        auto recip = static_cast<unsigned>(fixed_reciprocal_lut[(norm >> 23) & 0xff]) << 16;
+        for (int ii = 0; ii < 2; ++ii) {
+            const auto error = (1ULL << 63) - static_cast<unsigned long long>(norm) * recip;
+            recip += static_cast<unsigned>((static_cast<unsigned long long>(recip) * static_cast<unsigned>(error >> 31)) >> 32);
+        }
+
+        const auto estimate = [recip, shift](unsigned long long x) {
+            const auto high = static_cast<unsigned long long>(static_cast<unsigned>(x >> 32)) * recip;
+            const auto low = (static_cast<unsigned long long>(static_cast<unsigned>(x)) * recip) >> 32;
+            return static_cast<unsigned>((high + low) >> (31 - shift));
+        };
+
+        // Both estimates are under, the second leaves at most one divisor in the remainder
+        auto quotient = estimate(numerator);
+        auto remainder = numerator - static_cast<unsigned long long>(quotient) * divisor;
+        const auto correction = estimate(remainder);
+        quotient += correction;
+        remainder -= static_cast<unsigned long long>(correction) * divisor;
+        if (remainder >= divisor) {
+            ++quotient;
+        }
+        return quotient;
+    }
+
+    template <std::int64_t Shift>
+    [[gnu::always_inline]]
+    inline unsigned long long fixed_shift_numerator(unsigned long long x) noexcept {
+        if constexpr (Shift < 0) {
+            return x >> -Shift;
+        } else {
+            return x << Shift;
+        }
+    }
+
+} // namespace detail
+
+namespace fixed_policy {
+
+    /**
+     * @struct iwram_arm
+     * @brief 32-bit fixed-point multiply and divide kernels compiled as ARM code in IWRAM.
+     *
+     * Multiplication uses `smull`/`umull` and rounds to nearest (rather than truncating as fixed_policy::standard
+     * does). Division uses a reciprocal table with Newton-Raphson refinement instead of the `__aeabi_ldivmod` call
+     * that 64-bit division generates, truncates towards zero, and saturates on overflow or division by zero.
+     *
+     * Only `int` and `unsigned int` data types use the kernels, other types and constant evaluation use the standard
+     * arithmetic.
+     *
+     * @code{cpp}
+     * // Physics in ARM IWRAM kernels
+     *
+     * #include <gba/gba.hpp>
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     using fixed_t = fixed<int, 16, fixed_policy::iwram_arm>;
+     *
+     *     fixed_t velocity = 3.5;
+     *     fixed_t time = 0.25;
+     *     fixed_t distance = velocity * time; // smull in IWRAM
+     *     fixed_t speed = distance / time; // Reciprocal division in IWRAM
+     * }
+     * @endcode
+     *
+     * @note Each operation is a long call into IWRAM, so the gain is largest for code that is itself ARM in IWRAM, or
+     *       for division.
+     *
+     * @sa fixed_policy::standard
+     */
+    struct iwram_arm {
+        template <std::int64_t Shift, typename T> requires std::same_as<T, int> || std::same_as<T, unsigned int>
+        [[gnu::always_inline]]
+        static T multiply(T lhs, T rhs) noexcept {
+            static_assert(Shift >= 0 && Shift < 64);
+            if constexpr (std::same_as<T, int>) {
+                return detail::fixed_smul(lhs, rhs, Shift);
+            } else {
+                return detail::fixed_umul(lhs, rhs, Shift);
+            }
+        }
+
+        template <std::int64_t Shift, typename T> requires std::same_as<T, int> || std::same_as<T, unsigned int>
+        [[gnu::always_inline]]
+        static T divide(T lhs, T rhs) noexcept {
+            if constexpr (std::same_as<T, int>) {
+                const auto negative = (lhs < 0) != (rhs < 0);
+                const auto numerator = detail::fixed_shift_numerator<Shift>(lhs < 0 ? -static_cast<unsigned long long>(lhs) : lhs);
+                const auto quotient = detail::fixed_udiv(numerator, rhs < 0 ? -static_cast<unsigned>(rhs) : rhs);
+                if (quotient > 0x7fffffffu) [[unlikely]] {
+                    return negative ? -0x7fffffff - 1 : 0x7fffffff; // Saturate, same as division by zero
+                }
+                return negative ? -static_cast<int>(quotient) : static_cast<int>(quotient);
+            } else {
+                return detail::fixed_udiv(detail::fixed_shift_numerator<Shift>(lhs), rhs);
+            }
+        }
+    };
+
+} // namespace fixed_policy
+
+} // namespace gba
+
+#endif // define GBAXX_TYPE_FIXED_POLICY_HPP
@@ -16,8 +16,65 @@
 #include <memory>
 #include <utility>
 
+#include <gba/host.hpp>
+
 namespace gba {
 
+    namespace detail {
+
+        template <typename T>
+        inline constexpr bool is_word_burst = sizeof(T) > 8 && sizeof(T) % 4 == 0 && alignof(T) >= 4;
+
+        // Copies whole words with ldmia/stmia pairs of up to 4 registers, in ascending address order. The asm
+        // statements are volatile with a memory clobber, so every word is transferred exactly once
+#if defined(GBAXX_HOST)
+        // Host builds replace the ARM loads and stores with a copy between compiler barriers
+        inline void host_copy(volatile void* dest, const volatile void* src, std::size_t size) noexcept {
+            asm volatile ("" ::: "memory");
+            __builtin_memcpy(const_cast<void*>(dest), const_cast<const void*>(src), size);
+            asm volatile ("" ::: "memory");
+        }
+#endif
+
+        template <std::size_t Words>
+        [[gnu::always_inline]]
+        inline void volatile_copy_words(volatile std::uint32_t* dest, const volatile std::uint32_t* src) noexcept {
+#if defined(GBAXX_HOST)
+            for (std::size_t ii = 0; ii < Words; ++ii) {
+                dest[ii] = src[ii];
+            }
+#else
+            if constexpr (Words >= 4) {
+                asm volatile (
+                    "ldmia %[src]!, {r0-r3}\n"
+                    "stmia %[dst]!, {r0-r3}"
+                    : [src]"+l"(src), [dst]"+l"(dest) :: "r0", "r1", "r2", "r3", "memory"
+                );
+                volatile_copy_words<Words - 4>(dest, src);
+            } else if constexpr (Words == 3) {
+                asm volatile (
+                    "ldmia %[src]!, {r0-r2}\n"
+                    "stmia %[dst]!, {r0-r2}"
+                    : [src]"+l"(src), [dst]"+l"(dest) :: "r0", "r1", "r2", "memory"
+                );
+            } else if constexpr (Words == 2) {
+                asm volatile (
+                    "ldmia %[src]!, {r0-r1}\n"
+                    "stmia %[dst]!, {r0-r1}"
+                    : [src]"+l"(src), [dst]"+l"(dest) :: "r0", "r1", "memory"
+                );
+            } else if constexpr (Words == 1) {
+                asm volatile (
+                    "ldr r0, [%[src]]\n"
+                    "str r0, [%[dst]]"
+                    :: [src]"l"(src), [dst]"l"(dest) : "r0", "memory"
+                );
+            }
+#endif
+        }
+
+    } // namespace detail
+
     /**
      * @brief Returns the value pointed to by *ptr in a register-safe manner, ensuring a volatile load.
      * @note This function does not modify the pointer itself.
@@ -29,6 +86,9 @@ namespace gba {
      * @param ptr A pointer to the value to be loaded.
      * @return The value pointed to by *ptr.
      *
+     * @note Word aligned types larger than 8 bytes that are a whole number of words (such as tile4bpp and
+     *       bios::bg_affine_dest) are loaded with `ldmia`/`stmia` bursts.
+     *
      * @sa volatile_store()
      */
     template <typename T>
@@ -36,7 +96,13 @@ namespace gba {
         using value_type = std::remove_cvref_t<T>;
         static_assert(std::is_trivially_copyable_v<value_type>, "Volatile load can only be used with trivially copyable types");
 
-        return __builtin_bit_cast(value_type, *const_cast<std::add_cv_t<T>*>(ptr));
+        if constexpr (detail::is_word_burst<value_type>) {
+            struct alignas(value_type) { std::uint32_t words[sizeof(value_type) / 4]; } buffer;
+            detail::volatile_copy_words<sizeof(value_type) / 4>(buffer.words, reinterpret_cast<const volatile std::uint32_t*>(ptr));
+            return __builtin_bit_cast(value_type, buffer);
+        } else {
+            return __builtin_bit_cast(value_type, *const_cast<std::add_cv_t<T>*>(ptr));
+        }
     }
 
     /**
@@ -50,6 +116,9 @@ namespace gba {
      * @param ptr A pointer to the memory location to store the value in.
      * @param value The value to be stored in the memory location.
      *
+     * @note Word aligned types larger than 8 bytes that are a whole number of words (such as tile4bpp and
+     *       bios::bg_affine_dest) are stored with `ldmia`/`stmia` bursts, rather than a memcpy.
+     *
      * @see volatile_load()
      */
     template <typename T, typename U = std::remove_cvref_t<T>>
@@ -57,6 +126,10 @@ namespace gba {
         using value_type = std::remove_cvref_t<T>;
         static_assert(std::is_trivially_copyable_v<value_type>, "Volatile store can only be used with trivially copyable types");
 
+#if defined(GBAXX_HOST)
+        const value_type copy = value;
+        detail::host_copy(ptr, &copy, sizeof(value_type));
+#else
         if constexpr (sizeof(value_type) == sizeof(char)) {
             asm volatile (
                 "strb %[val], [%[ptr]]"
@@ -90,10 +163,14 @@ namespace gba {
                 "str r3, [%[dst], #4]"
                 :: [src]"l"(&value), [dst]"l"(ptr) : "r3", "memory"
             );
+        } else if constexpr (detail::is_word_burst<value_type>) {
+            const value_type copy = value;
+            detail::volatile_copy_words<sizeof(value_type) / 4>(reinterpret_cast<volatile std::uint32_t*>(ptr), reinterpret_cast<const std::uint32_t*>(&copy));
         } else {
             asm volatile ("" ::: "memory"); // Prevent optimizing out
             __builtin_memcpy(const_cast<value_type*>(ptr), &value, sizeof(value_type));
         }
+#endif
     }
 
     /**
@@ -114,6 +191,14 @@ namespace gba {
         using value_type = std::remove_cvref_t<T>;
         static_assert(std::is_trivially_copyable_v<value_type>, "Volatile swap can only be used with trivially copyable types");
 
+#if defined(GBAXX_HOST)
+        alignas(value_type) std::byte av[sizeof(value_type)];
+        alignas(value_type) std::byte bv[sizeof(value_type)];
+        detail::host_copy(av, a, sizeof(value_type));
+        detail::host_copy(bv, b, sizeof(value_type));
+        detail::host_copy(a, bv, sizeof(value_type));
+        detail::host_copy(b, av, sizeof(value_type));
+#else
         if constexpr (sizeof(value_type) == sizeof(char)) {
             asm volatile (
                 "ldrb r3, [%[a]]\n"
@@ -147,6 +232,25 @@ namespace gba {
             __builtin_memcpy(const_cast<value_type*>(a), &bv, sizeof(value_type));
             __builtin_memcpy(const_cast<value_type*>(b), &av, sizeof(value_type));
         }
+#endif
+    }
+
+    /**
+     * @brief Copies a fixed number of words to volatile memory with `ldmia`/`stmia` bursts of up to 4 words.
+     *
+     * Every word of the destination is written exactly once, in ascending address order. Unlike a series of
+     * volatile_store() calls, consecutive words are written back-to-back without address calculations in between.
+     *
+     * @tparam Words Number of words to copy.
+     * @param dest Word aligned destination, such as a range of memory mapped registers.
+     * @param src Word aligned source.
+     *
+     * @sa register_block
+     */
+    template <std::size_t Words>
+    [[gnu::always_inline]]
+    inline void volatile_burst_store(volatile std::uint32_t* dest, const std::uint32_t* src) noexcept {
+        detail::volatile_copy_words<Words>(dest, src);
     }
 
     /**
@@ -171,6 +275,9 @@ namespace gba {
         const auto value = value_type(std::forward<Args>(args)...);
 #pragma GCC diagnostic pop
 
+#if defined(GBAXX_HOST)
+        detail::host_copy(ptr, &value, sizeof(value_type));
+#else
         if constexpr (sizeof(value_type) == sizeof(char)) {
             asm volatile (
                 "strb %[val], [%[ptr]]"
@@ -204,10 +311,14 @@ namespace gba {
                 "str r3, [%[dst], #4]"
                 :: [src]"l"(&value), [dst]"l"(ptr) : "r3", "memory"
             );
+        } else if constexpr (detail::is_word_burst<value_type>) {
+            const value_type copy = value;
+            detail::volatile_copy_words<sizeof(value_type) / 4>(reinterpret_cast<volatile std::uint32_t*>(ptr), reinterpret_cast<const std::uint32_t*>(&copy));
         } else {
             asm volatile ("" ::: "memory"); // Prevent optimizing out
             __builtin_memcpy(const_cast<value_type*>(ptr), &value, sizeof(value_type));
         }
+#endif
 
         return value;
     }
@@ -241,7 +352,7 @@ namespace gba {
          * @return A usable pointer.
          */
         constexpr pointer get() const noexcept {
-            return reinterpret_cast<pointer>(m_ptr);
+            return reinterpret_cast<pointer>(detail::mapped_address(m_ptr));
         }
 
         constexpr std::add_lvalue_reference_t<T> operator*() const noexcept {
@@ -257,7 +368,7 @@ namespace gba {
         }
 
         constexpr auto* operator&() const noexcept {
-            return reinterpret_cast<std::remove_volatile_t<std::remove_all_extents_t<T>>*>(m_ptr);
+            return reinterpret_cast<std::remove_volatile_t<std::remove_all_extents_t<T>>*>(detail::mapped_address(m_ptr));
         }
 
         /**
@@ -547,6 +658,43 @@ namespace gba {
             return *this;
         }
 
+        /**
+         * @brief Writes every element of the series.
+         *
+         * A tightly packed series covering whole words (such as mmio::BGCNT) is written with a single
+         * volatile_burst_store(), otherwise the elements are stored one at a time in ascending order.
+         *
+         * @param values New value of each element.
+         *
+         * @code{cpp}
+         * #include <gba/gba.hpp>
+         *
+         * int main() {
+         *     using namespace gba;
+         *
+         *     // Two stmia word stores, rather than four strh
+         *     mmio::BGCNT.assign({
+         *         bgcnt{.screenblock = 28}, bgcnt{.screenblock = 29},
+         *         bgcnt{.screenblock = 30}, bgcnt{.screenblock = 31}
+         *     });
+         * }
+         * @endcode
+         */
+        void assign(const std::remove_cv_t<element_type> (&values)[std::extent_v<typename decltype(Ptr)::element_type>]) const noexcept requires(!std::is_const_v<element_type>) {
+            constexpr auto count = std::extent_v<typename decltype(Ptr)::element_type>;
+            constexpr auto bytes = sizeof(element_type) * count;
+
+            if constexpr (stride == sizeof(element_type) && Ptr.m_ptr % 4 == 0 && bytes % 4 == 0) {
+                std::uint32_t words[bytes / 4];
+                __builtin_memcpy(words, values, bytes);
+                volatile_burst_store<bytes / 4>(reinterpret_cast<volatile std::uint32_t*>(detail::mapped_address(Ptr.m_ptr)), words);
+            } else {
+                for (std::size_t ii = 0; ii < count; ++ii) {
+                    volatile_store(reinterpret_cast<element_type*>(detail::mapped_address(Ptr.m_ptr) + ii * stride), values[ii]);
+                }
+            }
+        }
+
         /**
          * @brief The address operator has been overloaded to provide convenience for functions such as std::memcpy().
          *
@@ -558,11 +706,11 @@ namespace gba {
         }
 
         constexpr auto& operator[](ptr_type i) const noexcept requires(!std::is_const_v<element_type>) {
-            return *reinterpret_cast<std::remove_volatile_t<element_type>*>(Ptr.m_ptr + i * stride);
+            return *reinterpret_cast<std::remove_volatile_t<element_type>*>(detail::mapped_address(Ptr.m_ptr) + i * stride);
         }
 
         constexpr auto operator[](ptr_type i) const noexcept requires(std::is_const_v<element_type>) {
-            return volatile_load(reinterpret_cast<element_type*>(Ptr.m_ptr + i * stride));
+            return volatile_load(reinterpret_cast<element_type*>(detail::mapped_address(Ptr.m_ptr) + i * stride));
         }
 
         /**
@@ -574,7 +722,7 @@ namespace gba {
          * @note This returns a copy of the value at `i`, not a reference.
          */
         constexpr auto get(std::size_t i) const noexcept {
-            return volatile_load(reinterpret_cast<std::remove_volatile_t<element_type>*>(Ptr.m_ptr + i * stride));
+            return volatile_load(reinterpret_cast<std::remove_volatile_t<element_type>*>(detail::mapped_address(Ptr.m_ptr) + i * stride));
         }
 
         /**
@@ -586,7 +734,7 @@ namespace gba {
          */
         template <typename T = std::remove_volatile_t<element_type>>
         constexpr void set(std::size_t i, T&& value) const noexcept {
-            volatile_store(reinterpret_cast<element_type*>(Ptr.m_ptr + i * stride), value);
+            volatile_store(reinterpret_cast<element_type*>(detail::mapped_address(Ptr.m_ptr) + i * stride), value);
         }
 
         /**
@@ -597,7 +745,7 @@ namespace gba {
          * @sa registral::reset()
          */
         constexpr void reset(std::size_t i) const noexcept requires(!std::is_const_v<element_type>) {
-            volatile_emplace(reinterpret_cast<element_type*>(Ptr.m_ptr + i * stride));
+            volatile_emplace(reinterpret_cast<element_type*>(detail::mapped_address(Ptr.m_ptr) + i * stride));
         }
 
         /**
@@ -612,7 +760,7 @@ namespace gba {
          */
         template <typename... Args>
         constexpr auto emplace(std::size_t i, Args&&... args) const noexcept -> std::remove_cvref_t<element_type> requires(!std::is_const_v<element_type>) {
-            return volatile_emplace(reinterpret_cast<element_type*>(Ptr.m_ptr + i * stride), std::forward<Args>(args)...);
+            return volatile_emplace(reinterpret_cast<element_type*>(detail::mapped_address(Ptr.m_ptr) + i * stride), std::forward<Args>(args)...);
         }
 
         /**
@@ -682,7 +830,7 @@ namespace gba {
          * @sa scoped_ref
          */
         constexpr auto acquire(std::size_t i) const noexcept {
-            return scoped_ref{Ptr.m_ptr + i * stride};
+            return scoped_ref{detail::mapped_address(Ptr.m_ptr) + i * stride};
         }
     };
 
@@ -0,0 +1,183 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_TYPE_REGISTER_BLOCK_HPP
+#define GBAXX_TYPE_REGISTER_BLOCK_HPP
+/** @file */
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <gba/type/memory.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        template <typename T>
+        struct register_traits;
+
+        template <auto Ptr>
+        struct register_traits<registral<Ptr>> {
+            using value_type = std::remove_cvref_t<typename decltype(Ptr)::element_type>;
+
+            static constexpr std::uintptr_t address = Ptr.m_ptr;
+            static constexpr std::size_t size = sizeof(value_type);
+            static constexpr bool is_series = false;
+        };
+
+        template <auto Ptr, std::ptrdiff_t Stride>
+        struct register_traits<registral_series<Ptr, Stride>> {
+            using value_type = std::remove_cv_t<typename registral_series<Ptr, Stride>::element_type>;
+
+            static constexpr std::uintptr_t address = Ptr.m_ptr;
+            static constexpr std::size_t stride = registral_series<Ptr, Stride>::stride;
+            static constexpr std::size_t count = std::extent_v<typename decltype(Ptr)::element_type>;
+            static constexpr std::size_t size = stride * (count - 1) + sizeof(value_type);
+            static constexpr bool is_series = true;
+        };
+
+        template <auto Reg>
+        using register_traits_of = register_traits<std::remove_cv_t<decltype(Reg)>>;
+
+    } // namespace detail
+
+    /**
+     * @class register_block
+     * @brief RAM copy of a contiguous range of memory mapped registers, written to the hardware in one burst.
+     *
+     * The block covers every byte from the first register to the end of the last register. Registers are set in RAM
+     * with set(), then commit() writes the whole range with volatile_burst_store(), which is a handful of
+     * `ldmia`/`stmia` pairs rather than one `strh` per register.
+     *
+     * This keeps the register updates of a VBlank handler short, and always just as long.
+     *
+     * @tparam First First registral or registral_series of the range, word aligned.
+     * @tparam Last Last registral or registral_series of the range, ending on a word boundary.
+     *
+     * @code{cpp}
+     * // Scrolling all four backgrounds with one commit per frame
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static gba::register_block<gba::mmio::BGCNT, gba::mmio::BG3VOFS> backgrounds;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     backgrounds.set<mmio::BG0CNT>({.screenblock = 31});
+     *     backgrounds.set<mmio::BGCNT>(1, {.screenblock = 30});
+     *
+     *     u16 scroll = 0;
+     *     while (true) {
+     *         backgrounds.set<mmio::BG0HOFS>(scroll++);
+     *         bios::VBlankIntrWait();
+     *         backgrounds.commit(); // 24 bytes, BG0CNT to BG3VOFS
+     *     }
+     * }
+     * @endcode
+     *
+     * @note Every register in the range is written by commit(), including ones never set (which hold zero).
+     *
+     * @sa volatile_burst_store()
+     * @sa registral_series::assign()
+     */
+    template <auto First, auto Last> requires (
+        detail::register_traits_of<First>::address % 4 == 0 &&
+        (detail::register_traits_of<Last>::address + detail::register_traits_of<Last>::size) % 4 == 0 &&
+        detail::register_traits_of<Last>::address >= detail::register_traits_of<First>::address
+    )
+    class register_block {
+    public:
+        static constexpr std::uintptr_t address = detail::register_traits_of<First>::address;
+        static constexpr std::size_t size = detail::register_traits_of<Last>::address + detail::register_traits_of<Last>::size - address;
+        static constexpr std::size_t words = size / 4;
+
+        constexpr register_block() noexcept = default;
+
+        /**
+         * @brief Sets the value of a register, written on the next commit().
+         *
+         * @tparam Reg Registral within the block.
+         * @param value New value.
+         */
+        template <auto Reg> requires (!detail::register_traits_of<Reg>::is_series)
+        void set(const typename detail::register_traits_of<Reg>::value_type& value) noexcept {
+            store(offset_of<Reg>(), value);
+        }
+
+        /**
+         * @brief Sets the value of one element of a registral_series, written on the next commit().
+         *
+         * @tparam Series Registral series within the block.
+         * @param i Element index.
+         * @param value New value.
+         */
+        template <auto Series> requires detail::register_traits_of<Series>::is_series
+        void set(std::size_t i, const typename detail::register_traits_of<Series>::value_type& value) noexcept {
+            store(offset_of<Series>() + i * detail::register_traits_of<Series>::stride, value);
+        }
+
+        /**
+         * @brief Value of a register as held by the block (not read from the hardware).
+         *
+         * @tparam Reg Registral within the block.
+         */
+        template <auto Reg> requires (!detail::register_traits_of<Reg>::is_series)
+        [[nodiscard]]
+        auto get() const noexcept {
+            return load<typename detail::register_traits_of<Reg>::value_type>(offset_of<Reg>());
+        }
+
+        /**
+         * @brief Value of one element of a registral_series as held by the block.
+         *
+         * @tparam Series Registral series within the block.
+         * @param i Element index.
+         */
+        template <auto Series> requires detail::register_traits_of<Series>::is_series
+        [[nodiscard]]
+        auto get(std::size_t i) const noexcept {
+            return load<typename detail::register_traits_of<Series>::value_type>(offset_of<Series>() + i * detail::register_traits_of<Series>::stride);
+        }
+
+        /**
+         * @brief Writes every register of the block to the hardware.
+         */
+        void commit() const noexcept {
+            volatile_burst_store<words>(reinterpret_cast<volatile std::uint32_t*>(detail::mapped_address(address)), m_words);
+        }
+
+    private:
+        template <auto Reg>
+        static constexpr std::size_t offset_of() noexcept {
+            using traits = detail::register_traits_of<Reg>;
+            static_assert(traits::address >= address && traits::address + traits::size <= address + size, "Register is outside of the block");
+            return traits::address - address;
+        }
+
+        template <typename T>
+        void store(std::size_t offset, const T& value) noexcept {
+            __builtin_memcpy(reinterpret_cast<char*>(m_words) + offset, &value, sizeof(T));
+        }
+
+        template <typename T>
+        T load(std::size_t offset) const noexcept {
+            T value;
+            __builtin_memcpy(&value, reinterpret_cast<const char*>(m_words) + offset, sizeof(T));
+            return value;
+        }
+
+        std::uint32_t m_words[words]{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_TYPE_REGISTER_BLOCK_HPP
@@ -18,16 +18,20 @@ namespace gba {
     /**
      * @struct tile4bpp
      * @brief 4bpp 8x8 tile.
+     *
+     * @note Tiles are word aligned to allow 32-bit copies (such as DMA) into character data.
      */
-    struct tile4bpp {
+    struct alignas(int) tile4bpp {
         u4x2 data[32];
     };
 
     /**
      * @struct tile8bpp
      * @brief 8bpp 8x8 tile.
+     *
+     * @note Tiles are word aligned to allow 32-bit copies (such as DMA) into character data.
      */
-    struct tile8bpp {
+    struct alignas(int) tile8bpp {
         uinttype<8> data[64];
     };
 
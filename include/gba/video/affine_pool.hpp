@@ -0,0 +1,179 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_AFFINE_POOL_HPP
+#define GBAXX_VIDEO_AFFINE_POOL_HPP
+/** @file */
+
+#include <gba/bios/math.hpp>
+#include <gba/math/trig.hpp>
+#include <gba/video/shadow_oam.hpp>
+
+namespace gba {
+
+    /**
+     * @enum affine_kernel
+     * @brief Selects the implementation used to resolve affine matrices.
+     */
+    enum class affine_kernel {
+        bios, /**< A single bios::ObjAffineSet() call. */
+        arm, /**< An ARM loop in IWRAM using lut::sin_lut (equivalent to the BIOS table), avoiding the SWI overhead. */
+    };
+
+    namespace detail {
+
+        [[gnu::section(".iwram._gba_obj_affine_set"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void obj_affine_set_arm(const bios::obj_affine_src* __restrict__ src, fixed<short, 8>* __restrict__ dest, std::size_t num) noexcept {
+            auto* out = reinterpret_cast<short*>(dest);
+            while (num--) {
+                const auto index = src->alpha.data() >> 8;
+                // lut::sin_lut matches the BIOS table: 256 entries with 14 fractional bits
+                const int sin = lut::sin_lut.data()[index].data();
+                const int cos = lut::sin_lut.data()[(index + 64) & 0xff].data();
+                const int sx = src->sx.data();
+                const int sy = src->sy.data();
+
+                out[0] = short((sx * cos) >> 14);
+                out[4] = short((-sx * sin) >> 14);
+                out[8] = short((sy * sin) >> 14);
+                out[12] = short((sy * cos) >> 14);
+
+                out += 16;
+                ++src;
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * @class obj_affine_pool
+     * @brief Collects object affine matrix requests during the frame and resolves them in one batch.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#swi-0fh-gba---objaffineset">SWI 0Fh (GBA) - ObjAffineSet</a>
+     *
+     * Each push() reserves the next of the 32 OBJ affine matrices. resolve() then builds every matrix with a single
+     * bios::ObjAffineSet() call (or the ARM kernel) writing straight into the affine parameter slots of a shadow_oam.
+     *
+     * @code{cpp}
+     * // Rotating many sprites with one SWI
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static gba::shadow_oam oam;
+     * static gba::obj_affine_pool matrices;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     u16 rotation = 0;
+     *     while (true) {
+     *         oam.clear();
+     *         matrices.clear();
+     *
+     *         for (int ii = 0; ii < 16; ++ii) {
+     *             const auto matrix = matrices.push({.sx = 1, .sy = 1, .alpha = u16(rotation + ii * 0x1000)});
+     *             oam.push_affine(objattr_affine{{.y = 64, .style = obj_display::affine}, {.x = u16(ii * 12), .affine_index = u16(matrix)}, {}});
+     *         }
+     *
+     *         oam.commit();
+     *         matrices.resolve(oam);
+     *         rotation += 0x100;
+     *
+     *         bios::VBlankIntrWait();
+     *         oam.flush();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note bios::BgAffineSet() already takes a count, so background matrices can be batched by passing an array.
+     *
+     * @sa bios::obj_affine_src
+     * @sa shadow_oam::param()
+     */
+    class obj_affine_pool {
+    public:
+        static constexpr std::size_t capacity = shadow_oam::affine_size;
+
+        constexpr obj_affine_pool() noexcept = default;
+
+        /**
+         * @brief Reserves the next affine matrix.
+         *
+         * @param src Scale and rotation of the matrix.
+         * @return Index of the reserved matrix, or -1 if all 32 matrices are in use.
+         */
+        [[nodiscard]]
+        int push(const bios::obj_affine_src& src) noexcept {
+            if (m_count == capacity) {
+                return -1;
+            }
+            m_src[m_count] = src;
+            return int(m_count++);
+        }
+
+        /**
+         * @brief Releases every reserved matrix.
+         */
+        void clear() noexcept {
+            m_count = 0;
+        }
+
+        /**
+         * @brief Number of reserved matrices.
+         *
+         * @return Matrix count.
+         */
+        [[nodiscard]]
+        std::size_t size() const noexcept {
+            return m_count;
+        }
+
+        /**
+         * @brief Builds the reserved matrices into the affine parameters of a shadow OAM.
+         *
+         * @tparam Kernel Implementation used to build the matrices.
+         * @param oam Shadow OAM receiving the matrices. The modified entries are marked dirty.
+         */
+        template <affine_kernel Kernel = affine_kernel::bios>
+        void resolve(shadow_oam& oam) const noexcept {
+            if (!m_count) {
+                return;
+            }
+
+            auto* dest = &oam.data()->param;
+            if constexpr (Kernel == affine_kernel::arm) {
+                detail::obj_affine_set_arm(m_src, dest, m_count);
+            } else {
+                bios::ObjAffineSet(m_src, dest, m_count, sizeof(shadow_oam::entry));
+            }
+            oam.mark(0, m_count * 4 - 1);
+        }
+
+        /**
+         * @brief Builds the reserved matrices directly into a destination such as OAM.
+         *
+         * @param dest Pointer to PA of the first matrix.
+         * @param stride Byte distance between each matrix component (8 for OAM).
+         *
+         * @sa bios::ObjAffineSet()
+         */
+        [[gnu::nonnull(2)]]
+        void resolve(volatile fixed<short, 8>* dest, std::size_t stride) const noexcept {
+            if (m_count) {
+                bios::ObjAffineSet(m_src, dest, m_count, stride);
+            }
+        }
+
+    private:
+        bios::obj_affine_src m_src[capacity]{};
+        std::size_t m_count{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_AFFINE_POOL_HPP
@@ -0,0 +1,267 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_BG_STREAMER_HPP
+#define GBAXX_VIDEO_BG_STREAMER_HPP
+/** @file */
+
+#include <cstddef>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+namespace gba {
+
+    /**
+     * @class bg_streamer
+     * @brief Streams a large tile map through a 32x32 hardware screen as the camera scrolls.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#text-bg-screen-2-bytes-per-entry">Text BG Screen (2 bytes per entry)</a>
+     *
+     * The hardware screen always holds the 32x32 tile window of the map whose top-left tile is under the camera, with
+     * the hardware wrap-around acting as a ring buffer. update() compares the camera against the window and only
+     * uploads the rows and columns that have newly entered it.
+     *
+     * Rows are contiguous both in the map and in the screenblock, so they are queued as (at most two) DMA copies
+     * straight from ROM. Columns are strided, so they are gathered into a small buffer during update() and written by
+     * flush() during VBlank, which also writes the background offset so both stay in sync.
+     *
+     * @tparam MaxColumns Maximum number of new columns per update() (camera movement of up to 8 * MaxColumns pixels).
+     *
+     * @code{cpp}
+     * // Scrolling around a 128x64 tile level
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const gba::textscreen level_map[64][128];
+     *
+     * static gba::dma_queue<16> uploads;
+     * static gba::bg_streamer<> streamer{&level_map[0][0], 128, 64, 0, 31};
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.vblank) {
+     *             uploads.flush();
+     *             streamer.flush();
+     *         }
+     *     });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true};
+     *     mmio::IME = true;
+     *
+     *     mmio::BG0CNT = {.screenblock = 31};
+     *     streamer.reset(0, 0);
+     *     mmio::DISPCNT = {.show_bg0 = true};
+     *
+     *     int x = 0;
+     *     while (true) {
+     *         streamer.update(++x, 0, uploads);
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note The camera must stay within the map: 0 <= x <= map width * 8 - 240 and 0 <= y <= map height * 8 - 160.
+     * @note Only 32x32 (256x256 pixel) text backgrounds are supported.
+     * @note update() should be called once per frame, between VBlanks, so flush() never sees a partial update.
+     *
+     * @sa dma_queue
+     * @sa metatile_streamer
+     * @sa mmio::TEXT_SCREENBLOCKS
+     */
+    template <std::size_t MaxColumns = 2> requires (MaxColumns > 0 && MaxColumns <= 32)
+    class bg_streamer {
+    public:
+        static constexpr std::size_t screen_size = 32;
+        static constexpr auto max_columns = MaxColumns;
+
+        /**
+         * @param map Top-left entry of the row-major map.
+         * @param width Width of the map in tiles.
+         * @param height Height of the map in tiles.
+         * @param bg Background index, for the offset register written by flush().
+         * @param screenblock Screenblock of the background (bgcnt::screenblock).
+         */
+        constexpr bg_streamer(const textscreen* map, std::size_t width, std::size_t height, std::size_t bg, std::size_t screenblock) noexcept :
+            m_map{map}, m_width{width}, m_height{height}, m_bg{bg}, m_screenblock{screenblock} {}
+
+        bg_streamer(const bg_streamer&) = delete;
+        bg_streamer& operator=(const bg_streamer&) = delete;
+
+        /**
+         * @brief Immediately uploads the whole window under the camera and sets the background offset.
+         *
+         * Intended for level loads (during forced blank or VBlank), or when the camera jumps too far for update().
+         *
+         * @param x Camera left edge in pixels.
+         * @param y Camera top edge in pixels.
+         */
+        void reset(int x, int y) noexcept {
+            m_x = x;
+            m_y = y;
+            m_tile_x = x >> 3;
+            m_tile_y = y >> 3;
+            m_columns = 0;
+
+            for (std::size_t ii = 0; ii < screen_size; ++ii) {
+                const auto row = m_tile_y + int(ii);
+                if (row >= int(m_height)) {
+                    break;
+                }
+                copy_row(row);
+            }
+            mmio::BGOFS[m_bg] = offset();
+        }
+
+        /**
+         * @brief Moves the camera, queuing the rows and columns that enter the window.
+         *
+         * @tparam Queue dma_queue type.
+         * @param x Camera left edge in pixels.
+         * @param y Camera top edge in pixels.
+         * @param queue Queue that receives the row copies.
+         * @return False if an update could not be queued (the camera moved too far, or the queue is full), in which case
+         *         reset() should be used.
+         */
+        template <class Queue>
+        bool update(int x, int y, Queue& queue) noexcept {
+            const auto tile_x = x >> 3;
+            const auto tile_y = y >> 3;
+            const auto dx = tile_x - m_tile_x;
+            const auto dy = tile_y - m_tile_y;
+            const auto rows = dy < 0 ? -dy : dy;
+            const auto columns = dx < 0 ? -dx : dx;
+            if (rows > int(screen_size) || m_columns + columns > int(MaxColumns)) {
+                return false;
+            }
+
+            m_x = x;
+            m_y = y;
+            m_tile_x = tile_x;
+            m_tile_y = tile_y;
+
+            // Rows entering the bottom (dy > 0) or the top (dy < 0)
+            auto ok = true;
+            const auto first_row = dy > 0 ? tile_y + int(screen_size) - rows : tile_y;
+            for (auto row = first_row; ok && row < first_row + rows; ++row) {
+                if (row < int(m_height)) {
+                    ok = queue_row(row, queue);
+                }
+            }
+
+            // Columns entering the right (dx > 0) or the left (dx < 0)
+            const auto first_column = dx > 0 ? tile_x + int(screen_size) - columns : tile_x;
+            for (auto column = first_column; column < first_column + columns; ++column) {
+                if (column < int(m_width)) {
+                    gather_column(column);
+                }
+            }
+
+            return ok;
+        }
+
+        /**
+         * @brief Writes the gathered columns and the background offset.
+         *
+         * Intended to be called from the VBlank interrupt handler, alongside dma_queue::flush().
+         */
+        void flush() noexcept {
+            auto* const screen = reinterpret_cast<volatile u16*>(&mmio::TEXT_SCREENBLOCKS[m_screenblock]);
+            for (int ii = 0; ii < m_columns; ++ii) {
+                const auto& column = m_column_buffer[ii];
+                auto* dest = screen + column.index;
+                for (std::size_t jj = 0; jj < column.count; ++jj) {
+                    dest[((column.row + jj) & (screen_size - 1)) * screen_size] = column.entries[jj];
+                }
+            }
+            m_columns = 0;
+            mmio::BGOFS[m_bg] = offset();
+        }
+
+        /**
+         * @brief Background offset for the current camera.
+         *
+         * @return Horizontal and vertical offset.
+         */
+        [[nodiscard]]
+        u16x2 offset() const noexcept {
+            return u16x2{u16(m_x), u16(m_y)};
+        }
+
+    private:
+        struct column {
+            u16 entries[screen_size];
+            u16 index; // Hardware column
+            u16 row; // Hardware row of the first entry
+            std::size_t count;
+        };
+
+        // Map entries of a row within the window, before the map's right edge
+        [[nodiscard]]
+        std::size_t row_length() const noexcept {
+            const auto length = int(m_width) - m_tile_x;
+            return length < int(screen_size) ? std::size_t(length) : screen_size;
+        }
+
+        void copy_row(int row) noexcept {
+            const auto* src = reinterpret_cast<const u16*>(m_map + std::size_t(row) * m_width + std::size_t(m_tile_x));
+            auto* const dest = reinterpret_cast<volatile u16*>(&mmio::TEXT_SCREENBLOCKS[m_screenblock]) + (row & (screen_size - 1)) * screen_size;
+            const auto length = row_length();
+            for (std::size_t ii = 0; ii < length; ++ii) {
+                dest[(std::size_t(m_tile_x) + ii) & (screen_size - 1)] = src[ii];
+            }
+        }
+
+        template <class Queue>
+        bool queue_row(int row, Queue& queue) noexcept {
+            const auto* src = m_map + std::size_t(row) * m_width + std::size_t(m_tile_x);
+            auto* const dest = &mmio::TEXT_SCREENBLOCKS[m_screenblock][0] + (row & (screen_size - 1)) * screen_size;
+
+            // The window wraps around the right edge of the hardware screen
+            const auto start = std::size_t(m_tile_x) & (screen_size - 1);
+            const auto length = row_length();
+            const auto first = length < screen_size - start ? length : screen_size - start;
+            if (!queue.push(src, dest + start, first)) {
+                return false;
+            }
+            return length == first || queue.push(src + first, dest, length - first);
+        }
+
+        void gather_column(int column) noexcept {
+            auto& out = m_column_buffer[m_columns++];
+            out.index = u16(column & (screen_size - 1));
+            out.row = u16(m_tile_y & (screen_size - 1));
+
+            const auto rows = int(m_height) - m_tile_y;
+            out.count = rows < int(screen_size) ? std::size_t(rows) : screen_size;
+
+            const auto* src = reinterpret_cast<const u16*>(m_map + std::size_t(m_tile_y) * m_width + std::size_t(column));
+            for (std::size_t ii = 0; ii < out.count; ++ii) {
+                out.entries[ii] = src[ii * m_width];
+            }
+        }
+
+        const textscreen* m_map;
+        std::size_t m_width;
+        std::size_t m_height;
+        std::size_t m_bg;
+        std::size_t m_screenblock;
+        int m_x{};
+        int m_y{};
+        int m_tile_x{};
+        int m_tile_y{};
+        int m_columns{};
+        column m_column_buffer[MaxColumns]{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_BG_STREAMER_HPP
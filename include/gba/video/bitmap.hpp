@@ -0,0 +1,430 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_BITMAP_HPP
+#define GBAXX_VIDEO_BITMAP_HPP
+/** @file */
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        // Fills 32 bytes per stm, the largest burst that leaves registers for the pointer and count
+        [[gnu::section(".iwram._gba_bitmap_fill"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void bitmap_fill(u32* dest, std::size_t words, u32 value) noexcept {
+#if !defined(GBAXX_HOST)
+            register u32 r2 asm("r2") = value;
+            register u32 r3 asm("r3") = value;
+            register u32 r4 asm("r4") = value;
+            register u32 r5 asm("r5") = value;
+            register u32 r6 asm("r6") = value;
+            register u32 r7 asm("r7") = value;
+            register u32 r8 asm("r8") = value;
+            register u32 r9 asm("r9") = value;
+
+            for (auto bursts = words / 8; bursts; --bursts) {
+                asm volatile (
+                    "stmia %[dest]!, {r2-r9}"
+                    : [dest]"+r"(dest)
+                    : "r"(r2), "r"(r3), "r"(r4), "r"(r5), "r"(r6), "r"(r7), "r"(r8), "r"(r9)
+                    : "memory"
+                );
+            }
+            words %= 8;
+#endif
+            for (; words; --words) {
+                *dest++ = value;
+            }
+        }
+
+        // Short spans are not worth the long call into IWRAM
+        inline constexpr std::size_t bitmap_fill_threshold = 16;
+
+        inline void bitmap_fill_halfwords(u16* dest, std::size_t count, u16 value) noexcept {
+            if (!count) {
+                return;
+            }
+            if (reinterpret_cast<std::uintptr_t>(dest) & 2) {
+                *dest++ = value;
+                --count;
+            }
+
+            const auto words = count / 2;
+            const auto pair = value | (u32(value) << 16);
+            if (words >= bitmap_fill_threshold) {
+                bitmap_fill(reinterpret_cast<u32*>(dest), words, pair);
+            } else {
+                auto* out = reinterpret_cast<u32*>(dest);
+                for (std::size_t ii = 0; ii < words; ++ii) {
+                    out[ii] = pair;
+                }
+            }
+
+            if (count & 1) {
+                dest[count - 1] = value;
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * @class bitmap
+     * @brief Drawing surface over the frame buffer of a bitmap video mode.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#lcd-vram-bitmap-bg-modes">LCD VRAM Bitmap BG Modes</a>
+     *
+     * Writes VRAM through plain (non-volatile) pointers, filling spans a 32-bit word at a time and long spans with
+     * 32-byte stm bursts from IWRAM. All coordinates are clipped to the surface.
+     *
+     * Mode 4 pixels are bytes, but VRAM ignores byte writes, so single pixels are written with a read-modify-write of
+     * the u8x2 pair holding them, and spans only do so for an unpaired pixel at either end.
+     *
+     * For modes 4 and 5 the surface draws to one page while the other is displayed, and flip() swaps them.
+     *
+     * @tparam Mode Bitmap video mode (3, 4, or 5).
+     *
+     * @code{cpp}
+     * // Double buffered mode 4
+     *
+     * #include <gba/gba.hpp>
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::DISPCNT = {.video_mode = 4, .show_bg2 = true};
+     *     mmio::BG_PALETTE[1] = 0x7fff;
+     *
+     *     bitmap<4> screen;
+     *     for (int x = 0; ; ++x) {
+     *         screen.clear(0);
+     *         screen.line(0, 0, x % 240, 159, 1);
+     *         screen.fill_rect(100, 60, 40, 40, 1);
+     *
+     *         bios::VBlankIntrWait();
+     *         screen.flip();
+     *     }
+     * }
+     * @endcode
+     *
+     * @sa mmio::VIDEO3_VRAM
+     * @sa mmio::VIDEO4_VRAM
+     * @sa mmio::VIDEO5_VRAM
+     */
+    template <u32 Mode> requires (Mode >= 3 && Mode <= 5)
+    class bitmap {
+    public:
+        /**
+         * @brief 15-bit color for modes 3 and 5, palette index for mode 4.
+         */
+        using pixel_type = std::conditional_t<Mode == 4, u8, u16>;
+
+        static constexpr int width = Mode == 5 ? 160 : 240;
+        static constexpr int height = Mode == 5 ? 128 : 160;
+        static constexpr bool paged = Mode != 3;
+
+        /**
+         * @param draw_page Page drawn to (ignored by mode 3). Page 1 is hidden while mmio::DISPCNT shows page 0.
+         */
+        constexpr explicit bitmap(u32 draw_page = 1) noexcept : m_page{paged ? draw_page & 1 : 0} {}
+
+        /**
+         * @brief Displays the drawn page, and draws to the other.
+         *
+         * @note Best called during VBlank, to avoid tearing.
+         */
+        void flip() noexcept requires paged {
+            auto cnt = *mmio::DISPCNT;
+            cnt.page = m_page;
+            mmio::DISPCNT = cnt;
+            m_page ^= 1;
+        }
+
+        /**
+         * @brief Page being drawn to.
+         */
+        [[nodiscard]]
+        constexpr u32 page() const noexcept {
+            return m_page;
+        }
+
+        /**
+         * @brief First halfword of the page being drawn to. Rows are `width` pixels, packed as for mmio::VIDEO3_VRAM,
+         *        mmio::VIDEO4_VRAM, or mmio::VIDEO5_VRAM.
+         */
+        [[nodiscard]]
+        u16* data() const noexcept {
+            return row(0);
+        }
+
+        /**
+         * @brief Fills the whole page.
+         *
+         * @param color Fill color.
+         */
+        void clear(pixel_type color) noexcept {
+            detail::bitmap_fill(reinterpret_cast<u32*>(row(0)), stride * height / 2, word_of(color));
+        }
+
+        /**
+         * @brief Sets one pixel.
+         *
+         * @param x Column.
+         * @param y Row.
+         * @param color Pixel color.
+         */
+        void plot(int x, int y, pixel_type color) noexcept {
+            if (unsigned(x) < unsigned(width) && unsigned(y) < unsigned(height)) {
+                set(x, y, color);
+            }
+        }
+
+        /**
+         * @brief Reads one pixel.
+         *
+         * @param x Column.
+         * @param y Row.
+         * @return Pixel color, or zero outside of the surface.
+         */
+        [[nodiscard]]
+        pixel_type get(int x, int y) const noexcept {
+            if (unsigned(x) >= unsigned(width) || unsigned(y) >= unsigned(height)) {
+                return 0;
+            }
+            if constexpr (Mode == 4) {
+                const auto pair = reinterpret_cast<const volatile u8x2*>(row(y))[x / 2];
+                return pair[x & 1];
+            } else {
+                return row(y)[x];
+            }
+        }
+
+        /**
+         * @brief Fills a horizontal span.
+         *
+         * @param x0 First column.
+         * @param x1 Last column (inclusive, may be less than x0).
+         * @param y Row.
+         * @param color Fill color.
+         */
+        void hline(int x0, int x1, int y, pixel_type color) noexcept {
+            if (x1 < x0) {
+                const auto t = x0;
+                x0 = x1;
+                x1 = t;
+            }
+            if (unsigned(y) >= unsigned(height) || x1 < 0 || x0 >= width) {
+                return;
+            }
+            span(x0 < 0 ? 0 : x0, x1 >= width ? width - 1 : x1, y, color);
+        }
+
+        /**
+         * @brief Fills a vertical span.
+         *
+         * @param x Column.
+         * @param y0 First row.
+         * @param y1 Last row (inclusive, may be less than y0).
+         * @param color Fill color.
+         */
+        void vline(int x, int y0, int y1, pixel_type color) noexcept {
+            if (y1 < y0) {
+                const auto t = y0;
+                y0 = y1;
+                y1 = t;
+            }
+            if (unsigned(x) >= unsigned(width) || y1 < 0 || y0 >= height) {
+                return;
+            }
+            y0 = y0 < 0 ? 0 : y0;
+            y1 = y1 >= height ? height - 1 : y1;
+            for (auto y = y0; y <= y1; ++y) {
+                set(x, y, color);
+            }
+        }
+
+        /**
+         * @brief Fills a rectangle.
+         *
+         * @param x Left column.
+         * @param y Top row.
+         * @param w Width in pixels.
+         * @param h Height in pixels.
+         * @param color Fill color.
+         */
+        void fill_rect(int x, int y, int w, int h, pixel_type color) noexcept {
+            auto x0 = x < 0 ? 0 : x;
+            auto y0 = y < 0 ? 0 : y;
+            const auto x1 = x + w > width ? width : x + w;
+            const auto y1 = y + h > height ? height : y + h;
+            if (x0 >= x1 || y0 >= y1) {
+                return;
+            }
+            if (x0 == 0 && x1 == width) {
+                // Whole rows are contiguous
+                detail::bitmap_fill_halfwords(row(y0), std::size_t(stride * (y1 - y0)), u16(word_of(color)));
+                return;
+            }
+            for (; y0 < y1; ++y0) {
+                span(x0, x1 - 1, y0, color);
+            }
+        }
+
+        /**
+         * @brief Draws a line with Bresenham's algorithm.
+         *
+         * @param x0 Start column.
+         * @param y0 Start row.
+         * @param x1 End column.
+         * @param y1 End row.
+         * @param color Line color.
+         */
+        void line(int x0, int y0, int x1, int y1, pixel_type color) noexcept {
+            if (y0 == y1) {
+                hline(x0, x1, y0, color);
+                return;
+            }
+            if (x0 == x1) {
+                vline(x0, y0, y1, color);
+                return;
+            }
+
+            const auto dx = x1 > x0 ? x1 - x0 : x0 - x1;
+            const auto dy = y1 > y0 ? y0 - y1 : y1 - y0;
+            const auto sx = x0 < x1 ? 1 : -1;
+            const auto sy = y0 < y1 ? 1 : -1;
+            auto err = dx + dy;
+            while (true) {
+                plot(x0, y0, color);
+                if (x0 == x1 && y0 == y1) {
+                    break;
+                }
+                const auto e2 = err * 2;
+                if (e2 >= dy) {
+                    err += dy;
+                    x0 += sx;
+                }
+                if (e2 <= dx) {
+                    err += dx;
+                    y0 += sy;
+                }
+            }
+        }
+
+        /**
+         * @brief Copies a rectangle of pixels, clipped to the surface.
+         *
+         * @param x Destination left column.
+         * @param y Destination top row.
+         * @param src Source pixels, row by row.
+         * @param w Width in pixels.
+         * @param h Height in pixels.
+         * @param src_stride Pixels between source rows, or zero for w.
+         */
+        void blit(int x, int y, const pixel_type* src, int w, int h, int src_stride = 0) noexcept {
+            if (!src_stride) {
+                src_stride = w;
+            }
+            auto x0 = x;
+            auto y0 = y;
+            auto x1 = x + w > width ? width : x + w;
+            const auto y1 = y + h > height ? height : y + h;
+            if (x0 < 0) {
+                src -= x0;
+                x0 = 0;
+            }
+            if (y0 < 0) {
+                src -= y0 * src_stride;
+                y0 = 0;
+            }
+            if (x0 >= x1 || y0 >= y1) {
+                return;
+            }
+            for (; y0 < y1; ++y0, src += src_stride) {
+                copy(x0, x1 - 1, y0, src);
+            }
+        }
+
+    private:
+        // Halfwords per row
+        static constexpr int stride = Mode == 4 ? width / 2 : width;
+
+        static constexpr u32 word_of(pixel_type color) noexcept {
+            if constexpr (Mode == 4) {
+                return u32(color) * 0x01010101u;
+            } else {
+                return color | (u32(color) << 16);
+            }
+        }
+
+        [[nodiscard]]
+        u16* row(int y) const noexcept {
+            return reinterpret_cast<u16*>(detail::mapped_address(0x6000000 + m_page * 0xA000)) + y * stride;
+        }
+
+        void set(int x, int y, pixel_type color) noexcept {
+            if constexpr (Mode == 4) {
+                auto* pairs = reinterpret_cast<volatile u8x2*>(row(y));
+                u8x2 pair = pairs[x / 2];
+                pair[x & 1] = color;
+                pairs[x / 2] = pair;
+            } else {
+                row(y)[x] = color;
+            }
+        }
+
+        // Unclipped, x0 <= x1
+        void span(int x0, int x1, int y, pixel_type color) noexcept {
+            if constexpr (Mode == 4) {
+                if (x0 & 1) {
+                    set(x0++, y, color);
+                }
+                if (!(x1 & 1)) {
+                    set(x1--, y, color);
+                }
+                if (x0 < x1) {
+                    detail::bitmap_fill_halfwords(row(y) + x0 / 2, std::size_t((x1 - x0 + 1) / 2), u16(word_of(color)));
+                }
+            } else {
+                detail::bitmap_fill_halfwords(row(y) + x0, std::size_t(x1 - x0 + 1), color);
+            }
+        }
+
+        // Unclipped, x0 <= x1
+        void copy(int x0, int x1, int y, const pixel_type* src) noexcept {
+            if constexpr (Mode == 4) {
+                if (x0 & 1) {
+                    set(x0++, y, *src++);
+                }
+                auto* out = row(y) + x0 / 2;
+                for (; x0 < x1; x0 += 2, src += 2) {
+                    *out++ = u16(src[0] | (src[1] << 8));
+                }
+                if (x0 == x1) {
+                    set(x1, y, *src);
+                }
+            } else {
+                auto* out = row(y) + x0;
+                for (auto n = x1 - x0 + 1; n; --n) {
+                    *out++ = *src++;
+                }
+            }
+        }
+
+        u32 m_page;
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_BITMAP_HPP
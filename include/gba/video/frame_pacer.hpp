@@ -0,0 +1,258 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_FRAME_PACER_HPP
+#define GBAXX_VIDEO_FRAME_PACER_HPP
+/** @file */
+
+#include <cstddef>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+#include <gba/bios/halt.hpp>
+#include <gba/debug/profile.hpp>
+
+namespace gba {
+
+    /**
+     * @struct frame_stats
+     * @brief Measurements of the work done in one frame.
+     *
+     * @sa frame_pacer
+     */
+    struct frame_stats {
+        u32 cycles; /**< CPU cycles between the start of the frame and frame_pacer::wait(). */
+        u16 lines; /**< Scanlines of work (cycles / 1232). */
+        u16 end_line; /**< mmio::VCOUNT when frame_pacer::wait() was called. */
+        u16 missed; /**< Number of VBlanks missed because the work overran. */
+        bool overrun; /**< The work took longer than the budget. */
+    };
+
+    /**
+     * @class frame_pacer
+     * @brief Frame loop helper that measures how much of each frame the game's work consumes.
+     *
+     * wait() ends the frame: it measures the cycles since the previous VBlank with profile::cycles(), records them,
+     * calls the optional hook, and then waits for the next VBlank with bios::VBlankIntrWait(). The hook receives
+     * every frame's frame_stats, so the game can adapt (skipping AI ticks, reducing particles) before dropping frames.
+     *
+     * Optionally, a raster bar is drawn by setting the backdrop color (mmio::BG_PALETTE[0]) to a "busy" color at the
+     * start of the frame and an "idle" color in wait(), so the height of the busy band shows the load on screen.
+     *
+     * @tparam History Number of frames kept for the rolling statistics.
+     *
+     * @code{cpp}
+     * // Skipping expensive work when over budget
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static bool high_quality = true;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true};
+     *     mmio::IME = true;
+     *
+     *     frame_pacer<> pacer;
+     *     pacer.set_hook([](const frame_stats& stats) {
+     *         high_quality = !stats.overrun;
+     *     });
+     *     pacer.set_raster_bar(0x001f, 0x0000); // Red while busy
+     *
+     *     pacer.start();
+     *     while (true) {
+     *         // Game update...
+     *         pacer.wait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note The cycle counter is shared with the profiler (TIMER2 and TIMER3), which start() starts.
+     *
+     * @sa profile::cycles()
+     * @sa bios::VBlankIntrWait()
+     */
+    template <std::size_t History = 32> requires (History > 0)
+    class frame_pacer {
+    public:
+        using hook_type = void(*)(const frame_stats&);
+
+        static constexpr u32 cycles_per_line = 1232;
+
+        /**
+         * @param budget Cycles of work allowed per frame before it counts as an overrun.
+         */
+        constexpr explicit frame_pacer(u32 budget = profile::frame_cycles) noexcept : m_budget{budget} {}
+
+        /**
+         * @brief Starts the cycle counter and waits for the first VBlank.
+         */
+        void start() noexcept {
+            profile::start();
+            m_size = 0;
+            m_next = 0;
+            m_overruns = 0;
+            bios::VBlankIntrWait();
+            begin_frame();
+        }
+
+        /**
+         * @brief Ends the frame's work and waits for the next VBlank.
+         *
+         * @return Measurements of the frame that just ended.
+         */
+        frame_stats wait() noexcept {
+            const auto end_line = *mmio::VCOUNT;
+            const auto cycles = profile::cycles() - m_frame_start;
+            if (m_raster_bar) {
+                mmio::BG_PALETTE[0] = m_idle_color;
+            }
+
+            const auto stats = frame_stats{
+                .cycles = cycles,
+                .lines = u16(cycles / cycles_per_line),
+                .end_line = end_line,
+                .missed = u16(cycles / profile::frame_cycles),
+                .overrun = cycles > m_budget
+            };
+
+            m_cycles[m_next] = cycles;
+            m_next = m_next + 1 < History ? m_next + 1 : 0;
+            if (m_size < History) {
+                ++m_size;
+            }
+            m_overruns += stats.overrun;
+            m_last = stats;
+
+            if (m_hook) {
+                m_hook(stats);
+            }
+
+            bios::VBlankIntrWait();
+            begin_frame();
+            return stats;
+        }
+
+        /**
+         * @brief Sets a function called by wait() with the measurements of every frame.
+         *
+         * @param hook Function to call, or nullptr to remove.
+         */
+        void set_hook(hook_type hook) noexcept {
+            m_hook = hook;
+        }
+
+        /**
+         * @brief Enables the backdrop color raster bar.
+         *
+         * @param busy Backdrop color while working.
+         * @param idle Backdrop color after wait().
+         */
+        void set_raster_bar(u16 busy, u16 idle) noexcept {
+            m_raster_bar = true;
+            m_busy_color = busy;
+            m_idle_color = idle;
+        }
+
+        /**
+         * @brief Disables the raster bar, leaving the backdrop color with the idle color.
+         */
+        void clear_raster_bar() noexcept {
+            m_raster_bar = false;
+        }
+
+        [[nodiscard]]
+        u32 budget() const noexcept {
+            return m_budget;
+        }
+
+        void set_budget(u32 budget) noexcept {
+            m_budget = budget;
+        }
+
+        /**
+         * @brief Measurements of the most recent frame.
+         */
+        [[nodiscard]]
+        const frame_stats& last() const noexcept {
+            return m_last;
+        }
+
+        /**
+         * @brief Average cycles of work over the recorded history.
+         */
+        [[nodiscard]]
+        u32 average() const noexcept {
+            if (!m_size) {
+                return 0;
+            }
+            unsigned long long total = 0;
+            for (std::size_t ii = 0; ii < m_size; ++ii) {
+                total += m_cycles[ii];
+            }
+            return u32(total / m_size);
+        }
+
+        /**
+         * @brief Highest cycles of work over the recorded history.
+         */
+        [[nodiscard]]
+        u32 peak() const noexcept {
+            u32 result = 0;
+            for (std::size_t ii = 0; ii < m_size; ++ii) {
+                result = m_cycles[ii] > result ? m_cycles[ii] : result;
+            }
+            return result;
+        }
+
+        /**
+         * @brief Average load over the recorded history.
+         *
+         * @return Percentage of the budget used (may exceed 100).
+         */
+        [[nodiscard]]
+        u32 load() const noexcept {
+            return u32((static_cast<unsigned long long>(average()) * 100) / m_budget);
+        }
+
+        /**
+         * @brief Number of frames that overran the budget since start().
+         */
+        [[nodiscard]]
+        u32 overruns() const noexcept {
+            return m_overruns;
+        }
+
+    private:
+        void begin_frame() noexcept {
+            m_frame_start = profile::cycles();
+            if (m_raster_bar) {
+                mmio::BG_PALETTE[0] = m_busy_color;
+            }
+        }
+
+        u32 m_budget;
+        u32 m_frame_start{};
+        u32 m_cycles[History]{};
+        std::size_t m_next{};
+        std::size_t m_size{};
+        u32 m_overruns{};
+        frame_stats m_last{};
+        hook_type m_hook{};
+        bool m_raster_bar{};
+        u16 m_busy_color{};
+        u16 m_idle_color{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_FRAME_PACER_HPP
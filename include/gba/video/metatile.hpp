@@ -0,0 +1,481 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_METATILE_HPP
+#define GBAXX_VIDEO_METATILE_HPP
+/** @file */
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+#include <gba/video/textscreen.hpp>
+
+namespace gba {
+
+    /**
+     * @struct metatile
+     * @brief A 2x2 block of screen entries (16x16 pixels), drawn from a map of metatile indices.
+     *
+     * Each half is one word: the top-left and top-right entries, then the bottom-left and bottom-right entries. An even
+     * hardware column is word aligned within a screenblock row, so a half is written with a single store.
+     *
+     * @sa metatile_layer
+     * @sa make_metatiles()
+     */
+    struct alignas(4) metatile {
+        textscreen tiles[4]; /**< Top-left, top-right, bottom-left, bottom-right. */
+    };
+
+    namespace detail {
+
+        // Writes one half of each metatile, two entries per store, into a 16 word ring (a screenblock row)
+        template <typename Index>
+        [[gnu::section(".iwram._gba_metatile_expand"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void metatile_expand(volatile u32* __restrict__ row, const u32* __restrict__ halves, const Index* __restrict__ indices, u32 first, u32 count) noexcept {
+            for (; count; --count, ++first) {
+                row[first & 15] = halves[u32(*indices++) * 2];
+            }
+        }
+
+        [[nodiscard]]
+        constexpr std::uint64_t metatile_key(const metatile& block) noexcept {
+            std::uint64_t key = 0;
+            for (const auto& entry : block.tiles) {
+                key = (key << 16) | entry.tile | (u32(entry.hflip) << 10) | (u32(entry.vflip) << 11) | (u32(entry.palbank) << 12);
+            }
+            return key;
+        }
+
+        template <std::size_t N>
+        struct metatile_dedup {
+            std::array<metatile, N> unique{};
+            std::array<u16, N> indices{};
+            std::size_t count{};
+        };
+
+        // Open addressing on the packed entries, so each block costs a probe or two rather than a scan of the set
+        template <std::size_t Width, std::size_t N>
+        consteval auto dedup_metatiles(const std::array<textscreen, N>& map) {
+            constexpr auto columns = Width / 2;
+            constexpr auto size = N / 4;
+            constexpr auto buckets = std::bit_ceil(size * 2);
+            constexpr auto hash_shift = 64 - std::countr_zero(buckets);
+
+            auto result = metatile_dedup<size>{};
+            auto keys = std::array<std::uint64_t, size>{};
+            auto slots = std::array<u16, buckets>{}; // Unique index + 1, 0 when empty
+
+            for (std::size_t ii = 0; ii < size; ++ii) {
+                const auto top = (ii / columns) * 2 * Width + (ii % columns) * 2;
+                const auto block = metatile{{map[top], map[top + 1], map[top + Width], map[top + Width + 1]}};
+                const auto key = metatile_key(block);
+
+                auto slot = std::size_t((key * 0x9e3779b97f4a7c15ull) >> hash_shift) & (buckets - 1);
+                while (slots[slot] && keys[slots[slot] - 1] != key) {
+                    slot = (slot + 1) & (buckets - 1);
+                }
+                if (!slots[slot]) {
+                    keys[result.count] = key;
+                    result.unique[result.count++] = block;
+                    slots[slot] = u16(result.count);
+                }
+                result.indices[ii] = u16(slots[slot] - 1);
+            }
+            return result;
+        }
+
+    } // namespace detail
+
+    /**
+     * @struct metatile_data
+     * @brief Unique metatiles and the map of their indices, from make_metatiles().
+     *
+     * @tparam Index u8 for up to 256 metatiles, otherwise u16.
+     * @tparam Count Number of unique metatiles.
+     * @tparam Size Number of metatiles in the map.
+     */
+    template <typename Index, std::size_t Count, std::size_t Size>
+    struct metatile_data {
+        using index_type = Index;
+
+        std::array<metatile, Count> set;
+        std::array<Index, Size> indices;
+        std::size_t width; /**< Width of the map in metatiles. */
+        std::size_t height; /**< Height of the map in metatiles. */
+    };
+
+    /**
+     * @brief Splits a map of screen entries into unique 2x2 metatiles and a map of their indices, at compile time.
+     *
+     * Each metatile index replaces four screen entries, so with up to 256 unique metatiles (and u8 indices) the map
+     * takes an eighth of the ROM, plus 8 bytes per metatile.
+     *
+     * @tparam Map Reference to a constant std::array of textscreen, row by row.
+     * @tparam Width Width of the map in tiles. Both the width and the height must be even.
+     * @return metatile_data for metatile_layer or metatile_streamer.
+     *
+     * @sa metatile_layer
+     */
+    template <const auto& Map, std::size_t Width>
+    consteval auto make_metatiles() {
+        constexpr auto size = std::tuple_size_v<std::remove_cvref_t<decltype(Map)>>;
+        static_assert(Width % 2 == 0 && size % (Width * 2) == 0, "Map must be a whole number of 2x2 metatiles");
+
+        constexpr auto dedup = detail::dedup_metatiles<Width>(Map);
+        using index_type = std::conditional_t<(dedup.count <= 256), u8, u16>;
+
+        auto result = metatile_data<index_type, dedup.count, size / 4>{{}, {}, Width / 2, size / Width / 2};
+        for (std::size_t ii = 0; ii < dedup.count; ++ii) {
+            result.set[ii] = dedup.unique[ii];
+        }
+        for (std::size_t ii = 0; ii < size / 4; ++ii) {
+            result.indices[ii] = index_type(dedup.indices[ii]);
+        }
+        return result;
+    }
+
+    /**
+     * @class metatile_layer
+     * @brief Map of metatile indices, expanded into screen entries for a 32x32 text background.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#text-bg-screen-2-bytes-per-entry">Text BG Screen (2 bytes per entry)</a>
+     *
+     * Rows are expanded by an ARM kernel in IWRAM that reads one index and one word per metatile, and writes two screen
+     * entries with each store. Coordinates are in tiles, as for bg_streamer.
+     *
+     * @tparam Index Metatile index type, u8 or u16.
+     *
+     * @sa metatile_streamer
+     * @sa make_metatiles()
+     */
+    template <typename Index = u8> requires (std::is_same_v<Index, u8> || std::is_same_v<Index, u16>)
+    class metatile_layer {
+    public:
+        static constexpr std::size_t screen_size = 32;
+
+        /**
+         * @param set Metatiles referenced by the map.
+         * @param indices Top-left index of the row-major map.
+         * @param width Width of the map in metatiles.
+         * @param height Height of the map in metatiles.
+         */
+        constexpr metatile_layer(const metatile* set, const Index* indices, std::size_t width, std::size_t height) noexcept :
+            m_set{set}, m_indices{indices}, m_width{width}, m_height{height} {}
+
+        /**
+         * @param data Output of make_metatiles().
+         */
+        template <std::size_t Count, std::size_t Size>
+        constexpr explicit metatile_layer(const metatile_data<Index, Count, Size>& data) noexcept :
+            metatile_layer{data.set.data(), data.indices.data(), data.width, data.height} {}
+
+        /**
+         * @brief Width of the map in tiles.
+         */
+        [[nodiscard]]
+        constexpr std::size_t width() const noexcept {
+            return m_width * 2;
+        }
+
+        /**
+         * @brief Height of the map in tiles.
+         */
+        [[nodiscard]]
+        constexpr std::size_t height() const noexcept {
+            return m_height * 2;
+        }
+
+        /**
+         * @brief Screen entry of a tile of the map.
+         *
+         * @param x Tile column.
+         * @param y Tile row.
+         * @return The screen entry.
+         */
+        [[nodiscard]]
+        textscreen entry(std::size_t x, std::size_t y) const noexcept {
+            const auto& block = m_set[m_indices[(y / 2) * m_width + x / 2]];
+            return block.tiles[(y & 1) * 2 + (x & 1)];
+        }
+
+        /**
+         * @brief Expands the 32 tiles of a map row from `x` into a screenblock row, wrapping as the hardware does.
+         *
+         * @param row Tile row of the map.
+         * @param x Tile column of the left edge of the window.
+         * @param dest Screenblock row (or a 16 word buffer) that receives the entries, at hardware column 0.
+         *
+         * @note Columns beyond the right edge of the map are left unchanged.
+         */
+        void expand_row(std::size_t row, std::size_t x, volatile u32* dest) const noexcept {
+            const auto* halves = reinterpret_cast<const u32*>(m_set) + (row & 1);
+            const auto* indices = m_indices + (row / 2) * m_width;
+
+            auto first = x / 2;
+            auto end = (x + screen_size + 1) / 2;
+            end = end < m_width ? end : m_width;
+            if (first >= end) {
+                return;
+            }
+
+            // An odd left edge shares its word with the column that leaves the window
+            if (x & 1) {
+                detail::metatile_expand(dest, halves, indices + first + 1, u32(first + 1), u32(end - first - 1));
+                const auto& block = m_set[indices[first]];
+                reinterpret_cast<volatile u16*>(dest)[x & (screen_size - 1)] = __builtin_bit_cast(u16, block.tiles[(row & 1) * 2 + 1]);
+            } else {
+                detail::metatile_expand(dest, halves, indices + first, u32(first), u32(end - first));
+            }
+        }
+
+        /**
+         * @brief Draws the 32x32 tile window with its top-left tile at (x, y) into a screenblock.
+         *
+         * Intended for level loads, during forced blank or VBlank.
+         *
+         * @param screenblock Screenblock of the background (bgcnt::screenblock).
+         * @param x Tile column of the left edge of the window.
+         * @param y Tile row of the top edge of the window.
+         */
+        void draw(std::size_t screenblock, std::size_t x, std::size_t y) const noexcept {
+            auto* const screen = reinterpret_cast<volatile u32*>(&mmio::TEXT_SCREENBLOCKS[screenblock]);
+            for (auto row = y; row < y + screen_size && row < height(); ++row) {
+                expand_row(row, x, screen + (row & (screen_size - 1)) * (screen_size / 2));
+            }
+        }
+
+    private:
+        const metatile* m_set;
+        const Index* m_indices;
+        std::size_t m_width;
+        std::size_t m_height;
+    };
+
+    template <typename Index, std::size_t Count, std::size_t Size>
+    metatile_layer(const metatile_data<Index, Count, Size>&) -> metatile_layer<Index>;
+
+    /**
+     * @class metatile_streamer
+     * @brief bg_streamer for a metatile_layer, expanding the rows and columns that enter the window.
+     *
+     * Works as bg_streamer, with the same camera rules and the same dma_queue. Rows are expanded into small buffers
+     * during update() and queued as one 32-bit copy each. Columns are gathered and written by flush() during VBlank.
+     *
+     * @tparam Index Metatile index type, u8 or u16.
+     * @tparam MaxColumns Maximum number of new columns per update() (camera movement of up to 8 * MaxColumns pixels).
+     * @tparam MaxRows Maximum number of new rows per update().
+     *
+     * @code{cpp}
+     * // Scrolling around a 128x64 tile level stored as metatiles
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static constexpr std::array<gba::textscreen, 128 * 64> level_entries = {
+     *     // ... screen entries of the level, row by row
+     * };
+     * static constexpr auto level = gba::make_metatiles<level_entries, 128>();
+     *
+     * static gba::dma_queue<16> uploads;
+     * static gba::metatile_streamer<> streamer{gba::metatile_layer{level}, 0, 31};
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.vblank) {
+     *             uploads.flush();
+     *             streamer.flush();
+     *         }
+     *     });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true};
+     *     mmio::IME = true;
+     *
+     *     mmio::BG0CNT = {.screenblock = 31};
+     *     streamer.reset(0, 0);
+     *     mmio::DISPCNT = {.show_bg0 = true};
+     *
+     *     int x = 0;
+     *     while (true) {
+     *         streamer.update(++x, 0, uploads);
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note update() should be called once per frame, between VBlanks, as the queued rows are read from buffers that
+     *       the next update() overwrites.
+     *
+     * @sa bg_streamer
+     * @sa metatile_layer
+     */
+    template <typename Index = u8, std::size_t MaxColumns = 2, std::size_t MaxRows = 2> requires (MaxColumns > 0 && MaxColumns <= 32 && MaxRows > 0 && MaxRows <= 32)
+    class metatile_streamer {
+    public:
+        static constexpr std::size_t screen_size = 32;
+        static constexpr auto max_columns = MaxColumns;
+        static constexpr auto max_rows = MaxRows;
+
+        /**
+         * @param layer Map to stream.
+         * @param bg Background index, for the offset register written by flush().
+         * @param screenblock Screenblock of the background (bgcnt::screenblock).
+         */
+        constexpr metatile_streamer(const metatile_layer<Index>& layer, std::size_t bg, std::size_t screenblock) noexcept :
+            m_layer{layer}, m_bg{bg}, m_screenblock{screenblock} {}
+
+        metatile_streamer(const metatile_streamer&) = delete;
+        metatile_streamer& operator=(const metatile_streamer&) = delete;
+
+        /**
+         * @brief Immediately draws the whole window under the camera and sets the background offset.
+         *
+         * @param x Camera left edge in pixels.
+         * @param y Camera top edge in pixels.
+         *
+         * @sa bg_streamer::reset()
+         */
+        void reset(int x, int y) noexcept {
+            m_x = x;
+            m_y = y;
+            m_tile_x = x >> 3;
+            m_tile_y = y >> 3;
+            m_columns = 0;
+
+            m_layer.draw(m_screenblock, std::size_t(m_tile_x), std::size_t(m_tile_y));
+            mmio::BGOFS[m_bg] = offset();
+        }
+
+        /**
+         * @brief Moves the camera, queuing the rows and gathering the columns that enter the window.
+         *
+         * @tparam Queue dma_queue type.
+         * @param x Camera left edge in pixels.
+         * @param y Camera top edge in pixels.
+         * @param queue Queue that receives the row copies.
+         * @return False if an update could not be queued (the camera moved too far, or the queue is full), in which case
+         *         reset() should be used.
+         *
+         * @sa bg_streamer::update()
+         */
+        template <class Queue>
+        bool update(int x, int y, Queue& queue) noexcept {
+            const auto tile_x = x >> 3;
+            const auto tile_y = y >> 3;
+            const auto dx = tile_x - m_tile_x;
+            const auto dy = tile_y - m_tile_y;
+            const auto rows = dy < 0 ? -dy : dy;
+            const auto columns = dx < 0 ? -dx : dx;
+            if (rows > int(MaxRows) || m_columns + columns > int(MaxColumns)) {
+                return false;
+            }
+
+            m_x = x;
+            m_y = y;
+            m_tile_x = tile_x;
+            m_tile_y = tile_y;
+
+            // Rows entering the bottom (dy > 0) or the top (dy < 0)
+            auto ok = true;
+            const auto first_row = dy > 0 ? tile_y + int(screen_size) - rows : tile_y;
+            for (auto row = first_row; ok && row < first_row + rows; ++row) {
+                if (row < int(m_layer.height())) {
+                    ok = queue_row(row, m_row_buffer[row - first_row], queue);
+                }
+            }
+
+            // Columns entering the right (dx > 0) or the left (dx < 0)
+            const auto first_column = dx > 0 ? tile_x + int(screen_size) - columns : tile_x;
+            for (auto column = first_column; column < first_column + columns; ++column) {
+                if (column < int(m_layer.width())) {
+                    gather_column(column);
+                }
+            }
+
+            return ok;
+        }
+
+        /**
+         * @brief Writes the gathered columns and the background offset.
+         *
+         * Intended to be called from the VBlank interrupt handler, after dma_queue::flush().
+         */
+        void flush() noexcept {
+            auto* const screen = reinterpret_cast<volatile u16*>(&mmio::TEXT_SCREENBLOCKS[m_screenblock]);
+            for (int ii = 0; ii < m_columns; ++ii) {
+                const auto& column = m_column_buffer[ii];
+                auto* dest = screen + column.index;
+                for (std::size_t jj = 0; jj < column.count; ++jj) {
+                    dest[((column.row + jj) & (screen_size - 1)) * screen_size] = column.entries[jj];
+                }
+            }
+            m_columns = 0;
+            mmio::BGOFS[m_bg] = offset();
+        }
+
+        /**
+         * @brief Background offset for the current camera.
+         *
+         * @return Horizontal and vertical offset.
+         */
+        [[nodiscard]]
+        u16x2 offset() const noexcept {
+            return u16x2{u16(m_x), u16(m_y)};
+        }
+
+    private:
+        struct column {
+            u16 entries[screen_size];
+            u16 index; // Hardware column
+            u16 row; // Hardware row of the first entry
+            std::size_t count;
+        };
+
+        // The buffer holds the row in hardware column order, so it is copied over the screenblock row as it is
+        template <class Queue>
+        bool queue_row(int row, u32 (&buffer)[screen_size / 2], Queue& queue) noexcept {
+            m_layer.expand_row(std::size_t(row), std::size_t(m_tile_x), buffer);
+            auto* const dest = reinterpret_cast<volatile u32*>(&mmio::TEXT_SCREENBLOCKS[m_screenblock][0] + (row & (screen_size - 1)) * screen_size);
+            return queue.push(&buffer[0], dest, screen_size / 2);
+        }
+
+        void gather_column(int column) noexcept {
+            auto& out = m_column_buffer[m_columns++];
+            out.index = u16(column & (screen_size - 1));
+            out.row = u16(m_tile_y & (screen_size - 1));
+
+            const auto rows = int(m_layer.height()) - m_tile_y;
+            out.count = rows < int(screen_size) ? std::size_t(rows) : screen_size;
+
+            for (std::size_t ii = 0; ii < out.count; ++ii) {
+                out.entries[ii] = __builtin_bit_cast(u16, m_layer.entry(std::size_t(column), std::size_t(m_tile_y) + ii));
+            }
+        }
+
+        metatile_layer<Index> m_layer;
+        std::size_t m_bg;
+        std::size_t m_screenblock;
+        int m_x{};
+        int m_y{};
+        int m_tile_x{};
+        int m_tile_y{};
+        int m_columns{};
+        u32 m_row_buffer[MaxRows][screen_size / 2]{};
+        column m_column_buffer[MaxColumns]{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_METATILE_HPP
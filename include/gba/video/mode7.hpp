@@ -0,0 +1,167 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_MODE7_HPP
+#define GBAXX_VIDEO_MODE7_HPP
+/** @file */
+
+#include <bit>
+#include <cstddef>
+#include <span>
+
+#include <gba/type.hpp>
+
+#include <gba/bios/math.hpp>
+#include <gba/math/reciprocal.hpp>
+#include <gba/math/trig.hpp>
+
+namespace gba {
+
+    /**
+     * @struct mode7_camera
+     * @brief Camera looking over an affine background plane.
+     *
+     * @sa mode7_generate()
+     */
+    struct mode7_camera {
+        fixed<int, 8> x; /**< Position on the background, in pixels. */
+        fixed<int, 8> y; /**< Position on the background, in pixels. */
+        fixed<int, 8> height; /**< Height above the plane, in pixels. */
+        angle<u16> yaw; /**< Rotation around the vertical axis. Zero looks towards -y (up the background). */
+        angle<u16> pitch; /**< Downwards tilt. Zero looks at the horizon, placing it at the center of the screen. */
+        int focal = 256; /**< Distance from the eye to the screen, in pixels. Smaller values widen the field of view. */
+    };
+
+    /**
+     * @brief Reciprocal table used by mode7_generate().
+     *
+     * Distances are normalized into the entries 128 to 256, where 24 fractional bits give 17 bits of precision.
+     */
+    inline constexpr auto mode7_reciprocal_lut = lut::make_reciprocal<257, fixed<unsigned int, 24>>();
+
+    namespace detail {
+
+        inline constexpr int mode7_lines = 160;
+        inline constexpr int mode7_center_x = 120;
+        inline constexpr int mode7_center_y = 80;
+
+        // Every value is raw fixed point: trig and den in .14, positions in .8, reciprocals in .24
+        [[gnu::section(".iwram._gba_mode7_generate"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline int mode7_generate(bios::bg_affine_dest* __restrict__ out, const fixed<unsigned int, 24>* __restrict__ recip,
+                                  int cam_x, int cam_y, int height, int cos_yaw, int sin_yaw, int cos_pitch, int sin_pitch,
+                                  int focal) noexcept {
+            using pa_type = fixed<short, 8>;
+            using dx_type = fixed<int, 8>;
+
+            // Projection of the screen row onto the view direction grows by cos(pitch) per line
+            auto den = (-mode7_center_y) * cos_pitch + focal * sin_pitch;
+            auto forward = focal * cos_pitch + mode7_center_y * sin_pitch;
+
+            int horizon = mode7_lines;
+            for (int y = 0; y < mode7_lines; ++y, den += cos_pitch, forward -= sin_pitch) {
+                if (den < (1 << 14)) {
+                    // Above (or too close to) the horizon, all pixels sample a single texel far outside the map
+                    out[y] = {pa_type{}, pa_type{}, pa_type{}, pa_type{}, dx_type::from_data(-0x4000000), dx_type::from_data(-0x4000000)};
+                    continue;
+                }
+                if (horizon == mode7_lines) {
+                    horizon = y;
+                }
+
+                // Normalize den into the table entries 128 to 256, then interpolate with the bits shifted out
+                const auto shift = 24 - std::countl_zero(u32(den));
+                const auto m = den >> shift;
+                const auto frac = u32(den) & ((1u << shift) - 1);
+                const auto lo = recip[m].data();
+                const auto hi = recip[m + 1].data();
+                const auto r = lo - (((lo - hi) * frac) >> shift);
+
+                // Distance scale .16 (height .8 times 1 / den, which is r .24 scaled by 2^(14 - shift))
+                const auto lambda = int((static_cast<long long>(height) * r) >> (shift + 2));
+                const auto pa = int((static_cast<long long>(cos_yaw) * lambda) >> 22);
+                const auto pc = int((static_cast<long long>(sin_yaw) * lambda) >> 22);
+                const auto depth = int((static_cast<long long>(forward) * lambda) >> 22);
+
+                const auto dx = cam_x - mode7_center_x * pa + int((static_cast<long long>(sin_yaw) * depth) >> 14);
+                const auto dy = cam_y - mode7_center_x * pc - int((static_cast<long long>(cos_yaw) * depth) >> 14);
+
+                out[y] = {pa_type::from_data(short(pa)), pa_type::from_data(short(-pc)),
+                          pa_type::from_data(short(pc)), pa_type::from_data(short(pa)),
+                          dx_type::from_data(dx), dx_type::from_data(dy)};
+            }
+            return horizon;
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Computes the affine parameters of every scanline for a perspective view of the background plane.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#lcd-io-bg-rotationscaling">LCD I/O BG Rotation/Scaling</a>
+     *
+     * Each line of the screen below the horizon sees the plane at a single distance, so it is drawn with its own
+     * scale (mmio::BG2PA and mmio::BG2PC) and start point (mmio::BG2X and mmio::BG2Y). The distance of each line is
+     * found with a table of reciprocals rather than a division, and the whole table is computed in IWRAM ARM code.
+     *
+     * The table has the layout of BG2PA to BG2Y (bios::bg_affine_dest), so it is displayed with a scanline_effect.
+     *
+     * @code{cpp}
+     * // Racing track on background 2
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static gba::scanline_effect<gba::mmio::BG2PA, gba::bios::bg_affine_dest> track;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.vblank) {
+     *             track.vblank();
+     *         }
+     *     });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true};
+     *     mmio::IME = true;
+     *
+     *     mmio::DISPCNT = {.video_mode = 1, .show_bg2 = true};
+     *     mmio::BG2CNT = {.screenblock = 8, .size = 3};
+     *
+     *     auto camera = mode7_camera{.x = 512, .y = 512, .height = 24, .pitch = 0x0800};
+     *     while (true) {
+     *         camera.yaw += angle<u16>(0x80);
+     *         mode7_generate(camera, track.back());
+     *         track.swap();
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @param camera Camera position, orientation, and focal length.
+     * @param lines Per-line parameters, written for all 160 lines.
+     * @return First line showing the plane (the horizon), or 160 if the camera sees none of it.
+     *
+     * @note Lines above the horizon sample a point far outside the background, so they are transparent as long as
+     *       the background does not wrap (bgcnt::is_affine_wrapping). They can be covered by a window or another background.
+     * @note Map coordinates use the 20.8 fixed-point range of mmio::BG2X, and heights should stay below 128 pixels.
+     *
+     * @sa mode7_camera
+     * @sa scanline_effect
+     */
+    inline int mode7_generate(const mode7_camera& camera, std::span<bios::bg_affine_dest, 160> lines) noexcept {
+        return detail::mode7_generate(lines.data(), mode7_reciprocal_lut.data(),
+                                      camera.x.data(), camera.y.data(), camera.height.data(),
+                                      lut::cos_lerp(lut::sin_lut, camera.yaw).data(), lut::sin_lerp(lut::sin_lut, camera.yaw).data(),
+                                      lut::cos_lerp(lut::sin_lut, camera.pitch).data(), lut::sin_lerp(lut::sin_lut, camera.pitch).data(),
+                                      camera.focal);
+    }
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_MODE7_HPP
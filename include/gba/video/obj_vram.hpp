@@ -0,0 +1,359 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_OBJ_VRAM_HPP
+#define GBAXX_VIDEO_OBJ_VRAM_HPP
+/** @file */
+
+#include <bit>
+#include <cstddef>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+namespace gba {
+
+    /**
+     * @class obj_vram_allocator
+     * @brief Allocates runs of 32-byte tiles from object VRAM.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#lcd-obj-vram-character-tile-mapping">LCD OBJ - VRAM Character (Tile) Mapping</a>
+     *
+     * Tracks the 1024 tiles of mmio::OBJ_TILES with a bitmap. Runs are aligned to their size rounded up to a power of
+     * 2 (up to 32 tiles), so the sprite sizes pack without fragmenting one another and 8bpp runs always start on an
+     * even tile.
+     *
+     * @note Tile indices are for 1D object mapping (dispcnt::obj_vram_1d) and can be used directly as objattr2::tile_id.
+     *
+     * @sa obj_tile_cache
+     */
+    class obj_vram_allocator {
+    public:
+        static constexpr std::size_t tiles = 1024;
+
+        /**
+         * @param bitmap_mode Reserve the lower 512 tiles, which overlap the frame buffer in video modes 3 to 5.
+         */
+        constexpr explicit obj_vram_allocator(bool bitmap_mode = false) noexcept {
+            if (bitmap_mode) {
+                for (std::size_t ii = 0; ii < words / 2; ++ii) {
+                    m_used[ii] = ~0u;
+                }
+            }
+        }
+
+        /**
+         * @brief Allocates a run of tiles.
+         *
+         * @param count Number of 4bpp tiles (twice the number of 8bpp tiles).
+         * @return First tile index, or -1 if there is no space.
+         */
+        [[nodiscard]]
+        constexpr int allocate(std::size_t count) noexcept {
+            if (!count || count > tiles) {
+                return -1;
+            }
+
+            if (count <= 32) {
+                const auto align = std::bit_ceil(count);
+                const auto mask = count == 32 ? ~0u : (1u << count) - 1;
+                for (std::size_t ii = 0; ii < words; ++ii) {
+                    const auto used = m_used[ii];
+                    if (used == ~0u) {
+                        continue;
+                    }
+                    for (std::size_t offset = 0; offset + count <= 32; offset += align) {
+                        if (!(used & (mask << offset))) {
+                            m_used[ii] = used | (mask << offset);
+                            return int(ii * 32 + offset);
+                        }
+                    }
+                }
+                return -1;
+            }
+
+            // Larger runs start on a word and span whole words (except the last)
+            const auto span = (count + 31) / 32;
+            const auto align = std::bit_ceil(span);
+            for (std::size_t ii = 0; ii + span <= words; ii += align) {
+                if (is_free(ii * 32, count)) {
+                    mark(ii * 32, count, true);
+                    return int(ii * 32);
+                }
+            }
+            return -1;
+        }
+
+        /**
+         * @brief Frees a run of tiles.
+         *
+         * @param tile First tile index returned by allocate().
+         * @param count Number of tiles passed to allocate().
+         */
+        constexpr void deallocate(int tile, std::size_t count) noexcept {
+            mark(std::size_t(tile), count, false);
+        }
+
+        /**
+         * @brief Number of free tiles (which may not be contiguous).
+         */
+        [[nodiscard]]
+        constexpr std::size_t available() const noexcept {
+            std::size_t count = 0;
+            for (const auto used : m_used) {
+                count += std::size_t(std::popcount(~used));
+            }
+            return count;
+        }
+
+    private:
+        static constexpr std::size_t words = tiles / 32;
+
+        [[nodiscard]]
+        constexpr bool is_free(std::size_t first, std::size_t count) const noexcept {
+            for (auto ii = first; ii < first + count; ++ii) {
+                if (m_used[ii / 32] & (1u << (ii % 32))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr void mark(std::size_t first, std::size_t count, bool used) noexcept {
+            for (auto ii = first; ii < first + count; ++ii) {
+                if (used) {
+                    m_used[ii / 32] |= 1u << (ii % 32);
+                } else {
+                    m_used[ii / 32] &= ~(1u << (ii % 32));
+                }
+            }
+        }
+
+        u32 m_used[words]{};
+    };
+
+    /**
+     * @class obj_tile_cache
+     * @brief Reference counted cache of sprite graphics in object VRAM, keyed by their source address.
+     *
+     * acquire() returns the tile index of graphics already in VRAM (a hit), or allocates space and queues an upload
+     * (a miss). Graphics released by every user stay cached until their space is needed, at which point the least
+     * recently used are evicted. This way animation frames are only uploaded when they are first shown, rather than
+     * every frame.
+     *
+     * @tparam Entries Maximum number of distinct graphics cached at once.
+     *
+     * @code{cpp}
+     * // Sharing animation frames between sprites
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const gba::tile4bpp walk_frames[8][4]; // 16x16 frames
+     *
+     * static gba::dma_queue<32> uploads;
+     * static gba::obj_tile_cache<> obj_tiles;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     // VBlank handler flushes uploads...
+     *
+     *     const tile4bpp* shown = nullptr;
+     *     for (int frame = 0; ; ++frame) {
+     *         const auto* next = walk_frames[(frame / 8) % 8];
+     *         const auto tile = obj_tiles.acquire(next, 4, uploads);
+     *         if (shown) {
+     *             obj_tiles.release(shown);
+     *         }
+     *         shown = next;
+     *
+     *         mmio::OBJ_ATTR[0] = objattr{{.y = 40}, {.x = 80, .size = 1}, {.tile_id = u16(tile)}};
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note Source graphics must stay valid (typically in ROM) while cached, and the queue must be flushed before the
+     *       returned tiles are displayed.
+     *
+     * @sa obj_vram_allocator
+     * @sa dma_queue
+     * @sa mmio::OBJ_TILES
+     */
+    template <std::size_t Entries = 64> requires (Entries > 0)
+    class obj_tile_cache {
+    public:
+        /**
+         * @param bitmap_mode Reserve the lower 512 tiles, which overlap the frame buffer in video modes 3 to 5.
+         */
+        constexpr explicit obj_tile_cache(bool bitmap_mode = false) noexcept : m_vram{bitmap_mode} {}
+
+        obj_tile_cache(const obj_tile_cache&) = delete;
+        obj_tile_cache& operator=(const obj_tile_cache&) = delete;
+
+        /**
+         * @brief Finds or uploads 4bpp graphics, adding a reference.
+         *
+         * @tparam Queue dma_queue type.
+         * @param src Source tiles.
+         * @param count Number of tiles.
+         * @param queue Queue that receives the upload on a miss.
+         * @return First tile index, or -1 if the graphics could not be made resident.
+         */
+        template <class Queue>
+        int acquire(const tile4bpp* src, std::size_t count, Queue& queue) noexcept {
+            return acquire_with(src, count, [&](int tile) {
+                return queue.push(src, &mmio::OBJ_TILES[tile], count);
+            });
+        }
+
+        /**
+         * @brief Finds or uploads 8bpp graphics, adding a reference.
+         *
+         * @tparam Queue dma_queue type.
+         * @param src Source tiles.
+         * @param count Number of 8bpp tiles.
+         * @param queue Queue that receives the upload on a miss.
+         * @return First (4bpp) tile index, or -1 if the graphics could not be made resident.
+         */
+        template <class Queue>
+        int acquire(const tile8bpp* src, std::size_t count, Queue& queue) noexcept {
+            return acquire_with(src, count * 2, [&](int tile) {
+                return queue.push(src, reinterpret_cast<volatile tile8bpp*>(&mmio::OBJ_TILES[tile]), count);
+            });
+        }
+
+        /**
+         * @brief Removes a reference added by acquire().
+         *
+         * The graphics stay cached after the last reference is released.
+         *
+         * @param src Source tiles passed to acquire().
+         */
+        void release(const void* src) noexcept {
+            if (auto* e = find(src); e && e->refs) {
+                --e->refs;
+                e->last_used = ++m_clock;
+            }
+        }
+
+        /**
+         * @brief Number of live references to graphics.
+         *
+         * @param src Source tiles passed to acquire().
+         * @return References, or zero if not cached.
+         */
+        [[nodiscard]]
+        std::size_t references(const void* src) const noexcept {
+            for (const auto& e : m_entries) {
+                if (e.src == src) {
+                    return e.refs;
+                }
+            }
+            return 0;
+        }
+
+        /**
+         * @brief Forgets every cached graphic and frees all tiles.
+         */
+        void clear() noexcept {
+            for (auto& e : m_entries) {
+                if (e.src) {
+                    m_vram.deallocate(e.tile, e.count);
+                }
+                e = {};
+            }
+        }
+
+        /**
+         * @brief Underlying allocator, for reserving tiles outside of the cache.
+         */
+        [[nodiscard]]
+        obj_vram_allocator& allocator() noexcept {
+            return m_vram;
+        }
+
+    private:
+        struct entry {
+            const void* src;
+            u16 tile;
+            u16 count;
+            u16 refs;
+            u32 last_used;
+        };
+
+        template <class Upload>
+        int acquire_with(const void* src, std::size_t count, Upload&& upload) noexcept {
+            if (auto* e = find(src)) {
+                ++e->refs;
+                return e->tile;
+            }
+
+            auto* slot = find(nullptr);
+            if (!slot) {
+                slot = least_recently_used();
+                if (!slot) {
+                    return -1;
+                }
+                evict(*slot);
+            }
+
+            auto tile = m_vram.allocate(count);
+            while (tile < 0) {
+                auto* victim = least_recently_used();
+                if (!victim) {
+                    return -1;
+                }
+                evict(*victim);
+                tile = m_vram.allocate(count);
+            }
+
+            if (!upload(tile)) {
+                m_vram.deallocate(tile, count);
+                return -1;
+            }
+
+            *slot = entry{src, u16(tile), u16(count), 1, ++m_clock};
+            return tile;
+        }
+
+        [[nodiscard]]
+        entry* find(const void* src) noexcept {
+            for (auto& e : m_entries) {
+                if (e.src == src) {
+                    return &e;
+                }
+            }
+            return nullptr;
+        }
+
+        // Unreferenced entry released the longest time ago
+        [[nodiscard]]
+        entry* least_recently_used() noexcept {
+            entry* oldest = nullptr;
+            for (auto& e : m_entries) {
+                if (e.src && !e.refs && (!oldest || e.last_used - oldest->last_used > 0x80000000u)) {
+                    oldest = &e;
+                }
+            }
+            return oldest;
+        }
+
+        void evict(entry& e) noexcept {
+            m_vram.deallocate(e.tile, e.count);
+            e = {};
+        }
+
+        obj_vram_allocator m_vram;
+        entry m_entries[Entries]{};
+        u32 m_clock{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_OBJ_VRAM_HPP
@@ -0,0 +1,291 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_PALETTE_HPP
+#define GBAXX_VIDEO_PALETTE_HPP
+/** @file */
+
+#include <bit>
+#include <cstddef>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+#include <gba/hardware/dmahelper.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        // Spreads the 15-bit colors of a word into two sets of fields with 5 spare bits between them, so a weight of
+        // up to 32 can be multiplied into every component at once
+        inline constexpr u32 palette_mask_lo = 0x03e07c1f; // Red and blue of the first color, green of the second
+        inline constexpr u32 palette_mask_hi = 0x03e0f81f; // Green of the first color, red and blue of the second (>> 5)
+
+        [[gnu::always_inline]]
+        inline u32 palette_lerp(u32 a, u32 b, u32 alpha) noexcept {
+            const auto inverse = 32 - alpha;
+            const auto lo = ((a & palette_mask_lo) * inverse + (b & palette_mask_lo) * alpha) >> 5;
+            const auto hi = (((a >> 5) & palette_mask_hi) * inverse + ((b >> 5) & palette_mask_hi) * alpha) >> 5;
+            return (lo & palette_mask_lo) | ((hi & palette_mask_hi) << 5);
+        }
+
+        [[gnu::section(".iwram._gba_palette_fade"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void palette_fade(const u32* __restrict__ src, u32* __restrict__ dest, std::size_t words, u32 color, u32 alpha) noexcept {
+            while (words--) {
+                *dest++ = palette_lerp(*src++, color, alpha);
+            }
+        }
+
+        [[gnu::section(".iwram._gba_palette_blend"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void palette_blend(const u32* __restrict__ a, const u32* __restrict__ b, u32* __restrict__ dest, std::size_t words, u32 alpha) noexcept {
+            while (words--) {
+                *dest++ = palette_lerp(*a++, *b++, alpha);
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Fades colors towards a single color.
+     *
+     * Runs from IWRAM in ARM state, processing two colors per 32-bit word.
+     *
+     * @param src Source colors.
+     * @param dest Destination colors (may be the same as src).
+     * @param count Number of colors. Must be even.
+     * @param color 15-bit color to fade towards.
+     * @param alpha Amount of fade, from 0 (src) to 32 (color).
+     *
+     * @note src and dest must be 4-byte aligned.
+     *
+     * @sa palette_blend()
+     */
+    inline void palette_fade(const u16* src, u16* dest, std::size_t count, u16 color, u32 alpha) noexcept {
+        detail::palette_fade(reinterpret_cast<const u32*>(src), reinterpret_cast<u32*>(dest), count / 2, color | (u32(color) << 16), alpha);
+    }
+
+    /**
+     * @brief Blends between two sets of colors.
+     *
+     * Runs from IWRAM in ARM state, processing two colors per 32-bit word.
+     *
+     * @param a Colors at an alpha of 0.
+     * @param b Colors at an alpha of 32.
+     * @param dest Destination colors (may be the same as a or b).
+     * @param count Number of colors. Must be even.
+     * @param alpha Blend amount, from 0 (a) to 32 (b).
+     *
+     * @note a, b and dest must be 4-byte aligned.
+     *
+     * @sa palette_fade()
+     */
+    inline void palette_blend(const u16* a, const u16* b, u16* dest, std::size_t count, u32 alpha) noexcept {
+        detail::palette_blend(reinterpret_cast<const u32*>(a), reinterpret_cast<const u32*>(b), reinterpret_cast<u32*>(dest), count / 2, alpha);
+    }
+
+    /**
+     * @class shadow_palette
+     * @brief RAM copy of palette memory with dirty 16-color bank tracking.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#color-palette-ram">Color Palette RAM</a>
+     *
+     * Holds both the background (colors 0 to 255) and object (colors 256 to 511) palettes. Each of the 32 banks of 16
+     * colors is marked dirty when written, and flush() copies only the dirty banks into palette RAM, merging adjacent
+     * banks into a single DMA.
+     *
+     * @code{cpp}
+     * // Fading the screen to black
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const gba::u16 level_palette[512];
+     *
+     * static gba::shadow_palette palette;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     for (u32 alpha = 0; alpha <= 32; ++alpha) {
+     *         palette.fade(level_palette, 0x0000, alpha);
+     *         bios::VBlankIntrWait();
+     *         palette.flush();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note Kept in IWRAM (the default for .bss) this gives the fastest CPU and DMA access.
+     *
+     * @sa mmio::BG_PALETTE
+     * @sa mmio::OBJ_PALETTE
+     */
+    class alignas(4) shadow_palette {
+    public:
+        static constexpr std::size_t size = 512;
+        static constexpr std::size_t bank_size = 16;
+        static constexpr std::size_t banks = size / bank_size;
+
+        constexpr shadow_palette() noexcept = default;
+
+        shadow_palette(const shadow_palette&) = delete;
+        shadow_palette& operator=(const shadow_palette&) = delete;
+
+        /**
+         * @brief Color entry, marking its bank as dirty.
+         *
+         * @param i Color index (0 to 255 for backgrounds, 256 to 511 for objects).
+         * @return Mutable 15-bit color.
+         */
+        [[nodiscard]]
+        u16& operator[](std::size_t i) noexcept {
+            mark(i / bank_size, 1);
+            return m_colors[i];
+        }
+
+        [[nodiscard]]
+        const u16& operator[](std::size_t i) const noexcept {
+            return m_colors[i];
+        }
+
+        /**
+         * @brief Colors of a 16-color bank, marking it as dirty.
+         *
+         * @param i Bank index (0 to 15 for backgrounds, 16 to 31 for objects).
+         * @return Pointer to the first of 16 colors.
+         */
+        [[nodiscard]]
+        u16* bank(std::size_t i) noexcept {
+            mark(i, 1);
+            return m_colors + i * bank_size;
+        }
+
+        /**
+         * @brief Raw colors, without marking anything dirty.
+         *
+         * @return Pointer to the first of 512 colors.
+         *
+         * @sa mark()
+         */
+        [[nodiscard]]
+        u16* data() noexcept {
+            return m_colors;
+        }
+
+        [[nodiscard]]
+        const u16* data() const noexcept {
+            return m_colors;
+        }
+
+        /**
+         * @brief Marks a range of banks as dirty.
+         *
+         * @param first First dirty bank.
+         * @param count Number of banks.
+         */
+        void mark(std::size_t first, std::size_t count) noexcept {
+            const auto mask = count >= banks ? ~0u : (1u << count) - 1;
+            m_dirty |= mask << first;
+        }
+
+        /**
+         * @brief Marks every bank as dirty.
+         */
+        void mark_all() noexcept {
+            m_dirty = ~0u;
+        }
+
+        /**
+         * @brief Tests if any banks are waiting to be flushed.
+         *
+         * @return True if there are dirty banks.
+         */
+        [[nodiscard]]
+        bool dirty() const noexcept {
+            return m_dirty != 0;
+        }
+
+        /**
+         * @brief Copies colors in, marking their banks as dirty.
+         *
+         * @param src Source colors, 4-byte aligned.
+         * @param first_bank First bank written.
+         * @param count Number of banks.
+         */
+        void load(const u16* src, std::size_t first_bank = 0, std::size_t count = banks) noexcept {
+            const auto* in = reinterpret_cast<const u32*>(src);
+            auto* out = reinterpret_cast<u32*>(m_colors + first_bank * bank_size);
+            for (std::size_t ii = 0; ii < count * bank_size / 2; ++ii) {
+                out[ii] = in[ii];
+            }
+            mark(first_bank, count);
+        }
+
+        /**
+         * @brief Fades source colors towards a single color, marking the banks as dirty.
+         *
+         * @param src Unfaded colors of the banks (typically the original palette in ROM), 4-byte aligned.
+         * @param color 15-bit color to fade towards (0x0000 for black, 0x7fff for white).
+         * @param alpha Amount of fade, from 0 (src) to 32 (color).
+         * @param first_bank First bank written.
+         * @param count Number of banks.
+         *
+         * @sa palette_fade()
+         */
+        void fade(const u16* src, u16 color, u32 alpha, std::size_t first_bank = 0, std::size_t count = banks) noexcept {
+            palette_fade(src, m_colors + first_bank * bank_size, count * bank_size, color, alpha);
+            mark(first_bank, count);
+        }
+
+        /**
+         * @brief Blends between two sets of source colors, marking the banks as dirty.
+         *
+         * @param a Colors at an alpha of 0, 4-byte aligned.
+         * @param b Colors at an alpha of 32, 4-byte aligned.
+         * @param alpha Blend amount, from 0 (a) to 32 (b).
+         * @param first_bank First bank written.
+         * @param count Number of banks.
+         *
+         * @sa palette_blend()
+         */
+        void blend(const u16* a, const u16* b, u32 alpha, std::size_t first_bank = 0, std::size_t count = banks) noexcept {
+            palette_blend(a, b, m_colors + first_bank * bank_size, count * bank_size, alpha);
+            mark(first_bank, count);
+        }
+
+        /**
+         * @brief Copies the dirty banks into palette RAM and clears the dirty banks.
+         *
+         * Adjacent dirty banks are copied with a single DMA.
+         *
+         * @tparam Channel DMA channel used for the copies.
+         *
+         * @note Palette RAM should be written during VBlank, HBlank, or forced blank to avoid visible artifacts.
+         */
+        template <std::size_t Channel = 3>
+        void flush() noexcept {
+            auto* const palette = reinterpret_cast<volatile u32*>(&mmio::BG_PALETTE);
+            const auto* const colors = reinterpret_cast<const u32*>(m_colors);
+
+            auto dirty = m_dirty;
+            m_dirty = 0;
+            while (dirty) {
+                const auto first = std::size_t(std::countr_zero(dirty));
+                const auto count = std::size_t(std::countr_one(dirty >> first));
+                dma<Channel>::copy(colors + first * bank_size / 2, palette + first * bank_size / 2, count * bank_size / 2);
+                dirty = count + first >= banks ? 0 : dirty & (~0u << (first + count));
+            }
+        }
+
+    private:
+        u16 m_colors[size]{};
+        u32 m_dirty{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_PALETTE_HPP
@@ -0,0 +1,484 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_RASTER3D_HPP
+#define GBAXX_VIDEO_RASTER3D_HPP
+/** @file */
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include <gba/type.hpp>
+
+#include <gba/math/matrix.hpp>
+#include <gba/video/bitmap.hpp>
+#include <gba/video/sprite_sort.hpp>
+
+namespace gba {
+
+    /**
+     * @struct screen_vertex
+     * @brief Projected vertex, from transform_vertices().
+     */
+    struct screen_vertex {
+        int x; /**< Column, in 1/16 pixels. */
+        int y; /**< Row, in 1/16 pixels. */
+        int z; /**< Camera depth, as vertex data. Zero for vertices in front of the near plane, which are not drawn. */
+    };
+
+    /**
+     * @struct projection
+     * @brief Perspective projection onto the screen.
+     *
+     * Camera space looks along +Z, with +X to the right and +Y up.
+     */
+    struct projection {
+        int focal = 120; /**< Distance to the screen in pixels. 120 gives a 90 degree horizontal field of view. Below 512. */
+        int center_x = 120; /**< Column of the view axis. */
+        int center_y = 80; /**< Row of the view axis. */
+        int near = 16; /**< Smallest visible depth, as vertex data. */
+    };
+
+    /**
+     * @struct texcoord
+     * @brief Texture coordinate of a triangle corner, in texels.
+     */
+    struct texcoord {
+        u16 u;
+        u16 v;
+    };
+
+    /**
+     * @struct raster_texture
+     * @brief 8-bit palette indexed texture, row by row, with power of two dimensions that wrap.
+     */
+    struct raster_texture {
+        const u8* texels;
+        u8 width_bits; /**< Width is `1 << width_bits`. */
+        u8 height_bits; /**< Height is `1 << height_bits`. */
+    };
+
+    /**
+     * @struct mesh_face
+     * @brief Flat shaded triangle of a mesh, indexing its vertices.
+     */
+    struct mesh_face {
+        u16 a;
+        u16 b;
+        u16 c;
+        u8 color; /**< Palette index. */
+    };
+
+    /**
+     * @struct textured_face
+     * @brief Affine textured triangle of a mesh, indexing its vertices.
+     */
+    struct textured_face {
+        u16 a;
+        u16 b;
+        u16 c;
+        texcoord ta;
+        texcoord tb;
+        texcoord tc;
+    };
+
+    namespace detail {
+
+        inline constexpr int raster_width = 240;
+        inline constexpr int raster_height = 160;
+        inline constexpr int raster_stride = 120; // Halfword pairs per row
+
+        // Vertices further than this outside of the screen are not drawn, which keeps the setup in 32 bits
+        inline constexpr int raster_guard = 768 << 4;
+
+        [[gnu::section(".iwram._gba_transform_vertices"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void transform_vertices(const int* __restrict__ matrix, const int* __restrict__ in, screen_vertex* __restrict__ out,
+                                       std::size_t count, unsigned shift, const projection& view) noexcept {
+            const auto center_x = view.center_x << 4;
+            const auto center_y = view.center_y << 4;
+            const auto focal = unsigned(view.focal) << 22;
+            const auto near = view.near > 0 ? view.near : 1;
+
+            const auto clamp = [](std::int64_t x) {
+                constexpr auto limit = std::int64_t{1} << 20;
+                return int(x > limit ? limit : x < -limit ? -limit : x);
+            };
+
+            for (; count; --count, in += 3, ++out) {
+                const auto row = [&](const int* m) {
+                    const auto sum = std::int64_t(m[0]) * in[0] + std::int64_t(m[1]) * in[1] + std::int64_t(m[2]) * in[2];
+                    return int(sum >> shift) + m[3];
+                };
+
+                const auto z = row(matrix + 8);
+                if (z < near) {
+                    *out = {};
+                    continue;
+                }
+
+                // One division per vertex, shared by both axes
+                const auto scale = std::int64_t(focal / unsigned(z));
+                out->x = center_x + clamp((row(matrix) * scale) >> 18);
+                out->y = center_y - clamp((row(matrix + 4) * scale) >> 18);
+                out->z = z;
+            }
+        }
+
+        struct raster_edge {
+            int x; // 16.16 pixels at the current row centre
+            int step;
+        };
+
+        [[nodiscard, gnu::always_inline]]
+        inline raster_edge raster_edge_at(const screen_vertex& a, const screen_vertex& b, int center) noexcept {
+            const auto inverse = (1u << 30) / unsigned(b.y - a.y);
+            const auto step = int((std::int64_t(b.x - a.x) * inverse) >> 14);
+            return {(a.x << 12) + int((std::int64_t(step) * (center - a.y)) >> 4), step};
+        }
+
+        // Calls span(row, first, end) for the pixels whose centres are inside the triangle, clipped to the screen
+        template <typename Fn>
+        [[gnu::always_inline]]
+        inline void raster_rows(const screen_vertex* v0, const screen_vertex* v1, const screen_vertex* v2, Fn&& span) noexcept {
+            if (v1->y < v0->y) {
+                const auto* t = v0;
+                v0 = v1;
+                v1 = t;
+            }
+            if (v2->y < v1->y) {
+                const auto* t = v1;
+                v1 = v2;
+                v2 = t;
+            }
+            if (v1->y < v0->y) {
+                const auto* t = v0;
+                v0 = v1;
+                v1 = t;
+            }
+
+            // First row with its centre at or below y
+            const auto row_of = [](int y) {
+                const auto row = (y + 7) >> 4;
+                return row < 0 ? 0 : row > raster_height ? raster_height : row;
+            };
+            const auto center = [](int row) {
+                return (row << 4) + 8;
+            };
+
+            const auto top = row_of(v0->y);
+            const auto mid = row_of(v1->y);
+            const auto bottom = row_of(v2->y);
+            if (top >= bottom) {
+                return;
+            }
+
+            // Which side of the long edge the middle vertex is on
+            const auto right = (v1->x - v0->x) * (v2->y - v0->y) > (v2->x - v0->x) * (v1->y - v0->y);
+            auto long_edge = raster_edge_at(*v0, *v2, center(top));
+
+            const auto run = [&](raster_edge other, int from, int to) {
+                for (auto row = from; row < to; ++row) {
+                    auto left = (right ? long_edge.x : other.x) + 0x7fff;
+                    auto end = (right ? other.x : long_edge.x) + 0x7fff;
+                    long_edge.x += long_edge.step;
+                    other.x += other.step;
+
+                    left = left < 0 ? 0 : left >> 16;
+                    end = end < 0 ? 0 : end >> 16;
+                    end = end > raster_width ? raster_width : end;
+                    if (left < end) {
+                        span(row, left, end);
+                    }
+                }
+            };
+
+            if (top < mid) {
+                run(raster_edge_at(*v0, *v1, center(top)), top, mid);
+            }
+            if (mid < bottom) {
+                const auto from = top > mid ? top : mid;
+                run(raster_edge_at(*v1, *v2, center(from)), from, bottom);
+            }
+        }
+
+        [[gnu::section(".iwram._gba_raster_flat"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void raster_flat(u16* page, const screen_vertex& a, const screen_vertex& b, const screen_vertex& c, u8 color) noexcept {
+            const auto pair = u16(color * 0x0101);
+            raster_rows(&a, &b, &c, [&](int row, int first, int end) {
+                auto* line = page + row * raster_stride;
+
+                // VRAM ignores byte writes, so unpaired pixels at either end keep their neighbour
+                if (first & 1) {
+                    line[first / 2] = (line[first / 2] & 0x00ff) | (pair & 0xff00);
+                    ++first;
+                }
+                if (first < end && (end & 1)) {
+                    --end;
+                    line[end / 2] = (line[end / 2] & 0xff00) | (pair & 0x00ff);
+                }
+                if (first < end) {
+                    bitmap_fill_halfwords(line + first / 2, std::size_t(end - first) / 2, pair);
+                }
+            });
+        }
+
+        struct raster_gradient {
+            u32 origin; // 16.16 texels at the centre of pixel (0, 0)
+            int dx;
+            int dy;
+        };
+
+        [[gnu::section(".iwram._gba_raster_textured"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void raster_textured(u16* page, const screen_vertex& a, const screen_vertex& b, const screen_vertex& c,
+                                    const texcoord* uv, const raster_texture& texture) noexcept {
+            const auto x1 = b.x - a.x;
+            const auto y1 = b.y - a.y;
+            const auto x2 = c.x - a.x;
+            const auto y2 = c.y - a.y;
+            const auto area = x1 * y2 - x2 * y1;
+
+            // Reciprocal of the area, normalized to keep 16 bits of precision
+            auto magnitude = u32(area < 0 ? -area : area);
+            unsigned shift = 11;
+            while (magnitude >= 0x10000) {
+                magnitude >>= 1;
+                ++shift;
+            }
+            const auto reciprocal = std::int64_t(0x80000000u / magnitude);
+
+            // Affine texture coordinates are planes across the triangle
+            const auto gradient = [&](int t0, int t1, int t2) {
+                const auto d1 = t1 - t0;
+                const auto d2 = t2 - t0;
+                auto dx = int(((std::int64_t(d1) * y2 - std::int64_t(d2) * y1) * reciprocal) >> shift);
+                auto dy = int(((std::int64_t(d2) * x1 - std::int64_t(d1) * x2) * reciprocal) >> shift);
+                if (area < 0) {
+                    dx = -dx;
+                    dy = -dy;
+                }
+                const auto offset = (std::int64_t(dx) * (8 - a.x) + std::int64_t(dy) * (8 - a.y)) >> 4;
+                return raster_gradient{u32(t0) * 0x10000u + u32(offset), dx, dy};
+            };
+            const auto u = gradient(uv[0].u, uv[1].u, uv[2].u);
+            const auto v = gradient(uv[0].v, uv[1].v, uv[2].v);
+
+            const auto* texels = texture.texels;
+            const auto width_bits = texture.width_bits;
+            const auto u_mask = (1u << width_bits) - 1;
+            const auto v_mask = (1u << texture.height_bits) - 1;
+
+            raster_rows(&a, &b, &c, [&](int row, int first, int end) {
+                auto s = u.origin + u32(u.dy) * u32(row) + u32(u.dx) * u32(first);
+                auto t = v.origin + u32(v.dy) * u32(row) + u32(v.dx) * u32(first);
+                const auto sample = [&]() {
+                    const u32 texel = texels[(((t >> 16) & v_mask) << width_bits) | ((s >> 16) & u_mask)];
+                    s += u32(u.dx);
+                    t += u32(v.dx);
+                    return texel;
+                };
+
+                auto* line = page + row * raster_stride;
+                if (first & 1) {
+                    line[first / 2] = u16((line[first / 2] & 0x00ff) | (sample() << 8));
+                    ++first;
+                }
+                for (; first + 1 < end; first += 2) {
+                    const auto low = sample();
+                    const auto high = sample();
+                    line[first / 2] = u16(low | (high << 8));
+                }
+                if (first < end) {
+                    line[first / 2] = u16((line[first / 2] & 0xff00) | sample());
+                }
+            });
+        }
+
+        // Near plane, guard band, and backface tests. Front faces wind anticlockwise on screen
+        [[nodiscard, gnu::always_inline]]
+        inline bool raster_visible(const screen_vertex& a, const screen_vertex& b, const screen_vertex& c) noexcept {
+            const auto inside = [](const screen_vertex& p) {
+                return p.z && p.x > -raster_guard && p.x < (raster_width << 4) + raster_guard &&
+                       p.y > -raster_guard && p.y < (raster_height << 4) + raster_guard;
+            };
+            if (!inside(a) || !inside(b) || !inside(c)) {
+                return false;
+            }
+            return (b.x - a.x) * (c.y - a.y) < (c.x - a.x) * (b.y - a.y);
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Transforms and projects a batch of vertices, in ARM.
+     *
+     * @param model_view Transform from model space to camera space.
+     * @param vertices Model space vertices.
+     * @param out Receives one screen_vertex per vertex.
+     * @param view Projection onto the screen.
+     *
+     * @sa draw_mesh()
+     */
+    template <std::size_t MatrixBits, std::size_t VectorBits>
+    void transform_vertices(const fixed_mat3x4<MatrixBits, VectorBits>& model_view, std::type_identity_t<std::span<const fixed_vec3<VectorBits>>> vertices,
+                            screen_vertex* out, const projection& view = {}) noexcept {
+        static_assert(sizeof(fixed_vec3<VectorBits>) == sizeof(int) * 3);
+
+        int matrix[12];
+        for (int row = 0; row < 3; ++row) {
+            matrix[row * 4 + 0] = model_view.basis.m[row][0].data();
+            matrix[row * 4 + 1] = model_view.basis.m[row][1].data();
+            matrix[row * 4 + 2] = model_view.basis.m[row][2].data();
+        }
+        matrix[3] = model_view.origin.x.data();
+        matrix[7] = model_view.origin.y.data();
+        matrix[11] = model_view.origin.z.data();
+
+        detail::transform_vertices(matrix, reinterpret_cast<const int*>(vertices.data()), out, vertices.size(), MatrixBits, view);
+    }
+
+    /**
+     * @brief Draws a flat shaded triangle on the page being drawn to.
+     *
+     * @param target Mode 4 surface.
+     * @param a First corner.
+     * @param b Second corner.
+     * @param c Third corner.
+     * @param color Palette index.
+     * @return False if the triangle was culled: back facing, in front of the near plane, or far off screen.
+     */
+    inline bool draw_triangle(bitmap<4>& target, const screen_vertex& a, const screen_vertex& b, const screen_vertex& c, u8 color) noexcept {
+        if (!detail::raster_visible(a, b, c)) {
+            return false;
+        }
+        detail::raster_flat(target.data(), a, b, c, color);
+        return true;
+    }
+
+    /**
+     * @brief Draws an affine textured triangle on the page being drawn to.
+     *
+     * @param target Mode 4 surface.
+     * @param a First corner.
+     * @param b Second corner.
+     * @param c Third corner.
+     * @param ta Texture coordinate of a.
+     * @param tb Texture coordinate of b.
+     * @param tc Texture coordinate of c.
+     * @param texture Texture to sample.
+     * @return False if the triangle was culled: back facing, in front of the near plane, or far off screen.
+     */
+    inline bool draw_triangle(bitmap<4>& target, const screen_vertex& a, const screen_vertex& b, const screen_vertex& c,
+                              texcoord ta, texcoord tb, texcoord tc, const raster_texture& texture) noexcept {
+        if (!detail::raster_visible(a, b, c)) {
+            return false;
+        }
+        const texcoord uv[3] = {ta, tb, tc};
+        detail::raster_textured(target.data(), a, b, c, uv, texture);
+        return true;
+    }
+
+    /**
+     * @brief Orders faces from the furthest to the nearest, for drawing meshes that are not convex.
+     *
+     * @param vertices Projected vertices.
+     * @param faces Faces, up to 256.
+     * @param order Receives the face indices, furthest first.
+     */
+    template <typename Face, std::size_t Extent>
+    void depth_order(std::span<const screen_vertex> vertices, std::span<const Face, Extent> faces, u8* order) noexcept {
+        u16 keys[256];
+        const auto count = faces.size() < 256 ? faces.size() : 256;
+        for (std::size_t ii = 0; ii < count; ++ii) {
+            const auto& face = faces[ii];
+            const auto depth = u32(vertices[face.a].z + vertices[face.b].z + vertices[face.c].z) >> 4;
+            keys[ii] = u16(0xffff - (depth > 0xffff ? 0xffff : depth));
+        }
+        radix_sort(keys, order, count);
+    }
+
+    /**
+     * @brief Draws the flat shaded faces of a mesh.
+     *
+     * Faces wind anticlockwise when seen from outside. Convex meshes need no ordering, as back faces are culled.
+     *
+     * @param target Mode 4 surface.
+     * @param vertices Projected vertices.
+     * @param faces Faces to draw.
+     * @param order Drawing order, such as from depth_order(), or nullptr to draw the faces in order.
+     *
+     * @code{cpp}
+     * // Spinning cube, double buffered
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static constexpr gba::fixed_vec3<> corners[] = {
+     *     {-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1}, {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}
+     * };
+     * static constexpr gba::mesh_face faces[] = {
+     *     {0, 1, 2, 1}, {0, 2, 3, 1}, {5, 4, 7, 2}, {5, 7, 6, 2}, {4, 0, 3, 3}, {4, 3, 7, 3},
+     *     {1, 5, 6, 4}, {1, 6, 2, 4}, {4, 5, 1, 5}, {4, 1, 0, 5}, {3, 2, 6, 6}, {3, 6, 7, 6}
+     * };
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::DISPCNT = {.video_mode = 4, .show_bg2 = true};
+     *     // ... palette entries 1 to 6
+     *
+     *     bitmap<4> screen;
+     *     screen_vertex projected[8];
+     *
+     *     for (u16 frame = 0; ; ++frame) {
+     *         const angle<u16, 8> spin = frame;
+     *         const auto model_view = fixed_mat3x4<>::translate({0, 0, 4}) *
+     *                                 fixed_mat3x4<>{fixed_mat3<>::rotate_y(spin) * fixed_mat3<>::rotate_x(spin)};
+     *
+     *         transform_vertices(model_view, corners, projected);
+     *         screen.clear(0);
+     *         draw_mesh(screen, projected, faces);
+     *
+     *         bios::VBlankIntrWait();
+     *         screen.flip();
+     *     }
+     * }
+     * @endcode
+     *
+     * @sa transform_vertices()
+     * @sa bitmap::flip()
+     */
+    inline void draw_mesh(bitmap<4>& target, std::span<const screen_vertex> vertices, std::span<const mesh_face> faces,
+                          const u8* order = nullptr) noexcept {
+        for (std::size_t ii = 0; ii < faces.size(); ++ii) {
+            const auto& face = faces[order ? order[ii] : ii];
+            draw_triangle(target, vertices[face.a], vertices[face.b], vertices[face.c], face.color);
+        }
+    }
+
+    /**
+     * @brief Draws the affine textured faces of a mesh.
+     *
+     * @param target Mode 4 surface.
+     * @param vertices Projected vertices.
+     * @param faces Faces to draw.
+     * @param texture Texture of every face.
+     * @param order Drawing order, such as from depth_order(), or nullptr to draw the faces in order.
+     */
+    inline void draw_mesh(bitmap<4>& target, std::span<const screen_vertex> vertices, std::span<const textured_face> faces,
+                          const raster_texture& texture, const u8* order = nullptr) noexcept {
+        for (std::size_t ii = 0; ii < faces.size(); ++ii) {
+            const auto& face = faces[order ? order[ii] : ii];
+            draw_triangle(target, vertices[face.a], vertices[face.b], vertices[face.c], face.ta, face.tb, face.tc, texture);
+        }
+    }
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_RASTER3D_HPP
@@ -0,0 +1,188 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_SCANLINE_HPP
+#define GBAXX_VIDEO_SCANLINE_HPP
+/** @file */
+
+#include <span>
+#include <type_traits>
+
+#include <gba/hardware/dmahelper.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        // Writes the value for line 0, then arms a repeating HBlank DMA that writes table[N + 1] in the HBlank of line N
+        template <std::size_t Channel, typename T>
+        [[gnu::always_inline]]
+        inline void hblank_stream(const T* table, volatile T* dest) noexcept {
+            using channel = dma<Channel>;
+
+            // The source address is not reloaded on repeat, so the channel is restarted every frame
+            channel::stop();
+
+            volatile_store(dest, table[0]);
+            channel::transfer(&table[1], dest, channel::template units_of<T>(1),
+                    channel::template control_for<T>(src_addr::increment, dest_addr::inc_reload, start::hblank, true));
+        }
+
+    } // namespace detail
+
+    /**
+     * @class scanline_effect
+     * @brief Streams a per-scanline table of values into a register using a repeating HBlank DMA.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#gba-dma-transfers">GBA DMA Transfers</a>
+     *
+     * The effect owns two tables of 160 values. The back table is filled by game logic, then swap() requests that it
+     * be displayed from the next frame. vblank() must be called from the VBlank interrupt handler: it writes the value
+     * for line 0 directly and arms an HBlank DMA that writes the value for line N + 1 during the HBlank of line N.
+     *
+     * The destination uses dest_addr::inc_reload, so T may span several consecutive registers (such as
+     * BG2PA..BG2PD, or WIN0H and WIN1H).
+     *
+     * @tparam Target Registral of the first destination register.
+     * @tparam T Value type written for each line. Defaults to the value type of `Target`.
+     * @tparam Channel DMA channel used for the effect. DMA0 has the highest priority, so is the default.
+     *
+     * @code{cpp}
+     * // Sine wave on background 0
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static gba::scanline_effect<gba::mmio::BG0HOFS> wave;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.vblank) {
+     *             wave.vblank();
+     *         }
+     *     });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true};
+     *     mmio::IME = true;
+     *
+     *     int phase = 0;
+     *     while (true) {
+     *         auto table = wave.back();
+     *         for (int y = 0; y < 160; ++y) {
+     *             table[y] = (y + phase) & 7;
+     *         }
+     *         wave.swap();
+     *         ++phase;
+     *
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note DMA0 can only read from internal memory, so the effect object must be placed in IWRAM or EWRAM.
+     *
+     * @sa dma
+     */
+    template <auto Target, typename T = std::remove_cv_t<std::remove_pointer_t<decltype(&Target)>>, std::size_t Channel = 0>
+        requires DmaTransferable<T>
+    class scanline_effect {
+    public:
+        using value_type = T;
+
+        static constexpr std::size_t lines = 160;
+
+        constexpr scanline_effect() noexcept = default;
+
+        scanline_effect(const scanline_effect&) = delete;
+        scanline_effect& operator=(const scanline_effect&) = delete;
+
+        /**
+         * @brief Table to be displayed after the next swap().
+         *
+         * @return Writable table of values, one per line.
+         *
+         * @warning Do not modify the back table between calling swap() and the following VBlank.
+         */
+        [[nodiscard]]
+        std::span<T, lines> back() noexcept {
+            return std::span<T, lines>{m_tables[m_front ^ 1], lines};
+        }
+
+        /**
+         * @brief Table currently being displayed.
+         *
+         * @return Table of values, one per line.
+         */
+        [[nodiscard]]
+        std::span<const T, lines> front() const noexcept {
+            return std::span<const T, lines>{m_tables[m_front], lines};
+        }
+
+        /**
+         * @brief Requests that the back table be displayed from the next VBlank.
+         */
+        void swap() noexcept {
+            m_swap = true;
+        }
+
+        /**
+         * @brief Tests if a swap is pending.
+         *
+         * @return True if swap() was called and vblank() has not yet run.
+         */
+        [[nodiscard]]
+        bool swap_pending() const noexcept {
+            return m_swap;
+        }
+
+        /**
+         * @brief Stops the effect, leaving the register with its last written value.
+         */
+        void stop() noexcept {
+            m_enabled = false;
+            dma<Channel>::stop();
+        }
+
+        /**
+         * @brief Restarts a stopped effect from the next VBlank.
+         */
+        void start() noexcept {
+            m_enabled = true;
+        }
+
+        /**
+         * @brief Swaps tables if requested, then re-arms the HBlank DMA for the next frame.
+         *
+         * Must be called from the VBlank interrupt handler.
+         */
+        void vblank() noexcept {
+            if (!m_enabled) {
+                return;
+            }
+
+            if (m_swap) {
+                m_front ^= 1;
+                m_swap = false;
+            }
+
+            detail::hblank_stream<Channel>(m_tables[m_front], reinterpret_cast<volatile T*>(&Target));
+        }
+
+    private:
+        // The HBlank of line 159 reads one entry past the end of the table
+        T m_tables[2][lines + 1]{};
+        int m_front{};
+        volatile bool m_swap{};
+        volatile bool m_enabled{true};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_SCANLINE_HPP
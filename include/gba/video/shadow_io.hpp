@@ -0,0 +1,241 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_SHADOW_IO_HPP
+#define GBAXX_VIDEO_SHADOW_IO_HPP
+/** @file */
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        inline constexpr std::uintptr_t shadow_io_address = 0x4000000;
+        inline constexpr std::size_t shadow_io_words = 22; // DISPCNT (0x4000000) to BLDY (0x4000054)
+
+        // Runs of fully dirty words are written with bursts, and lone dirty halfwords with strh, so a register that is
+        // not shadowed is never touched
+        [[gnu::section(".iwram._gba_shadow_io_commit"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void shadow_io_commit(const u32* __restrict__ shadow, std::uint64_t dirty) noexcept {
+            u32 words = 0;
+            for (u32 ii = 0; ii < shadow_io_words; ++ii) {
+                if (((dirty >> (ii * 2)) & 3) == 3) {
+                    words |= 1u << ii;
+                    dirty &= ~(std::uint64_t(3) << (ii * 2));
+                }
+            }
+
+            auto* io = reinterpret_cast<volatile u32*>(mapped_address(shadow_io_address));
+            while (words) {
+                const auto first = std::countr_zero(words);
+                const auto run = std::countr_one(words >> first);
+                words &= ~(((1u << run) - 1) << first);
+
+                auto* dest = io + first;
+                const auto* src = shadow + first;
+                auto remaining = run;
+                for (; remaining >= 4; remaining -= 4, dest += 4, src += 4) {
+                    volatile_burst_store<4>(dest, src);
+                }
+                for (; remaining; --remaining) {
+                    volatile_store(dest++, *src++);
+                }
+            }
+
+            const auto* shadow_halves = reinterpret_cast<const u16*>(shadow);
+            auto* io_halves = reinterpret_cast<volatile u16*>(mapped_address(shadow_io_address));
+            while (dirty) {
+                const auto half = std::countr_zero(dirty);
+                dirty &= dirty - 1;
+                volatile_store(io_halves + half, shadow_halves[half]);
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * @class shadow_io
+     * @brief RAM copy of the display, background, window, and blending registers, committed to the hardware at VBlank.
+     *
+     * Game code changes registers from mmio::DISPCNT (0x4000000) to mmio::BLDY (0x4000054) through the shadow with
+     * set(), which marks each changed register as dirty. The VBlank handler then calls commit(), which writes only the
+     * dirty registers, with bursts of `stmia` for runs of neighbouring registers. Every change made during a frame
+     * therefore takes effect together, at the start of the next frame.
+     *
+     * Registers never set through the shadow are not written by commit(), so mmio::DISPSTAT (for example) can still
+     * be written directly.
+     *
+     * @code{cpp}
+     * // Fading the screen from the game logic, without tearing
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static gba::shadow_io io;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.vblank) {
+     *             io.commit();
+     *         }
+     *     });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true};
+     *     mmio::IME = true;
+     *
+     *     io.set<mmio::DISPCNT>({.show_bg0 = true});
+     *     io.set<mmio::BLDCNT>(bldcnt{.target1_bg0 = true, .mode = color_effect::brighten});
+     *
+     *     int fade = 0;
+     *     while (true) {
+     *         io.set<mmio::BLDY>(fixed<u16, 4>::from_data(u16(fade++ % 17)));
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note A static shadow_io lives in .bss, which is IWRAM, so commit() reads it at full speed.
+     *
+     * @sa register_block
+     * @sa shadow_oam
+     */
+    class shadow_io {
+    public:
+        static constexpr std::uintptr_t address = detail::shadow_io_address;
+        static constexpr std::size_t size = detail::shadow_io_words * 4;
+
+        constexpr shadow_io() noexcept = default;
+
+        shadow_io(const shadow_io&) = delete;
+        shadow_io& operator=(const shadow_io&) = delete;
+
+        /**
+         * @brief Sets the value of a register and marks it dirty.
+         *
+         * @tparam Reg Registral within the shadowed range, such as mmio::DISPCNT.
+         * @param value New value.
+         */
+        template <auto Reg> requires (!detail::register_traits_of<Reg>::is_series)
+        void set(const typename detail::register_traits_of<Reg>::value_type& value) noexcept {
+            store(offset_of<Reg>(), value);
+        }
+
+        /**
+         * @brief Sets the value of one element of a registral_series and marks it dirty.
+         *
+         * @tparam Series Registral series within the shadowed range, such as mmio::BGCNT.
+         * @param i Element index.
+         * @param value New value.
+         */
+        template <auto Series> requires detail::register_traits_of<Series>::is_series
+        void set(std::size_t i, const typename detail::register_traits_of<Series>::value_type& value) noexcept {
+            store(offset_of<Series>() + i * detail::register_traits_of<Series>::stride, value);
+        }
+
+        /**
+         * @brief Value of a register as held by the shadow.
+         *
+         * @tparam Reg Registral within the shadowed range.
+         */
+        template <auto Reg> requires (!detail::register_traits_of<Reg>::is_series)
+        [[nodiscard]]
+        auto get() const noexcept {
+            return load<typename detail::register_traits_of<Reg>::value_type>(offset_of<Reg>());
+        }
+
+        /**
+         * @brief Value of one element of a registral_series as held by the shadow.
+         *
+         * @tparam Series Registral series within the shadowed range.
+         * @param i Element index.
+         */
+        template <auto Series> requires detail::register_traits_of<Series>::is_series
+        [[nodiscard]]
+        auto get(std::size_t i) const noexcept {
+            return load<typename detail::register_traits_of<Series>::value_type>(offset_of<Series>() + i * detail::register_traits_of<Series>::stride);
+        }
+
+        /**
+         * @brief Marks a register dirty without changing it, such as after writing it directly.
+         *
+         * @tparam Reg Registral or registral_series within the shadowed range.
+         */
+        template <auto Reg>
+        void mark() noexcept {
+            mark_bytes(offset_of<Reg>(), detail::register_traits_of<Reg>::size);
+        }
+
+        /**
+         * @brief Tests if any registers are waiting to be committed.
+         */
+        [[nodiscard]]
+        bool dirty() const noexcept {
+            return volatile_load(&m_dirty) != 0;
+        }
+
+        /**
+         * @brief Writes the dirty registers to the hardware, and clears the dirty bits.
+         *
+         * Intended to be called from the VBlank interrupt handler, which the main loop cannot interrupt.
+         */
+        void commit() noexcept {
+            const auto dirty = m_dirty;
+            if (!dirty) {
+                return;
+            }
+            m_dirty = 0;
+            detail::shadow_io_commit(m_words, dirty);
+        }
+
+    private:
+        template <auto Reg>
+        static constexpr std::size_t offset_of() noexcept {
+            using traits = detail::register_traits_of<Reg>;
+            static_assert(traits::address >= address && traits::address + traits::size <= address + size, "Register is outside of the shadowed range");
+            return traits::address - address;
+        }
+
+        template <typename T>
+        void store(std::size_t offset, const T& value) noexcept {
+            __builtin_memcpy(reinterpret_cast<char*>(m_words) + offset, &value, sizeof(T));
+            mark_bytes(offset, sizeof(T));
+        }
+
+        template <typename T>
+        T load(std::size_t offset) const noexcept {
+            T value;
+            __builtin_memcpy(&value, reinterpret_cast<const char*>(m_words) + offset, sizeof(T));
+            return value;
+        }
+
+        // An interrupted read-modify-write may mark an already committed register again, which only costs a rewrite
+        void mark_bytes(std::size_t offset, std::size_t bytes) noexcept {
+            const auto first = offset / 2;
+            const auto count = (offset + bytes + 1) / 2 - first;
+            const auto bits = ((std::uint64_t(1) << count) - 1) << first;
+            std::atomic_signal_fence(std::memory_order_release);
+            m_dirty = m_dirty | bits;
+        }
+
+        u32 m_words[detail::shadow_io_words]{};
+        volatile std::uint64_t m_dirty{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_SHADOW_IO_HPP
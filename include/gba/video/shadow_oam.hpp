@@ -0,0 +1,346 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_SHADOW_OAM_HPP
+#define GBAXX_VIDEO_SHADOW_OAM_HPP
+/** @file */
+
+#include <gba/hardware/dmahelper.hpp>
+
+namespace gba {
+
+    /**
+     * @class shadow_oam
+     * @brief RAM copy of object attribute memory with dirty-range tracking.
+     * @see <a href="https://mgba-emu.github.io/gbatek/#lcd-obj-oam-attributes">LCD OBJ - OAM Attributes</a>
+     *
+     * Objects can be modified at any time during the frame, and flush() copies only the span of entries that changed
+     * into OAM with a single DMA, which should be done during VBlank.
+     *
+     * Entries are 8 bytes, exactly as in OAM, so the affine parameters interleaved with the attributes are preserved.
+     *
+     * The sprite allocator collects objects with push() and hands them out in objattr2::priority order with commit(),
+     * which avoids the hardware quirk where a lower index object with a lower priority hides a higher priority one.
+     *
+     * @code{cpp}
+     * // Building a sprite list during active display
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static gba::shadow_oam oam;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true};
+     *     mmio::IME = true;
+     *
+     *     mmio::DISPCNT = {.obj_vram_1d = true, .show_obj = true};
+     *
+     *     while (true) {
+     *         oam.clear();
+     *         oam.push(objattr{{.y = 40}, {.x = 80}, {.tile_id = 0, .priority = 1}});
+     *         oam.push(objattr{{.y = 48}, {.x = 88}, {.tile_id = 4, .priority = 0}}); // Moved in front of the first
+     *         oam.commit();
+     *
+     *         bios::VBlankIntrWait();
+     *         oam.flush();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note Kept in IWRAM (the default for .bss) this gives the fastest CPU and DMA access.
+     *
+     * @sa mmio::OBJ_ATTR
+     * @sa mmio::OBJ_ATTR_AFFINE
+     */
+    class shadow_oam {
+    public:
+        /**
+         * @struct entry
+         * @brief One OAM entry: object attributes followed by one affine parameter.
+         */
+        struct alignas(4) entry {
+            union {
+                objattr attr{}; /**< Object attributes. */
+                objattr_affine attr_affine; /**< Affine object attributes. */
+            };
+            fixed<short, 8> param; /**< Affine parameter component. @sa shadow_oam::param() */
+        };
+        static_assert(sizeof(entry) == 8);
+
+        static constexpr std::size_t size = 128;
+        static constexpr std::size_t affine_size = 32;
+
+        /**
+         * @brief Constructs a shadow with every object hidden and dirty.
+         */
+        constexpr shadow_oam() noexcept {
+            for (auto& e : m_entries) {
+                e.attr.style = obj_display::hidden;
+            }
+        }
+
+        shadow_oam(const shadow_oam&) = delete;
+        shadow_oam& operator=(const shadow_oam&) = delete;
+
+        /**
+         * @brief Object attributes of an entry, marking it as dirty.
+         *
+         * @param i Object index (0 to 127).
+         * @return Mutable attributes.
+         */
+        [[nodiscard]]
+        objattr& operator[](std::size_t i) noexcept {
+            mark(i, i);
+            return m_entries[i].attr;
+        }
+
+        [[nodiscard]]
+        const objattr& operator[](std::size_t i) const noexcept {
+            return m_entries[i].attr;
+        }
+
+        /**
+         * @brief Object attributes of an affine entry, marking it as dirty.
+         *
+         * @param i Object index (0 to 127).
+         * @return Mutable affine attributes.
+         */
+        [[nodiscard]]
+        objattr_affine& affine(std::size_t i) noexcept {
+            mark(i, i);
+            return m_entries[i].attr_affine;
+        }
+
+        /**
+         * @brief Component of an affine matrix, marking the entry holding it as dirty.
+         *
+         * @param matrix Affine matrix index (0 to 31).
+         * @param component 0 = PA, 1 = PB, 2 = PC, 3 = PD.
+         * @return Mutable affine parameter.
+         *
+         * @sa mmio::AFFINE_PARAM_A
+         */
+        [[nodiscard]]
+        fixed<short, 8>& param(std::size_t matrix, std::size_t component) noexcept {
+            const auto i = matrix * 4 + component;
+            mark(i, i);
+            return m_entries[i].param;
+        }
+
+        /**
+         * @brief Raw entries, without marking anything dirty.
+         *
+         * @return Pointer to the first of 128 entries.
+         *
+         * @sa mark()
+         */
+        [[nodiscard]]
+        entry* data() noexcept {
+            return m_entries;
+        }
+
+        [[nodiscard]]
+        const entry* data() const noexcept {
+            return m_entries;
+        }
+
+        /**
+         * @brief Marks a range of entries as dirty.
+         *
+         * @param first First dirty index.
+         * @param last Last dirty index (inclusive).
+         */
+        void mark(std::size_t first, std::size_t last) noexcept {
+            if (first < m_dirty_first) {
+                m_dirty_first = first;
+            }
+            if (last + 1 > m_dirty_end) {
+                m_dirty_end = last + 1;
+            }
+        }
+
+        /**
+         * @brief Marks every entry as dirty.
+         */
+        void mark_all() noexcept {
+            m_dirty_first = 0;
+            m_dirty_end = size;
+        }
+
+        /**
+         * @brief Hides an object.
+         *
+         * @param i Object index (0 to 127).
+         */
+        void hide(std::size_t i) noexcept {
+            (*this)[i].style = obj_display::hidden;
+        }
+
+        /**
+         * @brief Hides every object.
+         */
+        void hide_all() noexcept {
+            for (auto& e : m_entries) {
+                e.attr.style = obj_display::hidden;
+            }
+            m_committed = 0;
+            mark_all();
+        }
+
+        /**
+         * @brief Tests if any entries are waiting to be flushed.
+         *
+         * @return True if there are dirty entries.
+         */
+        [[nodiscard]]
+        bool dirty() const noexcept {
+            return m_dirty_first < m_dirty_end;
+        }
+
+        /**
+         * @brief Copies the dirty span of entries into OAM and clears the dirty range.
+         *
+         * @tparam Channel DMA channel used for the copy.
+         *
+         * @note OAM is only accessible during VBlank, HBlank (with dispcnt::hblank_oam_free), or forced blank.
+         */
+        template <std::size_t Channel = 3>
+        void flush() noexcept {
+            if (!dirty()) {
+                return;
+            }
+
+            auto* oam = reinterpret_cast<volatile entry*>(&mmio::OBJ_ATTR);
+            dma<Channel>::copy(m_entries + m_dirty_first, oam + m_dirty_first, m_dirty_end - m_dirty_first);
+
+            m_dirty_first = size;
+            m_dirty_end = 0;
+        }
+
+        /**
+         * @brief Starts a new sprite list for the allocator.
+         *
+         * @sa push()
+         * @sa commit()
+         */
+        void clear() noexcept {
+            m_pending = 0;
+        }
+
+        /**
+         * @brief Adds an object to the sprite list.
+         *
+         * @param attr Object attributes.
+         * @return False if 128 objects have already been pushed.
+         */
+        bool push(const objattr& attr) noexcept {
+            if (m_pending == size) {
+                return false;
+            }
+            m_sprites[m_pending++] = attr;
+            return true;
+        }
+
+        /**
+         * @brief Adds an affine object to the sprite list.
+         *
+         * @param attr Affine object attributes.
+         * @return False if 128 objects have already been pushed.
+         */
+        bool push_affine(const objattr_affine& attr) noexcept {
+            return push(__builtin_bit_cast(objattr, attr));
+        }
+
+        /**
+         * @brief Number of objects pushed since clear().
+         *
+         * @return Object count.
+         */
+        [[nodiscard]]
+        std::size_t pending() const noexcept {
+            return m_pending;
+        }
+
+        /**
+         * @brief Writes the sprite list into the shadow, sorted by objattr2::priority.
+         *
+         * Objects with the same priority keep the order they were pushed. Entries used by the previous commit that
+         * are no longer needed are hidden. Affine parameters are not moved.
+         *
+         * @return Number of objects written.
+         */
+        std::size_t commit() noexcept {
+            std::size_t offsets[4]{};
+            for (std::size_t ii = 0; ii < m_pending; ++ii) {
+                ++offsets[m_sprites[ii].priority];
+            }
+
+            std::size_t sum = 0;
+            for (auto& offset : offsets) {
+                const auto count = offset;
+                offset = sum;
+                sum += count;
+            }
+
+            for (std::size_t ii = 0; ii < m_pending; ++ii) {
+                const auto& sprite = m_sprites[ii];
+                m_entries[offsets[sprite.priority]++].attr = sprite;
+            }
+
+            return finish();
+        }
+
+        /**
+         * @brief Writes the sprite list into the shadow in a given order.
+         *
+         * Entries used by the previous commit that are no longer needed are hidden. Affine parameters are not moved.
+         *
+         * @param order Index of the pushed object to write to each entry, one per pending() object, such as from
+         *              radix_sort(). This should keep objattr2::priority in order.
+         * @return Number of objects written.
+         *
+         * @sa sprite_sort_key()
+         */
+        std::size_t commit(const u8* order) noexcept {
+            for (std::size_t ii = 0; ii < m_pending; ++ii) {
+                m_entries[ii].attr = m_sprites[order[ii]];
+            }
+
+            return finish();
+        }
+
+    private:
+        std::size_t finish() noexcept {
+            for (auto ii = m_pending; ii < m_committed; ++ii) {
+                m_entries[ii].attr.style = obj_display::hidden;
+            }
+
+            const auto last = m_pending > m_committed ? m_pending : m_committed;
+            if (last) {
+                mark(0, last - 1);
+            }
+
+            m_committed = m_pending;
+            return m_committed;
+        }
+
+        entry m_entries[size]{};
+        objattr m_sprites[size]{};
+        std::size_t m_pending{};
+        std::size_t m_committed{};
+        std::size_t m_dirty_first{};
+        std::size_t m_dirty_end{size};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_SHADOW_OAM_HPP
@@ -0,0 +1,152 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_SPRITE_SORT_HPP
+#define GBAXX_VIDEO_SPRITE_SORT_HPP
+/** @file */
+
+#include <cstddef>
+
+#include <gba/type.hpp>
+
+#include <gba/video/objattr.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        // One stable counting sort pass over the byte of each key at Shift
+        template <unsigned Shift, typename Key>
+        [[gnu::always_inline]]
+        inline void radix_pass(const Key* __restrict__ keys, const u8* __restrict__ in, u8* __restrict__ out, std::size_t count) noexcept {
+            u16 offsets[256]{};
+            for (std::size_t ii = 0; ii < count; ++ii) {
+                ++offsets[(keys[ii] >> Shift) & 0xff];
+            }
+
+            u32 sum = 0;
+            for (auto& offset : offsets) {
+                const auto bucket = offset;
+                offset = u16(sum);
+                sum += bucket;
+            }
+
+            if (in) {
+                for (std::size_t ii = 0; ii < count; ++ii) {
+                    const auto index = in[ii];
+                    out[offsets[(keys[index] >> Shift) & 0xff]++] = index;
+                }
+            } else {
+                for (std::size_t ii = 0; ii < count; ++ii) {
+                    out[offsets[(keys[ii] >> Shift) & 0xff]++] = u8(ii);
+                }
+            }
+        }
+
+        [[gnu::section(".iwram._gba_radix_sort_u8"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void radix_sort_u8(const u8* __restrict__ keys, u8* __restrict__ order, std::size_t count) noexcept {
+            radix_pass<0>(keys, nullptr, order, count);
+        }
+
+        [[gnu::section(".iwram._gba_radix_sort_u16"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline void radix_sort_u16(const u16* __restrict__ keys, u8* __restrict__ order, std::size_t count) noexcept {
+            // Bytes that are the same in every key do not need a pass
+            u32 any = 0;
+            u32 all = 0xffff;
+            for (std::size_t ii = 0; ii < count; ++ii) {
+                any |= keys[ii];
+                all &= keys[ii];
+            }
+            const auto varies = any ^ all;
+
+            if (!(varies & 0xff00)) {
+                radix_pass<0>(keys, nullptr, order, count);
+            } else if (!(varies & 0x00ff)) {
+                radix_pass<8>(keys, nullptr, order, count);
+            } else {
+                u8 low[256];
+                radix_pass<0>(keys, nullptr, low, count);
+                radix_pass<8>(keys, low, order, count);
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Stable radix sort producing the order of a list of keys, rather than moving the keys.
+     *
+     * Runs a counting sort pass per byte of key (skipping bytes that are the same in every key) in IWRAM, so sorting
+     * the 128 sprites of a frame costs a few linear passes, with no comparisons and no allocation.
+     *
+     * @param keys Sort keys, smallest first.
+     * @param order Receives the indices of the keys in sorted order. Keys that compare equal keep their relative order.
+     * @param count Number of keys, up to 256.
+     *
+     * @sa sprite_sort_key()
+     * @sa shadow_oam::commit()
+     */
+    inline void radix_sort(const u8* keys, u8* order, std::size_t count) noexcept {
+        detail::radix_sort_u8(keys, order, count);
+    }
+
+    /**
+     * @copydoc radix_sort(const u8*, u8*, std::size_t)
+     */
+    inline void radix_sort(const u16* keys, u8* order, std::size_t count) noexcept {
+        detail::radix_sort_u16(keys, order, count);
+    }
+
+    /**
+     * @brief Builds a 16-bit sprite sort key, ordered by objattr2::priority and then by depth.
+     *
+     * Objects drawn with a lower OAM index appear in front, and must also have the higher (lower numbered) priority to
+     * avoid the hardware quirk where a lower index object with a lower priority hides a higher priority one. Sorting by
+     * this key keeps priority as the major order.
+     *
+     * @param attr Attributes holding the priority.
+     * @param depth Distance from the viewer (such as 255 minus the bottom of the sprite), 0 to 16383.
+     * @return Key for radix_sort().
+     *
+     * @code{cpp}
+     * // Sprites further down the screen drawn in front
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern gba::objattr sprites[64];
+     *
+     * static gba::shadow_oam oam;
+     * static gba::u16 keys[128];
+     * static gba::u8 order[128];
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     while (true) {
+     *         oam.clear();
+     *         for (const auto& sprite : sprites) {
+     *             keys[oam.pending()] = sprite_sort_key(sprite, u16(255 - sprite.y));
+     *             oam.push(sprite);
+     *         }
+     *         radix_sort(keys, order, oam.pending());
+     *         oam.commit(order);
+     *
+     *         bios::VBlankIntrWait();
+     *         oam.flush();
+     *     }
+     * }
+     * @endcode
+     */
+    [[nodiscard]]
+    constexpr u16 sprite_sort_key(const objattr2& attr, u16 depth) noexcept {
+        return u16((attr.priority << 14) | (depth & 0x3fff));
+    }
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_SPRITE_SORT_HPP
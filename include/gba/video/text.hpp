@@ -0,0 +1,278 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_TEXT_HPP
+#define GBAXX_VIDEO_TEXT_HPP
+/** @file */
+
+#include <cstddef>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+#include <gba/compress/bitunpack.hpp>
+#include <gba/hardware/dmahelper.hpp>
+
+namespace gba {
+
+    /**
+     * @struct font
+     * @brief Proportional 1bpp font.
+     *
+     * Each glyph is `height` bytes, one per row, with bit 0 as the leftmost pixel (the bit order of
+     * bios::BitUnPack()). Glyphs are at most 8 pixels wide.
+     *
+     * @sa text_canvas
+     */
+    struct font {
+        const u8* bitmap; /**< Glyph rows, `height` bytes per glyph. */
+        const u8* widths; /**< Horizontal advance of each glyph, in pixels. */
+        u8 first; /**< Character code of the first glyph. */
+        u8 count; /**< Number of glyphs. */
+        u8 height; /**< Rows per glyph. */
+    };
+
+    namespace detail {
+
+        // Clears the scratch line then ORs in each glyph row, expanded to 4bpp and shifted across two tiles. Returns the
+        // width drawn in pixels
+        [[gnu::section(".iwram._gba_text_rasterize"), GBAXX_TARGET_ARM, GBAXX_LONG_CALL, gnu::noinline]]
+        inline int text_rasterize(u32* __restrict__ tiles, std::size_t columns, std::size_t rows, const char* __restrict__ text,
+                                  const font& f, const compress::bit_unpacker<1, 4>& expand) noexcept {
+            for (std::size_t ii = 0; ii < columns * rows * 8; ++ii) {
+                tiles[ii] = 0;
+            }
+
+            const auto width = int(columns * 8);
+            int x = 0;
+            for (; *text; ++text) {
+                const auto glyph = unsigned(u8(*text)) - f.first;
+                if (glyph >= f.count) {
+                    continue;
+                }
+                const auto advance = int(f.widths[glyph]);
+                if (x + advance > width) {
+                    break;
+                }
+
+                const auto column = std::size_t(x / 8);
+                const auto shift = unsigned(x % 8) * 4;
+                const auto* src = f.bitmap + glyph * f.height;
+                const auto height = f.height < rows * 8 ? f.height : rows * 8;
+                for (std::size_t py = 0; py < height; ++py) {
+                    const auto bits = src[py];
+                    if (!bits) {
+                        continue;
+                    }
+                    const auto row = expand[bits];
+                    auto* out = tiles + ((py / 8) * columns + column) * 8 + py % 8;
+                    out[0] |= row << shift;
+                    if (shift && column + 1 < columns) {
+                        out[8] |= row >> (32 - shift);
+                    }
+                }
+                x += advance;
+            }
+            return x;
+        }
+
+    } // namespace detail
+
+    /**
+     * @class text_canvas
+     * @brief Renders proportional text into a block of 4bpp background tiles, re-rendering only lines that change.
+     *
+     * The canvas owns `Columns * LineTiles * Lines` consecutive tiles in a character block. Each line of text is
+     * rendered into a RAM buffer (glyph rows are expanded from 1bpp with a bit_unpacker table, then shifted into place)
+     * and copied to VRAM with a single DMA.
+     *
+     * write() keeps a hash of each line's text, so writing the same text again costs only the hash, and a dialogue
+     * box can call write() every frame without touching VRAM.
+     *
+     * @tparam Columns Width of the canvas in tiles (up to 32).
+     * @tparam Lines Number of text lines.
+     * @tparam LineTiles Height of a text line in tiles, enough for the font height.
+     *
+     * @code{cpp}
+     * // Dialogue box on background 0
+     *
+     * #include <gba/gba.hpp>
+     *
+     * extern const gba::font dialogue_font;
+     *
+     * static gba::text_canvas<28, 4, 2> dialogue{dialogue_font, 0, 1, 3};
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::BG0CNT = {.charblock = 0, .screenblock = 31};
+     *     mmio::DISPCNT = {.show_bg0 = true};
+     *     mmio::BG_PALETTE[3] = 0x7fff;
+     *
+     *     dialogue.map(31, 1, 12);
+     *     dialogue.write(0, "Hello, world!");
+     *
+     *     while (true) {
+     *         dialogue.write(1, "Press A"); // Only rendered the first time
+     *         bios::VBlankIntrWait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @note Tile 0 of the character block is left alone, and is usually a blank tile for the rest of the background.
+     *
+     * @sa font
+     * @sa compress::bit_unpacker
+     */
+    template <std::size_t Columns, std::size_t Lines, std::size_t LineTiles = 1>
+        requires (Columns > 0 && Columns <= 32 && Lines > 0 && LineTiles > 0)
+    class text_canvas {
+    public:
+        static constexpr std::size_t columns = Columns;
+        static constexpr std::size_t lines = Lines;
+        static constexpr std::size_t tiles = Columns * LineTiles * Lines;
+        static constexpr int width = int(Columns * 8);
+
+        /**
+         * @param f Font, which must stay valid.
+         * @param charblock Character block holding the canvas tiles.
+         * @param first_tile First tile of the canvas in the character block.
+         * @param color Palette index of the text (the background is color 0, transparent).
+         */
+        constexpr text_canvas(const font& f, std::size_t charblock, u16 first_tile, u8 color = 1) noexcept :
+                m_font{f}, m_expand{u32(color - 1)}, m_charblock{charblock}, m_first_tile{first_tile} {}
+
+        text_canvas(const text_canvas&) = delete;
+        text_canvas& operator=(const text_canvas&) = delete;
+
+        /**
+         * @brief Points a rectangle of a screen block at the canvas tiles.
+         *
+         * @param screenblock Screen block of the background.
+         * @param x Left column of the rectangle.
+         * @param y Top row of the rectangle.
+         * @param palbank Palette bank of the text color.
+         */
+        void map(std::size_t screenblock, std::size_t x, std::size_t y, u16 palbank = 0) const noexcept {
+            auto* screen = &mmio::TEXT_SCREENBLOCKS[screenblock][0];
+            auto tile = m_first_tile;
+            for (std::size_t row = 0; row < Lines * LineTiles; ++row) {
+                for (std::size_t col = 0; col < Columns; ++col) {
+                    screen[(y + row) * 32 + x + col] = textscreen{.tile = tile++, .palbank = palbank};
+                }
+            }
+        }
+
+        /**
+         * @brief Sets the text of a line, rendering it if it changed.
+         *
+         * @param line Line index.
+         * @param text Null terminated text. Characters without a glyph are skipped, and text past the right edge is
+         *             cut off.
+         * @return True if the line was rendered.
+         */
+        bool write(std::size_t line, const char* text) noexcept {
+            const auto hash = hash_of(text);
+            if (m_valid[line] && m_hash[line] == hash) {
+                return false;
+            }
+            m_hash[line] = hash;
+            m_valid[line] = true;
+
+            m_widths[line] = detail::text_rasterize(m_scratch, Columns, LineTiles, text, m_font, m_expand);
+            upload(line);
+            return true;
+        }
+
+        /**
+         * @brief Blanks a line.
+         *
+         * @param line Line index.
+         */
+        void clear(std::size_t line) noexcept {
+            write(line, "");
+        }
+
+        /**
+         * @brief Changes the text color, and re-renders lines on their next write().
+         *
+         * @param color Palette index of the text.
+         */
+        void set_color(u8 color) noexcept {
+            m_expand.set_offset(u32(color - 1));
+            invalidate();
+        }
+
+        /**
+         * @brief Forces every line to be rendered on its next write(), such as after VRAM was overwritten.
+         */
+        void invalidate() noexcept {
+            for (auto& valid : m_valid) {
+                valid = false;
+            }
+        }
+
+        /**
+         * @brief Width in pixels of the last text rendered into a line.
+         *
+         * @param line Line index.
+         */
+        [[nodiscard]]
+        int line_width(std::size_t line) const noexcept {
+            return m_widths[line];
+        }
+
+        /**
+         * @brief Measures text without rendering it.
+         *
+         * @param text Null terminated text.
+         * @return Width in pixels (which may be wider than the canvas).
+         */
+        [[nodiscard]]
+        constexpr int measure(const char* text) const noexcept {
+            int x = 0;
+            for (; *text; ++text) {
+                const auto glyph = unsigned(u8(*text)) - m_font.first;
+                if (glyph < m_font.count) {
+                    x += m_font.widths[glyph];
+                }
+            }
+            return x;
+        }
+
+    private:
+        static constexpr std::size_t line_words = Columns * LineTiles * 8;
+
+        // FNV-1a
+        static constexpr u32 hash_of(const char* text) noexcept {
+            u32 hash = 2166136261u;
+            for (; *text; ++text) {
+                hash = (hash ^ u8(*text)) * 16777619u;
+            }
+            return hash;
+        }
+
+        void upload(std::size_t line) const noexcept {
+            auto* dest = reinterpret_cast<volatile u32*>(&mmio::CHARBLOCKS_4BPP[m_charblock][m_first_tile + line * Columns * LineTiles]);
+            dma<3>::copy(m_scratch, dest, line_words);
+        }
+
+        font m_font;
+        compress::bit_unpacker<1, 4> m_expand;
+        std::size_t m_charblock;
+        u16 m_first_tile;
+        u32 m_hash[Lines]{};
+        bool m_valid[Lines]{};
+        int m_widths[Lines]{};
+        u32 m_scratch[line_words]{};
+    };
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_TEXT_HPP
@@ -0,0 +1,194 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_TILEMAP_BUILDER_HPP
+#define GBAXX_VIDEO_TILEMAP_BUILDER_HPP
+/** @file */
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+
+#include <gba/type.hpp>
+
+#include <gba/video/textscreen.hpp>
+
+namespace gba {
+
+    namespace detail {
+
+        [[nodiscard]]
+        constexpr u8 tile_pixel(const tile4bpp& tile, unsigned x, unsigned y) noexcept {
+            const auto& pair = tile.data[y * 4 + x / 2];
+            return x & 1 ? pair.hi : pair.lo;
+        }
+
+        [[nodiscard]]
+        constexpr u8 tile_pixel(const tile8bpp& tile, unsigned x, unsigned y) noexcept {
+            return tile.data[y * 8 + x];
+        }
+
+        // Compares a with b displayed with the flips
+        template <typename Tile>
+        constexpr bool tile_matches(const Tile& a, const Tile& b, bool hflip, bool vflip) noexcept {
+            for (unsigned y = 0; y < 8; ++y) {
+                for (unsigned x = 0; x < 8; ++x) {
+                    if (tile_pixel(a, x, y) != tile_pixel(b, hflip ? 7 - x : x, vflip ? 7 - y : y)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // FNV-1a of the pixels of a tile displayed with the flips, so a flipped match is found by hashing the flip
+        template <typename Tile>
+        constexpr u32 tile_hash(const Tile& tile, bool hflip, bool vflip) noexcept {
+            u32 hash = 0x811c9dc5;
+            for (unsigned y = 0; y < 8; ++y) {
+                for (unsigned x = 0; x < 8; ++x) {
+                    hash = (hash ^ tile_pixel(tile, hflip ? 7 - x : x, vflip ? 7 - y : y)) * 0x01000193;
+                }
+            }
+            return hash;
+        }
+
+        struct tilemap_entry {
+            u16 tile;
+            bool hflip;
+            bool vflip;
+        };
+
+        template <std::size_t N>
+        struct tile_dedup {
+            std::array<u16, N> unique{}; // Source index of each unique tile
+            std::array<tilemap_entry, N> entries{};
+            std::size_t count{};
+        };
+
+        // Open addressing on the tile hashes, so each tile costs a probe or two per flip rather than a scan of the set
+        template <typename Tile, std::size_t N>
+        consteval auto dedup_tiles(const std::array<Tile, N>& tiles, bool flips) {
+            constexpr auto buckets = std::bit_ceil(N * 2);
+
+            auto result = tile_dedup<N>{};
+            auto hashes = std::array<u32, N>{};
+            auto slots = std::array<u16, buckets>{}; // Unique index + 1, 0 when empty
+
+            for (std::size_t ii = 0; ii < N; ++ii) {
+                auto found = false;
+                for (unsigned flip = 0; flip < (flips ? 4u : 1u) && !found; ++flip) {
+                    // The unique tile that this tile displays as with the flips has the hash of the flipped pixels
+                    const auto hash = tile_hash(tiles[ii], flip & 1, flip & 2);
+                    for (auto slot = hash & (buckets - 1); slots[slot]; slot = (slot + 1) & (buckets - 1)) {
+                        const auto jj = std::size_t(slots[slot] - 1);
+                        if (hashes[jj] == hash && tile_matches(tiles[ii], tiles[result.unique[jj]], flip & 1, flip & 2)) {
+                            result.entries[ii] = {u16(jj), bool(flip & 1), bool(flip & 2)};
+                            found = true;
+                            break;
+                        }
+                    }
+                }
+                if (!found) {
+                    const auto hash = tile_hash(tiles[ii], false, false);
+                    auto slot = hash & (buckets - 1);
+                    while (slots[slot]) {
+                        slot = (slot + 1) & (buckets - 1);
+                    }
+                    slots[slot] = u16(result.count + 1);
+                    hashes[result.count] = hash;
+                    result.unique[result.count] = u16(ii);
+                    result.entries[ii] = {u16(result.count), false, false};
+                    ++result.count;
+                }
+            }
+            return result;
+        }
+
+    } // namespace detail
+
+    /**
+     * @struct tilemap_data
+     * @brief Unique tiles and the screen entries that use them, from make_tilemap().
+     *
+     * @tparam Tile tile4bpp or tile8bpp.
+     * @tparam TileCount Number of unique tiles.
+     * @tparam MapSize Number of screen entries.
+     */
+    template <typename Tile, std::size_t TileCount, std::size_t MapSize>
+    struct tilemap_data {
+        std::array<Tile, TileCount> tiles;
+        std::array<textscreen, MapSize> map;
+    };
+
+    /**
+     * @brief Deduplicates the tiles of an image at compile time, including tiles that are flips of one another.
+     *
+     * Each tile is kept only the first time it appears, directly or flipped horizontally, vertically, or both. Its
+     * screen entries set the flip bits that display the original. The tiles can then be uploaded as they are, taking
+     * no more character VRAM (or upload time) than the image needs.
+     *
+     * @tparam Tiles Reference to a constant std::array of tile4bpp or tile8bpp, in screen entry order.
+     * @tparam Base Character index of the first unique tile, such as 1 to keep tile 0 blank.
+     * @tparam Palbank Palette bank of the 4bpp screen entries.
+     * @tparam Flips Also match flipped tiles. Affine backgrounds have no flip bits.
+     * @return tilemap_data with exactly the unique tiles, and a screen entry per tile of the image.
+     *
+     * @code{cpp}
+     * // Uploading a deduplicated 32x32 tile background
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static constexpr std::array<gba::tile4bpp, 1024> level_tiles = {
+     *     // ... tiles of the image, row by row
+     * };
+     * static constexpr auto level = gba::make_tilemap<level_tiles>();
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     dma<3>::copy(level.tiles.data(), *mmio::CHARBLOCK0_4BPP, level.tiles.size());
+     *     dma<3>::copy(level.map.data(), mmio::TEXT_SCREENBLOCKS[31], level.map.size());
+     *
+     *     mmio::BG0CNT = {.screenblock = 31};
+     *     mmio::DISPCNT = {.show_bg0 = true};
+     * }
+     * @endcode
+     *
+     * @sa textscreen
+     */
+    template <const auto& Tiles, u16 Base = 0, u8 Palbank = 0, bool Flips = true>
+    consteval auto make_tilemap() {
+        using tile_type = typename std::remove_cvref_t<decltype(Tiles)>::value_type;
+        static_assert(std::is_same_v<tile_type, tile4bpp> || std::is_same_v<tile_type, tile8bpp>, "Tiles must be tile4bpp or tile8bpp");
+
+        constexpr auto dedup = detail::dedup_tiles(Tiles, Flips);
+        static_assert(Base + dedup.count <= 1024, "Screen entries address up to 1024 tiles");
+
+        constexpr auto size = std::tuple_size_v<std::remove_cvref_t<decltype(Tiles)>>;
+        auto result = tilemap_data<tile_type, dedup.count, size>{};
+        for (std::size_t ii = 0; ii < dedup.count; ++ii) {
+            result.tiles[ii] = Tiles[dedup.unique[ii]];
+        }
+        for (std::size_t ii = 0; ii < size; ++ii) {
+            const auto& entry = dedup.entries[ii];
+            result.map[ii] = {
+                .tile = u16(Base + entry.tile),
+                .hflip = entry.hflip,
+                .vflip = entry.vflip,
+                .palbank = std::is_same_v<tile_type, tile4bpp> ? u16(Palbank) : u16(0)
+            };
+        }
+        return result;
+    }
+
+} // namespace gba
+
+#endif // define GBAXX_VIDEO_TILEMAP_BUILDER_HPP
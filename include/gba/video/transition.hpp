@@ -0,0 +1,432 @@
+/*
+===============================================================================
+
+ Copyright (C) 2022-2023 gba-hpp contributors
+ For conditions of distribution and use, see copyright notice in LICENSE.md
+
+===============================================================================
+*/
+
+#ifndef GBAXX_VIDEO_TRANSITION_HPP
+#define GBAXX_VIDEO_TRANSITION_HPP
+/** @file */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include <gba/mmio.hpp>
+#include <gba/type.hpp>
+
+#include <gba/math/sqrt.hpp>
+#include <gba/video/bld.hpp>
+#include <gba/video/scanline.hpp>
+#include <gba/video/shadow_io.hpp>
+#include <gba/video/win.hpp>
+
+namespace gba::transition {
+
+    /**
+     * @enum direction
+     * @brief Whether a transition reveals the screen or hides it.
+     */
+    enum class direction {
+        in, /**< Ends with the screen fully shown, then releases the blend. */
+        out, /**< Ends with the screen hidden, which holds until the next transition. */
+    };
+
+    /**
+     * @enum edge
+     * @brief Side of the screen that a wipe starts from.
+     */
+    enum class edge {
+        left,
+        right,
+        top,
+        bottom,
+    };
+
+    /**
+     * @struct frame
+     * @brief Register values for one frame of a transition.
+     */
+    struct frame {
+        fixed<u8x2, 5> bldalpha; /**< @sa mmio::BLDALPHA */
+        fixed<u16, 4> bldy; /**< @sa mmio::BLDY */
+        u8x2 win0h; /**< @sa mmio::WIN0H */
+        u8x2 win0v; /**< @sa mmio::WIN0V */
+    };
+
+    /**
+     * @struct sequence
+     * @brief Precomputed transition, played by a player.
+     *
+     * Generated at compile time by fade(), cross_fade(), wipe(), or iris(), so it is stored in ROM.
+     *
+     * @tparam Frames Length of the transition in frames.
+     * @tparam Lines Also holds a mmio::WIN0H value for every scanline of every frame.
+     *
+     * @sa player
+     */
+    template <std::size_t Frames, bool Lines = false>
+    struct sequence {
+        static constexpr std::size_t lines_per_frame = 161; // The HBlank of line 159 reads one entry past the end
+
+        bldcnt blend; /**< Written when the transition starts. */
+        winin inside; /**< Written when the transition starts, if window is set. */
+        winout outside; /**< Written when the transition starts, if window is set. */
+        bool window; /**< Uses window 0, which must be enabled with dispcnt::enable_win0. */
+        bool release; /**< Clears mmio::BLDCNT when the transition ends. */
+        std::array<frame, Frames> frames;
+        std::array<std::array<u8x2, lines_per_frame>, Lines ? Frames : 0> lines;
+    };
+
+    namespace detail {
+
+        // from + (to - from) * step / (steps - 1), rounded
+        consteval int ramp(std::size_t step, std::size_t steps, int from, int to) noexcept {
+            const auto span = int(steps - 1);
+            const auto distance = to > from ? to - from : from - to;
+            const auto moved = (distance * int(step) * 2 + span) / (span * 2);
+            return to > from ? from + moved : from - moved;
+        }
+
+        consteval u8x2 span(int from, int to) noexcept {
+            return u8x2{u8(from), u8(to)};
+        }
+
+        consteval int clamp_round(double x, int max) noexcept {
+            if (x <= 0) {
+                return 0;
+            }
+            if (x >= max) {
+                return max;
+            }
+            return int(x + 0.5);
+        }
+
+        template <std::size_t Frames>
+        consteval auto blank_sequence() {
+            static_assert(Frames >= 2 && Frames <= 0xffff, "Transitions last from 2 to 65535 frames");
+
+            auto result = sequence<Frames>{};
+            for (auto& f : result.frames) {
+                f.bldalpha = fixed<u8x2, 5>::from_data(span(16, 0));
+                f.win0h = span(0, 240);
+                f.win0v = span(0, 160);
+            }
+            return result;
+        }
+
+        inline constexpr auto all_layers = winin{
+            .win0_bg0 = true,
+            .win0_bg1 = true,
+            .win0_bg2 = true,
+            .win0_bg3 = true,
+            .win0_obj = true,
+            .win0_effect = true
+        };
+
+    } // namespace detail
+
+    /**
+     * @brief Fades every layer to or from black (or white), with mmio::BLDY.
+     *
+     * @tparam Frames Length of the fade.
+     * @param dir direction::out fades to black, direction::in fades from it.
+     * @param effect color_effect::darken for black, or color_effect::brighten for white.
+     */
+    template <std::size_t Frames>
+    consteval auto fade(direction dir, color_effect effect = color_effect::darken) {
+        auto result = detail::blank_sequence<Frames>();
+        result.blend = bldcnt{
+            .target1_bg0 = true,
+            .target1_bg1 = true,
+            .target1_bg2 = true,
+            .target1_bg3 = true,
+            .target1_obj = true,
+            .target1_backdrop = true,
+            .mode = effect
+        };
+        result.release = dir == direction::in;
+        for (std::size_t ii = 0; ii < Frames; ++ii) {
+            const auto y = dir == direction::out ? detail::ramp(ii, Frames, 0, 16) : detail::ramp(ii, Frames, 16, 0);
+            result.frames[ii].bldy = fixed<u16, 4>::from_data(u16(y));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Blends from the first target layers of a bldcnt to its second target layers, with mmio::BLDALPHA.
+     *
+     * @tparam Frames Length of the cross-fade.
+     * @param layers Layers to fade out as target 1, and layers to fade in as target 2. The mode is ignored.
+     *
+     * @note The blend is kept at the end, showing only the second target. Write mmio::BLDCNT to release it.
+     */
+    template <std::size_t Frames>
+    consteval auto cross_fade(bldcnt layers) {
+        auto result = detail::blank_sequence<Frames>();
+        result.blend = layers;
+        result.blend.mode = color_effect::alpha_blend;
+        for (std::size_t ii = 0; ii < Frames; ++ii) {
+            const auto eva = detail::ramp(ii, Frames, 16, 0);
+            result.frames[ii].bldalpha = fixed<u8x2, 5>::from_data(detail::span(eva, 16 - eva));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Sweeps the edge of window 0 across the screen, hiding or revealing the layers behind it.
+     *
+     * Outside of the window only the backdrop is shown.
+     *
+     * @tparam Frames Length of the wipe.
+     * @param dir direction::in grows the shown area from the edge, direction::out grows the hidden area from it.
+     * @param from Side of the screen that the moving edge starts from.
+     * @param layers Window 0 layers of the winin shown inside the window.
+     */
+    template <std::size_t Frames>
+    consteval auto wipe(direction dir, edge from, winin layers = detail::all_layers) {
+        auto result = detail::blank_sequence<Frames>();
+        result.inside = layers;
+        result.window = true;
+        result.release = dir == direction::in;
+
+        const auto vertical = from == edge::top || from == edge::bottom;
+        const auto extent = vertical ? 160 : 240;
+        const auto start_side = from == edge::left || from == edge::top;
+        for (std::size_t ii = 0; ii < Frames; ++ii) {
+            const auto moved = detail::ramp(ii, Frames, 0, extent);
+
+            // The shown span, which either grows out of the edge, or retreats from it
+            const auto shown = dir == direction::in ? (start_side ? detail::span(0, moved) : detail::span(extent - moved, extent))
+                                                    : (start_side ? detail::span(moved, extent) : detail::span(0, extent - moved));
+            (vertical ? result.frames[ii].win0v : result.frames[ii].win0h) = shown;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Closes or opens a circle around a point of the screen, with a window 0 span for every scanline.
+     *
+     * Outside of the circle only the backdrop is shown.
+     *
+     * @tparam Frames Length of the iris.
+     * @param dir direction::in opens the circle, direction::out closes it.
+     * @param x Horizontal center of the circle, in pixels.
+     * @param y Vertical center of the circle, in pixels.
+     * @param layers Window 0 layers of the winin shown inside the circle.
+     *
+     * @note Each frame holds 161 scanline spans, so an iris takes 322 bytes of ROM per frame.
+     */
+    template <std::size_t Frames>
+    consteval auto iris(direction dir, int x = 120, int y = 80, winin layers = detail::all_layers) {
+        const auto base = detail::blank_sequence<Frames>();
+        auto result = sequence<Frames, true>{};
+        result.frames = base.frames;
+        result.inside = layers;
+        result.window = true;
+        result.release = dir == direction::in;
+
+        // Distance to the farthest corner, so the open circle covers the screen
+        const auto dx = x < 120 ? 240 - x : x;
+        const auto dy = y < 80 ? 160 - y : y;
+        const auto max_radius = int(gba::detail::square_root(double(dx * dx + dy * dy))) + 1;
+
+        for (std::size_t ii = 0; ii < Frames; ++ii) {
+            const auto radius = dir == direction::in ? detail::ramp(ii, Frames, 0, max_radius) : detail::ramp(ii, Frames, max_radius, 0);
+
+            auto& lines = result.lines[ii];
+            for (int line = 0; line < 160; ++line) {
+                const auto offset = line + 0.5 - y;
+                const auto squared = double(radius) * radius - offset * offset;
+                if (squared <= 0) {
+                    lines[line] = detail::span(0, 0);
+                    continue;
+                }
+                const auto half = gba::detail::square_root(squared);
+                const auto left = detail::clamp_round(x - half, 240);
+                const auto right = detail::clamp_round(x + half, 240);
+                lines[line] = left < right ? detail::span(left, right) : detail::span(0, 0);
+            }
+            lines[160] = lines[159];
+            result.frames[ii].win0h = lines[0];
+        }
+        return result;
+    }
+
+    /**
+     * @class player
+     * @brief Plays a transition from the VBlank handler, one precomputed frame per VBlank.
+     *
+     * Every frame of a sequence is computed at compile time, so vblank() only copies a few values into a shadow_io,
+     * and re-arms an HBlank DMA for transitions with per-scanline windows. The main loop is free to load assets while
+     * the screen fades.
+     *
+     * A frame is shown from the VBlank that vblank() and shadow_io::commit() run in. The VBlank after the last frame
+     * ends the transition, releasing mmio::BLDCNT after direction::in.
+     *
+     * @tparam Channel DMA channel for per-scanline sequences. DMA0 cannot read ROM, so the default is DMA3.
+     *
+     * @code{cpp}
+     * // Closing an iris on the player, loading the next level behind it, then fading in
+     *
+     * #include <gba/gba.hpp>
+     *
+     * static constexpr auto iris_close = gba::transition::iris<30>(gba::transition::direction::out, 120, 96);
+     * static constexpr auto fade_open = gba::transition::fade<16>(gba::transition::direction::in);
+     *
+     * static gba::shadow_io io;
+     * static gba::transition::player<> level_transition;
+     *
+     * int main() {
+     *     using namespace gba;
+     *
+     *     mmio::IRQ_HANDLER = agbabi::irq_user([](irq flags) {
+     *         if (flags.vblank) {
+     *             level_transition.vblank(io);
+     *             io.commit();
+     *         }
+     *     });
+     *
+     *     mmio::DISPSTAT = {.irq_vblank = true};
+     *     mmio::IE = {.vblank = true};
+     *     mmio::IME = true;
+     *
+     *     io.set<mmio::DISPCNT>({.show_bg0 = true, .enable_win0 = true});
+     *
+     *     level_transition.play(iris_close);
+     *     // ... decompress the next level while the iris closes
+     *     while (level_transition.playing()) {
+     *         bios::VBlankIntrWait();
+     *     }
+     *
+     *     level_transition.play(fade_open);
+     * }
+     * @endcode
+     *
+     * @note Window sequences write both window halves of mmio::WININ and mmio::WINOUT.
+     *
+     * @sa shadow_io
+     * @sa scanline_effect
+     */
+    template <std::size_t Channel = 3>
+    class player {
+    public:
+        constexpr player() noexcept = default;
+
+        player(const player&) = delete;
+        player& operator=(const player&) = delete;
+
+        /**
+         * @brief Starts a transition from the next VBlank, replacing any that is playing.
+         *
+         * @param seq Sequence to play, which must outlive the transition.
+         */
+        template <std::size_t Frames, bool Lines>
+        void play(const sequence<Frames, Lines>& seq) noexcept {
+            m_playing = false;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+
+            if (m_lines) {
+                dma<Channel>::stop(); // The previous sequence's HBlank DMA is not reloaded by the next one
+            }
+
+            m_frames = seq.frames.data();
+            if constexpr (Lines) {
+                m_lines = seq.lines.front().data();
+            } else {
+                m_lines = nullptr;
+            }
+            m_count = u16(Frames);
+            m_blend = seq.blend;
+            m_inside = seq.inside;
+            m_outside = seq.outside;
+            m_window = seq.window;
+            m_release = seq.release;
+            m_frame = 0;
+
+            std::atomic_signal_fence(std::memory_order_release);
+            m_playing = true;
+        }
+
+        /**
+         * @brief Tests if a transition has frames left to show.
+         */
+        [[nodiscard]]
+        bool playing() const noexcept {
+            return m_playing;
+        }
+
+        /**
+         * @brief Ends the transition, leaving the registers as they are.
+         */
+        void stop() noexcept {
+            m_playing = false;
+            if (m_lines) {
+                dma<Channel>::stop();
+            }
+        }
+
+        /**
+         * @brief Sets the registers of the next frame in the shadow.
+         *
+         * Must be called from the VBlank interrupt handler, before shadow_io::commit().
+         *
+         * @param io Shadow registers committed by the same VBlank handler.
+         */
+        void vblank(shadow_io& io) noexcept {
+            if (!m_playing) {
+                return;
+            }
+
+            const auto index = m_frame;
+            if (index == m_count) {
+                if (m_lines) {
+                    dma<Channel>::stop();
+                }
+                if (m_release) {
+                    io.set<mmio::BLDCNT>(bldcnt{});
+                }
+                m_playing = false;
+                return;
+            }
+
+            if (index == 0) {
+                io.set<mmio::BLDCNT>(m_blend);
+                if (m_window) {
+                    io.set<mmio::WININ>(m_inside);
+                    io.set<mmio::WINOUT>(m_outside);
+                }
+            }
+
+            const auto& step = m_frames[index];
+            io.set<mmio::BLDALPHA>(step.bldalpha);
+            io.set<mmio::BLDY>(step.bldy);
+            if (m_window) {
+                io.set<mmio::WIN0H>(step.win0h);
+                io.set<mmio::WIN0V>(step.win0v);
+            }
+            if (m_lines) {
+                gba::detail::hblank_stream<Channel>(m_lines + index * sequence<1>::lines_per_frame, reinterpret_cast<volatile u8x2*>(&mmio::WIN0H));
+            }
+            m_frame = index + 1;
+        }
+
+    private:
+        const frame* m_frames{};
+        const u8x2* m_lines{};
+        u16 m_count{};
+        u16 m_frame{};
+        bldcnt m_blend{};
+        winin m_inside{};
+        winout m_outside{};
+        bool m_window{};
+        bool m_release{};
+        volatile bool m_playing{};
+    };
+
+} // namespace gba::transition
+
+#endif // define GBAXX_VIDEO_TRANSITION_HPP
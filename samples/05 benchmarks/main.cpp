@@ -0,0 +1,171 @@
+#include <gba/gba.hpp>
+
+#include <array>
+#include <cstring>
+
+namespace {
+
+    constexpr std::size_t bytes = 1024;
+    constexpr std::size_t words = bytes / 4;
+
+    // LZ77: one literal block, then blocks of 18-byte back-references 8 bytes back
+    constexpr auto make_lz77() {
+        std::array<gba::u8, 4 + 9 + 8 * 17 + 3> data{};
+        std::size_t n = 0;
+        const auto header = 0x10u | (bytes << 8);
+        for (int ii = 0; ii < 4; ++ii) {
+            data[n++] = gba::u8(header >> (ii * 8));
+        }
+        data[n++] = 0x00;
+        for (int ii = 0; ii < 8; ++ii) {
+            data[n++] = gba::u8('a' + ii);
+        }
+        for (std::size_t written = 8; written < bytes; ) {
+            data[n++] = 0xff;
+            for (int ii = 0; ii < 8 && written < bytes; ++ii) {
+                const auto length = bytes - written < 18 ? bytes - written : std::size_t{18};
+                data[n++] = gba::u8((length - 3) << 4);
+                data[n++] = 8 - 1;
+                written += length;
+            }
+        }
+        return data;
+    }
+
+    // Run-length: runs of 128 bytes
+    constexpr auto make_rle() {
+        std::array<gba::u8, 4 + (bytes / 128) * 2> data{};
+        std::size_t n = 0;
+        const auto header = 0x30u | (bytes << 8);
+        for (int ii = 0; ii < 4; ++ii) {
+            data[n++] = gba::u8(header >> (ii * 8));
+        }
+        for (std::size_t run = 0; run < bytes / 128; ++run) {
+            data[n++] = 0x80 | (128 - 3);
+            data[n++] = gba::u8(run);
+        }
+        return data;
+    }
+
+    // Huffman: 8-bit symbols with a two leaf tree, alternating between them
+    constexpr auto make_huffman() {
+        std::array<gba::u32, 2 + bytes / 32> data{};
+        data[0] = 0x28u | (bytes << 8);
+        data[1] = 0x01u | (0xc0u << 8) | (gba::u32('A') << 16) | (gba::u32('B') << 24); // Tree size, root, leaves
+        for (std::size_t ii = 2; ii < data.size(); ++ii) {
+            data[ii] = 0x55555555;
+        }
+        return data;
+    }
+
+    alignas(4) constexpr auto lz77_data = make_lz77();
+    alignas(4) constexpr auto rle_data = make_rle();
+    constexpr auto huffman_data = make_huffman();
+
+    alignas(4) gba::u8 source[bytes];
+    alignas(4) gba::u8 destination[bytes];
+
+    volatile int numerator = 1234567;
+    volatile int denominator = 89;
+    volatile gba::u32 radicand = 1234567;
+    volatile gba::u16 rotation = 0x1234;
+
+    auto* const vram = reinterpret_cast<void*>(0x6000000);
+
+} // namespace
+
+int main() {
+    using namespace gba;
+
+    if (!mgba::open()) {
+        while (true);
+    }
+
+    benchmark::suite<24> benches;
+
+    // Copies of 1KiB (cycles/op is per word)
+    benches.add("std::memcpy", [] {
+        std::memcpy(destination, source, bytes);
+        benchmark::clobber();
+    }, words);
+    benches.add("agbabi::memcpy2", [] {
+        agbabi::memcpy2(destination, source, bytes);
+        benchmark::clobber();
+    }, words);
+    benches.add("agbabi::memcpy1", [] {
+        agbabi::memcpy1(destination, source, bytes);
+        benchmark::clobber();
+    }, words);
+    benches.add("agbabi::fiq::memcpy4", [] {
+        agbabi::fiq::memcpy4(destination, source, bytes);
+        benchmark::clobber();
+    }, words);
+    benches.add("bios::CpuFastSet", [] {
+        bios::CpuFastSet(source, destination, bios::cpu_fast_set{.count = words});
+    }, words);
+    benches.add("bios::CpuSet 32-bit", [] {
+        bios::CpuSet(source, destination, bios::cpu_set{.count = words, .set_32bit = true});
+    }, words);
+    benches.add("bios::CpuSet 16-bit", [] {
+        bios::CpuSet(source, destination, bios::cpu_set{.count = bytes / 2});
+    }, words);
+    benches.add("dma<3>::copy", [] {
+        dma<3>::copy(reinterpret_cast<const u32*>(source), reinterpret_cast<u32*>(destination), words);
+    }, words);
+
+    // Division
+    benches.add("bios::Div", [] {
+        benchmark::do_not_optimize(bios::Div(numerator, denominator));
+    });
+    benches.add("operator/ (agbabi)", [] {
+        benchmark::do_not_optimize(numerator / denominator);
+    });
+
+    // Trigonometry and roots
+    benches.add("bios::SinCos", [] {
+        benchmark::do_not_optimize(bios::SinCos(angle<u16>(rotation)));
+    });
+    benches.add("lut::sin + lut::cos", [] {
+        const auto a = angle<u16>(rotation);
+        benchmark::do_not_optimize(lut::sin(lut::sin_lut, a));
+        benchmark::do_not_optimize(lut::cos(lut::sin_lut, a));
+    });
+    benches.add("bios::Sqrt", [] {
+        benchmark::do_not_optimize(bios::Sqrt(radicand));
+    });
+    benches.add("agbabi::sqrt", [] {
+        benchmark::do_not_optimize(agbabi::sqrt(radicand));
+    });
+
+    // Decompression of 1KiB (cycles/op is per byte)
+    benches.add("bios::LZ77UnCompWram", [] {
+        bios::LZ77UnCompWram(lz77_data.data(), destination);
+    }, bytes);
+    benches.add("bios::LZ77UnCompVram", [] {
+        bios::LZ77UnCompVram(lz77_data.data(), vram);
+    }, bytes);
+    benches.add("compress::lz77_decompress<wram>", [] {
+        compress::lz77_decompress(lz77_data.data(), destination);
+    }, bytes);
+    benches.add("compress::lz77_decompress<vram>", [] {
+        compress::lz77_decompress<compress::target::vram>(lz77_data.data(), vram);
+    }, bytes);
+    benches.add("compress::lz77_decoder", [] {
+        compress::lz77_decoder{lz77_data.data(), destination}.decode_all();
+    }, bytes);
+    benches.add("bios::RLUnCompWram", [] {
+        bios::RLUnCompWram(rle_data.data(), destination);
+    }, bytes);
+    benches.add("bios::RLUnCompVram", [] {
+        bios::RLUnCompVram(rle_data.data(), vram);
+    }, bytes);
+    benches.add("bios::HuffUnComp", [] {
+        bios::HuffUnComp(huffman_data.data(), destination);
+    }, bytes);
+
+    benches.run(64);
+    mgba::puts(mgba::log::info, "Benchmarks complete");
+    mgba::close();
+
+    while (true);
+}
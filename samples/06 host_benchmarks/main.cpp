@@ -0,0 +1,83 @@
+#include <gba/gba.hpp>
+
+#include <array>
+
+// Built with GBAXX_HOST, this runs on the development machine. Results are host time in nanoseconds, useful to compare
+// revisions of an algorithm, but not a substitute for measuring cycles on the device (see samples/05 benchmarks)
+
+namespace {
+
+    constexpr std::size_t bytes = 1024;
+
+    constexpr auto pattern = gba::lut::make<bytes>([](std::size_t i) {
+        return gba::u8((i / 64) ^ (i % 7 == 0));
+    });
+
+    constexpr auto lz77_data = gba::compress::lz77_compress<pattern>();
+    constexpr auto rle_data = gba::compress::rle_compress<pattern>();
+
+    alignas(4) gba::u8 destination[bytes];
+
+    // 128x64 tile level with 2048 unique metatiles, which needs u16 indices
+    constexpr auto level_entries = gba::lut::make<128 * 64>([](std::size_t i) {
+        const auto x = i % 128;
+        const auto y = i / 128;
+        const auto block = (y / 2) * 64 + x / 2;
+        return gba::textscreen{.tile = gba::u16(block % 1024), .palbank = gba::u16(block / 1024 + (x & 1) * 2 + (y & 1) * 4)};
+    });
+
+    constexpr auto level = gba::make_metatiles<level_entries, 128>();
+    static_assert(level.set.size() == 2048 && std::is_same_v<decltype(level)::index_type, gba::u16>);
+
+    volatile int numerator = 1234567;
+    volatile int length_x = 0x34000; // 3.25 in 16.16
+    volatile int length_y = 0x78000; // 7.5 in 16.16
+    volatile gba::u16 rotation = 0x1234;
+
+} // namespace
+
+int main() {
+    using namespace gba;
+
+    benchmark::suite<8> benches;
+
+    // Decompression of 1KiB (ns/op is per byte)
+    benches.add("compress::lz77_decompress<wram>", [] {
+        compress::lz77_decompress(lz77_data.data(), destination);
+        benchmark::clobber();
+    }, bytes);
+    benches.add("compress::lz77_decoder", [] {
+        compress::lz77_decoder{lz77_data.data(), destination}.decode_all();
+        benchmark::clobber();
+    }, bytes);
+    benches.add("compress::rle_decoder", [] {
+        compress::rle_decoder{rle_data.data(), destination}.decode_all();
+        benchmark::clobber();
+    }, bytes);
+
+    // Expanding a 32x32 tile window of metatiles into a screenblock (ns/op is per tile)
+    benches.add("metatile_layer::draw", [] {
+        metatile_layer{level}.draw(31, 16, 8);
+        benchmark::clobber();
+    }, 32 * 32);
+
+    // Arithmetic
+    benches.add("operator/ constant<24>", [] {
+        benchmark::do_not_optimize(numerator / constant<24>);
+    });
+    benches.add("rsqrt", [] {
+        benchmark::do_not_optimize(rsqrt(fixed<int, 16>::from_data(length_x)));
+    });
+    benches.add("hypot", [] {
+        benchmark::do_not_optimize(hypot(fixed<int, 16>::from_data(length_x), fixed<int, 16>::from_data(length_y)));
+    });
+    benches.add("lut::sin + lut::cos", [] {
+        const auto a = angle<u16>(rotation);
+        benchmark::do_not_optimize(lut::sin(lut::sin_lut, a));
+        benchmark::do_not_optimize(lut::cos(lut::sin_lut, a));
+    });
+
+    benches.run(1024);
+    mgba::puts(mgba::log::info, "Benchmarks complete");
+    return 0;
+}
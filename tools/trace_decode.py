@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022-2023 gba-hpp contributors
+# For conditions of distribution and use, see copyright notice in LICENSE.md
+#
+"""Decodes gba::trace output from an mGBA log into a timeline.
+
+Reads the log (a file, or standard input) and prints one line per event:
+the cycle timestamp, frame, scanline and dot it was recorded at, the cycles
+since the previous event, the event id and its payload.
+
+    mgba -l 31 game.gba 2> game.log
+    tools/trace_decode.py game.log --names events.txt
+
+The optional names file maps event ids to names, one "id name" pair per line.
+
+Frames and scanlines are counted from profile::start(). Start the counter at
+the beginning of a frame (when VCOUNT is 0) for them to match the display.
+"""
+
+import argparse
+import sys
+
+CHARS_PER_ENTRY = 11
+CYCLES_PER_LINE = 1232
+CYCLES_PER_FRAME = 228 * CYCLES_PER_LINE
+CYCLES_PER_SECOND = 1 << 24
+
+
+def decode_value(text):
+    value = 0
+    for shift, char in enumerate(text):
+        digit = ord(char) - ord('0')
+        if not 0 <= digit < 64:
+            raise ValueError(f'invalid trace character {char!r}')
+        value |= digit << (shift * 6)
+    return value
+
+
+def read_events(lines):
+    """Yields ('event', time, id, payload) and ('lost', count) in log order."""
+    for line in lines:
+        marker = line.find('~T')
+        if marker >= 0:
+            data = line[marker + 2:].rstrip()
+            for start in range(0, len(data) - CHARS_PER_ENTRY + 1, CHARS_PER_ENTRY):
+                value = decode_value(data[start:start + CHARS_PER_ENTRY])
+                yield 'event', value & 0xffffffff, (value >> 32) & 0xffff, (value >> 48) & 0xffff
+            continue
+        marker = line.find('~L')
+        if marker >= 0:
+            yield 'lost', decode_value(line[marker + 2:marker + 8])
+
+
+def read_names(path):
+    names = {}
+    with open(path) as file:
+        for line in file:
+            fields = line.split(None, 1)
+            if len(fields) == 2 and not fields[0].startswith('#'):
+                names[int(fields[0], 0)] = fields[1].strip()
+    return names
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('log', nargs='?', type=argparse.FileType('r'), default=sys.stdin, help='mGBA log (default: stdin)')
+    parser.add_argument('--names', help='file of "id name" lines')
+    parser.add_argument('--csv', action='store_true', help='print comma separated values')
+    args = parser.parse_args()
+
+    names = read_names(args.names) if args.names else {}
+    separator = ',' if args.csv else ' '
+    print(separator.join(['cycles', 'us', 'frame', 'line', 'dot', 'delta', 'event', 'payload']))
+
+    # The 32-bit counter wraps about every 256 seconds, so time is unwrapped assuming events arrive in order
+    base = 0
+    previous = None
+    for record in read_events(args.log):
+        if record[0] == 'lost':
+            print(f'# {record[1]} events lost')
+            previous = None
+            continue
+
+        _, time, event, payload = record
+        if previous is not None and time + base < previous:
+            base += 1 << 32
+        time += base
+
+        delta = '' if previous is None else str(time - previous)
+        previous = time
+
+        frame, offset = divmod(time, CYCLES_PER_FRAME)
+        line, dot = divmod(offset, CYCLES_PER_LINE)
+        fields = [
+            str(time),
+            f'{time * 1000000 / CYCLES_PER_SECOND:.2f}',
+            str(frame),
+            str(line),
+            str(dot // 4),
+            delta,
+            names.get(event, str(event)),
+            f'0x{payload:04x}',
+        ]
+        print(separator.join(fields) if args.csv else '{:>12} {:>12} {:>7} {:>4} {:>4} {:>8}  {} {}'.format(*fields))
+
+
+if __name__ == '__main__':
+    main()